@@ -114,6 +114,7 @@ const sidebars: SidebarsConfig = {
                                 'manual/tools-mark-bad-channels',
                                 'manual/tools-compensate-data',
                                 'manual/tools-cov2proj',
+                                'manual/tools-sss',
                                 'manual/tools-add-to-meas-info',
                                 'manual/tools-create-comp-data',
                                 'manual/tools-fix-mag-coil-types',
@@ -117,6 +117,7 @@ QMenu *Filtering::getMenu()
 QDockWidget *Filtering::getControl()
 {
     m_pFilterSettingsView = new FilterSettingsView("MNEANALYZE");
+    m_pFilterSettingsView->setProcessingMode(DISPLIB::AbstractView::ProcessingMode::Offline);
 
     connect(this, &Filtering::guiModeChanged,
             m_pFilterSettingsView.data(), &FilterSettingsView::setGuiMode, Qt::UniqueConnection);
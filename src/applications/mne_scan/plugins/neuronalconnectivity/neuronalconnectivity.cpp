@@ -42,6 +42,7 @@
 
 #include <conn/connectivity.h>
 #include <conn/metrics/abstractmetric.h>
+#include <conn/metrics/slidingwindowmetric.h>
 #include <dsp/rt/rt_connectivity.h>
 
 #include <disp/viewers/connectivitysettingsview.h>
@@ -103,6 +104,8 @@ NeuronalConnectivity::NeuronalConnectivity()
     //Init rt connectivity worker
     connect(m_pRtConnectivity.data(), &RtConnectivity::newConnectivityResultAvailable,
             this, &NeuronalConnectivity::onNewConnectivityResultAvailable);
+    connect(m_pRtConnectivity.data(), &RtConnectivity::newSlidingWindowResultAvailable,
+            this, &NeuronalConnectivity::onNewSlidingWindowResultAvailable);
 }
 
 //=============================================================================================================
@@ -274,30 +277,23 @@ void NeuronalConnectivity::updateSource(SCMEASLIB::Measurement::SPtr pMeasuremen
 
             m_iBlockSize = pRTSE->getValue().first()->data.cols() - iZeroIdx;
 
-            // Check row and colum integrity and restart if necessary
-            if(m_connectivitySettings.size() != 0) {
-                if(m_iBlockSize != m_connectivitySettings.at(0).matData.cols()) {
-                    m_connectivitySettings.clearAllData();
-                    m_pRtConnectivity->restart();
-                }
-            }
-
-            // No copy necessary since we do a deep copy in connectivity settings before the measurement
-            // overwrites the matrix
-            m_connectivitySettings.append(pRTSE->getValue()[i]->data.block(0,
-                                                                           iZeroIdx,
-                                                                           pRTSE->getValue()[i]->data.rows(),
-                                                                           pRTSE->getValue()[i]->data.cols() - iZeroIdx));
-        }
-
-        //Pop data from buffer
-        if(m_connectivitySettings.size() >= m_iNumberAverages) {
-            m_pRtConnectivity->restart();
-            m_connectivitySettings.removeFirst(m_connectivitySettings.size()-m_iNumberAverages);
+            appendTrial(pRTSE->getValue()[i]->data.block(0,
+                                                         iZeroIdx,
+                                                         pRTSE->getValue()[i]->data.rows(),
+                                                         pRTSE->getValue()[i]->data.cols() - iZeroIdx));
         }
 
         m_timer.restart();
-        m_pRtConnectivity->append(m_connectivitySettings);
+
+        if(!publishSlidingWindow()) {
+            //Pop data from buffer
+            if(m_connectivitySettings.size() >= m_iNumberAverages) {
+                m_pRtConnectivity->restart();
+                m_connectivitySettings.removeFirst(m_connectivitySettings.size()-m_iNumberAverages);
+            }
+
+            m_pRtConnectivity->append(m_connectivitySettings);
+        }
     }
 }
 
@@ -342,31 +338,26 @@ void NeuronalConnectivity::updateRTMSA(SCMEASLIB::Measurement::SPtr pMeasurement
                 const MatrixXd& t_mat = pRTMSA->getMultiSampleArray()[i];
                 m_iBlockSize = pRTMSA->getMultiSampleArray()[i].cols();
 
-                // Check row and colum integrity and restart if necessary
-                if(m_connectivitySettings.size() != 0) {
-                    if(m_iBlockSize != m_connectivitySettings.at(0).matData.cols()) {
-                        m_connectivitySettings.clearAllData();
-                        m_pRtConnectivity->restart();
-                    }
-                }
-
                 data.resize(m_vecPicks.cols(), t_mat.cols());
 
                 for(qint32 j = 0; j < m_vecPicks.cols(); ++j) {
                     data.row(j) = t_mat.row(m_vecPicks[j]);
                 }
 
-                m_connectivitySettings.append(data);
-            }
-
-            //Pop data from buffer
-            if(m_connectivitySettings.size() > m_iNumberAverages) {
-                m_pRtConnectivity->restart();
-                m_connectivitySettings.removeFirst(m_connectivitySettings.size()-m_iNumberAverages);
+                appendTrial(data);
             }
 
             m_timer.restart();
-            m_pRtConnectivity->append(m_connectivitySettings);
+
+            if(!publishSlidingWindow()) {
+                //Pop data from buffer
+                if(m_connectivitySettings.size() > m_iNumberAverages) {
+                    m_pRtConnectivity->restart();
+                    m_connectivitySettings.removeFirst(m_connectivitySettings.size()-m_iNumberAverages);
+                }
+
+                m_pRtConnectivity->append(m_connectivitySettings);
+            }
         }
     }
 }
@@ -425,14 +416,6 @@ void NeuronalConnectivity::updateRTEV(SCMEASLIB::Measurement::SPtr pMeasurement)
 
                     m_iBlockSize = t_mat.cols();
 
-                    // Check row and colum integrity and restart if necessary
-                    if(m_connectivitySettings.size() != 0) {
-                        if(m_iBlockSize != m_connectivitySettings.at(0).matData.cols()) {
-                            m_connectivitySettings.clearAllData();
-                            m_pRtConnectivity->restart();
-                        }
-                    }
-
                     MatrixXd data;
                     data.resize(m_vecPicks.cols(), t_mat.cols());
 
@@ -440,16 +423,19 @@ void NeuronalConnectivity::updateRTEV(SCMEASLIB::Measurement::SPtr pMeasurement)
                         data.row(j) = t_mat.row(m_vecPicks[j]);
                     }
 
-                    m_connectivitySettings.append(data);
-
-                    //Pop data from buffer
-                    if(m_connectivitySettings.size() > m_iNumberAverages) {
-                        m_pRtConnectivity->restart();
-                        m_connectivitySettings.removeFirst(m_connectivitySettings.size()-m_iNumberAverages);
-                    }
+                    appendTrial(data);
 
                     m_timer.restart();
-                    m_pRtConnectivity->append(m_connectivitySettings);
+
+                    if(!publishSlidingWindow()) {
+                        //Pop data from buffer
+                        if(m_connectivitySettings.size() > m_iNumberAverages) {
+                            m_pRtConnectivity->restart();
+                            m_connectivitySettings.removeFirst(m_connectivitySettings.size()-m_iNumberAverages);
+                        }
+
+                        m_pRtConnectivity->append(m_connectivitySettings);
+                    }
 
                     break;
                 }
@@ -460,6 +446,48 @@ void NeuronalConnectivity::updateRTEV(SCMEASLIB::Measurement::SPtr pMeasurement)
 
 //=============================================================================================================
 
+void NeuronalConnectivity::appendTrial(const MatrixXd& matData)
+{
+    // Spectral metrics are updated incrementally by the worker, one trial at a time
+    if(SlidingWindowMetric::supports(m_sConnectivityMethods)) {
+        m_lSlidingWindowTrials.append(matData);
+        return;
+    }
+
+    m_lSlidingWindowTrials.clear();
+
+    // Check row and colum integrity and restart if necessary
+    if(m_connectivitySettings.size() != 0) {
+        if(matData.cols() != m_connectivitySettings.at(0).matData.cols()) {
+            m_connectivitySettings.clearAllData();
+            m_pRtConnectivity->restart();
+        }
+    }
+
+    // No copy necessary since we do a deep copy in connectivity settings before the measurement
+    // overwrites the matrix
+    m_connectivitySettings.append(matData);
+}
+
+//=============================================================================================================
+
+bool NeuronalConnectivity::publishSlidingWindow()
+{
+    if(!SlidingWindowMetric::supports(m_sConnectivityMethods)) {
+        return false;
+    }
+
+    // The spectra and the networks are computed on the worker thread, not on the one delivering the data
+    if(!m_lSlidingWindowTrials.isEmpty()) {
+        m_pRtConnectivity->appendTrials(m_lSlidingWindowTrials, m_connectivitySettings, m_iNumberAverages);
+        m_lSlidingWindowTrials.clear();
+    }
+
+    return true;
+}
+
+//=============================================================================================================
+
 void NeuronalConnectivity::generateNodeVertices()
 {
     if(!m_pFiffInfo) {
@@ -554,6 +582,15 @@ void NeuronalConnectivity::onNewConnectivityResultAvailable(const QList<Network>
 
 //=============================================================================================================
 
+void NeuronalConnectivity::onNewSlidingWindowResultAvailable(const QList<Network>& connectivityResults)
+{
+    for(int i = 0; i < connectivityResults.size(); ++i) {
+        m_pCircularBuffer->push(connectivityResults.at(i));
+    }
+}
+
+//=============================================================================================================
+
 void NeuronalConnectivity::onMetricChanged(const QString& sMetric)
 {
     if(m_sConnectivityMethods.contains(sMetric)) {
@@ -174,6 +174,24 @@ signals:
     void responsibleTriggerTypesChaged(const QStringList& lResponsibleTriggerTypes);
 
 protected:
+    //=========================================================================================================
+    /**
+     * Adds a trial. If all selected metrics support it, the trial is collected for the sliding window of the
+     * real-time connectivity worker. Otherwise it is appended to the connectivity settings.
+     *
+     * @param[in] matData        The trial data (channels x samples).
+     */
+    void appendTrial(const Eigen::MatrixXd& matData);
+
+    //=========================================================================================================
+    /**
+     * Hands the collected trials to the sliding window of the real-time connectivity worker, which publishes the
+     * networks of the window from its thread.
+     *
+     * @return True if the sliding window is in use, false otherwise.
+     */
+    bool publishSlidingWindow();
+
     //=========================================================================================================
     /**
      * Generate the node positions based on the current incoming data. Also take into account selected bad channels.
@@ -195,6 +213,14 @@ protected:
     void onNewConnectivityResultAvailable(const QList<CONNLIB::Network>& connectivityResults,
                                           const CONNLIB::ConnectivitySettings& connectivitySettings);
 
+    //=========================================================================================================
+    /**
+     * Slot called when the sliding window of the real-time connectivity worker has new networks.
+     *
+     * @param[in] connectivityResults        The networks of the window.
+     */
+    void onNewSlidingWindowResultAvailable(const QList<CONNLIB::Network>& connectivityResults);
+
     //=========================================================================================================
     /**
      * Slot called when the metric changed.
@@ -252,6 +278,7 @@ private:
     QElapsedTimer       m_timer;                /**< The timer to evaluate performance. */
 
     CONNLIB::ConnectivitySettings                                           m_connectivitySettings;         /**< The connectivity settings.*/
+    QList<Eigen::MatrixXd>                                                  m_lSlidingWindowTrials;         /**< The trials of the current update, waiting to be handed to the sliding window.*/
 
     QSharedPointer<UTILSLIB::CircularBuffer<CONNLIB::Network> >             m_pCircularBuffer;              /**< The circular buffer holding the connectivity estimates.*/
     QSharedPointer<RTPROCESSINGLIB::RtConnectivity>                                 m_pRtConnectivity;              /**< The real-time connectivity estimation object.*/
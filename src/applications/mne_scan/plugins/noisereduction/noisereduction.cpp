@@ -47,7 +47,8 @@
 #include <disp/viewers/compensatorview.h>
 #include <disp/viewers/spharasettingsview.h>
 
-#include <dsp/rt/rt_filter.h>
+#include <dsp/rt/rt_streaming_fir.h>
+#include <dsp/rt/rt_streaming_iir.h>
 #include <dsp/sphara.h>
 
 #include <utils/ioutils.h>
@@ -87,6 +88,7 @@ NoiseReduction::NoiseReduction()
 , m_bSpharaActive(false)
 , m_bProjActivated(false)
 , m_bFilterActivated(false)
+, m_bFilterLowLatency(false)
 , m_iMaxFilterLength(1)
 , m_iMaxFilterTapSize(-1)
 , m_sCurrentSystem("VectorView")
@@ -286,10 +288,14 @@ void NoiseReduction::initPluginControlWidgets()
         connect(pFilterSettingsView, &FilterSettingsView::filterActivationChanged,
                 this, &NoiseReduction::setFilterActive);
 
+        connect(pFilterSettingsView, &FilterSettingsView::filterLowLatencyChanged,
+                this, &NoiseReduction::setFilterLowLatency);
+
         pFilterSettingsView->setSamplingRate(m_pFiffInfo->sfreq);
         pFilterSettingsView->getFilterView()->setMaxAllowedFilterTaps(m_iMaxFilterTapSize);
 
         this->setFilterActive(pFilterSettingsView->getFilterActive());
+        this->setFilterLowLatency(pFilterSettingsView->getFilterLowLatency());
         this->setFilterChannelType(pFilterSettingsView->getFilterView()->getChannelType());
 
         // SPHARA settings
@@ -343,7 +349,8 @@ void NoiseReduction::run()
 
     // Init
     MatrixXd matData;
-    QScopedPointer<RTPROCESSINGLIB::FilterOverlapAdd> pRtFilter(new RTPROCESSINGLIB::FilterOverlapAdd());
+    RTPROCESSINGLIB::StreamingFirFilter rtFilter;
+    RTPROCESSINGLIB::StreamingIirFilter rtIirFilter;
 
     while(!isInterruptionRequested()) {
         // Get the current data
@@ -368,10 +375,20 @@ void NoiseReduction::run()
             }
 
             //Do temporal filtering here
-            if(m_bFilterActivated) {
-                matData = pRtFilter->calculate(matData,
-                                               m_filterKernel,
-                                               m_lFilterChannelList);
+            if(m_bFilterActivated && m_bFilterLowLatency) {
+                //Causal IIR filter without block latency
+                rtFilter.reset();
+                rtIirFilter.setSections(m_vecIirSections);
+                rtIirFilter.setPicks(m_lFilterChannelList);
+                rtIirFilter.process(matData, matData);
+            } else if(m_bFilterActivated) {
+                rtIirFilter.reset();
+                rtFilter.setFilterKernel(m_filterKernel);
+                rtFilter.setPicks(m_lFilterChannelList);
+                matData = rtFilter.process(matData);
+            } else {
+                rtFilter.reset();
+                rtIirFilter.reset();
             }
 
             //Do SPHARA here
@@ -561,6 +578,7 @@ void NoiseReduction::setFilter(const FilterKernel& filterData)
 {
     m_mutex.lock();
     m_filterKernel = filterData;
+    m_vecIirSections = RTPROCESSINGLIB::StreamingIirFilter::designFromKernel(m_filterKernel);
 
     m_iMaxFilterLength = 1;
     if(m_iMaxFilterLength < m_filterKernel.getFilterOrder()) {
@@ -578,6 +596,13 @@ void NoiseReduction::setFilterActive(bool state)
 
 //=============================================================================================================
 
+void NoiseReduction::setFilterLowLatency(bool state)
+{
+    m_bFilterLowLatency = state;
+}
+
+//=============================================================================================================
+
 void NoiseReduction::initSphara()
 {
     //Load SPHARA matrix
@@ -47,6 +47,7 @@
 #include <fiff/fiff_proj.h>
 
 #include <dsp/filterkernel.h>
+#include <dsp/iirfilter.h>
 
 #include <scShared/Plugins/abstractalgorithm.h>
 
@@ -206,6 +207,15 @@ protected:
      */
     void setFilterActive(bool state);
 
+    //=========================================================================================================
+    /**
+     * Filter latency mode changed
+     *
+     * @param[in] state    true to apply a causal Butterworth IIR filter with the band of the current filter
+     *                     instead of the zero-phase FIR filter.
+     */
+    void setFilterLowLatency(bool state);
+
     //=========================================================================================================
     /**
      * Init the SPHARA method.
@@ -225,6 +235,7 @@ private:
     bool                            m_bSpharaActive;                            /**< Flag whether thread is running.*/
     bool                            m_bProjActivated;                           /**< Projections activated. */
     bool                            m_bFilterActivated;                         /**< Projections activated. */
+    bool                            m_bFilterLowLatency;                        /**< Use the IIR instead of the FIR filter. */
 
     int                             m_iNBaseFctsFirst;                          /**< The number of grad/inner base functions to use for calculating the sphara opreator.*/
     int                             m_iNBaseFctsSecond;                         /**< The number of grad/outer base functions to use for calculating the sphara opreator.*/
@@ -235,6 +246,7 @@ private:
     QString                         m_sFilterChannelType;                       /**< Kind of channel which is to be filtered. */
 
     UTILSLIB::FilterKernel     m_filterKernel;                             /**< The currently active filter. */
+    QVector<UTILSLIB::IirBiquad>    m_vecIirSections;                           /**< Butterworth sections with the band of m_filterKernel. */
 
     Eigen::VectorXi                 m_vecIndicesFirstVV;                        /**< The indices of the channels to pick for the first SPHARA oerpator in case of a VectorView system.*/
     Eigen::VectorXi                 m_vecIndicesSecondVV;                       /**< The indices of the channels to pick for the second SPHARA oerpator in case of a VectorView system.*/
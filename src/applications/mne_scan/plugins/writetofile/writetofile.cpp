@@ -410,6 +410,7 @@ void WriteToFile::toggleRecordingFile()
 
         fiff_int_t first = 0;
         m_pOutfid->write_int(FIFF_FIRST_SAMPLE, &first);
+        m_pOutfid->start_write_behind();
         m_mutex.unlock();
 
         m_bWriteToFile = true;
@@ -461,6 +462,7 @@ void WriteToFile::splitRecordingFile()
 
     fiff_int_t first = 0;
     m_pOutfid->write_int(FIFF_FIRST_SAMPLE, &first);
+    m_pOutfid->start_write_behind();
 
     m_lFileNames.append(QFileInfo(m_qFileOut).fileName());
 }
@@ -486,6 +488,9 @@ void WriteToFile::clipRecording(bool bChecked)
 
     QMutexLocker locker(&m_mutex);
 
+    // The queued buffers must be in the file before it is copied
+    m_pOutfid->finish_write_behind();
+
     m_qFileOut.close();
     m_FileSharer.copyRealtimeFile(m_qFileOut.fileName());
     if (!m_qFileOut.open(QIODevice::ReadWrite)) {
@@ -494,6 +499,7 @@ void WriteToFile::clipRecording(bool bChecked)
     }
 
     m_pOutfid->skipRawData(m_qFileOut.bytesAvailable());
+    m_pOutfid->start_write_behind();
 }
 
 //=============================================================================================================
@@ -41,6 +41,7 @@
 #include <conn/connectivitysettings.h>
 #include <conn/network/network.h>
 #include <conn/metrics/abstractmetric.h>
+#include <conn/metrics/multimetric.h>
 
 #include <fiff/fiff_raw_data.h>
 
@@ -277,6 +278,35 @@ int main(int argc, char *argv[])
                         m_iCurrentIteration++;
                     }
                 }
+
+                // Compare the separate spectral metrics against the shared multi-metric pass
+                m_sCurrentDir = QCoreApplication::applicationDirPath() + QString("/connectivity_performance_%1_%2_%3/%4/%5_%6_%7").arg(QHostInfo::localHostName()).arg(AbstractMetric::m_iNumberBinAmount).arg(iStorageModeActive).arg("MULTI").arg(QString::number(lNumberChannels.at(k))).arg(QString::number(lNumberSamples.at(j))).arg(QString::number(lNumberTrials.at(l)));
+                QDir().mkpath(m_sCurrentDir);
+
+                QStringList lSpectralMethods = MultiMetric::supportedMethods();
+                qint64 iTimeSeparate = 0;
+                qint64 iTimeShared = 0;
+
+                for(int u = 0; u < iNumberRepeats; ++u) {
+                    timer.restart();
+                    for(const QString& sMethod : lSpectralMethods) {
+                        connectivitySettings.clearIntermediateData();
+                        connectivitySettings.setConnectivityMethods(QStringList() << sMethod);
+                        connectivityObj.calculate(connectivitySettings);
+                    }
+                    iTimeSeparate += timer.elapsed();
+
+                    timer.restart();
+                    connectivitySettings.clearIntermediateData();
+                    MultiMetric::calculate(connectivitySettings, lSpectralMethods);
+                    iTimeShared += timer.elapsed();
+                }
+
+                qWarning() << "separate" << iTimeSeparate / iNumberRepeats;
+                qWarning() << "shared" << iTimeShared / iNumberRepeats;
+                qWarning() << "speedup" << double(iTimeSeparate) / double(qMax(iTimeShared, qint64(1)));
+
+                printf("Spectral metrics for %d trials, %d channels, %d samples: separate %lld ms, shared %lld ms, speedup %.2f\n", connectivitySettings.size(), lNumberChannels.at(k), lNumberSamples.at(j), iTimeSeparate / iNumberRepeats, iTimeShared / iNumberRepeats, double(iTimeSeparate) / double(qMax(iTimeShared, qint64(1))));
             }
         }
     }
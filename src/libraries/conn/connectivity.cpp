@@ -51,6 +51,7 @@
 #include "metrics/weightedphaselagindex.h"
 #include "metrics/unbiasedsquaredphaselagindex.h"
 #include "metrics/debiasedsquaredweightedphaselagindex.h"
+#include "metrics/multimetric.h"
 
 //=============================================================================================================
 // QT INCLUDES
@@ -58,6 +59,7 @@
 
 #include <QDebug>
 #include <QFutureSynchronizer>
+#include <QMap>
 #include <QtConcurrent>
 
 //=============================================================================================================
@@ -91,11 +93,31 @@ QList<Network> Connectivity::calculate(ConnectivitySettings& connectivitySetting
     QElapsedTimer timer;
     timer.start();
 
-    if(lMethods.contains("WPLI")) {
+    // Compute all requested spectral metrics from one shared spectral pass. The storage mode keeps the
+    // intermediate data of each metric and therefore uses the per-metric implementations.
+    QMap<QString, Network> mapShared;
+    QStringList lShared;
+    for(const QString& sMethod : MultiMetric::supportedMethods()) {
+        if(lMethods.contains(sMethod)) {
+            lShared.append(sMethod);
+        }
+    }
+
+    if(lShared.size() > 1 && !AbstractMetric::m_bStorageModeIsActive) {
+        for(const Network& network : MultiMetric::calculate(connectivitySettings, lShared)) {
+            mapShared.insert(network.getConnectivityMethod(), network);
+        }
+    }
+
+    if(mapShared.contains("WPLI")) {
+        results.append(mapShared.value("WPLI"));
+    } else if(lMethods.contains("WPLI")) {
         results.append(WeightedPhaseLagIndex::calculate(connectivitySettings));
     }
 
-    if(lMethods.contains("USPLI")) {
+    if(mapShared.contains("USPLI")) {
+        results.append(mapShared.value("USPLI"));
+    } else if(lMethods.contains("USPLI")) {
         results.append(UnbiasedSquaredPhaseLagIndex::calculate(connectivitySettings));
     }
 
@@ -107,23 +129,33 @@ QList<Network> Connectivity::calculate(ConnectivitySettings& connectivitySetting
         results.append(CrossCorrelation::calculate(connectivitySettings));
     }
 
-    if(lMethods.contains("PLI")) {
+    if(mapShared.contains("PLI")) {
+        results.append(mapShared.value("PLI"));
+    } else if(lMethods.contains("PLI")) {
         results.append(PhaseLagIndex::calculate(connectivitySettings));
     }
 
-    if(lMethods.contains("COH")) {
+    if(mapShared.contains("COH")) {
+        results.append(mapShared.value("COH"));
+    } else if(lMethods.contains("COH")) {
         results.append(Coherence::calculate(connectivitySettings));
     }
 
-    if(lMethods.contains("IMAGCOH")) {
+    if(mapShared.contains("IMAGCOH")) {
+        results.append(mapShared.value("IMAGCOH"));
+    } else if(lMethods.contains("IMAGCOH")) {
         results.append(ImagCoherence::calculate(connectivitySettings));
     }
 
-    if(lMethods.contains("PLV")) {
+    if(mapShared.contains("PLV")) {
+        results.append(mapShared.value("PLV"));
+    } else if(lMethods.contains("PLV")) {
         results.append(PhaseLockingValue::calculate(connectivitySettings));
     }
 
-    if(lMethods.contains("DSWPLI")) {
+    if(mapShared.contains("DSWPLI")) {
+        results.append(mapShared.value("DSWPLI"));
+    } else if(lMethods.contains("DSWPLI")) {
         results.append(DebiasedSquaredWeightedPhaseLagIndex::calculate(connectivitySettings));
     }
 
@@ -42,15 +42,20 @@
 // QT INCLUDES
 //=============================================================================================================
 
+#include <QtConcurrent>
+
 //=============================================================================================================
 // EIGEN INCLUDES
 //=============================================================================================================
 
+#include <Eigen/Dense>
+
 //=============================================================================================================
 // USED NAMESPACES
 //=============================================================================================================
 
 using namespace CONNLIB;
+using namespace Eigen;
 
 //=============================================================================================================
 // DEFINE GLOBAL METHODS
@@ -68,3 +73,67 @@ AbstractMetric::AbstractMetric()
 {
 }
 
+//=============================================================================================================
+
+void AbstractMetric::computePairCsd(const QVector<MatrixXcd>& vecTapSpectra,
+                                    int iNFreqs,
+                                    int iNfft,
+                                    const QPair<MatrixXd, VectorXd>& tapers,
+                                    QVector<QPair<int,MatrixXcd> >& vecPairCsd)
+{
+    vecPairCsd.clear();
+
+    const int iNRows = vecTapSpectra.size();
+
+    if(iNRows == 0) {
+        return;
+    }
+
+    const int iNTapers = vecTapSpectra.first().rows();
+    const int iNBins = m_iNumberBinAmount;
+    const double denomCSD = sqrt(tapers.second.cwiseAbs2().sum()) * sqrt(tapers.second.cwiseAbs2().sum()) / 2.0;
+    const bool bNfftEven = iNfft % 2 == 0;
+
+    vecPairCsd.reserve(iNRows);
+    for(int i = 0; i < iNRows; ++i) {
+        vecPairCsd.append(QPair<int,MatrixXcd>(i, MatrixXcd(iNRows, iNBins)));
+    }
+
+    // Every bin writes its own column only. Detach once here before writing from several threads.
+    QPair<int,MatrixXcd>* pPairCsd = vecPairCsd.data();
+
+    QVector<int> vecBins(iNBins);
+    for(int k = 0; k < iNBins; ++k) {
+        vecBins[k] = k;
+    }
+
+    std::function<void(int&)> computeLambda = [&](int& iBin) {
+        // Frequency-major layout: channels x tapers for this bin
+        MatrixXcd matSpectra(iNRows, iNTapers);
+        for(int i = 0; i < iNRows; ++i) {
+            matSpectra.row(i) = vecTapSpectra.at(i).col(m_iNumberBinStart + iBin).transpose();
+        }
+
+        // CSD of all pairs (average over tapers if necessary). Only the upper triangle is computed.
+        MatrixXcd matCsd = MatrixXcd::Zero(iNRows, iNRows);
+        matCsd.selfadjointView<Upper>().rankUpdate(matSpectra);
+
+        // Divide first and last element by 2 due to half spectrum
+        double dDenom = denomCSD;
+        if(m_iNumberBinStart == 0 && iBin == 0) {
+            dDenom *= 2.0;
+        }
+        if(bNfftEven && m_iNumberBinStart + m_iNumberBinAmount >= iNFreqs && iBin == iNBins - 1) {
+            dDenom *= 2.0;
+        }
+
+        for(int i = 0; i < iNRows; ++i) {
+            pPairCsd[i].second.col(iBin).tail(iNRows - i) = matCsd.row(i).tail(iNRows - i).transpose() / dDenom;
+            pPairCsd[i].second.col(iBin).head(i) = matCsd.col(i).head(i).conjugate() / dDenom;
+        }
+    };
+
+    QFuture<void> result = QtConcurrent::map(vecBins,
+                                             computeLambda);
+    result.waitForFinished();
+}
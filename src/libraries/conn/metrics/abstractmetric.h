@@ -45,6 +45,7 @@
 // QT INCLUDES
 //=============================================================================================================
 
+#include <QPair>
 #include <QSharedPointer>
 #include <QVector>
 
@@ -92,6 +93,23 @@ public:
     static int      m_iNumberBinAmount;
 
 protected:
+    //=========================================================================================================
+    /**
+     * Computes the cross spectral densities of all channel pairs for the current frequency bins. The tapered
+     * spectra are regrouped per frequency bin into a channels x tapers matrix X, so that the CSD of all pairs
+     * at that bin is a single Hermitian rank update X * X^H. The bins are processed in parallel.
+     *
+     * @param[in] vecTapSpectra     The tapered spectra, one tapers x frequencies matrix per channel.
+     * @param[in] iNFreqs           The number of frequencies of the half spectrum.
+     * @param[in] iNfft             The FFT length.
+     * @param[in] tapers            The tapers and their weights.
+     * @param[out] vecPairCsd       The CSD per channel i. Row j holds the CSD of the pair (i,j).
+     */
+    static void computePairCsd(const QVector<Eigen::MatrixXcd>& vecTapSpectra,
+                               int iNFreqs,
+                               int iNfft,
+                               const QPair<Eigen::MatrixXd, Eigen::VectorXd>& tapers,
+                               QVector<QPair<int,Eigen::MatrixXcd> >& vecPairCsd);
 };
 
 //=============================================================================================================
@@ -46,6 +46,7 @@
 #include "../network/network.h"
 
 #include <math/spectral.h>
+#include <math/fft_plan_cache.h>
 
 //=============================================================================================================
 // QT INCLUDES
@@ -251,8 +252,7 @@ void Coherency::compute(ConnectivitySettings::IntermediateTrialData& inputData,
         bNfftEven = true;
     }
 
-    FFT<double> fft;
-    fft.SetFlag(fft.HalfSpectrum);
+    FFT<double>& fft = FftPlanCache::get(true);
 
     double denomPSD = tapers.second.cwiseAbs2().sum() / 2.0;
 
@@ -319,28 +319,11 @@ void Coherency::compute(ConnectivitySettings::IntermediateTrialData& inputData,
     if(inputData.vecPairCsd.size() != iNRows) {
         inputData.vecPairCsd.clear();
 
-        //MatrixXcd matCsd = MatrixXcd(iNRows, iNFreqs);
-        MatrixXcd matCsd = MatrixXcd(iNRows, m_iNumberBinAmount);
-
-        double denomCSD = sqrt(tapers.second.cwiseAbs2().sum()) * sqrt(tapers.second.cwiseAbs2().sum()) / 2.0;
-
-        for (i = 0; i < iNRows; ++i) {
-            for (j = i; j < iNRows; ++j) {
-                // Compute CSD (average over tapers if necessary)
-                matCsd.row(j) = inputData.vecTapSpectra.at(i).block(0,m_iNumberBinStart,inputData.vecTapSpectra.at(i).rows(),m_iNumberBinAmount).cwiseProduct(inputData.vecTapSpectra.at(j).block(0,m_iNumberBinStart,inputData.vecTapSpectra.at(j).rows(),m_iNumberBinAmount).conjugate()).colwise().sum() / denomCSD;
-
-                // Divide first and last element by 2 due to half spectrum
-                if(m_iNumberBinStart == 0) {
-                    matCsd.row(j)(0) /= 2.0;
-                }
-
-                if(bNfftEven && m_iNumberBinStart + m_iNumberBinAmount >= iNFreqs) {
-                    matCsd.row(j).tail(1) /= 2.0;
-                }
-            }
-
-            inputData.vecPairCsd.append(QPair<int,MatrixXcd>(i,matCsd));
-        }
+        computePairCsd(inputData.vecTapSpectra,
+                       iNFreqs,
+                       iNfft,
+                       tapers,
+                       inputData.vecPairCsd);
 
         mutex.lock();
 
@@ -42,6 +42,7 @@
 #include "../network/network.h"
 
 #include <math/spectral.h>
+#include <math/fft_plan_cache.h>
 
 //=============================================================================================================
 // QT INCLUDES
@@ -190,8 +191,7 @@ void CrossCorrelation::compute(ConnectivitySettings::IntermediateTrialData& inpu
     RowVectorXd vecInputFFT, rowData;
     RowVectorXcd vecResultFreq;
 
-    FFT<double> fft;
-    fft.SetFlag(fft.HalfSpectrum);
+    FFT<double>& fft = FftPlanCache::get(true);
 
     int i, j;
     int iNRows = inputData.matData.rows();
@@ -0,0 +1,457 @@
+//=============================================================================================================
+/**
+ * @file     multimetric.cpp
+ * @author   Christoph Dinh <christoph.dinh@mne-cpp.org>
+ * @since    2.1.0
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, Christoph Dinh. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ *
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "multimetric.h"
+#include "../network/networknode.h"
+#include "../network/network.h"
+#include "../network/networktensor.h"
+
+#include <math/spectral.h>
+#include <math/fft_plan_cache.h>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QDebug>
+#include <QtConcurrent>
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <unsupported/Eigen/FFT>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace CONNLIB;
+using namespace Eigen;
+using namespace UTILSLIB;
+
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace
+{
+
+/** Upper bound for the spectra of the trials held at the same time. */
+const qint64 SPECTRA_BUDGET_BYTES = 256 * 1024 * 1024;
+
+}
+
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+MultiMetric::MultiMetric()
+: AbstractMetric()
+{
+}
+
+//=============================================================================================================
+
+QStringList MultiMetric::supportedMethods()
+{
+    return QStringList() << "COH" << "IMAGCOH" << "PLI" << "WPLI" << "USPLI" << "DSWPLI" << "PLV";
+}
+
+//=============================================================================================================
+
+QList<Network> MultiMetric::calculate(ConnectivitySettings& connectivitySettings,
+                                      const QStringList& lMethods)
+{
+    QList<Network> networks;
+
+    QStringList lSupported = supportedMethods();
+    QStringList lComputed;
+    for(const QString& sMethod : lMethods) {
+        if(lSupported.contains(sMethod) && !lComputed.contains(sMethod)) {
+            lComputed.append(sMethod);
+        }
+    }
+
+    if(lComputed.isEmpty()) {
+        return networks;
+    }
+
+    if(connectivitySettings.isEmpty()) {
+        qWarning() << "MultiMetric::calculate - Input data is empty";
+        return networks;
+    }
+
+    // The sums the requested metrics need
+    const bool bCsd = lComputed.contains("COH") || lComputed.contains("IMAGCOH")
+                      || lComputed.contains("WPLI") || lComputed.contains("DSWPLI");
+    const bool bPsd = lComputed.contains("COH") || lComputed.contains("IMAGCOH");
+    const bool bImagSign = lComputed.contains("PLI") || lComputed.contains("USPLI");
+    const bool bImagAbs = lComputed.contains("WPLI") || lComputed.contains("DSWPLI");
+    const bool bImagSqrd = lComputed.contains("DSWPLI");
+    const bool bCsdNormalized = lComputed.contains("PLV");
+
+    #ifdef EIGEN_FFTW_DEFAULT
+        fftw_make_planner_thread_safe();
+    #endif
+
+    int iNTrials = connectivitySettings.size();
+    int iNRows = connectivitySettings.at(0).matData.rows();
+    int iSignalLength = connectivitySettings.at(0).matData.cols();
+    int iNfft = connectivitySettings.getFFTSize();
+    int iNFreqs = int(floor(iNfft / 2.0)) + 1;
+
+    // Generate tapers
+    QPair<MatrixXd, VectorXd> tapers = Spectral::generateTapers(iSignalLength, connectivitySettings.getWindowType());
+
+    // Check if start and bin amount need to be reset to full spectrum
+    if(m_iNumberBinStart == -1 ||
+       m_iNumberBinAmount == -1 ||
+       m_iNumberBinStart > iNFreqs ||
+       m_iNumberBinAmount > iNFreqs ||
+       m_iNumberBinAmount + m_iNumberBinStart > iNFreqs) {
+        qDebug() << "MultiMetric::calculate - Resetting to full spectrum";
+        AbstractMetric::m_iNumberBinStart = 0;
+        AbstractMetric::m_iNumberBinAmount = iNFreqs;
+    }
+
+    const int iNBins = m_iNumberBinAmount;
+    const bool bHalfFirst = m_iNumberBinStart == 0;
+    const bool bHalfLast = iNfft % 2 == 0 && m_iNumberBinStart + m_iNumberBinAmount >= iNFreqs;
+    const double denomPSD = tapers.second.cwiseAbs2().sum() / 2.0;
+    const double denomCSD = sqrt(tapers.second.cwiseAbs2().sum()) * sqrt(tapers.second.cwiseAbs2().sum()) / 2.0;
+
+    // Sums for the pairs of each channel
+    QVector<PairSums> vecPairSums = createPairSums(iNRows,
+                                                   iNBins,
+                                                   bCsd,
+                                                   bCsdNormalized,
+                                                   bImagSign,
+                                                   bImagAbs,
+                                                   bImagSqrd);
+    MatrixXd matPsdSum = MatrixXd::Zero(iNRows, iNBins);
+
+    // Process the trials in blocks whose spectra fit the budget
+    const qint64 iBytesPerTrial = qint64(iNRows) * iNBins * tapers.first.rows() * qint64(sizeof(std::complex<double>));
+    const int iBlockSize = int(qBound(qint64(1), SPECTRA_BUDGET_BYTES / qMax(qint64(1), iBytesPerTrial), qint64(iNTrials)));
+
+    std::function<void(TrialSpectra&)> computeSpectraLambda = [&](TrialSpectra& spectra) {
+        computeSpectra(connectivitySettings.at(spectra.iTrial).matData,
+                       tapers,
+                       iNfft,
+                       spectra);
+    };
+
+    for(int iFirst = 0; iFirst < iNTrials; iFirst += iBlockSize) {
+        QVector<TrialSpectra> vecSpectra(qMin(iBlockSize, iNTrials - iFirst));
+        for(int t = 0; t < vecSpectra.size(); ++t) {
+            vecSpectra[t].iTrial = iFirst + t;
+        }
+
+        // Tapered spectra, once per trial
+        QFuture<void> resultSpectra = QtConcurrent::map(vecSpectra,
+                                                        computeSpectraLambda);
+        resultSpectra.waitForFinished();
+
+        if(bPsd) {
+            for(const TrialSpectra& spectra : vecSpectra) {
+                accumulatePsd(matPsdSum,
+                              spectra,
+                              denomPSD,
+                              bHalfFirst,
+                              bHalfLast);
+            }
+        }
+
+        // One pass over the channel pairs for all metrics
+        std::function<void(PairSums&)> accumulateLambda = [&](PairSums& sums) {
+            accumulatePairs(sums,
+                            vecSpectra,
+                            denomCSD,
+                            bHalfFirst,
+                            bHalfLast);
+        };
+
+        QFuture<void> resultPairs = QtConcurrent::map(vecPairSums,
+                                                      accumulateLambda);
+        resultPairs.waitForFinished();
+    }
+
+    return createNetworks(lComputed,
+                          vecPairSums,
+                          matPsdSum,
+                          iNTrials,
+                          iNFreqs,
+                          connectivitySettings);
+}
+
+//=============================================================================================================
+
+void MultiMetric::computeSpectra(const MatrixXd& matData,
+                                 const QPair<MatrixXd, VectorXd>& tapers,
+                                 int iNfft,
+                                 TrialSpectra& spectra)
+{
+    const int iNRows = matData.rows();
+    const int iNTapers = tapers.first.rows();
+
+    spectra.vecTapers = QVector<MatrixXcd>(iNTapers, MatrixXcd(iNRows, m_iNumberBinAmount));
+
+    FFT<double>& fft = FftPlanCache::get(true);
+
+    RowVectorXd vecInputFFT, rowData;
+    RowVectorXcd vecTmpFreq;
+
+    for(int i = 0; i < iNRows; ++i) {
+        // Substract mean
+        rowData.array() = matData.row(i).array() - matData.row(i).mean();
+
+        for(int j = 0; j < iNTapers; ++j) {
+            // Zero padd if necessary. The zero padding in Eigen's FFT is only working for column vectors.
+            if (rowData.cols() < iNfft) {
+                vecInputFFT.setZero(iNfft);
+                vecInputFFT.block(0,0,1,rowData.cols()) = rowData.cwiseProduct(tapers.first.row(j));
+            } else {
+                vecInputFFT = rowData.cwiseProduct(tapers.first.row(j));
+            }
+
+            // FFT for freq domain returning the half spectrum and multiply taper weights
+            fft.fwd(vecTmpFreq, vecInputFFT, iNfft);
+            spectra.vecTapers[j].row(i) = vecTmpFreq.segment(m_iNumberBinStart, m_iNumberBinAmount) * tapers.second(j);
+        }
+    }
+}
+
+//=============================================================================================================
+
+void MultiMetric::accumulatePairs(PairSums& sums,
+                                  const QVector<TrialSpectra>& vecSpectra,
+                                  double dDenomCSD,
+                                  bool bHalfFirst,
+                                  bool bHalfLast,
+                                  double dSign)
+{
+    if(vecSpectra.isEmpty()) {
+        return;
+    }
+
+    const int i = sums.iRow;
+    const int iNPairs = vecSpectra.first().vecTapers.first().rows() - i;
+    const int iNBins = vecSpectra.first().vecTapers.first().cols();
+
+    MatrixXcd matCsd(iNPairs, iNBins);
+
+    for(const TrialSpectra& spectra : vecSpectra) {
+        // CSD of channel i with all channels j >= i (average over tapers if necessary)
+        matCsd.setZero();
+        for(const MatrixXcd& matTapSpectra : spectra.vecTapers) {
+            matCsd.array() += matTapSpectra.bottomRows(iNPairs).conjugate().array().rowwise()
+                              * matTapSpectra.row(i).array();
+        }
+        matCsd /= dDenomCSD;
+
+        // Divide first and last element by 2 due to half spectrum
+        if(bHalfFirst) {
+            matCsd.col(0) /= 2.0;
+        }
+        if(bHalfLast) {
+            matCsd.col(iNBins - 1) /= 2.0;
+        }
+
+        if(sums.matCsd.size() > 0) {
+            sums.matCsd += dSign * matCsd;
+        }
+        if(sums.matCsdNormalized.size() > 0) {
+            sums.matCsdNormalized += dSign * matCsd.cwiseQuotient(matCsd.cwiseAbs());
+        }
+        if(sums.matCsdImagSign.size() > 0) {
+            sums.matCsdImagSign += dSign * matCsd.imag().cwiseSign();
+        }
+        if(sums.matCsdImagAbs.size() > 0) {
+            sums.matCsdImagAbs += dSign * matCsd.imag().cwiseAbs();
+        }
+        if(sums.matCsdImagSqrd.size() > 0) {
+            sums.matCsdImagSqrd += dSign * matCsd.imag().array().square().matrix();
+        }
+    }
+}
+
+//=============================================================================================================
+
+QVector<MultiMetric::PairSums> MultiMetric::createPairSums(int iNRows,
+                                                           int iNBins,
+                                                           bool bCsd,
+                                                           bool bCsdNormalized,
+                                                           bool bImagSign,
+                                                           bool bImagAbs,
+                                                           bool bImagSqrd)
+{
+    QVector<PairSums> vecPairSums(iNRows);
+
+    for(int i = 0; i < iNRows; ++i) {
+        PairSums& sums = vecPairSums[i];
+        sums.iRow = i;
+        if(bCsd) {
+            sums.matCsd = MatrixXcd::Zero(iNRows - i, iNBins);
+        }
+        if(bCsdNormalized) {
+            sums.matCsdNormalized = MatrixXcd::Zero(iNRows - i, iNBins);
+        }
+        if(bImagSign) {
+            sums.matCsdImagSign = MatrixXd::Zero(iNRows - i, iNBins);
+        }
+        if(bImagAbs) {
+            sums.matCsdImagAbs = MatrixXd::Zero(iNRows - i, iNBins);
+        }
+        if(bImagSqrd) {
+            sums.matCsdImagSqrd = MatrixXd::Zero(iNRows - i, iNBins);
+        }
+    }
+
+    return vecPairSums;
+}
+
+//=============================================================================================================
+
+void MultiMetric::accumulatePsd(MatrixXd& matPsdSum,
+                                const TrialSpectra& spectra,
+                                double dDenomPSD,
+                                bool bHalfFirst,
+                                bool bHalfLast,
+                                double dSign)
+{
+    if(spectra.vecTapers.isEmpty()) {
+        return;
+    }
+
+    const int iNBins = spectra.vecTapers.first().cols();
+
+    MatrixXd matPsd = MatrixXd::Zero(spectra.vecTapers.first().rows(), iNBins);
+    for(const MatrixXcd& matTapSpectra : spectra.vecTapers) {
+        matPsd += matTapSpectra.cwiseAbs2();
+    }
+    matPsd /= dDenomPSD;
+
+    // Divide first and last element by 2 due to half spectrum
+    if(bHalfFirst) {
+        matPsd.col(0) /= 2.0;
+    }
+    if(bHalfLast) {
+        matPsd.col(iNBins - 1) /= 2.0;
+    }
+
+    matPsdSum += dSign * matPsd;
+}
+
+//=============================================================================================================
+
+QList<Network> MultiMetric::createNetworks(const QStringList& lMethods,
+                                          const QVector<PairSums>& vecPairSums,
+                                          const MatrixXd& matPsdSum,
+                                          int iNTrials,
+                                          int iNFreqs,
+                                          const ConnectivitySettings& connectivitySettings)
+{
+    QList<Network> networks;
+
+    const double dNTrials = double(iNTrials);
+    const int iNRows = vecPairSums.size();
+    const int iNBins = matPsdSum.cols();
+    RowVectorXf rowVert = RowVectorXf::Zero(3);
+
+    for(const QString& sMethod : lMethods) {
+        Network finalNetwork(sMethod);
+        finalNetwork.setSamplingFrequency(connectivitySettings.getSamplingFrequency());
+
+        for(int i = 0; i < iNRows; ++i) {
+            rowVert = RowVectorXf::Zero(3);
+
+            if(connectivitySettings.getNodePositions().rows() != 0 && i < connectivitySettings.getNodePositions().rows()) {
+                rowVert(0) = connectivitySettings.getNodePositions().row(i)(0);
+                rowVert(1) = connectivitySettings.getNodePositions().row(i)(1);
+                rowVert(2) = connectivitySettings.getNodePositions().row(i)(2);
+            }
+
+            finalNetwork.append(NetworkNode::SPtr(new NetworkNode(i, rowVert)));
+        }
+
+        // Pass information about the FFT length. Use iNFreqs because we only use the half spectrum
+        finalNetwork.setFFTSize(iNFreqs);
+        finalNetwork.setUsedFreqBins(iNBins);
+
+        // Store the edges in compact form
+        NetworkTensor tensor(iNRows, iNBins);
+
+        for(int i = 0; i < iNRows; ++i) {
+            const PairSums& sums = vecPairSums.at(i);
+            MatrixXd matValue;
+
+            if(sMethod == "COH" || sMethod == "IMAGCOH") {
+                // Average. Note that the number of trials cancel each other out.
+                MatrixXd matPsdProduct = matPsdSum.bottomRows(iNRows - i).array().rowwise() * matPsdSum.row(i).array();
+                MatrixXcd matCohy = sums.matCsd.cwiseQuotient(matPsdProduct.cwiseSqrt());
+                matValue = sMethod == "COH" ? MatrixXd(matCohy.cwiseAbs()) : MatrixXd(matCohy.imag());
+            } else if(sMethod == "PLI") {
+                matValue = sums.matCsdImagSign.cwiseAbs() / dNTrials;
+            } else if(sMethod == "USPLI") {
+                matValue = sums.matCsdImagSign.cwiseAbs() / dNTrials;
+                matValue = (dNTrials * matValue.array().square() - 1.0) / (dNTrials - 1.0);
+            } else if(sMethod == "WPLI") {
+                MatrixXd matDenom = (sums.matCsdImagAbs.array() == 0.).select(INFINITY, sums.matCsdImagAbs);
+                matValue = sums.matCsd.imag().cwiseAbs().cwiseQuotient(matDenom);
+            } else if(sMethod == "DSWPLI") {
+                MatrixXd matNom = sums.matCsd.imag().array().square();
+                matNom -= sums.matCsdImagSqrd;
+                MatrixXd matDenom = sums.matCsdImagAbs.array().square();
+                matDenom -= sums.matCsdImagSqrd;
+                matDenom = (matDenom.array() == 0.).select(INFINITY, matDenom);
+                matValue = matNom.cwiseQuotient(matDenom);
+            } else if(sMethod == "PLV") {
+                matValue = sums.matCsdNormalized.cwiseAbs() / dNTrials;
+            }
+
+            // Row 0 is the connection of node i with itself, which is not stored
+            tensor.setNodeWeights(i, matValue.bottomRows(iNRows - 1 - i));
+        }
+
+        finalNetwork.setTensor(tensor);
+
+        networks.append(finalNetwork);
+    }
+
+    return networks;
+}
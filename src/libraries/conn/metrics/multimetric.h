@@ -0,0 +1,235 @@
+//=============================================================================================================
+/**
+ * @file     multimetric.h
+ * @author   Christoph Dinh <christoph.dinh@mne-cpp.org>
+ * @since    2.1.0
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, Christoph Dinh. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief     MultiMetric class declaration.
+ *
+ */
+
+#ifndef MULTIMETRIC_H
+#define MULTIMETRIC_H
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../conn_global.h"
+#include "abstractmetric.h"
+#include "../connectivitysettings.h"
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QStringList>
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+//=============================================================================================================
+// DEFINE NAMESPACE CONNLIB
+//=============================================================================================================
+
+namespace CONNLIB {
+
+//=============================================================================================================
+// CONNLIB FORWARD DECLARATIONS
+//=============================================================================================================
+
+class Network;
+
+//=============================================================================================================
+/**
+ * Computes several spectral connectivity metrics with one spectral pass. The tapered spectra of each trial
+ * are computed once, and a single pass over the channel pairs accumulates only the sums the requested
+ * metrics need: the CSD, the PSD, the sign, absolute value and square of the imaginary CSD, and the
+ * normalized CSD. Nothing is kept per trial, independent of AbstractMetric::m_bStorageModeIsActive.
+ *
+ * The results equal the ones of the single metric classes up to the summation order.
+ *
+ * @brief Computes COH, IMAGCOH, PLI, WPLI, USPLI, DSWPLI and PLV in one spectral pass
+ */
+class CONNSHARED_EXPORT MultiMetric : public AbstractMetric
+{
+
+public:
+    typedef QSharedPointer<MultiMetric> SPtr;            /**< Shared pointer type for MultiMetric. */
+    typedef QSharedPointer<const MultiMetric> ConstSPtr; /**< Const shared pointer type for MultiMetric. */
+
+    //=========================================================================================================
+    /**
+     * Constructs a MultiMetric object.
+     */
+    explicit MultiMetric();
+
+    //=========================================================================================================
+    /**
+     * Returns the methods MultiMetric can compute.
+     *
+     * @return The method names, as used by ConnectivitySettings::setConnectivityMethods.
+     */
+    static QStringList supportedMethods();
+
+    //=========================================================================================================
+    /**
+     * Calculates the requested spectral metrics between the rows of the data matrices.
+     *
+     * @param[in] connectivitySettings   The input data and parameters.
+     * @param[in] lMethods               The methods to compute. Methods not in supportedMethods() are skipped.
+     *
+     * @return                   One network per computed method, in the order of lMethods.
+     */
+    static QList<Network> calculate(ConnectivitySettings& connectivitySettings,
+                                    const QStringList& lMethods);
+
+protected:
+    /** The tapered spectra of one trial. */
+    struct TrialSpectra {
+        int                         iTrial;         /**< The trial index. */
+        QVector<Eigen::MatrixXcd>   vecTapers;      /**< Per taper: weighted spectra (rows x used bins). */
+    };
+
+    /** The sums for the channel pairs (i, j >= i) of one channel i. Row k belongs to channel j = i + k. */
+    struct PairSums {
+        int                 iRow;                   /**< The channel i. */
+        Eigen::MatrixXcd    matCsd;                 /**< Sum of the CSD. */
+        Eigen::MatrixXcd    matCsdNormalized;       /**< Sum of the CSD divided by its magnitude. */
+        Eigen::MatrixXd     matCsdImagSign;         /**< Sum of the sign of the imaginary CSD. */
+        Eigen::MatrixXd     matCsdImagAbs;          /**< Sum of the magnitude of the imaginary CSD. */
+        Eigen::MatrixXd     matCsdImagSqrd;         /**< Sum of the squared imaginary CSD. */
+    };
+
+    //=========================================================================================================
+    /**
+     * Computes the tapered spectra of one trial. This function gets called in parallel.
+     *
+     * @param[in] matData        The trial data (rows x samples).
+     * @param[in] tapers         The taper information.
+     * @param[in] iNfft          The FFT length.
+     * @param[out] spectra       The weighted spectra, restricted to the used bins.
+     */
+    static void computeSpectra(const Eigen::MatrixXd& matData,
+                               const QPair<Eigen::MatrixXd, Eigen::VectorXd>& tapers,
+                               int iNfft,
+                               TrialSpectra& spectra);
+
+    //=========================================================================================================
+    /**
+     * Adds the CSD statistics of the pairs of one channel for a block of trials. This function gets called
+     * in parallel, one channel per call, so that every sum has a single writer.
+     *
+     * @param[in, out] sums      The sums of the channel.
+     * @param[in] vecSpectra     The spectra of the trials.
+     * @param[in] dDenomCSD      The CSD normalization.
+     * @param[in] bHalfFirst     Whether to halve the first bin.
+     * @param[in] bHalfLast      Whether to halve the last bin.
+     * @param[in] dSign          1 to add the trials, -1 to remove trials added before.
+     */
+    static void accumulatePairs(PairSums& sums,
+                                const QVector<TrialSpectra>& vecSpectra,
+                                double dDenomCSD,
+                                bool bHalfFirst,
+                                bool bHalfLast,
+                                double dSign = 1.0);
+
+    //=========================================================================================================
+    /**
+     * Creates zero sums for all channels. Only the sums whose flag is set are allocated.
+     *
+     * @param[in] iNRows             The number of channels.
+     * @param[in] iNBins             The number of used frequency bins.
+     * @param[in] bCsd               Whether to allocate the CSD sum.
+     * @param[in] bCsdNormalized     Whether to allocate the normalized CSD sum.
+     * @param[in] bImagSign          Whether to allocate the imaginary sign sum.
+     * @param[in] bImagAbs           Whether to allocate the imaginary magnitude sum.
+     * @param[in] bImagSqrd          Whether to allocate the squared imaginary sum.
+     *
+     * @return                   The sums, one per channel.
+     */
+    static QVector<PairSums> createPairSums(int iNRows,
+                                            int iNBins,
+                                            bool bCsd,
+                                            bool bCsdNormalized,
+                                            bool bImagSign,
+                                            bool bImagAbs,
+                                            bool bImagSqrd);
+
+    //=========================================================================================================
+    /**
+     * Adds the PSD of one trial.
+     *
+     * @param[in, out] matPsdSum The PSD sum (rows x used bins).
+     * @param[in] spectra        The spectra of the trial.
+     * @param[in] dDenomPSD      The PSD normalization.
+     * @param[in] bHalfFirst     Whether to halve the first bin.
+     * @param[in] bHalfLast      Whether to halve the last bin.
+     * @param[in] dSign          1 to add the trial, -1 to remove a trial added before.
+     */
+    static void accumulatePsd(Eigen::MatrixXd& matPsdSum,
+                              const TrialSpectra& spectra,
+                              double dDenomPSD,
+                              bool bHalfFirst,
+                              bool bHalfLast,
+                              double dSign = 1.0);
+
+    //=========================================================================================================
+    /**
+     * Creates the networks from the accumulated sums.
+     *
+     * @param[in] lMethods               The methods to create networks for.
+     * @param[in] vecPairSums            The sums of the channel pairs.
+     * @param[in] matPsdSum              The PSD sum. Only used for COH and IMAGCOH.
+     * @param[in] iNTrials               The number of trials the sums hold.
+     * @param[in] iNFreqs                The number of frequencies of the half spectrum.
+     * @param[in] connectivitySettings   The settings providing the node positions and sampling frequency.
+     *
+     * @return                   One network per method, in the order of lMethods.
+     */
+    static QList<Network> createNetworks(const QStringList& lMethods,
+                                         const QVector<PairSums>& vecPairSums,
+                                         const Eigen::MatrixXd& matPsdSum,
+                                         int iNTrials,
+                                         int iNFreqs,
+                                         const ConnectivitySettings& connectivitySettings);
+};
+
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+} // namespace CONNLIB
+
+#endif // MULTIMETRIC_H
@@ -46,6 +46,7 @@
 #include "../network/network.h"
 
 #include <math/spectral.h>
+#include <math/fft_plan_cache.h>
 
 //=============================================================================================================
 // QT INCLUDES
@@ -208,8 +209,7 @@ void PhaseLagIndex::compute(ConnectivitySettings::IntermediateTrialData& inputDa
 
         MatrixXcd matTapSpectrum(tapers.first.rows(), iNFreqs);
 
-        FFT<double> fft;
-        fft.SetFlag(fft.HalfSpectrum);
+        FFT<double>& fft = FftPlanCache::get(true);
 
         for (i = 0; i < iNRows; ++i) {
             // Substract mean
@@ -236,32 +236,14 @@ void PhaseLagIndex::compute(ConnectivitySettings::IntermediateTrialData& inputDa
 
     // Compute CSD
     if(inputData.vecPairCsd.isEmpty()) {
-        MatrixXcd matCsd = MatrixXcd(iNRows, m_iNumberBinAmount);
-
-        double denomCSD = sqrt(tapers.second.cwiseAbs2().sum()) * sqrt(tapers.second.cwiseAbs2().sum()) / 2.0;
-
-        bool bNfftEven = false;
-        if (iNfft % 2 == 0){
-            bNfftEven = true;
-        }
+        computePairCsd(inputData.vecTapSpectra,
+                       iNFreqs,
+                       iNfft,
+                       tapers,
+                       inputData.vecPairCsd);
 
         for (i = 0; i < iNRows; ++i) {
-            for (j = i; j < iNRows; ++j) {
-                // Compute CSD (average over tapers if necessary)
-                matCsd.row(j) = inputData.vecTapSpectra.at(i).block(0,m_iNumberBinStart,inputData.vecTapSpectra.at(i).rows(),m_iNumberBinAmount).cwiseProduct(inputData.vecTapSpectra.at(j).block(0,m_iNumberBinStart,inputData.vecTapSpectra.at(j).rows(),m_iNumberBinAmount).conjugate()).colwise().sum() / denomCSD;
-
-                // Divide first and last element by 2 due to half spectrum
-                if(m_iNumberBinStart == 0) {
-                    matCsd.row(j)(0) /= 2.0;
-                }
-
-                if(bNfftEven && m_iNumberBinStart + m_iNumberBinAmount >= iNFreqs) {
-                    matCsd.row(j).tail(1) /= 2.0;
-                }
-            }
-
-            inputData.vecPairCsd.append(QPair<int,MatrixXcd>(i,matCsd));
-            inputData.vecPairCsdImagSign.append(QPair<int,MatrixXd>(i,matCsd.imag().cwiseSign()));
+            inputData.vecPairCsdImagSign.append(QPair<int,MatrixXd>(i,inputData.vecPairCsd.at(i).second.imag().cwiseSign()));
         }
 
         mutex.lock();
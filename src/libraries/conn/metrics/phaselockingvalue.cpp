@@ -46,6 +46,7 @@
 #include "../network/network.h"
 
 #include <math/spectral.h>
+#include <math/fft_plan_cache.h>
 
 //=============================================================================================================
 // QT INCLUDES
@@ -209,8 +210,7 @@ void PhaseLockingValue::compute(ConnectivitySettings::IntermediateTrialData& inp
 
         MatrixXcd matTapSpectrum(tapers.first.rows(), iNFreqs);
 
-        FFT<double> fft;
-        fft.SetFlag(fft.HalfSpectrum);
+        FFT<double>& fft = FftPlanCache::get(true);
 
         for (i = 0; i < iNRows; ++i) {
             // Substract mean
@@ -237,32 +237,14 @@ void PhaseLockingValue::compute(ConnectivitySettings::IntermediateTrialData& inp
 
     // Compute CSD
     if(inputData.vecPairCsd.isEmpty()) {
-        MatrixXcd matCsd = MatrixXcd(iNRows, m_iNumberBinAmount);
-
-        bool bNfftEven = false;
-        if (iNfft % 2 == 0){
-            bNfftEven = true;
-        }
-
-        double denomCSD = sqrt(tapers.second.cwiseAbs2().sum()) * sqrt(tapers.second.cwiseAbs2().sum()) / 2.0;
+        computePairCsd(inputData.vecTapSpectra,
+                       iNFreqs,
+                       iNfft,
+                       tapers,
+                       inputData.vecPairCsd);
 
         for (i = 0; i < iNRows; ++i) {
-            for (j = i; j < iNRows; ++j) {
-                // Compute CSD (average over tapers if necessary)
-                matCsd.row(j) = inputData.vecTapSpectra.at(i).block(0,m_iNumberBinStart,inputData.vecTapSpectra.at(i).rows(),m_iNumberBinAmount).cwiseProduct(inputData.vecTapSpectra.at(j).block(0,m_iNumberBinStart,inputData.vecTapSpectra.at(j).rows(),m_iNumberBinAmount).conjugate()).colwise().sum() / denomCSD;
-
-                // Divide first and last element by 2 due to half spectrum
-                if(m_iNumberBinStart == 0) {
-                    matCsd.row(j)(0) /= 2.0;
-                }
-
-                if(bNfftEven && m_iNumberBinStart + m_iNumberBinAmount >= iNFreqs) {
-                    matCsd.row(j).tail(1) /= 2.0;
-                }
-            }
-
-            inputData.vecPairCsd.append(QPair<int,MatrixXcd>(i,matCsd));
-            inputData.vecPairCsdNormalized.append(QPair<int,MatrixXcd>(i,matCsd.cwiseQuotient(matCsd.cwiseAbs())));
+            inputData.vecPairCsdNormalized.append(QPair<int,MatrixXcd>(i,inputData.vecPairCsd.at(i).second.cwiseQuotient(inputData.vecPairCsd.at(i).second.cwiseAbs())));
         }
 
         mutex.lock();
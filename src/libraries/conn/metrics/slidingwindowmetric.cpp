@@ -0,0 +1,317 @@
+//=============================================================================================================
+/**
+ * @file     slidingwindowmetric.cpp
+ * @author   Christoph Dinh <christoph.dinh@mne-cpp.org>
+ * @since    2.1.0
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, Christoph Dinh. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ * @brief     SlidingWindowMetric class definition.
+ *
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "slidingwindowmetric.h"
+#include "../network/network.h"
+
+#include <math/spectral.h>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QDebug>
+#include <QtConcurrent>
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace CONNLIB;
+using namespace Eigen;
+using namespace UTILSLIB;
+
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace
+{
+
+/** Number of removed trials after which the sums are recomputed from the spectra held. */
+const int REBUILD_INTERVAL = 1000;
+
+}
+
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+SlidingWindowMetric::SlidingWindowMetric(int iWindowSize)
+: MultiMetric()
+, m_iWindowSize(qMax(1, iWindowSize))
+, m_iNRows(0)
+, m_iNSamples(0)
+, m_iNfft(0)
+, m_iBinStart(-1)
+, m_iBinAmount(-1)
+, m_iNUpdates(0)
+{
+}
+
+//=============================================================================================================
+
+bool SlidingWindowMetric::supports(const QStringList& lMethods)
+{
+    if(lMethods.isEmpty()) {
+        return false;
+    }
+
+    QStringList lSupported = supportedMethods();
+    for(const QString& sMethod : lMethods) {
+        if(!lSupported.contains(sMethod)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//=============================================================================================================
+
+void SlidingWindowMetric::setWindowSize(int iWindowSize)
+{
+    m_iWindowSize = qMax(1, iWindowSize);
+
+    if(m_vecSpectra.size() > m_iWindowSize) {
+        m_vecSpectra.remove(0, m_vecSpectra.size() - m_iWindowSize);
+        rebuildSums();
+    }
+}
+
+//=============================================================================================================
+
+int SlidingWindowMetric::getWindowSize() const
+{
+    return m_iWindowSize;
+}
+
+//=============================================================================================================
+
+int SlidingWindowMetric::size() const
+{
+    return m_vecSpectra.size();
+}
+
+//=============================================================================================================
+
+void SlidingWindowMetric::clear()
+{
+    m_vecSpectra.clear();
+    m_vecPairSums.clear();
+    m_matPsdSum.resize(0, 0);
+    m_iNUpdates = 0;
+}
+
+//=============================================================================================================
+
+void SlidingWindowMetric::append(const MatrixXd& matTrial,
+                                 const ConnectivitySettings& connectivitySettings)
+{
+    if(matTrial.rows() == 0 || matTrial.cols() == 0) {
+        qWarning() << "SlidingWindowMetric::append - Input data is empty";
+        return;
+    }
+
+    updateLayout(matTrial, connectivitySettings);
+
+    TrialSpectra spectra;
+    spectra.iTrial = m_vecSpectra.size();
+    computeSpectra(matTrial,
+                   m_tapers,
+                   m_iNfft,
+                   spectra);
+
+    // Evict the oldest trials if the window is full
+    QVector<TrialSpectra> vecRemoved;
+    if(m_vecSpectra.size() >= m_iWindowSize) {
+        const int iNRemoved = m_vecSpectra.size() - m_iWindowSize + 1;
+        vecRemoved = m_vecSpectra.mid(0, iNRemoved);
+        m_vecSpectra.remove(0, iNRemoved);
+    }
+
+    m_vecSpectra.append(spectra);
+
+    if(!vecRemoved.isEmpty() && ++m_iNUpdates >= REBUILD_INTERVAL) {
+        rebuildSums();
+    } else {
+        updateSums(QVector<TrialSpectra>() << spectra,
+                   vecRemoved);
+    }
+}
+
+//=============================================================================================================
+
+QList<Network> SlidingWindowMetric::getNetworks(const ConnectivitySettings& connectivitySettings,
+                                                const QStringList& lMethods) const
+{
+    QStringList lSupported = supportedMethods();
+    QStringList lComputed;
+    for(const QString& sMethod : lMethods) {
+        if(lSupported.contains(sMethod) && !lComputed.contains(sMethod)) {
+            lComputed.append(sMethod);
+        }
+    }
+
+    if(lComputed.isEmpty() || m_vecSpectra.isEmpty()) {
+        return QList<Network>();
+    }
+
+    return createNetworks(lComputed,
+                          m_vecPairSums,
+                          m_matPsdSum,
+                          m_vecSpectra.size(),
+                          int(floor(m_iNfft / 2.0)) + 1,
+                          connectivitySettings);
+}
+
+//=============================================================================================================
+
+void SlidingWindowMetric::updateLayout(const MatrixXd& matTrial,
+                                       const ConnectivitySettings& connectivitySettings)
+{
+    const int iNfft = connectivitySettings.getFFTSize();
+    const int iNFreqs = int(floor(iNfft / 2.0)) + 1;
+
+    // Check if start and bin amount need to be reset to full spectrum
+    if(m_iNumberBinStart == -1 ||
+       m_iNumberBinAmount == -1 ||
+       m_iNumberBinStart > iNFreqs ||
+       m_iNumberBinAmount > iNFreqs ||
+       m_iNumberBinAmount + m_iNumberBinStart > iNFreqs) {
+        qDebug() << "SlidingWindowMetric::updateLayout - Resetting to full spectrum";
+        AbstractMetric::m_iNumberBinStart = 0;
+        AbstractMetric::m_iNumberBinAmount = iNFreqs;
+    }
+
+    if(matTrial.rows() != m_iNRows ||
+       matTrial.cols() != m_iNSamples ||
+       iNfft != m_iNfft ||
+       connectivitySettings.getWindowType() != m_sWindowType ||
+       m_iNumberBinStart != m_iBinStart ||
+       m_iNumberBinAmount != m_iBinAmount) {
+        if(!m_vecSpectra.isEmpty()) {
+            qDebug() << "SlidingWindowMetric::updateLayout - Trial layout changed. Clearing the window.";
+        }
+
+        clear();
+
+        if(matTrial.cols() != m_iNSamples || connectivitySettings.getWindowType() != m_sWindowType) {
+            m_tapers = Spectral::generateTapers(matTrial.cols(), connectivitySettings.getWindowType());
+        }
+
+        m_iNRows = matTrial.rows();
+        m_iNSamples = matTrial.cols();
+        m_iNfft = iNfft;
+        m_sWindowType = connectivitySettings.getWindowType();
+        m_iBinStart = m_iNumberBinStart;
+        m_iBinAmount = m_iNumberBinAmount;
+    }
+
+    if(m_vecPairSums.isEmpty()) {
+        m_vecPairSums = createPairSums(m_iNRows, m_iBinAmount, true, true, true, true, true);
+        m_matPsdSum = MatrixXd::Zero(m_iNRows, m_iBinAmount);
+    }
+}
+
+//=============================================================================================================
+
+void SlidingWindowMetric::updateSums(const QVector<TrialSpectra>& vecAdded,
+                                     const QVector<TrialSpectra>& vecRemoved)
+{
+    const int iNFreqs = int(floor(m_iNfft / 2.0)) + 1;
+    const bool bHalfFirst = m_iBinStart == 0;
+    const bool bHalfLast = m_iNfft % 2 == 0 && m_iBinStart + m_iBinAmount >= iNFreqs;
+    const double denomPSD = m_tapers.second.cwiseAbs2().sum() / 2.0;
+    const double denomCSD = sqrt(m_tapers.second.cwiseAbs2().sum()) * sqrt(m_tapers.second.cwiseAbs2().sum()) / 2.0;
+
+    for(const TrialSpectra& spectra : vecRemoved) {
+        accumulatePsd(m_matPsdSum,
+                      spectra,
+                      denomPSD,
+                      bHalfFirst,
+                      bHalfLast,
+                      -1.0);
+    }
+
+    for(const TrialSpectra& spectra : vecAdded) {
+        accumulatePsd(m_matPsdSum,
+                      spectra,
+                      denomPSD,
+                      bHalfFirst,
+                      bHalfLast);
+    }
+
+    // Subtract out the old and add in the new trials, one channel per call
+    std::function<void(PairSums&)> accumulateLambda = [&](PairSums& sums) {
+        accumulatePairs(sums,
+                        vecRemoved,
+                        denomCSD,
+                        bHalfFirst,
+                        bHalfLast,
+                        -1.0);
+        accumulatePairs(sums,
+                        vecAdded,
+                        denomCSD,
+                        bHalfFirst,
+                        bHalfLast);
+    };
+
+    QFuture<void> resultPairs = QtConcurrent::map(m_vecPairSums,
+                                                  accumulateLambda);
+    resultPairs.waitForFinished();
+}
+
+//=============================================================================================================
+
+void SlidingWindowMetric::rebuildSums()
+{
+    m_iNUpdates = 0;
+
+    if(m_vecPairSums.isEmpty()) {
+        return;
+    }
+
+    m_vecPairSums = createPairSums(m_iNRows, m_iBinAmount, true, true, true, true, true);
+    m_matPsdSum = MatrixXd::Zero(m_iNRows, m_iBinAmount);
+
+    updateSums(m_vecSpectra,
+               QVector<TrialSpectra>());
+}
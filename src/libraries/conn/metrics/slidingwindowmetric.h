@@ -0,0 +1,213 @@
+//=============================================================================================================
+/**
+ * @file     slidingwindowmetric.h
+ * @author   Christoph Dinh <christoph.dinh@mne-cpp.org>
+ * @since    2.1.0
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, Christoph Dinh. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ * @brief     SlidingWindowMetric class declaration.
+ *
+ */
+
+#ifndef SLIDINGWINDOWMETRIC_H
+#define SLIDINGWINDOWMETRIC_H
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../conn_global.h"
+#include "multimetric.h"
+#include "../connectivitysettings.h"
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QStringList>
+#include <QList>
+#include <QVector>
+#include <QPair>
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+//=============================================================================================================
+// DEFINE NAMESPACE CONNLIB
+//=============================================================================================================
+
+namespace CONNLIB {
+
+//=============================================================================================================
+// CONNLIB FORWARD DECLARATIONS
+//=============================================================================================================
+
+class Network;
+
+//=============================================================================================================
+/**
+ * Keeps the spectral sums of the last trials of a stream. Appending a trial adds its statistics to the sums
+ * and, once the window is full, subtracts the statistics of the oldest trial. The tapered spectra of the
+ * trials in the window are kept, so that an update costs one spectral pass of the new trial plus one pass
+ * over the channel pairs, independent of the window size.
+ *
+ * All sums of MultiMetric are kept, so the networks of any of its methods can be created at any time.
+ *
+ * @brief Sliding-window connectivity with incremental trial updates
+ */
+class CONNSHARED_EXPORT SlidingWindowMetric : public MultiMetric
+{
+
+public:
+    typedef QSharedPointer<SlidingWindowMetric> SPtr;            /**< Shared pointer type for SlidingWindowMetric. */
+    typedef QSharedPointer<const SlidingWindowMetric> ConstSPtr; /**< Const shared pointer type for SlidingWindowMetric. */
+
+    //=========================================================================================================
+    /**
+     * Constructs a SlidingWindowMetric object.
+     *
+     * @param[in] iWindowSize    The number of trials in the window.
+     */
+    explicit SlidingWindowMetric(int iWindowSize = 10);
+
+    //=========================================================================================================
+    /**
+     * Returns whether all methods can be computed with a sliding window.
+     *
+     * @param[in] lMethods       The method names.
+     *
+     * @return                   True if lMethods is not empty and all methods are in supportedMethods().
+     */
+    static bool supports(const QStringList& lMethods);
+
+    //=========================================================================================================
+    /**
+     * Sets the number of trials in the window. If the window shrinks, the oldest trials are removed.
+     *
+     * @param[in] iWindowSize    The number of trials in the window.
+     */
+    void setWindowSize(int iWindowSize);
+
+    //=========================================================================================================
+    /**
+     * Returns the number of trials in the window.
+     *
+     * @return                   The window size.
+     */
+    int getWindowSize() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the number of trials currently held.
+     *
+     * @return                   The number of trials.
+     */
+    int size() const;
+
+    //=========================================================================================================
+    /**
+     * Removes all trials and resets the sums.
+     */
+    void clear();
+
+    //=========================================================================================================
+    /**
+     * Adds a trial and removes the oldest one if the window is full. If the channels, samples, FFT length,
+     * window type or used frequency bins differ from the trials held, the window is cleared first.
+     *
+     * @param[in] matTrial               The trial data (rows x samples).
+     * @param[in] connectivitySettings   The settings providing the FFT length and window type.
+     */
+    void append(const Eigen::MatrixXd& matTrial,
+                const ConnectivitySettings& connectivitySettings);
+
+    //=========================================================================================================
+    /**
+     * Creates the networks of the trials in the window.
+     *
+     * @param[in] connectivitySettings   The settings providing the node positions and sampling frequency.
+     * @param[in] lMethods               The methods to compute. Methods not in supportedMethods() are skipped.
+     *
+     * @return                   One network per computed method, in the order of lMethods.
+     */
+    QList<Network> getNetworks(const ConnectivitySettings& connectivitySettings,
+                               const QStringList& lMethods) const;
+
+protected:
+    //=========================================================================================================
+    /**
+     * Checks the layout of a new trial against the trials held and clears the window if it differs.
+     *
+     * @param[in] matTrial               The trial data (rows x samples).
+     * @param[in] connectivitySettings   The settings providing the FFT length and window type.
+     */
+    void updateLayout(const Eigen::MatrixXd& matTrial,
+                      const ConnectivitySettings& connectivitySettings);
+
+    //=========================================================================================================
+    /**
+     * Updates the sums with the trials to add and to remove.
+     *
+     * @param[in] vecAdded       The spectra of the trials to add.
+     * @param[in] vecRemoved     The spectra of the trials to remove.
+     */
+    void updateSums(const QVector<TrialSpectra>& vecAdded,
+                    const QVector<TrialSpectra>& vecRemoved);
+
+    //=========================================================================================================
+    /**
+     * Recomputes the sums from the spectra held. This bounds the rounding error of repeated subtractions.
+     */
+    void rebuildSums();
+
+    int                                         m_iWindowSize;      /**< The number of trials in the window. */
+    int                                         m_iNRows;           /**< The number of channels of the trials held. */
+    int                                         m_iNSamples;        /**< The number of samples of the trials held. */
+    int                                         m_iNfft;            /**< The FFT length of the trials held. */
+    int                                         m_iBinStart;        /**< The first used frequency bin. */
+    int                                         m_iBinAmount;       /**< The number of used frequency bins. */
+    int                                         m_iNUpdates;        /**< The number of removals since the last rebuild of the sums. */
+    QString                                     m_sWindowType;      /**< The window type of the trials held. */
+
+    QPair<Eigen::MatrixXd, Eigen::VectorXd>     m_tapers;           /**< The tapers of the trials held. */
+
+    QVector<TrialSpectra>                       m_vecSpectra;       /**< The spectra of the trials in the window, oldest first. */
+    QVector<PairSums>                           m_vecPairSums;      /**< The sums of the channel pairs. */
+    Eigen::MatrixXd                             m_matPsdSum;        /**< The PSD sum. */
+};
+
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+} // namespace CONNLIB
+
+#endif // SLIDINGWINDOWMETRIC_H
@@ -69,6 +69,20 @@ using namespace UTILSLIB;
 // DEFINE GLOBAL METHODS
 //=============================================================================================================
 
+namespace
+{
+
+QPair<int,int> getMinMaxDegrees(const VectorXi& vecDegrees)
+{
+    if(vecDegrees.size() == 0) {
+        return QPair<int,int>(1000000,0);
+    }
+
+    return QPair<int,int>(vecDegrees.minCoeff(),vecDegrees.maxCoeff());
+}
+
+} // namespace
+
 //=============================================================================================================
 // DEFINE MEMBER METHODS
 //=============================================================================================================
@@ -82,6 +96,8 @@ Network::Network(const QString& sConnectivityMethod,
 , m_fSFreq(0.0f)
 , m_iFFTSize(128)
 , m_iNumberFreqBins(0)
+, m_bCompact(false)
+, m_bEdgeViewsCreated(false)
 {
     qRegisterMetaType<CONNLIB::Network>("CONNLIB::Network");
     qRegisterMetaType<CONNLIB::Network::SPtr>("CONNLIB::Network::SPtr");
@@ -91,8 +107,19 @@ Network::Network(const QString& sConnectivityMethod,
 
 //=============================================================================================================
 
+Network::~Network()
+{
+    releaseNodes();
+}
+
+//=============================================================================================================
+
 MatrixXd Network::getFullConnectivityMatrix(bool bGetMirroredVersion) const
 {
+    if(m_bCompact) {
+        return m_tensor.getFullConnectivityMatrix(bGetMirroredVersion);
+    }
+
     MatrixXd matDist(m_lNodes.size(), m_lNodes.size());
     matDist.setZero();
 
@@ -117,6 +144,10 @@ MatrixXd Network::getFullConnectivityMatrix(bool bGetMirroredVersion) const
 
 MatrixXd Network::getThresholdedConnectivityMatrix(bool bGetMirroredVersion) const
 {
+    if(m_bCompact) {
+        return m_tensor.getThresholdedConnectivityMatrix(bGetMirroredVersion);
+    }
+
     MatrixXd matDist(m_lNodes.size(), m_lNodes.size());
     matDist.setZero();
 
@@ -141,6 +172,8 @@ MatrixXd Network::getThresholdedConnectivityMatrix(bool bGetMirroredVersion) con
 
 const QList<NetworkEdge::SPtr>& Network::getFullEdges() const
 {
+    createEdgeViews();
+
     return m_lFullEdges;
 }
 
@@ -148,6 +181,8 @@ const QList<NetworkEdge::SPtr>& Network::getFullEdges() const
 
 const QList<NetworkEdge::SPtr>& Network::getThresholdedEdges() const
 {
+    createEdgeViews();
+
     return m_lThresholdedEdges;
 }
 
@@ -155,6 +190,8 @@ const QList<NetworkEdge::SPtr>& Network::getThresholdedEdges() const
 
 const QList<NetworkNode::SPtr>& Network::getNodes() const
 {
+    ownNodes();
+
     return m_lNodes;
 }
 
@@ -162,13 +199,48 @@ const QList<NetworkNode::SPtr>& Network::getNodes() const
 
 NetworkNode::SPtr Network::getNodeAt(int i)
 {
+    ownNodes();
+
     return m_lNodes.at(i);
 }
 
 //=============================================================================================================
 
+int Network::getNumberNodes() const
+{
+    return m_lNodes.size();
+}
+
+//=============================================================================================================
+
+Index Network::getNumberFullEdges() const
+{
+    if(m_bCompact) {
+        return m_tensor.getNumberEdges();
+    }
+
+    return m_lFullEdges.size();
+}
+
+//=============================================================================================================
+
+MatrixXf Network::getNodeVertices() const
+{
+    MatrixXf matVert(m_lNodes.size(), m_lNodes.isEmpty() ? 0 : m_lNodes.first()->getVert().size());
+
+    for(int i = 0; i < m_lNodes.size(); ++i) {
+        matVert.row(i) = m_lNodes.at(i)->getVert();
+    }
+
+    return matVert;
+}
+
+//=============================================================================================================
+
 NetworkEdge::SPtr Network::getEdgeAt(int i)
 {
+    createEdgeViews();
+
     return m_lFullEdges.at(i);
 }
 
@@ -176,6 +248,11 @@ NetworkEdge::SPtr Network::getEdgeAt(int i)
 
 qint16 Network::getFullDistribution() const
 {
+    // Every node pair is an edge of both of its nodes
+    if(m_bCompact) {
+        return qint16(2 * m_tensor.getNumberEdges());
+    }
+
     qint16 distribution = 0;
 
     for(int i = 0; i < m_lNodes.size(); ++i) {
@@ -189,6 +266,10 @@ qint16 Network::getFullDistribution() const
 
 qint16 Network::getThresholdedDistribution() const
 {
+    if(m_bCompact) {
+        return qint16(m_tensor.getThresholdedDegrees().sum());
+    }
+
     qint16 distribution = 0;
 
     for(int i = 0; i < m_lNodes.size(); ++i) {
@@ -230,6 +311,11 @@ QPair<double, double> Network::getMinMaxThresholdedWeights() const
 
 QPair<int,int> Network::getMinMaxFullDegrees() const
 {
+    if(m_bCompact) {
+        const int iNumberNodes = m_tensor.getNumberNodes();
+        return getMinMaxDegrees(VectorXi::Constant(iNumberNodes, iNumberNodes - 1));
+    }
+
     int maxDegree = 0;
     int minDegree = 1000000;
 
@@ -248,6 +334,10 @@ QPair<int,int> Network::getMinMaxFullDegrees() const
 
 QPair<int,int> Network::getMinMaxThresholdedDegrees() const
 {
+    if(m_bCompact) {
+        return getMinMaxDegrees(m_tensor.getThresholdedDegrees());
+    }
+
     int maxDegree = 0;
     int minDegree = 1000000;
 
@@ -266,6 +356,12 @@ QPair<int,int> Network::getMinMaxThresholdedDegrees() const
 
 QPair<int,int> Network::getMinMaxFullIndegrees() const
 {
+    // Edge views start at the lower node index
+    if(m_bCompact) {
+        const int iNumberNodes = m_tensor.getNumberNodes();
+        return getMinMaxDegrees(VectorXi::LinSpaced(iNumberNodes, 0, iNumberNodes - 1));
+    }
+
     int maxDegree = 0;
     int minDegree = 1000000;
 
@@ -284,6 +380,10 @@ QPair<int,int> Network::getMinMaxFullIndegrees() const
 
 QPair<int,int> Network::getMinMaxThresholdedIndegrees() const
 {
+    if(m_bCompact) {
+        return getMinMaxDegrees(m_tensor.getThresholdedIndegrees());
+    }
+
     int maxDegree = 0;
     int minDegree = 1000000;
 
@@ -302,6 +402,11 @@ QPair<int,int> Network::getMinMaxThresholdedIndegrees() const
 
 QPair<int,int> Network::getMinMaxFullOutdegrees() const
 {
+    if(m_bCompact) {
+        const int iNumberNodes = m_tensor.getNumberNodes();
+        return getMinMaxDegrees(VectorXi::LinSpaced(iNumberNodes, iNumberNodes - 1, 0));
+    }
+
     int maxDegree = 0;
     int minDegree = 1000000;
 
@@ -320,6 +425,10 @@ QPair<int,int> Network::getMinMaxFullOutdegrees() const
 
 QPair<int,int> Network::getMinMaxThresholdedOutdegrees() const
 {
+    if(m_bCompact) {
+        return getMinMaxDegrees(m_tensor.getThresholdedOutdegrees());
+    }
+
     int maxDegree = 0;
     int minDegree = 1000000;
 
@@ -339,10 +448,19 @@ QPair<int,int> Network::getMinMaxThresholdedOutdegrees() const
 void Network::setThreshold(double dThreshold)
 {
     m_dThreshold = dThreshold;
+
+    if(m_bCompact) {
+        m_tensor.setThreshold(m_dThreshold);
+        ownNodes();
+    }
+
     m_lThresholdedEdges.clear();
 
+    // In compact mode only existing edge views need to be updated. Their order matches the tensor edges.
     for(int i = 0; i < m_lFullEdges.size(); ++i) {
-        if(fabs(m_lFullEdges.at(i)->getWeight()) >= m_dThreshold) {
+        bool bActive = m_bCompact ? m_tensor.isActive(i) : fabs(m_lFullEdges.at(i)->getWeight()) >= m_dThreshold;
+
+        if(bActive) {
             m_lFullEdges.at(i)->setActive(true);
             m_lThresholdedEdges.append(m_lFullEdges.at(i));
         } else {
@@ -396,6 +514,22 @@ void Network::setFrequencyRange(float fLowerFreq, float fUpperFreq)
     // Update the min max values
     m_minMaxFullWeights = QPair<double,double>(std::numeric_limits<double>::max(),0.0);
 
+    if(m_bCompact) {
+        m_tensor.setFrequencyBins(QPair<int,int>(iLowerBin,iUpperBin));
+
+        if(m_tensor.getNumberEdges() > 0) {
+            m_minMaxFullWeights.first = m_tensor.getAveragedWeights().cwiseAbs().minCoeff();
+            m_minMaxFullWeights.second = m_tensor.getAveragedWeights().cwiseAbs().maxCoeff();
+        }
+
+        ownNodes();
+        for(int i = 0; i < m_lFullEdges.size(); ++i) {
+            m_lFullEdges.at(i)->setFrequencyBins(QPair<int,int>(iLowerBin,iUpperBin));
+        }
+
+        return;
+    }
+
     for(int i = 0; i < m_lFullEdges.size(); ++i) {
         m_lFullEdges.at(i)->setFrequencyBins(QPair<int,int>(iLowerBin,iUpperBin));
 
@@ -418,6 +552,11 @@ const QPair<float,float>& Network::getFrequencyRange() const
 
 void Network::append(NetworkEdge::SPtr newEdge)
 {
+    if(m_bCompact) {
+        qWarning() << "Network::append - The network uses compact storage. Set the edge weights in the tensor instead.";
+        return;
+    }
+
     if(newEdge->getEndNodeID() != newEdge->getStartNodeID()) {
         double dEdgeWeight = newEdge->getWeight();
         if(dEdgeWeight < m_minMaxFullWeights.first) {
@@ -439,12 +578,21 @@ void Network::append(NetworkEdge::SPtr newEdge)
 void Network::append(NetworkNode::SPtr newNode)
 {
     m_lNodes << newNode;
+
+    // Existing edge views do not reach the new node, create them again on demand
+    if(m_bCompact) {
+        releaseNodes();
+    }
 }
 
 //=============================================================================================================
 
 bool Network::isEmpty() const
 {
+    if(m_bCompact) {
+        return m_tensor.isEmpty() || m_lNodes.isEmpty();
+    }
+
     if(m_lFullEdges.isEmpty() || m_lNodes.isEmpty()) {
         return true;
     }
@@ -462,6 +610,11 @@ void Network::normalize()
         return;
     }
 
+    if(m_bCompact) {
+        m_tensor.scaleAveragedWeights(1.0/m_minMaxFullWeights.second);
+        ownNodes();
+    }
+
     for(int i = 0; i < m_lFullEdges.size(); ++i) {
         m_lFullEdges.at(i)->setWeight(m_lFullEdges.at(i)->getWeight()/m_minMaxFullWeights.second);
     }
@@ -529,3 +682,153 @@ int Network::getFFTSize()
     return m_iFFTSize;
 }
 
+//=============================================================================================================
+
+void Network::setTensor(const NetworkTensor& tensor)
+{
+    m_tensor = tensor;
+    m_tensor.setThreshold(m_dThreshold);
+    m_bCompact = true;
+
+    // The nodes get the edges of the new tensor on demand
+    releaseNodes();
+    m_bEdgeViewsCreated = false;
+    m_lFullEdges.clear();
+    m_lThresholdedEdges.clear();
+
+    m_minMaxFullWeights = QPair<double,double>(std::numeric_limits<double>::max(),0.0);
+
+    if(m_tensor.getNumberEdges() > 0) {
+        m_minMaxFullWeights.first = qMin(m_minMaxFullWeights.first, m_tensor.getAveragedWeights().minCoeff());
+        m_minMaxFullWeights.second = qMax(m_minMaxFullWeights.second, m_tensor.getAveragedWeights().maxCoeff());
+    }
+}
+
+//=============================================================================================================
+
+const NetworkTensor& Network::getTensor() const
+{
+    return m_tensor;
+}
+
+//=============================================================================================================
+
+bool Network::isCompact() const
+{
+    return m_bCompact;
+}
+
+//=============================================================================================================
+
+VectorXi Network::getThresholdedDegrees() const
+{
+    if(m_bCompact) {
+        return m_tensor.getThresholdedDegrees();
+    }
+
+    VectorXi vecDegrees(m_lNodes.size());
+
+    for(int i = 0; i < m_lNodes.size(); ++i) {
+        vecDegrees(i) = m_lNodes.at(i)->getThresholdedDegree();
+    }
+
+    return vecDegrees;
+}
+
+//=============================================================================================================
+
+void Network::ownNodes() const
+{
+    if(!m_bCompact || (m_pNodeOwner && *m_pNodeOwner == this)) {
+        return;
+    }
+
+    // The nodes may be shared with other networks, e.g., the one this network was copied from. Edge views are
+    // only ever added to copies owned by this network.
+    m_pNodeOwner = QSharedPointer<const Network*>::create(this);
+    QWeakPointer<const Network*> pNodeOwner = m_pNodeOwner;
+
+    m_bEdgeViewsCreated = false;
+    m_lFullEdges.clear();
+    m_lThresholdedEdges.clear();
+
+    for(int i = 0; i < m_lNodes.size(); ++i) {
+        const NetworkNode::SPtr pNode = m_lNodes.at(i);
+        NetworkNode::SPtr pNodeCopy = NetworkNode::SPtr(new NetworkNode(pNode->getId(), pNode->getVert()));
+        pNodeCopy->setHubStatus(pNode->getHubStatus());
+        pNodeCopy->setEdgeCreator([pNodeOwner]() {
+            QSharedPointer<const Network*> pOwner = pNodeOwner.toStrongRef();
+            if(pOwner && *pOwner) {
+                (*pOwner)->createEdgeViews();
+            }
+        });
+        m_lNodes[i] = pNodeCopy;
+    }
+}
+
+//=============================================================================================================
+
+void Network::releaseNodes() const
+{
+    // Nodes handed out before must not call back into this network anymore
+    if(m_pNodeOwner && *m_pNodeOwner == this) {
+        *m_pNodeOwner = nullptr;
+    }
+
+    m_pNodeOwner.reset();
+}
+
+//=============================================================================================================
+
+void Network::createEdgeViews() const
+{
+    if(!m_bCompact) {
+        return;
+    }
+
+    ownNodes();
+
+    if(m_bEdgeViewsCreated) {
+        return;
+    }
+
+    m_bEdgeViewsCreated = true;
+
+    const int iNumberNodes = m_tensor.getNumberNodes();
+    const QPair<int,int>& minMaxFreqBins = m_tensor.getFrequencyBins();
+
+    m_lFullEdges.clear();
+    m_lThresholdedEdges.clear();
+    m_lFullEdges.reserve(int(m_tensor.getNumberEdges()));
+
+    // The nodes get their edges now, not again on request
+    for(int i = 0; i < m_lNodes.size(); ++i) {
+        m_lNodes.at(i)->setEdgeCreator(std::function<void()>());
+    }
+
+    Index iEdge = 0;
+    for(int i = 0; i < iNumberNodes; ++i) {
+        for(int j = i + 1; j < iNumberNodes; ++j, ++iEdge) {
+            bool bActive = m_tensor.isActive(iEdge);
+
+            NetworkEdge::SPtr pEdge = NetworkEdge::SPtr(new NetworkEdge(i,
+                                                                        j,
+                                                                        m_tensor.getWeights().row(iEdge).transpose(),
+                                                                        bActive,
+                                                                        minMaxFreqBins.first,
+                                                                        minMaxFreqBins.second));
+            pEdge->setWeight(m_tensor.getAveragedWeights()(iEdge));
+
+            m_lFullEdges << pEdge;
+
+            if(bActive) {
+                m_lThresholdedEdges << pEdge;
+            }
+
+            if(i < m_lNodes.size() && j < m_lNodes.size()) {
+                m_lNodes.at(i)->append(pEdge);
+                m_lNodes.at(j)->append(pEdge);
+            }
+        }
+    }
+}
@@ -40,6 +40,7 @@
 //=============================================================================================================
 
 #include "../conn_global.h"
+#include "networktensor.h"
 
 //=============================================================================================================
 // QT INCLUDES
@@ -84,6 +85,14 @@ struct VisualizationInfo {
 //=============================================================================================================
 /**
  * This class holds information (nodes and connecting edges) about a network, can compute a distance table and provide network metrics.
+ * The edges are either kept as a list of NetworkEdge objects or in compact form as a NetworkTensor (see setTensor). In
+ * compact form thresholding, frequency band averaging, the degrees and the connectivity matrices work on the tensor
+ * directly. The nodes are handed out without edges. The NetworkEdge objects are only created as views when the edge
+ * list of the network or the edges or metrics of one of its nodes are requested. The nodes are copies owned by this
+ * network, so copies of a compact network never share the edges of their nodes.
+ *
+ * Network is not thread-safe. In compact mode even the const getters create node copies and edge views, so a network
+ * must not be accessed from several threads at once without external locking.
  *
  * @brief This class holds information about a network, can compute a distance table and provide network metrics.
  */
@@ -105,6 +114,12 @@ public:
     explicit Network(const QString& sConnectivityMethod = "Unknown",
                      double dThreshold = 0.0);
 
+    //=========================================================================================================
+    /**
+     * Destroys the Network object.
+     */
+    ~Network();
+
     //=========================================================================================================
     /**
      * Returns the full connectivity matrix for this network structure.
@@ -147,12 +162,36 @@ public:
 
     //=========================================================================================================
     /**
-     * Returns the nodes.
+     * Returns the nodes. In compact mode their edges are created when first requested from one of them.
      *
      * @return Returns the network nodes.
      */
     const QList<QSharedPointer<NetworkNode> >& getNodes() const;
 
+    //=========================================================================================================
+    /**
+     * Returns the number of nodes.
+     *
+     * @return The number of nodes.
+     */
+    int getNumberNodes() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the number of full edges, without creating edge views in compact mode.
+     *
+     * @return The number of edges.
+     */
+    Eigen::Index getNumberFullEdges() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the 3D positions of the nodes.
+     *
+     * @return The positions, one row per node.
+     */
+    Eigen::MatrixXf getNodeVertices() const;
+
     //=========================================================================================================
     /**
      * Returns the edge at a specific position.
@@ -396,11 +435,64 @@ public:
      */
     int getFFTSize();
 
+    //=========================================================================================================
+    /**
+     * Switches the network to compact storage and replaces all edges with the ones of the tensor. The nodes
+     * must be appended separately. The current threshold is applied to the tensor.
+     *
+     * @param[in] tensor     The compact edge weights.
+     */
+    void setTensor(const NetworkTensor& tensor);
+
+    //=========================================================================================================
+    /**
+     * Returns the compact edge weights. Only valid if isCompact() is true.
+     *
+     * @return The compact edge weights.
+     */
+    const NetworkTensor& getTensor() const;
+
+    //=========================================================================================================
+    /**
+     * Returns whether the edges are kept in compact form.
+     *
+     * @return Whether the network uses compact storage.
+     */
+    bool isCompact() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the number of thresholded edges per node.
+     *
+     * @return The thresholded degree per node.
+     */
+    Eigen::VectorXi getThresholdedDegrees() const;
+
 protected:
-    QList<QSharedPointer<NetworkEdge> >     m_lFullEdges;               /**< List with all edges of the network.*/
-    QList<QSharedPointer<NetworkEdge> >     m_lThresholdedEdges;        /**< List with all the active (thresholded) edges of the network.*/
+    //=========================================================================================================
+    /**
+     * Replaces the nodes with copies owned by this network, if not done already. The copies create the edge views
+     * when their edges are first requested. The appended nodes may be shared with other networks.
+     */
+    void ownNodes() const;
 
-    QList<QSharedPointer<NetworkNode> >     m_lNodes;                   /**< List with all nodes of the network.*/
+    //=========================================================================================================
+    /**
+     * Detaches the owned node copies from this network. They are copied again on the next access.
+     */
+    void releaseNodes() const;
+
+    //=========================================================================================================
+    /**
+     * Creates the NetworkEdge views of the compact edges and adds them to the edge lists of the network and of
+     * the owned node copies, if not done already.
+     */
+    void createEdgeViews() const;
+
+    mutable QList<QSharedPointer<NetworkEdge> >     m_lFullEdges;       /**< List with all edges of the network. Filled on demand in compact mode.*/
+    mutable QList<QSharedPointer<NetworkEdge> >     m_lThresholdedEdges;/**< List with all the active (thresholded) edges of the network. Filled on demand in compact mode.*/
+
+    mutable QList<QSharedPointer<NetworkNode> >     m_lNodes;   /**< List with all nodes of the network. Replaced by copies with edges on demand in compact mode.*/
 
     Eigen::MatrixXd                         m_matDistMatrix;            /**< The distance matrix.*/
 
@@ -416,6 +508,11 @@ protected:
     int                                     m_iFFTSize;                 /**< The used FFT size (number of total frequency bins for a half spectrum - only positive frequencies).*/
 
     VisualizationInfo                       m_visualizationInfo;        /**< The current visualization info used to plot the network later on.*/
+
+    NetworkTensor                           m_tensor;                   /**< The compact edge weights.*/
+    bool                                    m_bCompact;                 /**< Whether the edges are kept in m_tensor.*/
+    mutable bool                            m_bEdgeViewsCreated;        /**< Whether the NetworkEdge views of m_tensor exist.*/
+    mutable QSharedPointer<const Network*>  m_pNodeOwner;               /**< The network the node copies call back to. Copies of this network share it until they own their nodes.*/
 };
 
 //=============================================================================================================
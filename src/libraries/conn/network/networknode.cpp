@@ -74,6 +74,8 @@ NetworkNode::NetworkNode(qint16 iId, const RowVectorXf& vecVert)
 
 const QList<QSharedPointer<NetworkEdge> >& NetworkNode::getFullEdges() const
 {
+    createEdges();
+
     return m_lEdges;
 }
 
@@ -81,6 +83,8 @@ const QList<QSharedPointer<NetworkEdge> >& NetworkNode::getFullEdges() const
 
 QList<QSharedPointer<NetworkEdge> > NetworkNode::getThresholdedEdges() const
 {
+    createEdges();
+
     QList<QSharedPointer<NetworkEdge> > edgeList;
 
     for(int i = 0; i< m_lEdges.size(); i++) {
@@ -96,6 +100,8 @@ QList<QSharedPointer<NetworkEdge> > NetworkNode::getThresholdedEdges() const
 
 QList<QSharedPointer<NetworkEdge> > NetworkNode::getFullEdgesIn() const
 {
+    createEdges();
+
     QList<QSharedPointer<NetworkEdge> > edgeList;
 
     for(int i = 0; i< m_lEdges.size(); i++) {
@@ -111,6 +117,8 @@ QList<QSharedPointer<NetworkEdge> > NetworkNode::getFullEdgesIn() const
 
 QList<QSharedPointer<NetworkEdge> > NetworkNode::getThresholdedEdgesIn() const
 {
+    createEdges();
+
     QList<QSharedPointer<NetworkEdge> > edgeList;
 
     for(int i = 0; i< m_lEdges.size(); i++) {
@@ -126,6 +134,8 @@ QList<QSharedPointer<NetworkEdge> > NetworkNode::getThresholdedEdgesIn() const
 
 QList<QSharedPointer<NetworkEdge> > NetworkNode::getFullEdgesOut() const
 {
+    createEdges();
+
     QList<QSharedPointer<NetworkEdge> > edgeList;
 
     for(int i = 0; i< m_lEdges.size(); i++) {
@@ -141,6 +151,8 @@ QList<QSharedPointer<NetworkEdge> > NetworkNode::getFullEdgesOut() const
 
 QList<QSharedPointer<NetworkEdge> > NetworkNode::getThresholdedEdgesOut() const
 {
+    createEdges();
+
     QList<QSharedPointer<NetworkEdge> > edgeList;
 
     for(int i = 0; i< m_lEdges.size(); i++) {
@@ -170,6 +182,8 @@ qint16 NetworkNode::getId() const
 
 qint16 NetworkNode::getFullDegree() const
 {
+    createEdges();
+
     return m_lEdges.size();
 }
 
@@ -177,6 +191,8 @@ qint16 NetworkNode::getFullDegree() const
 
 qint16 NetworkNode::getThresholdedDegree() const
 {
+    createEdges();
+
     qint16 degree = 0;
 
     for(int i = 0; i < m_lEdges.size(); i++) {
@@ -192,6 +208,8 @@ qint16 NetworkNode::getThresholdedDegree() const
 
 qint16 NetworkNode::getFullIndegree() const
 {
+    createEdges();
+
     qint16 degree = 0;
 
     for(int i = 0; i< m_lEdges.size(); i++) {
@@ -207,6 +225,8 @@ qint16 NetworkNode::getFullIndegree() const
 
 qint16 NetworkNode::getThresholdedIndegree() const
 {
+    createEdges();
+
     qint16 degree = 0;
 
     for(int i = 0; i< m_lEdges.size(); i++) {
@@ -222,6 +242,8 @@ qint16 NetworkNode::getThresholdedIndegree() const
 
 qint16 NetworkNode::getFullOutdegree() const
 {
+    createEdges();
+
     qint16 degree = 0;
 
     for(int i = 0; i< m_lEdges.size(); i++) {
@@ -237,6 +259,8 @@ qint16 NetworkNode::getFullOutdegree() const
 
 qint16 NetworkNode::getThresholdedOutdegree() const
 {
+    createEdges();
+
     qint16 degree = 0;
 
     for(int i = 0; i< m_lEdges.size(); i++) {
@@ -252,6 +276,8 @@ qint16 NetworkNode::getThresholdedOutdegree() const
 
 double NetworkNode::getFullStrength() const
 {
+    createEdges();
+
     double dStrength = 0.0;
 
     for(int i = 0; i < m_lEdges.size(); ++i) {
@@ -265,6 +291,8 @@ double NetworkNode::getFullStrength() const
 
 double NetworkNode::getThresholdedStrength() const
 {
+    createEdges();
+
     double dStrength = 0.0;
 
     for(int i = 0; i < m_lEdges.size(); ++i) {
@@ -280,6 +308,8 @@ double NetworkNode::getThresholdedStrength() const
 
 double NetworkNode::getFullInstrength() const
 {
+    createEdges();
+
     double dStrength = 0.0;
 
     for(int i = 0; i < m_lEdges.size(); ++i) {
@@ -295,6 +325,8 @@ double NetworkNode::getFullInstrength() const
 
 double NetworkNode::getThresholdedInstrength() const
 {
+    createEdges();
+
     double dStrength = 0.0;
 
     for(int i = 0; i < m_lEdges.size(); ++i) {
@@ -310,6 +342,8 @@ double NetworkNode::getThresholdedInstrength() const
 
 double NetworkNode::getFullOutstrength() const
 {
+    createEdges();
+
     double dStrength = 0.0;
 
     for(int i = 0; i < m_lEdges.size(); ++i) {
@@ -325,6 +359,8 @@ double NetworkNode::getFullOutstrength() const
 
 double NetworkNode::getThresholdedOutstrength() const
 {
+    createEdges();
+
     double dStrength = 0.0;
 
     for(int i = 0; i < m_lEdges.size(); ++i) {
@@ -352,6 +388,13 @@ bool NetworkNode::getHubStatus() const
 
 //=============================================================================================================
 
+void NetworkNode::setEdgeCreator(const std::function<void()>& createEdges)
+{
+    m_createEdges = createEdges;
+}
+
+//=============================================================================================================
+
 void NetworkNode::append(QSharedPointer<NetworkEdge> newEdge)
 {
     if(newEdge->getEndNodeID() != newEdge->getStartNodeID()) {
@@ -359,3 +402,14 @@ void NetworkNode::append(QSharedPointer<NetworkEdge> newEdge)
     }
 }
 
+//=============================================================================================================
+
+void NetworkNode::createEdges() const
+{
+    if(m_createEdges) {
+        // Cleared first, the creator appends to this node
+        std::function<void()> createEdges = m_createEdges;
+        m_createEdges = nullptr;
+        createEdges();
+    }
+}
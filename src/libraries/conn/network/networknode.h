@@ -49,6 +49,8 @@
 #include <QObject>
 #include <QSharedPointer>
 
+#include <functional>
+
 //=============================================================================================================
 // EIGEN INCLUDES
 //=============================================================================================================
@@ -278,7 +280,22 @@ public:
      */
     void append(QSharedPointer<NetworkEdge> newEdge);
 
+    //=========================================================================================================
+    /**
+     * Sets a function that adds the edges to this node the first time they or the node metrics are requested.
+     * Compact networks use it to create their edge views on demand.
+     *
+     * @param[in] createEdges    The function. Empty if the edges are already appended.
+     */
+    void setEdgeCreator(const std::function<void()>& createEdges);
+
 protected:
+    //=========================================================================================================
+    /**
+     * Calls the edge creator once, if set.
+     */
+    void createEdges() const;
+
     bool                                    m_bIsHub;       /**< Whether this node is a hub.*/
 
     qint16                                  m_iId;          /**< The node's ID.*/
@@ -286,6 +303,8 @@ protected:
     Eigen::RowVectorXf                      m_vecVert;      /**< The 3D position of the node.*/
 
     QList<QSharedPointer<NetworkEdge> >     m_lEdges;     /**< List with all incoming edges of the node.*/
+
+    mutable std::function<void()>           m_createEdges;  /**< Adds the edges on first request, empty once they exist.*/
 };
 
 //=============================================================================================================
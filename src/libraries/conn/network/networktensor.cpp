@@ -0,0 +1,393 @@
+//=============================================================================================================
+/**
+ * @file     networktensor.cpp
+ * @author   Christoph Dinh <christoph.dinh@mne-cpp.org>
+ * @since    2.1.0
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, Christoph Dinh. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief     NetworkTensor class definition.
+ *
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "networktensor.h"
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QDebug>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace CONNLIB;
+using namespace Eigen;
+
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+NetworkTensor::NetworkTensor(int iNumberNodes,
+                             int iNumberBins)
+: m_iNumberNodes(qMax(0, iNumberNodes))
+, m_dThreshold(0.0)
+, m_iMinMaxFreqBins(QPair<int,int>(-1,-1))
+, m_bThresholdedDirty(true)
+{
+    Index iNumberEdges = Index(m_iNumberNodes) * (m_iNumberNodes - 1) / 2;
+
+    m_matWeights = MatrixXd::Zero(iNumberEdges, qMax(1, iNumberBins));
+    m_vecAveragedWeights = VectorXd::Zero(iNumberEdges);
+}
+
+//=============================================================================================================
+
+int NetworkTensor::getNumberNodes() const
+{
+    return m_iNumberNodes;
+}
+
+//=============================================================================================================
+
+int NetworkTensor::getNumberBins() const
+{
+    return m_matWeights.cols();
+}
+
+//=============================================================================================================
+
+Index NetworkTensor::getNumberEdges() const
+{
+    return m_matWeights.rows();
+}
+
+//=============================================================================================================
+
+bool NetworkTensor::isEmpty() const
+{
+    return m_matWeights.rows() == 0;
+}
+
+//=============================================================================================================
+
+void NetworkTensor::setEdgeWeights(int i,
+                                   int j,
+                                   const VectorXd& vecWeights)
+{
+    if(i == j || i < 0 || j < 0 || i >= m_iNumberNodes || j >= m_iNumberNodes) {
+        qWarning() << "NetworkTensor::setEdgeWeights - Invalid node pair" << i << j;
+        return;
+    }
+
+    if(vecWeights.size() != m_matWeights.cols()) {
+        qWarning() << "NetworkTensor::setEdgeWeights - Expected" << m_matWeights.cols() << "bins, got" << vecWeights.size();
+        return;
+    }
+
+    Index iEdge = edgeIndex(i, j);
+    m_matWeights.row(iEdge) = vecWeights.transpose();
+
+    int iLowerBin, iNumberBins;
+    if(getBinRange(iLowerBin, iNumberBins)) {
+        m_vecAveragedWeights(iEdge) = vecWeights.segment(iLowerBin, iNumberBins).mean();
+    }
+
+    m_bThresholdedDirty = true;
+}
+
+//=============================================================================================================
+
+void NetworkTensor::setNodeWeights(int i,
+                                   const MatrixXd& matWeights)
+{
+    if(i < 0 || i >= m_iNumberNodes - 1) {
+        return;
+    }
+
+    if(matWeights.rows() != m_iNumberNodes - 1 - i || matWeights.cols() != m_matWeights.cols()) {
+        qWarning() << "NetworkTensor::setNodeWeights - Expected" << m_iNumberNodes - 1 - i << "x" << m_matWeights.cols() << "weights, got" << matWeights.rows() << "x" << matWeights.cols();
+        return;
+    }
+
+    // The edges of node i to all j > i are contiguous
+    Index iFirst = edgeIndex(i, i + 1);
+    m_matWeights.middleRows(iFirst, matWeights.rows()) = matWeights;
+
+    int iLowerBin, iNumberBins;
+    if(getBinRange(iLowerBin, iNumberBins)) {
+        m_vecAveragedWeights.segment(iFirst, matWeights.rows()) = matWeights.middleCols(iLowerBin, iNumberBins).rowwise().mean();
+    }
+
+    m_bThresholdedDirty = true;
+}
+
+//=============================================================================================================
+
+VectorXd NetworkTensor::getEdgeWeights(int i,
+                                       int j) const
+{
+    if(i == j || i < 0 || j < 0 || i >= m_iNumberNodes || j >= m_iNumberNodes) {
+        return VectorXd::Zero(m_matWeights.cols());
+    }
+
+    return m_matWeights.row(edgeIndex(i, j)).transpose();
+}
+
+//=============================================================================================================
+
+double NetworkTensor::getWeight(int i,
+                                int j) const
+{
+    if(i == j || i < 0 || j < 0 || i >= m_iNumberNodes || j >= m_iNumberNodes) {
+        return 0.0;
+    }
+
+    return m_vecAveragedWeights(edgeIndex(i, j));
+}
+
+//=============================================================================================================
+
+const MatrixXd& NetworkTensor::getWeights() const
+{
+    return m_matWeights;
+}
+
+//=============================================================================================================
+
+const VectorXd& NetworkTensor::getAveragedWeights() const
+{
+    return m_vecAveragedWeights;
+}
+
+//=============================================================================================================
+
+void NetworkTensor::setFrequencyBins(const QPair<int,int>& minMaxFreqBins)
+{
+    if(minMaxFreqBins.second < minMaxFreqBins.first || minMaxFreqBins.first < -1 || minMaxFreqBins.second < -1) {
+        return;
+    }
+
+    m_iMinMaxFreqBins = minMaxFreqBins;
+
+    updateAveragedWeights();
+}
+
+//=============================================================================================================
+
+const QPair<int,int>& NetworkTensor::getFrequencyBins() const
+{
+    return m_iMinMaxFreqBins;
+}
+
+//=============================================================================================================
+
+void NetworkTensor::setThreshold(double dThreshold)
+{
+    m_dThreshold = dThreshold;
+    m_bThresholdedDirty = true;
+}
+
+//=============================================================================================================
+
+double NetworkTensor::getThreshold() const
+{
+    return m_dThreshold;
+}
+
+//=============================================================================================================
+
+bool NetworkTensor::isActive(Index iEdge) const
+{
+    return std::fabs(m_vecAveragedWeights(iEdge)) >= m_dThreshold;
+}
+
+//=============================================================================================================
+
+const NetworkTensor::SparseMatrixType& NetworkTensor::getThresholdedEdges() const
+{
+    updateThresholdedEdges();
+
+    return m_matThresholded;
+}
+
+//=============================================================================================================
+
+VectorXi NetworkTensor::getThresholdedDegrees() const
+{
+    return getThresholdedIndegrees() + getThresholdedOutdegrees();
+}
+
+//=============================================================================================================
+
+VectorXi NetworkTensor::getThresholdedIndegrees() const
+{
+    updateThresholdedEdges();
+
+    VectorXi vecDegrees = VectorXi::Zero(m_iNumberNodes);
+
+    for(int i = 0; i < m_matThresholded.outerSize(); ++i) {
+        for(SparseMatrixType::InnerIterator it(m_matThresholded, i); it; ++it) {
+            vecDegrees(it.col())++;
+        }
+    }
+
+    return vecDegrees;
+}
+
+//=============================================================================================================
+
+VectorXi NetworkTensor::getThresholdedOutdegrees() const
+{
+    updateThresholdedEdges();
+
+    VectorXi vecDegrees(m_iNumberNodes);
+
+    for(int i = 0; i < m_iNumberNodes; ++i) {
+        vecDegrees(i) = int(m_matThresholded.outerIndexPtr()[i + 1] - m_matThresholded.outerIndexPtr()[i]);
+    }
+
+    return vecDegrees;
+}
+
+//=============================================================================================================
+
+MatrixXd NetworkTensor::getFullConnectivityMatrix(bool bGetMirroredVersion) const
+{
+    MatrixXd matDist = MatrixXd::Zero(m_iNumberNodes, m_iNumberNodes);
+
+    Index iEdge = 0;
+    for(int i = 0; i < m_iNumberNodes - 1; ++i) {
+        int iNumber = m_iNumberNodes - 1 - i;
+        matDist.row(i).tail(iNumber) = m_vecAveragedWeights.segment(iEdge, iNumber).transpose();
+
+        if(bGetMirroredVersion) {
+            matDist.col(i).tail(iNumber) = m_vecAveragedWeights.segment(iEdge, iNumber);
+        }
+
+        iEdge += iNumber;
+    }
+
+    return matDist;
+}
+
+//=============================================================================================================
+
+MatrixXd NetworkTensor::getThresholdedConnectivityMatrix(bool bGetMirroredVersion) const
+{
+    updateThresholdedEdges();
+
+    MatrixXd matDist = MatrixXd::Zero(m_iNumberNodes, m_iNumberNodes);
+
+    for(int i = 0; i < m_matThresholded.outerSize(); ++i) {
+        for(SparseMatrixType::InnerIterator it(m_matThresholded, i); it; ++it) {
+            matDist(i, it.col()) = it.value();
+
+            if(bGetMirroredVersion) {
+                matDist(it.col(), i) = it.value();
+            }
+        }
+    }
+
+    return matDist;
+}
+
+//=============================================================================================================
+
+void NetworkTensor::scaleAveragedWeights(double dFactor)
+{
+    m_vecAveragedWeights *= dFactor;
+    m_bThresholdedDirty = true;
+}
+
+//=============================================================================================================
+
+bool NetworkTensor::getBinRange(int& iLowerBin,
+                                int& iNumberBins) const
+{
+    int iBins = m_matWeights.cols();
+
+    if(m_iMinMaxFreqBins.first == -1 && m_iMinMaxFreqBins.second == -1) {
+        iLowerBin = 0;
+        iNumberBins = iBins;
+        return true;
+    }
+
+    // Same behavior as NetworkEdge: a lower bin outside of the weights keeps the current average
+    if(m_iMinMaxFreqBins.first < 0 || m_iMinMaxFreqBins.first >= iBins) {
+        return false;
+    }
+
+    iLowerBin = m_iMinMaxFreqBins.first;
+    iNumberBins = qMin(m_iMinMaxFreqBins.second, iBins - 1) - iLowerBin + 1;
+    return true;
+}
+
+//=============================================================================================================
+
+void NetworkTensor::updateAveragedWeights()
+{
+    int iLowerBin, iNumberBins;
+    if(getBinRange(iLowerBin, iNumberBins)) {
+        m_vecAveragedWeights = m_matWeights.middleCols(iLowerBin, iNumberBins).rowwise().mean();
+    }
+
+    m_bThresholdedDirty = true;
+}
+
+//=============================================================================================================
+
+void NetworkTensor::updateThresholdedEdges() const
+{
+    if(!m_bThresholdedDirty) {
+        return;
+    }
+
+    Index iNumberActive = (m_vecAveragedWeights.array().abs() >= m_dThreshold).count();
+
+    // The edges are already sorted by row and column, so the CSR matrix can be filled sequentially
+    m_matThresholded.resize(m_iNumberNodes, m_iNumberNodes);
+    m_matThresholded.setZero();
+    m_matThresholded.reserve(iNumberActive);
+
+    Index iEdge = 0;
+    for(int i = 0; i < m_iNumberNodes; ++i) {
+        m_matThresholded.startVec(i);
+
+        for(int j = i + 1; j < m_iNumberNodes; ++j, ++iEdge) {
+            if(std::fabs(m_vecAveragedWeights(iEdge)) >= m_dThreshold) {
+                m_matThresholded.insertBack(i, j) = m_vecAveragedWeights(iEdge);
+            }
+        }
+    }
+
+    m_matThresholded.finalize();
+    m_bThresholdedDirty = false;
+}
@@ -0,0 +1,355 @@
+//=============================================================================================================
+/**
+ * @file     networktensor.h
+ * @author   Christoph Dinh <christoph.dinh@mne-cpp.org>
+ * @since    2.1.0
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, Christoph Dinh. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief     NetworkTensor class declaration.
+ *
+ */
+
+#ifndef NETWORKTENSOR_H
+#define NETWORKTENSOR_H
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../conn_global.h"
+
+#include <utility>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QPair>
+#include <QSharedPointer>
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+
+//=============================================================================================================
+// DEFINE NAMESPACE CONNLIB
+//=============================================================================================================
+
+namespace CONNLIB {
+
+//=============================================================================================================
+/**
+ * Compact storage of a non-directional network. The weights of all node pairs i < j are kept in one dense
+ * pairs x frequency bins matrix in upper triangular order, so that an edge is found in O(1) and frequency band
+ * averaging and thresholding run vectorized over all edges. The thresholded edges are kept as a CSR matrix.
+ * Self connections are not stored.
+ *
+ * @brief Compact dense/CSR storage of a network.
+ */
+class CONNSHARED_EXPORT NetworkTensor
+{
+
+public:
+    typedef QSharedPointer<NetworkTensor> SPtr;            /**< Shared pointer type for NetworkTensor. */
+    typedef QSharedPointer<const NetworkTensor> ConstSPtr; /**< Const shared pointer type for NetworkTensor. */
+
+    typedef Eigen::SparseMatrix<double, Eigen::RowMajor> SparseMatrixType; /**< CSR matrix type of the thresholded edges. */
+
+    //=========================================================================================================
+    /**
+     * Constructs a NetworkTensor object with all weights set to zero.
+     *
+     * @param[in] iNumberNodes      The number of nodes.
+     * @param[in] iNumberBins       The number of frequency bins per edge.
+     */
+    explicit NetworkTensor(int iNumberNodes = 0,
+                           int iNumberBins = 1);
+
+    //=========================================================================================================
+    /**
+     * Returns the number of nodes.
+     *
+     * @return The number of nodes.
+     */
+    int getNumberNodes() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the number of frequency bins per edge.
+     *
+     * @return The number of frequency bins.
+     */
+    int getNumberBins() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the number of stored edges, i.e. the number of node pairs i < j.
+     *
+     * @return The number of edges.
+     */
+    Eigen::Index getNumberEdges() const;
+
+    //=========================================================================================================
+    /**
+     * Returns whether the tensor holds no edges.
+     *
+     * @return Whether the tensor is empty.
+     */
+    bool isEmpty() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the row of the edge between node i and node j in the weight matrix. The order of i and j does not
+     * matter. i and j must be different valid node indices.
+     *
+     * @param[in] i      The first node.
+     * @param[in] j      The second node.
+     *
+     * @return The edge index.
+     */
+    inline Eigen::Index edgeIndex(int i,
+                                  int j) const;
+
+    //=========================================================================================================
+    /**
+     * Sets the frequency resolved weights of the edge between node i and node j.
+     *
+     * @param[in] i              The first node.
+     * @param[in] j              The second node.
+     * @param[in] vecWeights     The weight per frequency bin.
+     */
+    void setEdgeWeights(int i,
+                        int j,
+                        const Eigen::VectorXd& vecWeights);
+
+    //=========================================================================================================
+    /**
+     * Sets the frequency resolved weights of all edges from node i to the nodes j > i at once.
+     *
+     * @param[in] i              The node.
+     * @param[in] matWeights     The weights. Row r holds the weights of the edge to node i + 1 + r.
+     */
+    void setNodeWeights(int i,
+                        const Eigen::MatrixXd& matWeights);
+
+    //=========================================================================================================
+    /**
+     * Returns the frequency resolved weights of the edge between node i and node j.
+     *
+     * @param[in] i      The first node.
+     * @param[in] j      The second node.
+     *
+     * @return The weight per frequency bin.
+     */
+    Eigen::VectorXd getEdgeWeights(int i,
+                                   int j) const;
+
+    //=========================================================================================================
+    /**
+     * Returns the weight of the edge between node i and node j averaged over the current frequency bins.
+     *
+     * @param[in] i      The first node.
+     * @param[in] j      The second node.
+     *
+     * @return The averaged weight.
+     */
+    double getWeight(int i,
+                     int j) const;
+
+    //=========================================================================================================
+    /**
+     * Returns the frequency resolved weights of all edges (edges x bins).
+     *
+     * @return The weight matrix.
+     */
+    const Eigen::MatrixXd& getWeights() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the averaged weights of all edges.
+     *
+     * @return The averaged weight per edge.
+     */
+    const Eigen::VectorXd& getAveragedWeights() const;
+
+    //=========================================================================================================
+    /**
+     * Sets the frequency bins to average from/to and updates the averaged weights and the thresholded edges.
+     * (-1,-1) averages over all bins.
+     *
+     * @param[in] minMaxFreqBins     The new lower/upper bin to average from/to.
+     */
+    void setFrequencyBins(const QPair<int,int>& minMaxFreqBins);
+
+    //=========================================================================================================
+    /**
+     * Returns the current frequency bins to average from/to.
+     *
+     * @return The current lower/upper bin.
+     */
+    const QPair<int,int>& getFrequencyBins() const;
+
+    //=========================================================================================================
+    /**
+     * Sets the threshold and updates the thresholded edges. An edge is kept if its absolute averaged weight is
+     * at least the threshold.
+     *
+     * @param[in] dThreshold     The new threshold.
+     */
+    void setThreshold(double dThreshold);
+
+    //=========================================================================================================
+    /**
+     * Returns the current threshold.
+     *
+     * @return The current threshold.
+     */
+    double getThreshold() const;
+
+    //=========================================================================================================
+    /**
+     * Returns whether the edge is part of the thresholded network.
+     *
+     * @param[in] iEdge      The edge index.
+     *
+     * @return Whether the edge is active.
+     */
+    bool isActive(Eigen::Index iEdge) const;
+
+    //=========================================================================================================
+    /**
+     * Returns the thresholded edges as upper triangular CSR matrix of averaged weights.
+     *
+     * @return The thresholded edges.
+     */
+    const SparseMatrixType& getThresholdedEdges() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the number of thresholded edges per node.
+     *
+     * @return The thresholded degree per node.
+     */
+    Eigen::VectorXi getThresholdedDegrees() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the number of thresholded edges ending at each node, i.e., the edges to nodes with a lower index.
+     *
+     * @return The thresholded indegree per node.
+     */
+    Eigen::VectorXi getThresholdedIndegrees() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the number of thresholded edges starting at each node, i.e., the edges to nodes with a higher index.
+     *
+     * @return The thresholded outdegree per node.
+     */
+    Eigen::VectorXi getThresholdedOutdegrees() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the full connectivity matrix of averaged weights.
+     *
+     * @param[in] bGetMirroredVersion    Whether to mirror the upper part into the lower part. Default is true.
+     *
+     * @return The full connectivity matrix.
+     */
+    Eigen::MatrixXd getFullConnectivityMatrix(bool bGetMirroredVersion = true) const;
+
+    //=========================================================================================================
+    /**
+     * Returns the thresholded connectivity matrix of averaged weights.
+     *
+     * @param[in] bGetMirroredVersion    Whether to mirror the upper part into the lower part. Default is true.
+     *
+     * @return The thresholded connectivity matrix.
+     */
+    Eigen::MatrixXd getThresholdedConnectivityMatrix(bool bGetMirroredVersion = true) const;
+
+    //=========================================================================================================
+    /**
+     * Scales the averaged weights, e.g. to normalize them. The frequency resolved weights are not changed.
+     *
+     * @param[in] dFactor    The scaling factor.
+     */
+    void scaleAveragedWeights(double dFactor);
+
+protected:
+    //=========================================================================================================
+    /**
+     * Returns the bins to average over for the current frequency bins.
+     *
+     * @param[out] iLowerBin     The first bin.
+     * @param[out] iNumberBins   The number of bins.
+     *
+     * @return Whether the current frequency bins select any bins.
+     */
+    bool getBinRange(int& iLowerBin,
+                     int& iNumberBins) const;
+
+    //=========================================================================================================
+    /**
+     * Recomputes the averaged weights of all edges from the current frequency bins.
+     */
+    void updateAveragedWeights();
+
+    //=========================================================================================================
+    /**
+     * Rebuilds the CSR matrix of the thresholded edges if it is out of date.
+     */
+    void updateThresholdedEdges() const;
+
+    int                         m_iNumberNodes;         /**< The number of nodes.*/
+    double                      m_dThreshold;           /**< The current threshold.*/
+    QPair<int,int>              m_iMinMaxFreqBins;      /**< The lower/upper bin to average from/to. (-1,-1) means all bins.*/
+
+    Eigen::MatrixXd             m_matWeights;           /**< The frequency resolved weights, edges x bins in upper triangular order.*/
+    Eigen::VectorXd             m_vecAveragedWeights;   /**< The averaged weight per edge.*/
+    mutable SparseMatrixType    m_matThresholded;       /**< The thresholded edges as upper triangular CSR matrix. Rebuilt on demand.*/
+    mutable bool                m_bThresholdedDirty;    /**< Whether the thresholded edges need to be rebuilt.*/
+};
+
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline Eigen::Index NetworkTensor::edgeIndex(int i,
+                                             int j) const
+{
+    if(i > j) {
+        std::swap(i, j);
+    }
+
+    return Eigen::Index(i) * (2 * Eigen::Index(m_iNumberNodes) - i - 1) / 2 + (j - i - 1);
+}
+} // namespace CONNLIB
+
+#endif // NETWORKTENSOR_H
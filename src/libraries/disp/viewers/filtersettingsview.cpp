@@ -99,6 +99,8 @@ FilterSettingsView::FilterSettingsView(const QString& sSettingsPath,
     //Connect GUI elements
     connect(m_pUi->m_pCheckBoxActivateFilter, &QCheckBox::toggled,
             this, &FilterSettingsView::onFilterActivationChanged);
+    connect(m_pUi->m_pCheckBoxLowLatency, &QCheckBox::toggled,
+            this, &FilterSettingsView::onFilterLowLatencyChanged);
     connect(m_pUi->m_pPushButtonShowFilterOptions, &QPushButton::clicked,
             this, &FilterSettingsView::onShowFilterView);
     connect(m_pUi->m_pDoubleSpinBoxFrom, &QDoubleSpinBox::editingFinished,
@@ -133,6 +135,13 @@ bool FilterSettingsView::getFilterActive()
 
 //=============================================================================================================
 
+bool FilterSettingsView::getFilterLowLatency()
+{
+    return m_pUi->m_pCheckBoxLowLatency->isChecked();
+}
+
+//=============================================================================================================
+
 void FilterSettingsView::setSamplingRate(double dSFreq)
 {
     //Update min max of spin boxes to nyquist
@@ -163,6 +172,7 @@ void FilterSettingsView::saveSettings()
     QSettings settings("MNECPP");
 
     settings.setValue(m_sSettingsPath + QString("/FilterSettingsView/filterActivated"), m_pUi->m_pCheckBoxActivateFilter->isChecked());
+    settings.setValue(m_sSettingsPath + QString("/FilterSettingsView/filterLowLatency"), m_pUi->m_pCheckBoxLowLatency->isChecked());
     settings.setValue(m_sSettingsPath + QString("/FilterSettingsView/filterFrom"), m_pUi->m_pDoubleSpinBoxFrom->value());
     settings.setValue(m_sSettingsPath + QString("/FilterSettingsView/filterTo"), m_pUi->m_pDoubleSpinBoxTo->value());
     settings.setValue(m_sSettingsPath + QString("/FilterSettingsView/filterChannelType"), m_pUi->m_pcomboBoxChannelTypes->currentText());
@@ -179,6 +189,7 @@ void FilterSettingsView::loadSettings()
     QSettings settings("MNECPP");
 
     m_pUi->m_pCheckBoxActivateFilter->setChecked(settings.value(m_sSettingsPath + QString("/FilterSettingsView/filterActivated"), false).toBool());
+    m_pUi->m_pCheckBoxLowLatency->setChecked(settings.value(m_sSettingsPath + QString("/FilterSettingsView/filterLowLatency"), false).toBool());
     m_pUi->m_pDoubleSpinBoxTo->setValue(settings.value(m_sSettingsPath + QString("/FilterSettingsView/filterTo"), 0).toDouble());
     m_pUi->m_pDoubleSpinBoxFrom->setValue(settings.value(m_sSettingsPath + QString("/FilterSettingsView/filterFrom"), 0).toDouble());
     m_pUi->m_pcomboBoxChannelTypes->setCurrentText(settings.value(m_sSettingsPath + QString("/FilterSettingsView/filterChannelType"), "All").toString());
@@ -204,8 +215,11 @@ void FilterSettingsView::updateProcessingMode(ProcessingMode mode)
 {
     switch(mode) {
         case ProcessingMode::Offline:
+            // Offline data is filtered zero-phase as a whole, there is no latency to save
+            m_pUi->m_pCheckBoxLowLatency->hide();
             break;
         default: // default is realtime mode
+            m_pUi->m_pCheckBoxLowLatency->show();
             break;
     }
 }
@@ -234,6 +248,15 @@ void FilterSettingsView::onFilterActivationChanged()
 
 //=============================================================================================================
 
+void FilterSettingsView::onFilterLowLatencyChanged()
+{
+    emit filterLowLatencyChanged(m_pUi->m_pCheckBoxLowLatency->isChecked());
+
+    saveSettings();
+}
+
+//=============================================================================================================
+
 void FilterSettingsView::onFilterFromChanged()
 {
     m_pFilterView->setFrom(m_pUi->m_pDoubleSpinBoxFrom->value());
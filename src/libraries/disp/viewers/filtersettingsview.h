@@ -117,6 +117,12 @@ public:
      */
     bool getFilterActive();
 
+    //=========================================================================================================
+    /**
+     * Returns true if the low latency (causal IIR) filter mode is selected.
+     */
+    bool getFilterLowLatency();
+
     //=========================================================================================================
     /**
      * Sets the sampling frequency and setups this view accrodingly.
@@ -150,6 +156,12 @@ signals:
      */
     void filterActivationChanged(bool activated);
 
+    //=========================================================================================================
+    /**
+     * Signal emited when the low latency box's state is changed.
+     */
+    void filterLowLatencyChanged(bool lowLatency);
+
 protected:
     //=========================================================================================================
     /**
@@ -179,6 +191,12 @@ protected:
      */
     void onFilterActivationChanged();
 
+    //=========================================================================================================
+    /**
+     * This function is called whenever the low latency mode changed
+     */
+    void onFilterLowLatencyChanged();
+
     //=========================================================================================================
     /**
      * This function is called whenever the filter parameters From changed
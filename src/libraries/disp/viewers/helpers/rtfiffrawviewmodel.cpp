@@ -92,6 +92,7 @@ RtFiffRawViewModel::RtFiffRawViewModel(QObject *parent)
 , m_bIsFreezed(false)
 , m_bDrawFilterFront(true)
 , m_bPerformFiltering(false)
+, m_bFilterLowLatency(false)
 , m_bTriggerDetectionActive(false)
 , m_fSps(1024.0f)
 , m_dTriggerThreshold(0.01)
@@ -524,13 +525,14 @@ void RtFiffRawViewModel::addData(const QList<MatrixXd> &data)
 
             //Perform SPHARA on filtered data after actual filtering - SPHARA should be applied on the best possible data
             if(doSphara) {
-                if(m_iCurrentSample-m_iMaxFilterLength/2 >= 0) {
-                    m_matDataFiltered.block(0, m_iCurrentSample-m_iMaxFilterLength/2, nRow, nCol) = m_matSparseSpharaMult * m_matDataFiltered.block(0, m_iCurrentSample-m_iMaxFilterLength/2, nRow, nCol);
+                const int iFilterDelay = getCurrentOverlapAddDelay();
+                if(m_iCurrentSample-iFilterDelay >= 0) {
+                    m_matDataFiltered.block(0, m_iCurrentSample-iFilterDelay, nRow, nCol) = m_matSparseSpharaMult * m_matDataFiltered.block(0, m_iCurrentSample-iFilterDelay, nRow, nCol);
                 }
                 else {
-                    if(m_iCurrentSample-m_iMaxFilterLength/2 < 0) {
+                    if(m_iCurrentSample-iFilterDelay < 0) {
                         m_matDataFiltered.block(0, 0, nRow, nCol) = m_matSparseSpharaMult * m_matDataFiltered.block(0, 0, nRow, nCol);
-                        int iResidual = m_iResidual+m_iMaxFilterLength/2;
+                        int iResidual = m_iResidual+iFilterDelay;
                         m_matDataFiltered.block(0, m_matDataFiltered.cols()-iResidual, nRow, iResidual) = m_matSparseSpharaMult * m_matDataFiltered.block(0, m_matDataFiltered.cols()-iResidual, nRow, iResidual);
                     }
                 }
@@ -912,6 +914,8 @@ void RtFiffRawViewModel::setFilter(QList<FilterKernel> filterData)
     m_matOverlap.conservativeResize(m_pFiffInfo->chs.size(), m_iMaxFilterLength);
     m_matOverlap.setZero();
 
+    m_iirFilter.setSections(RTPROCESSINGLIB::StreamingIirFilter::designFromKernels(m_filterKernel));
+
     m_bDrawFilterFront = false;
 
     //Filter all visible data channels at once
@@ -927,6 +931,17 @@ void RtFiffRawViewModel::setFilterActive(bool state)
 
 //=============================================================================================================
 
+void RtFiffRawViewModel::setFilterLowLatency(bool state)
+{
+    m_bFilterLowLatency = state;
+
+    m_iirFilter.reset();
+    m_matOverlap.setZero();
+    m_bDrawFilterFront = false;
+}
+
+//=============================================================================================================
+
 void RtFiffRawViewModel::setBackgroundColor(const QColor& color)
 {
     m_colBackground = color;
@@ -1195,102 +1210,128 @@ void RtFiffRawViewModel::filterDataBlock(const MatrixXd &data, int iDataIndex)
 {
     //std::cout<<"START RtFiffRawViewModel::filterDataBlock"<<std::endl;
 
-    if(iDataIndex >= m_matDataFiltered.cols() || data.cols() < m_iMaxFilterLength) {
+    if(iDataIndex >= m_matDataFiltered.cols()) {
         return;
     }
 
-    //Generate QList structure which can be handled by the QConcurrent framework
-    QList<QPair<QList<FilterKernel>,QPair<int,RowVectorXd> > > timeData;
+    QList<int> filterChannelIndex;
     QList<int> notFilterChannelIndex;
 
     for(qint32 i = 0; i < data.rows(); ++i) {
         if(m_filterChannelList.contains(m_pFiffInfo->chs.at(i).ch_name)) {
-            timeData.append(QPair<QList<FilterKernel>,QPair<int,RowVectorXd> >(m_filterKernel,QPair<int,RowVectorXd>(i,data.row(i))));
+            filterChannelIndex.append(i);
         } else {
             notFilterChannelIndex.append(i);
             }
     }
 
-    //Do the concurrent filtering
-    if(!timeData.isEmpty()) {
-        QFuture<void> future = QtConcurrent::map(timeData,
-                                             doFilterPerChannelRTMSA);
+    if(m_bFilterLowLatency) {
+        //The IIR filter keeps its state between blocks and has no block delay, so the result goes right where the raw data is
+        RowVectorXi vecPicks(filterChannelIndex.size());
+        for(int r = 0; r < filterChannelIndex.size(); ++r) {
+            vecPicks[r] = filterChannelIndex.at(r);
+        }
 
-        future.waitForFinished();
+        m_iirFilter.setPicks(vecPicks);
+        if(vecPicks.size() > 0) {
+            m_iirFilter.process(data, m_matFilterBlock);
+            m_matDataFiltered.block(0, iDataIndex, data.rows(), data.cols()) = m_matFilterBlock;
+        } else {
+            m_matDataFiltered.block(0, iDataIndex, data.rows(), data.cols()) = data;
+        }
+        return;
+    }
+
+    if(data.cols() < m_iMaxFilterLength) {
+        return;
+    }
+
+    //Do the concurrent filtering. All channels share one kernel spectrum and the output buffer is reused.
+    if(!filterChannelIndex.isEmpty()) {
+        RowVectorXi vecPicks(filterChannelIndex.size());
+        for(int r = 0; r < filterChannelIndex.size(); ++r) {
+            vecPicks[r] = filterChannelIndex.at(r);
+        }
+
+        m_firEngine.setFilterKernels(m_filterKernel);
+        m_firEngine.filterBlock(data, vecPicks, m_matFilterBlock);
 
         //Do the overlap add method and store in m_matDataFiltered
         int iFilterDelay = m_iMaxFilterLength/2;
-        int iFilteredNumberCols = timeData.at(0).second.second.cols();
+        int iFilteredNumberCols = m_matFilterBlock.cols();
+        RowVectorXd tempData;
+
+        for(int r = 0; r<filterChannelIndex.size(); ++r) {
+            const int iRow = filterChannelIndex.at(r);
 
-        for(int r = 0; r<timeData.size(); ++r) {
             if(iDataIndex+2*data.cols() > m_matDataRaw.cols()) {
                 //Handle last data block
                 //std::cout<<"Handle last data block"<<std::endl;
 
                 if(m_bDrawFilterFront) {
                     //Get the currently filtered data. This data has a delay of filterLength/2 in front and back.
-                    RowVectorXd tempData = timeData.at(r).second.second;
+                    tempData = m_matFilterBlock.row(iRow);
 
                     //Perform the actual overlap add by adding the last filterlength data to the newly filtered one
-                    tempData.head(m_iMaxFilterLength) += m_matOverlap.row(timeData.at(r).second.first);
+                    tempData.head(m_iMaxFilterLength) += m_matOverlap.row(iRow);
 
                     //Write the newly calulated filtered data to the filter data matrix. Keep in mind that the current block also effect last part of the last block (begin at dataIndex-iFilterDelay).
                     int start = iDataIndex-iFilterDelay < 0 ? 0 : iDataIndex-iFilterDelay;
-                    m_matDataFiltered.row(timeData.at(r).second.first).segment(start,iFilteredNumberCols-m_iMaxFilterLength) = tempData.head(iFilteredNumberCols-m_iMaxFilterLength);
+                    m_matDataFiltered.row(iRow).segment(start,iFilteredNumberCols-m_iMaxFilterLength) = tempData.head(iFilteredNumberCols-m_iMaxFilterLength);
                 } else {
                     //Perform this else case everytime the filter was changed. Do not begin to plot from dataIndex-iFilterDelay because the impsulse response and m_matOverlap do not match with the new filter anymore.
-                    m_matDataFiltered.row(timeData.at(r).second.first).segment(iDataIndex-iFilterDelay,m_iMaxFilterLength) = timeData.at(r).second.second.segment(m_iMaxFilterLength,m_iMaxFilterLength);
-                    m_matDataFiltered.row(timeData.at(r).second.first).segment(iDataIndex+iFilterDelay,iFilteredNumberCols-2*m_iMaxFilterLength) = timeData.at(r).second.second.segment(m_iMaxFilterLength,iFilteredNumberCols-2*m_iMaxFilterLength);
+                    m_matDataFiltered.row(iRow).segment(iDataIndex-iFilterDelay,m_iMaxFilterLength) = m_matFilterBlock.row(iRow).segment(m_iMaxFilterLength,m_iMaxFilterLength);
+                    m_matDataFiltered.row(iRow).segment(iDataIndex+iFilterDelay,iFilteredNumberCols-2*m_iMaxFilterLength) = m_matFilterBlock.row(iRow).segment(m_iMaxFilterLength,iFilteredNumberCols-2*m_iMaxFilterLength);
                 }
 
                 //Refresh the m_matOverlap with the new calculated filtered data.
-                m_matOverlap.row(timeData.at(r).second.first) = timeData.at(r).second.second.tail(m_iMaxFilterLength);
+                m_matOverlap.row(iRow) = m_matFilterBlock.row(iRow).tail(m_iMaxFilterLength);
             } else if(iDataIndex == 0) {
                 //Handle first data block
                 //std::cout<<"Handle first data block"<<std::endl;
 
                 if(m_bDrawFilterFront) {
                     //Get the currently filtered data. This data has a delay of filterLength/2 in front and back.
-                    RowVectorXd tempData = timeData.at(r).second.second;
+                    tempData = m_matFilterBlock.row(iRow);
 
                     //Add newly calculate data to the tail of the current filter data matrix
-                    m_matDataFiltered.row(timeData.at(r).second.first).segment(m_matDataFiltered.cols()-iFilterDelay-m_iResidual, iFilterDelay) = tempData.head(iFilterDelay) + m_matOverlap.row(timeData.at(r).second.first).head(iFilterDelay);
+                    m_matDataFiltered.row(iRow).segment(m_matDataFiltered.cols()-iFilterDelay-m_iResidual, iFilterDelay) = tempData.head(iFilterDelay) + m_matOverlap.row(iRow).head(iFilterDelay);
 
                     //Perform the actual overlap add by adding the last filterlength data to the newly filtered one
-                    tempData.head(m_iMaxFilterLength) += m_matOverlap.row(timeData.at(r).second.first);
-                    m_matDataFiltered.row(timeData.at(r).second.first).head(iFilteredNumberCols-m_iMaxFilterLength-iFilterDelay) = tempData.segment(iFilterDelay,iFilteredNumberCols-m_iMaxFilterLength-iFilterDelay);
+                    tempData.head(m_iMaxFilterLength) += m_matOverlap.row(iRow);
+                    m_matDataFiltered.row(iRow).head(iFilteredNumberCols-m_iMaxFilterLength-iFilterDelay) = tempData.segment(iFilterDelay,iFilteredNumberCols-m_iMaxFilterLength-iFilterDelay);
 
                     //Copy residual data from the front to the back. The residual is != 0 if the chosen block size cannot be evenly fit into the matrix size
-                    m_matDataFiltered.row(timeData.at(r).second.first).tail(m_iResidual) = m_matDataFiltered.row(timeData.at(r).second.first).head(m_iResidual);
+                    m_matDataFiltered.row(iRow).tail(m_iResidual) = m_matDataFiltered.row(iRow).head(m_iResidual);
                 } else {
                     //Perform this else case everytime the filter was changed. Do not begin to plot from dataIndex-iFilterDelay because the impsulse response and m_matOverlap do not match with the new filter anymore.
-                    m_matDataFiltered.row(timeData.at(r).second.first).head(m_iMaxFilterLength) = timeData.at(r).second.second.segment(m_iMaxFilterLength,m_iMaxFilterLength);
-                    m_matDataFiltered.row(timeData.at(r).second.first).segment(iFilterDelay,iFilteredNumberCols-2*m_iMaxFilterLength) = timeData.at(r).second.second.segment(m_iMaxFilterLength,iFilteredNumberCols-2*m_iMaxFilterLength);
+                    m_matDataFiltered.row(iRow).head(m_iMaxFilterLength) = m_matFilterBlock.row(iRow).segment(m_iMaxFilterLength,m_iMaxFilterLength);
+                    m_matDataFiltered.row(iRow).segment(iFilterDelay,iFilteredNumberCols-2*m_iMaxFilterLength) = m_matFilterBlock.row(iRow).segment(m_iMaxFilterLength,iFilteredNumberCols-2*m_iMaxFilterLength);
                 }
 
                 //Refresh the m_matOverlap with the new calculated filtered data.
-                m_matOverlap.row(timeData.at(r).second.first) = timeData.at(r).second.second.tail(m_iMaxFilterLength);
+                m_matOverlap.row(iRow) = m_matFilterBlock.row(iRow).tail(m_iMaxFilterLength);
             } else {
                 //Handle middle data blocks
                 //std::cout<<"Handle middle data block"<<std::endl;
 
                 if(m_bDrawFilterFront) {
                     //Get the currently filtered data. This data has a delay of filterLength/2 in front and back.
-                    RowVectorXd tempData = timeData.at(r).second.second;
+                    tempData = m_matFilterBlock.row(iRow);
 
                     //Perform the actual overlap add by adding the last filterlength data to the newly filtered one
-                    tempData.head(m_iMaxFilterLength) += m_matOverlap.row(timeData.at(r).second.first);
+                    tempData.head(m_iMaxFilterLength) += m_matOverlap.row(iRow);
 
                     //Write the newly calulated filtered data to the filter data matrix. Keep in mind that the current block also effect last part of the last block (begin at dataIndex-iFilterDelay).
-                    m_matDataFiltered.row(timeData.at(r).second.first).segment(iDataIndex-iFilterDelay,iFilteredNumberCols-m_iMaxFilterLength) = tempData.head(iFilteredNumberCols-m_iMaxFilterLength);
+                    m_matDataFiltered.row(iRow).segment(iDataIndex-iFilterDelay,iFilteredNumberCols-m_iMaxFilterLength) = tempData.head(iFilteredNumberCols-m_iMaxFilterLength);
                 } else {
                     //Perform this else case everytime the filter was changed. Do not begin to plot from dataIndex-iFilterDelay because the impsulse response and m_matOverlap do not match with the new filter anymore.
-                    m_matDataFiltered.row(timeData.at(r).second.first).segment(iDataIndex-iFilterDelay,m_iMaxFilterLength).setZero();// = timeData.at(r).second.second.segment(m_iMaxFilterLength,m_iMaxFilterLength);
-                    m_matDataFiltered.row(timeData.at(r).second.first).segment(iDataIndex+iFilterDelay,iFilteredNumberCols-2*m_iMaxFilterLength) = timeData.at(r).second.second.segment(m_iMaxFilterLength,iFilteredNumberCols-2*m_iMaxFilterLength);
+                    m_matDataFiltered.row(iRow).segment(iDataIndex-iFilterDelay,m_iMaxFilterLength).setZero();// = m_matFilterBlock.row(iRow).segment(m_iMaxFilterLength,m_iMaxFilterLength);
+                    m_matDataFiltered.row(iRow).segment(iDataIndex+iFilterDelay,iFilteredNumberCols-2*m_iMaxFilterLength) = m_matFilterBlock.row(iRow).segment(m_iMaxFilterLength,iFilteredNumberCols-2*m_iMaxFilterLength);
                 }
 
                 //Refresh the m_matOverlap with the new calculated filtered data.
-                m_matOverlap.row(timeData.at(r).second.first) = timeData.at(r).second.second.tail(m_iMaxFilterLength);
+                m_matOverlap.row(iRow) = m_matFilterBlock.row(iRow).tail(m_iMaxFilterLength);
             }
         }
     }
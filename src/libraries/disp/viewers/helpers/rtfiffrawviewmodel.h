@@ -48,6 +48,8 @@
 #include <fiff/fiff_proj.h>
 
 #include <dsp/filterkernel.h>
+#include <dsp/rt/rt_fir_engine.h>
+#include <dsp/rt/rt_streaming_iir.h>
 
 //=============================================================================================================
 // QT INCLUDES
@@ -351,6 +353,15 @@ public:
      */
     void setFilterActive(bool state);
 
+    //=========================================================================================================
+    /**
+     * Set the low latency filter mode. A causal Butterworth IIR filter with the band of the current filter is
+     * applied instead of the zero-phase FIR filter, so the filtered data is shown without filter delay.
+     *
+     * @param[in] state    low latency on/off flag.
+     */
+    void setFilterLowLatency(bool state);
+
     //=========================================================================================================
     /**
      * Set the background color
@@ -596,6 +607,7 @@ private:
     bool                                m_bIsFreezed;                               /**< Display is freezed. */
     bool                                m_bDrawFilterFront;                         /**< Flag whether to plot/write the delayed frontal part of the filtered signal. This flag is necessary to get rid of nasty signal jumps when changing the filter parameters. */
     bool                                m_bPerformFiltering;                        /**< Flag whether to activate/deactivate filtering. */
+    bool                                m_bFilterLowLatency;                        /**< Flag whether to filter with the causal IIR filter instead of the FIR filter. */
     bool                                m_bTriggerDetectionActive;                  /**< Trigger detection activation state. */
     float                               m_fSps;                                     /**< Sampling rate. */
     double                              m_dTriggerThreshold;                        /**< Trigger detection threshold. */
@@ -626,6 +638,9 @@ private:
     MatrixXdR                           m_matDataRawFreeze;                         /**< The raw data in freeze mode. */
     MatrixXdR                           m_matDataFilteredFreeze;                    /**< The raw filtered data in freeze mode. */
     Eigen::MatrixXd                     m_matOverlap;                               /**< Last overlap block for the back. */
+    Eigen::MatrixXd                     m_matFilterBlock;                           /**< Reused output of the streaming filter, one block plus the filter order. */
+    RTPROCESSINGLIB::FirFilterEngine    m_firEngine;                                /**< Streaming filter engine sharing one kernel spectrum across channels. */
+    RTPROCESSINGLIB::StreamingIirFilter m_iirFilter;                                /**< Stateful IIR filter used in low latency mode. */
 
     Eigen::VectorXi                     m_vecIndicesFirstVV;                        /**< The indices of the channels to pick for the first SPHARA operator in case of a VectorView system.*/
     Eigen::VectorXi                     m_vecIndicesSecondVV;                       /**< The indices of the channels to pick for the second SPHARA operator in case of a VectorView system.*/
@@ -706,7 +721,7 @@ inline qint32 RtFiffRawViewModel::getCurrentSampleIndex() const
     }
 
     if(!m_filterKernel.isEmpty() && m_bPerformFiltering) {
-        return m_iCurrentSample-m_iMaxFilterLength/2;
+        return m_iCurrentSample-getCurrentOverlapAddDelay();
     }
 
     return m_iCurrentSample;
@@ -837,7 +852,7 @@ inline bool RtFiffRawViewModel::triggerDetectionActive() const
 
 inline int RtFiffRawViewModel::getCurrentOverlapAddDelay() const
 {
-    if(!m_filterKernel.isEmpty())
+    if(!m_filterKernel.isEmpty() && !m_bFilterLowLatency)
         return m_iMaxFilterLength/2;
     else
         return 0;
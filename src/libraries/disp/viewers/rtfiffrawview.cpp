@@ -463,6 +463,13 @@ void RtFiffRawView::setFilterActive(bool state)
 
 //=============================================================================================================
 
+void RtFiffRawView::setFilterLowLatency(bool state)
+{
+    m_pModel->setFilterLowLatency(state);
+}
+
+//=============================================================================================================
+
 void RtFiffRawView::setFilterChannelType(const QString &channelType)
 {
     m_pModel->setFilterChannelType(channelType);
@@ -335,6 +335,14 @@ public:
      */
     void setFilterActive(bool state);
 
+    //=========================================================================================================
+    /**
+     * Filter latency mode changed
+     *
+     * @param[in] state    true to filter with a causal IIR filter without filter delay.
+     */
+    void setFilterLowLatency(bool state);
+
     //=========================================================================================================
     /**
      * Sets the type of channel which are to be filtered
@@ -251,8 +251,8 @@ NetworkTreeItem* BrainTreeModel::addNetwork(const CONNLIB::Network &network, con
     this->appendRow(item);
 
     qDebug() << "BrainTreeModel: Added network" << displayName
-             << "with" << network.getNodes().size() << "nodes and"
-             << network.getFullEdges().size() << "edges";
+             << "with" << network.getNumberNodes() << "nodes and"
+             << network.getNumberFullEdges() << "edges";
 
     return item;
 }
@@ -309,21 +309,23 @@ void NetworkObject::buildNodeInstances()
         return;
     }
 
-    const auto &nodes = m_network.getNodes();
+    // Positions and degrees are read directly, so compact networks do not create node edges
+    const MatrixXf matVert = m_network.getNodeVertices();
     qint16 iMaxDegree = m_network.getMinMaxThresholdedDegrees().second;
     if (iMaxDegree == 0) iMaxDegree = 1;
 
+    VectorXi vecDegrees = m_network.getThresholdedDegrees();
+
     VisualizationInfo vizInfo = m_network.getVisualizationInfo();
 
     std::vector<InstanceData> instances;
-    instances.reserve(nodes.size());
+    instances.reserve(matVert.rows());
 
-    for (int i = 0; i < nodes.size(); ++i) {
-        qint16 degree = nodes[i]->getThresholdedDegree();
+    for (int i = 0; i < matVert.rows() && i < vecDegrees.size(); ++i) {
+        qint16 degree = vecDegrees(i);
         if (degree == 0) continue;
 
-        const RowVectorXf &vert = nodes[i]->getVert();
-        QVector3D pos(vert(0), vert(1), vert(2));
+        QVector3D pos(matVert(i, 0), matVert(i, 1), matVert(i, 2));
 
         // Scale: nodes with higher degree are larger
         // Range: 0.0006 to 0.005 (same as disp3D)
@@ -378,8 +380,33 @@ void NetworkObject::buildEdgeInstances()
         return;
     }
 
-    const auto &edges = m_network.getThresholdedEdges();
-    const auto &nodes = m_network.getNodes();
+    const MatrixXf matVert = m_network.getNodeVertices();
+
+    // Collect the active edges. Compact networks are read from their CSR matrix without creating edge objects.
+    struct ActiveEdge {
+        int iStart;
+        int iEnd;
+        double dWeight;
+    };
+    std::vector<ActiveEdge> edges;
+
+    if (m_network.isCompact()) {
+        const NetworkTensor::SparseMatrixType &matEdges = m_network.getTensor().getThresholdedEdges();
+        edges.reserve(matEdges.nonZeros());
+        for (int i = 0; i < matEdges.outerSize(); ++i) {
+            for (NetworkTensor::SparseMatrixType::InnerIterator it(matEdges, i); it; ++it) {
+                edges.push_back({i, int(it.col()), it.value()});
+            }
+        }
+    } else {
+        const auto &lEdges = m_network.getThresholdedEdges();
+        edges.reserve(lEdges.size());
+        for (const auto &edge : lEdges) {
+            if (edge->isActive()) {
+                edges.push_back({edge->getStartNodeID(), edge->getEndNodeID(), edge->getWeight()});
+            }
+        }
+    }
 
     double dMaxWeight = m_network.getMinMaxThresholdedWeights().second;
     double dMinWeight = m_network.getMinMaxThresholdedWeights().first;
@@ -391,24 +418,18 @@ void NetworkObject::buildEdgeInstances()
     std::vector<InstanceData> instances;
     instances.reserve(edges.size());
 
-    for (int i = 0; i < edges.size(); ++i) {
-        auto &edge = edges[i];
-        if (!edge->isActive()) continue;
-
-        int iStart = edge->getStartNodeID();
-        int iEnd = edge->getEndNodeID();
-
-        if (iStart < 0 || iStart >= nodes.size() || iEnd < 0 || iEnd >= nodes.size()) continue;
+    for (size_t i = 0; i < edges.size(); ++i) {
+        int iStart = edges[i].iStart;
+        int iEnd = edges[i].iEnd;
 
-        const RowVectorXf &vStart = nodes[iStart]->getVert();
-        const RowVectorXf &vEnd = nodes[iEnd]->getVert();
+        if (iStart < 0 || iStart >= matVert.rows() || iEnd < 0 || iEnd >= matVert.rows()) continue;
 
-        QVector3D startPos(vStart(0), vStart(1), vStart(2));
-        QVector3D endPos(vEnd(0), vEnd(1), vEnd(2));
+        QVector3D startPos(matVert(iStart, 0), matVert(iStart, 1), matVert(iStart, 2));
+        QVector3D endPos(matVert(iEnd, 0), matVert(iEnd, 1), matVert(iEnd, 2));
 
         if (startPos == endPos) continue;
 
-        double dWeight = std::fabs(edge->getWeight());
+        double dWeight = std::fabs(edges[i].dWeight);
         if (dWeight == 0.0) continue;
 
         QVector3D diff = endPos - startPos;
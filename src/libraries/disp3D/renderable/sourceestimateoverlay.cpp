@@ -45,9 +45,22 @@
 #include "helpers/geometryinfo.h"
 
 #include <QFile>
+#include <QFileInfo>
 #include <QDebug>
+#include <algorithm>
 #include <cmath>
 
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace
+{
+
+constexpr int kDataRangeSamples = 256;  // Time points sampled for the data range of a mapped file
+
+}
+
 //=============================================================================================================
 // DEFINE MEMBER METHODS
 //=============================================================================================================
@@ -66,6 +79,20 @@ SourceEstimateOverlay::~SourceEstimateOverlay()
 
 bool SourceEstimateOverlay::loadStc(const QString &path, int hemi)
 {
+    // Large files stay mapped, so that the first frame does not wait for the whole file
+    if (QFileInfo(path).size() >= kMappedStcSize) {
+        INVLIB::InvStcFile::SPtr stcFile = INVLIB::InvStcFile::SPtr::create();
+        if (!stcFile->open(path)) {
+            qWarning() << "SourceEstimateOverlay::loadStc - Failed to map STC file:" << path;
+            return false;
+        }
+        setStcFile(stcFile, hemi);
+        qDebug() << "SourceEstimateOverlay: Mapped" << (hemi == 0 ? "LH" : "RH") << "with"
+                 << stcFile->nVertices() << "vertices," << stcFile->nTimes() << "time points";
+        updateThresholdsFromData();
+        return true;
+    }
+
     QFile file(path);
     // Note: InvSourceEstimate::read() opens the file internally, don't open it here
 
@@ -76,11 +103,13 @@ bool SourceEstimateOverlay::loadStc(const QString &path, int hemi)
     }
 
     if (hemi == 0) {
+        m_stcFileLh.reset();
         m_stcLh = stc;
         m_hasLh = true;
         qDebug() << "SourceEstimateOverlay: Loaded LH with" << stc.data.rows() << "vertices," 
                  << stc.data.cols() << "time points";
     } else {
+        m_stcFileRh.reset();
         m_stcRh = stc;
         m_hasRh = true;
         qDebug() << "SourceEstimateOverlay: Loaded RH with" << stc.data.rows() << "vertices," 
@@ -114,26 +143,21 @@ void SourceEstimateOverlay::applyToSurface(BrainSurface *surface, int timeIndex)
     if (!surface) return;
 
     int hemi = surface->hemi();
-    const INVLIB::InvSourceEstimate *stc = nullptr;
     QSharedPointer<Eigen::SparseMatrix<float>> interpMat;
 
     if (hemi == 0 && m_hasLh) {
-        stc = &m_stcLh;
         interpMat = m_interpolationMatLh;
     } else if (hemi == 1 && m_hasRh) {
-        stc = &m_stcRh;
         interpMat = m_interpolationMatRh;
     } else {
         return; // No data for this hemisphere
     }
 
-    if (stc->isEmpty()) return;
+    // Get source data for this time point (clamped), read from the file if it is mapped
+    Eigen::VectorXd column = hemiColumn(hemi, timeIndex);
+    if (column.size() == 0) return;
 
-    // Clamp time index
-    int tIdx = qBound(0, timeIndex, static_cast<int>(stc->data.cols()) - 1);
-
-    // Get source data for this time point
-    Eigen::VectorXf sourceData = stc->data.col(tIdx).cwiseAbs().cast<float>();
+    Eigen::VectorXf sourceData = column.cwiseAbs().cast<float>();
 
     // Create color array for all surface vertices
     uint32_t vertexCount = surface->vertexCount();
@@ -150,7 +174,7 @@ void SourceEstimateOverlay::applyToSurface(BrainSurface *surface, int timeIndex)
     } else {
         // Fall back to sparse visualization (direct mapping)
         interpolatedData = Eigen::VectorXf::Zero(vertexCount);
-        const Eigen::VectorXi &srcVertices = stc->vertices;
+        const Eigen::VectorXi srcVertices = hemiVertices(hemi);
         for (int i = 0; i < srcVertices.size() && i < sourceData.size(); ++i) {
             int vertIdx = srcVertices(i);
             if (vertIdx >= 0 && vertIdx < static_cast<int>(vertexCount)) {
@@ -208,8 +232,8 @@ void SourceEstimateOverlay::setThresholds(float min, float mid, float max)
 
 int SourceEstimateOverlay::numTimePoints() const
 {
-    if (m_hasLh) return m_stcLh.data.cols();
-    if (m_hasRh) return m_stcRh.data.cols();
+    if (m_hasLh) return hemiTimePoints(0);
+    if (m_hasRh) return hemiTimePoints(1);
     return 0;
 }
 
@@ -217,6 +241,12 @@ int SourceEstimateOverlay::numTimePoints() const
 
 float SourceEstimateOverlay::timeAtIndex(int idx) const
 {
+    if (m_hasLh && m_stcFileLh && idx < m_stcFileLh->nTimes()) {
+        return m_stcFileLh->tmin() + idx * m_stcFileLh->tstep();
+    }
+    if (m_hasRh && m_stcFileRh && idx < m_stcFileRh->nTimes()) {
+        return m_stcFileRh->tmin() + idx * m_stcFileRh->tstep();
+    }
     if (m_hasLh && idx < m_stcLh.times.size()) {
         return m_stcLh.times(idx);
     }
@@ -230,8 +260,8 @@ float SourceEstimateOverlay::timeAtIndex(int idx) const
 
 float SourceEstimateOverlay::tmin() const
 {
-    if (m_hasLh) return m_stcLh.tmin;
-    if (m_hasRh) return m_stcRh.tmin;
+    if (m_hasLh) return m_stcFileLh ? m_stcFileLh->tmin() : m_stcLh.tmin;
+    if (m_hasRh) return m_stcFileRh ? m_stcFileRh->tmin() : m_stcRh.tmin;
     return 0.0f;
 }
 
@@ -239,8 +269,8 @@ float SourceEstimateOverlay::tmin() const
 
 float SourceEstimateOverlay::tstep() const
 {
-    if (m_hasLh) return m_stcLh.tstep;
-    if (m_hasRh) return m_stcRh.tstep;
+    if (m_hasLh) return m_stcFileLh ? m_stcFileLh->tstep() : m_stcLh.tstep;
+    if (m_hasRh) return m_stcFileRh ? m_stcFileRh->tstep() : m_stcRh.tstep;
     return 0.0f;
 }
 
@@ -252,17 +282,11 @@ void SourceEstimateOverlay::getDataRange(double &minVal, double &maxVal) const
     maxVal = std::numeric_limits<double>::lowest();
 
     if (m_hasLh) {
-        double lhMin = m_stcLh.data.minCoeff();
-        double lhMax = m_stcLh.data.maxCoeff();
-        minVal = qMin(minVal, std::abs(lhMin));
-        maxVal = qMax(maxVal, std::abs(lhMax));
+        hemiDataRange(0, minVal, maxVal);
     }
 
     if (m_hasRh) {
-        double rhMin = m_stcRh.data.minCoeff();
-        double rhMax = m_stcRh.data.maxCoeff();
-        minVal = qMin(minVal, std::abs(rhMin));
-        maxVal = qMax(maxVal, std::abs(rhMax));
+        hemiDataRange(1, minVal, maxVal);
     }
 
     // If no data, set defaults
@@ -292,20 +316,17 @@ void SourceEstimateOverlay::computeInterpolationMatrix(BrainSurface *surface, in
 {
     if (!surface) return;
 
-    const INVLIB::InvSourceEstimate *stc = nullptr;
     QSharedPointer<Eigen::SparseMatrix<float>> *pMatPtr = nullptr;
 
     if (hemi == 0 && m_hasLh) {
-        stc = &m_stcLh;
         pMatPtr = &m_interpolationMatLh;
     } else if (hemi == 1 && m_hasRh) {
-        stc = &m_stcRh;
         pMatPtr = &m_interpolationMatRh;
     } else {
         return;
     }
 
-    if (stc->isEmpty()) return;
+    if (hemiTimePoints(hemi) == 0) return;
 
     qDebug() << "SourceEstimateOverlay: Computing interpolation matrix for hemi" << hemi;
 
@@ -314,7 +335,7 @@ void SourceEstimateOverlay::computeInterpolationMatrix(BrainSurface *surface, in
     std::vector<Eigen::VectorXi> vecNeighbors = surface->computeNeighbors();
 
     // Source vertex subset from STC (already a VectorXi)
-    Eigen::VectorXi vecSourceVertices = stc->vertices;
+    Eigen::VectorXi vecSourceVertices = hemiVertices(hemi);
 
     qDebug() << "SourceEstimateOverlay: FsSurface has" << matVertices.rows() << "vertices,"
              << vecSourceVertices.size() << "sources";
@@ -362,9 +383,11 @@ void SourceEstimateOverlay::computeInterpolationMatrix(BrainSurface *surface, in
 void SourceEstimateOverlay::setStcData(const INVLIB::InvSourceEstimate &stc, int hemi)
 {
     if (hemi == 0) {
+        m_stcFileLh.reset();
         m_stcLh = stc;
         m_hasLh = true;
     } else {
+        m_stcFileRh.reset();
         m_stcRh = stc;
         m_hasRh = true;
     }
@@ -372,6 +395,21 @@ void SourceEstimateOverlay::setStcData(const INVLIB::InvSourceEstimate &stc, int
 
 //=============================================================================================================
 
+void SourceEstimateOverlay::setStcFile(INVLIB::InvStcFile::SPtr stcFile, int hemi)
+{
+    if (hemi == 0) {
+        m_stcLh = INVLIB::InvSourceEstimate();
+        m_stcFileLh = stcFile;
+        m_hasLh = true;
+    } else {
+        m_stcRh = INVLIB::InvSourceEstimate();
+        m_stcFileRh = stcFile;
+        m_hasRh = true;
+    }
+}
+
+//=============================================================================================================
+
 void SourceEstimateOverlay::setInterpolationMatrix(QSharedPointer<Eigen::SparseMatrix<float>> mat, int hemi)
 {
     if (hemi == 0) {
@@ -399,24 +437,83 @@ void SourceEstimateOverlay::updateThresholdsFromData()
 
 Eigen::VectorXd SourceEstimateOverlay::sourceDataColumn(int timeIndex) const
 {
-    int nLh = m_hasLh ? m_stcLh.data.rows() : 0;
-    int nRh = m_hasRh ? m_stcRh.data.rows() : 0;
+    Eigen::VectorXd lh = m_hasLh ? hemiColumn(0, timeIndex) : Eigen::VectorXd();
+    Eigen::VectorXd rh = m_hasRh ? hemiColumn(1, timeIndex) : Eigen::VectorXd();
 
-    if (nLh == 0 && nRh == 0) {
+    if (lh.size() == 0 && rh.size() == 0) {
         return Eigen::VectorXd();
     }
 
-    Eigen::VectorXd result(nLh + nRh);
+    Eigen::VectorXd result(lh.size() + rh.size());
+    result << lh, rh;
 
-    if (m_hasLh) {
-        int tIdx = qBound(0, timeIndex, static_cast<int>(m_stcLh.data.cols()) - 1);
-        result.head(nLh) = m_stcLh.data.col(tIdx);
-    }
+    return result;
+}
 
-    if (m_hasRh) {
-        int tIdx = qBound(0, timeIndex, static_cast<int>(m_stcRh.data.cols()) - 1);
-        result.segment(nLh, nRh) = m_stcRh.data.col(tIdx);
+//=============================================================================================================
+
+int SourceEstimateOverlay::hemiTimePoints(int hemi) const
+{
+    const INVLIB::InvStcFile::SPtr &stcFile = (hemi == 0) ? m_stcFileLh : m_stcFileRh;
+    if (stcFile) return stcFile->nTimes();
+
+    const INVLIB::InvSourceEstimate &stc = (hemi == 0) ? m_stcLh : m_stcRh;
+    return stc.isEmpty() ? 0 : static_cast<int>(stc.data.cols());
+}
+
+//=============================================================================================================
+
+Eigen::VectorXi SourceEstimateOverlay::hemiVertices(int hemi) const
+{
+    const INVLIB::InvStcFile::SPtr &stcFile = (hemi == 0) ? m_stcFileLh : m_stcFileRh;
+    if (stcFile) return stcFile->vertices();
+
+    return (hemi == 0) ? m_stcLh.vertices : m_stcRh.vertices;
+}
+
+//=============================================================================================================
+
+Eigen::VectorXd SourceEstimateOverlay::hemiColumn(int hemi, int timeIndex) const
+{
+    int nTimes = hemiTimePoints(hemi);
+    if (nTimes == 0) return Eigen::VectorXd();
+
+    int tIdx = qBound(0, timeIndex, nTimes - 1);
+
+    const INVLIB::InvStcFile::SPtr &stcFile = (hemi == 0) ? m_stcFileLh : m_stcFileRh;
+    if (stcFile) return stcFile->readTime(tIdx);
+
+    return ((hemi == 0) ? m_stcLh : m_stcRh).data.col(tIdx);
+}
+
+//=============================================================================================================
+
+void SourceEstimateOverlay::hemiDataRange(int hemi, double &minVal, double &maxVal) const
+{
+    int nTimes = hemiTimePoints(hemi);
+    if (nTimes == 0) return;
+
+    double hemiMin = std::numeric_limits<double>::max();
+    double hemiMax = std::numeric_limits<double>::lowest();
+
+    const INVLIB::InvStcFile::SPtr &stcFile = (hemi == 0) ? m_stcFileLh : m_stcFileRh;
+    if (stcFile) {
+        // Reading a huge file completely would defeat the mapping, evenly spaced time points are enough here
+        int nSamples = std::min(nTimes, kDataRangeSamples);
+        for (int i = 0; i < nSamples; ++i) {
+            int tIdx = (nSamples > 1) ? static_cast<int>((static_cast<qint64>(i) * (nTimes - 1)) / (nSamples - 1)) : 0;
+            Eigen::VectorXd column = stcFile->readTime(tIdx);
+            if (column.size() == 0) continue;
+            hemiMin = qMin(hemiMin, column.minCoeff());
+            hemiMax = qMax(hemiMax, column.maxCoeff());
+        }
+        if (hemiMin > hemiMax) return;
+    } else {
+        const INVLIB::InvSourceEstimate &stc = (hemi == 0) ? m_stcLh : m_stcRh;
+        hemiMin = stc.data.minCoeff();
+        hemiMax = stc.data.maxCoeff();
     }
 
-    return result;
+    minVal = qMin(minVal, std::abs(hemiMin));
+    maxVal = qMax(maxVal, std::abs(hemiMax));
 }
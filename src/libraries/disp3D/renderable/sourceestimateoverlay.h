@@ -42,6 +42,7 @@
 #include "../disp3D_global.h"
 
 #include <inv/inv_source_estimate.h>
+#include <inv/inv_stc_file.h>
 #include <QVector>
 #include <QString>
 #include <QSharedPointer>
@@ -69,6 +70,8 @@ public:
      */
     SourceEstimateOverlay();
 
+    static constexpr qint64 kMappedStcSize = 256LL * 1024 * 1024; /**< STC files from this size on are memory-mapped instead of read. */
+
     //=========================================================================================================
     /**
      * Destructor
@@ -78,6 +81,7 @@ public:
     //=========================================================================================================
     /**
      * Load a source estimate file (.stc) for a hemisphere.
+     * Files of kMappedStcSize bytes or more stay memory-mapped, and time points are read on demand.
      *
      * @param[in] path       Path to the .stc file.
      * @param[in] hemi       Hemisphere index (0=lh, 1=rh).
@@ -199,6 +203,16 @@ public:
      */
     void setStcData(const INVLIB::InvSourceEstimate &stc, int hemi);
 
+    //=========================================================================================================
+    /**
+     * Set a memory-mapped source estimate file (used by async loader).
+     * Time points are read from the file on demand instead of being held in memory.
+     *
+     * @param[in] stcFile    The open STC file.
+     * @param[in] hemi       Hemisphere index (0=lh, 1=rh).
+     */
+    void setStcFile(INVLIB::InvStcFile::SPtr stcFile, int hemi);
+
     //=========================================================================================================
     /**
      * Set the interpolation matrix directly (used by async loader).
@@ -251,10 +265,51 @@ private:
      */
     uint32_t valueToColor(double value, uint8_t alpha = 255) const;
 
+    //=========================================================================================================
+    /**
+     * Get the number of time points of a hemisphere, from memory or from the mapped file.
+     *
+     * @param[in] hemi       Hemisphere index (0=lh, 1=rh).
+     * @return Number of time samples, 0 if the hemisphere is not loaded.
+     */
+    int hemiTimePoints(int hemi) const;
+
+    //=========================================================================================================
+    /**
+     * Get the source vertices of a hemisphere, from memory or from the mapped file.
+     *
+     * @param[in] hemi       Hemisphere index (0=lh, 1=rh).
+     * @return The source vertex numbers.
+     */
+    Eigen::VectorXi hemiVertices(int hemi) const;
+
+    //=========================================================================================================
+    /**
+     * Get the source values of a hemisphere at a time point, from memory or from the mapped file.
+     *
+     * @param[in] hemi       Hemisphere index (0=lh, 1=rh).
+     * @param[in] timeIndex  Time sample index, clamped to the available range.
+     * @return The source values, empty if the hemisphere is not loaded.
+     */
+    Eigen::VectorXd hemiColumn(int hemi, int timeIndex) const;
+
+    //=========================================================================================================
+    /**
+     * Widen the data range by the values of a hemisphere, as used by getDataRange().
+     * Mapped files are sampled at evenly spaced time points instead of being read completely.
+     *
+     * @param[in] hemi           Hemisphere index (0=lh, 1=rh).
+     * @param[in, out] minVal    Minimum data value.
+     * @param[in, out] maxVal    Maximum data value.
+     */
+    void hemiDataRange(int hemi, double &minVal, double &maxVal) const;
+
     INVLIB::InvSourceEstimate m_stcLh;      /**< Left hemisphere source estimate. */
     INVLIB::InvSourceEstimate m_stcRh;      /**< Right hemisphere source estimate. */
     bool m_hasLh = false;                    /**< Flag indicating LH data loaded. */
     bool m_hasRh = false;                    /**< Flag indicating RH data loaded. */
+    INVLIB::InvStcFile::SPtr m_stcFileLh;    /**< Mapped LH source estimate file, replaces m_stcLh if set. */
+    INVLIB::InvStcFile::SPtr m_stcFileRh;    /**< Mapped RH source estimate file, replaces m_stcRh if set. */
 
     QString m_colormap = "Hot";              /**< Current colormap name. */
     float m_threshMin = 0.0f;                /**< Minimum threshold. */
@@ -161,13 +161,19 @@ void SourceEstimateManager::onStcLoadingFinished(bool success)
 
     // Transfer data from worker to overlay
     if (m_stcWorker->hasLh()) {
-        m_overlay->setStcData(m_stcWorker->stcLh(), 0);
+        if (m_stcWorker->stcFileLh())
+            m_overlay->setStcFile(m_stcWorker->stcFileLh(), 0);
+        else
+            m_overlay->setStcData(m_stcWorker->stcLh(), 0);
         if (m_stcWorker->interpolationMatLh())
             m_overlay->setInterpolationMatrix(m_stcWorker->interpolationMatLh(), 0);
     }
 
     if (m_stcWorker->hasRh()) {
-        m_overlay->setStcData(m_stcWorker->stcRh(), 1);
+        if (m_stcWorker->stcFileRh())
+            m_overlay->setStcFile(m_stcWorker->stcFileRh(), 1);
+        else
+            m_overlay->setStcData(m_stcWorker->stcRh(), 1);
         if (m_stcWorker->interpolationMatRh())
             m_overlay->setInterpolationMatrix(m_stcWorker->interpolationMatRh(), 1);
     }
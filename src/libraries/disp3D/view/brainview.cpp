@@ -2331,7 +2331,7 @@ bool BrainView::loadDipoles(const QString &dipPath)
 
 bool BrainView::loadNetwork(const CONNLIB::Network &network, const QString &name)
 {
-    if (network.getNodes().isEmpty()) return false;
+    if (network.getNumberNodes() == 0) return false;
 
     m_network = std::make_unique<NetworkObject>();
     m_network->load(network);
@@ -38,11 +38,13 @@
 
 #include "stcloadingworker.h"
 #include "renderable/brainsurface.h"
+#include "renderable/sourceestimateoverlay.h"
 
 #include "helpers/interpolation.h"
 #include "helpers/geometryinfo.h"
 
 #include <QFile>
+#include <QFileInfo>
 #include <QDebug>
 
 //=============================================================================================================
@@ -78,13 +80,8 @@ void StcLoadingWorker::process()
 
     // Load LH STC file
     if (!m_lhPath.isEmpty()) {
-        QFile file(m_lhPath);
-        INVLIB::InvSourceEstimate stc;
-        if (INVLIB::InvSourceEstimate::read(file, stc)) {
-            m_stcLh = stc;
+        if (openStc(m_lhPath, m_stcLh, m_stcFileLh)) {
             m_hasLh = true;
-            qDebug() << "StcLoadingWorker: Loaded LH with" << stc.data.rows() << "vertices,"
-                     << stc.data.cols() << "time points";
         } else {
             emit error(QString("Failed to read LH STC file: %1").arg(m_lhPath));
         }
@@ -94,13 +91,8 @@ void StcLoadingWorker::process()
 
     // Load RH STC file
     if (!m_rhPath.isEmpty()) {
-        QFile file(m_rhPath);
-        INVLIB::InvSourceEstimate stc;
-        if (INVLIB::InvSourceEstimate::read(file, stc)) {
-            m_stcRh = stc;
+        if (openStc(m_rhPath, m_stcRh, m_stcFileRh)) {
             m_hasRh = true;
-            qDebug() << "StcLoadingWorker: Loaded RH with" << stc.data.rows() << "vertices,"
-                     << stc.data.cols() << "time points";
         } else {
             emit error(QString("Failed to read RH STC file: %1").arg(m_rhPath));
         }
@@ -119,7 +111,7 @@ void StcLoadingWorker::process()
         Eigen::MatrixX3f matVertices = m_lhSurface->verticesAsMatrix();
         std::vector<Eigen::VectorXi> vecNeighbors = m_lhSurface->computeNeighbors();
 
-        Eigen::VectorXi vecSourceVertices = m_stcLh.vertices;
+        Eigen::VectorXi vecSourceVertices = m_stcFileLh ? m_stcFileLh->vertices() : m_stcLh.vertices;
 
         qDebug() << "StcLoadingWorker: LH surface has" << matVertices.rows() << "vertices,"
                  << vecSourceVertices.size() << "sources";
@@ -158,7 +150,7 @@ void StcLoadingWorker::process()
         Eigen::MatrixX3f matVertices = m_rhSurface->verticesAsMatrix();
         std::vector<Eigen::VectorXi> vecNeighbors = m_rhSurface->computeNeighbors();
 
-        Eigen::VectorXi vecSourceVertices = m_stcRh.vertices;
+        Eigen::VectorXi vecSourceVertices = m_stcFileRh ? m_stcFileRh->vertices() : m_stcRh.vertices;
 
         qDebug() << "StcLoadingWorker: RH surface has" << matVertices.rows() << "vertices,"
                  << vecSourceVertices.size() << "sources";
@@ -194,3 +186,29 @@ void StcLoadingWorker::process()
     emit progress(100, "Complete");
     emit finished(true);
 }
+
+//=============================================================================================================
+
+bool StcLoadingWorker::openStc(const QString &path, INVLIB::InvSourceEstimate &stc, INVLIB::InvStcFile::SPtr &stcFile)
+{
+    stcFile.reset();
+
+    if (QFileInfo(path).size() >= SourceEstimateOverlay::kMappedStcSize) {
+        INVLIB::InvStcFile::SPtr mapped = INVLIB::InvStcFile::SPtr::create();
+        if (!mapped->open(path)) {
+            return false;
+        }
+        stcFile = mapped;
+        qDebug() << "StcLoadingWorker: Mapped" << path << "with" << mapped->nVertices() << "vertices,"
+                 << mapped->nTimes() << "time points";
+        return true;
+    }
+
+    QFile file(path);
+    if (!INVLIB::InvSourceEstimate::read(file, stc)) {
+        return false;
+    }
+    qDebug() << "StcLoadingWorker: Loaded" << path << "with" << stc.data.rows() << "vertices,"
+             << stc.data.cols() << "time points";
+    return true;
+}
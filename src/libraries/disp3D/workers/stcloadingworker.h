@@ -42,6 +42,7 @@
 #include "../disp3D_global.h"
 
 #include <inv/inv_source_estimate.h>
+#include <inv/inv_stc_file.h>
 #include <QObject>
 #include <QString>
 #include <QSharedPointer>
@@ -105,6 +106,22 @@ public:
      */
     const INVLIB::InvSourceEstimate& stcRh() const { return m_stcRh; }
 
+    //=========================================================================================================
+    /**
+     * Get the memory-mapped left hemisphere file. Large files are kept mapped instead of read into stcLh().
+     *
+     * @return The mapped file, null if the data was read into memory.
+     */
+    INVLIB::InvStcFile::SPtr stcFileLh() const { return m_stcFileLh; }
+
+    //=========================================================================================================
+    /**
+     * Get the memory-mapped right hemisphere file. Large files are kept mapped instead of read into stcRh().
+     *
+     * @return The mapped file, null if the data was read into memory.
+     */
+    INVLIB::InvStcFile::SPtr stcFileRh() const { return m_stcFileRh; }
+
     //=========================================================================================================
     /**
      * Get the computed left hemisphere interpolation matrix.
@@ -172,6 +189,18 @@ signals:
     void error(const QString &message);
 
 private:
+    //=========================================================================================================
+    /**
+     * Open an STC file. Files of SourceEstimateOverlay::kMappedStcSize bytes or more stay mapped,
+     * smaller ones are read completely.
+     *
+     * @param[in] path       Path to the STC file.
+     * @param[out] stc       Receives the data if the file is read completely.
+     * @param[out] stcFile   Receives the mapped file, null if the file is read completely.
+     * @return True if successful.
+     */
+    bool openStc(const QString &path, INVLIB::InvSourceEstimate &stc, INVLIB::InvStcFile::SPtr &stcFile);
+
     QString m_lhPath;                                          /**< Path to LH STC file. */
     QString m_rhPath;                                          /**< Path to RH STC file. */
     BrainSurface *m_lhSurface;                                 /**< Pointer to LH surface. */
@@ -182,6 +211,8 @@ private:
     INVLIB::InvSourceEstimate m_stcRh;                         /**< Loaded RH source estimate. */
     bool m_hasLh = false;                                      /**< Flag indicating LH data loaded. */
     bool m_hasRh = false;                                      /**< Flag indicating RH data loaded. */
+    INVLIB::InvStcFile::SPtr m_stcFileLh;                      /**< Mapped LH file, replaces m_stcLh if set. */
+    INVLIB::InvStcFile::SPtr m_stcFileRh;                      /**< Mapped RH file, replaces m_stcRh if set. */
 
     QSharedPointer<Eigen::SparseMatrix<float>> m_interpMatLh;  /**< LH interpolation matrix. */
     QSharedPointer<Eigen::SparseMatrix<float>> m_interpMatRh;  /**< RH interpolation matrix. */
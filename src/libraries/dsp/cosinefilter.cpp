@@ -39,6 +39,8 @@
 
 #include "cosinefilter.h"
 
+#include <math/fft_plan_cache.h>
+
 #define _USE_MATH_DEFINES
 #include <math.h>
 
@@ -160,8 +162,7 @@ CosineFilter::CosineFilter(int fftLength,
     m_vecFftCoeff = filterFreqResp;
 
     //Generate windowed impulse response - invert fft coeeficients to time domain
-    Eigen::FFT<double> fft;
-    fft.SetFlag(fft.HalfSpectrum);
+    Eigen::FFT<double>& fft = FftPlanCache::get(true);
 
     //invert to time domain and
     fft.inv(m_vecCoeff, filterFreqResp);/*
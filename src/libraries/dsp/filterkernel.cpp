@@ -41,6 +41,7 @@
 #include "filterkernel.h"
 
 #include <math/numerics.h>
+#include <math/fft_plan_cache.h>
 
 #include "parksmcclellan.h"
 #include "cosinefilter.h"
@@ -195,8 +196,7 @@ void FilterKernel::applyFftFilter(RowVectorXd& vecData,
     }
 
     //generate fft object
-    Eigen::FFT<double> fft;
-    fft.SetFlag(fft.HalfSpectrum);
+    Eigen::FFT<double>& fft = FftPlanCache::get(true);
 
     // Zero padd if necessary. Please note: The zero padding in Eigen's FFT is only working for column vectors -> We have to zero pad manually here
     int iOriginalSize = vecData.cols();
@@ -378,8 +378,7 @@ bool FilterKernel::fftTransformCoeffs(int iFftLength)
     }
 
     //generate fft object
-    Eigen::FFT<double> fft;
-    fft.SetFlag(fft.HalfSpectrum);
+    Eigen::FFT<double>& fft = FftPlanCache::get(true);
 
     // Zero padd if necessary. Please note: The zero padding in Eigen's FFT is only working for column vectors -> We have to zero pad manually here
     RowVectorXd vecInputFft;
@@ -37,6 +37,8 @@
 
 #include "morlet_tfr.h"
 
+#include <math/fft_plan_cache.h>
+
 //=============================================================================================================
 // EIGEN INCLUDES
 //=============================================================================================================
@@ -120,7 +122,7 @@ MorletTfrResult MorletTfr::compute(const RowVectorXd& vecData,
 
     // Pre-compute forward FFT of the (real) signal at the maximum needed convolution length.
     // For each frequency the wavelet may differ in length; recompute convolution per frequency.
-    Eigen::FFT<double> fft;
+    Eigen::FFT<double>& fft = FftPlanCache::get();
 
     for (int fi = 0; fi < nFreqs; ++fi) {
         int halfLen = 0;
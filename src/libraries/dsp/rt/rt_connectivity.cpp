@@ -97,6 +97,36 @@ void RtConnectivityWorker::doWork(const ConnectivitySettings &connectivitySettin
     emit resultReady(finalNetworks, connectivitySettingsTemp);
 }
 
+//=============================================================================================================
+
+void RtConnectivityWorker::doSlidingWindowWork(const QList<Eigen::MatrixXd>& lTrials,
+                                               const ConnectivitySettings& connectivitySettings,
+                                               int iWindowSize)
+{
+    if(this->thread()->isInterruptionRequested()) {
+        return;
+    }
+
+    if(!SlidingWindowMetric::supports(connectivitySettings.getConnectivityMethods())) {
+        qDebug()<<"RtConnectivityWorker::doSlidingWindowWork() - Methods are not supported by the sliding window";
+        return;
+    }
+
+    m_slidingWindow.setWindowSize(iWindowSize);
+
+    ConnectivitySettings connectivitySettingsTemp = connectivitySettings;
+    for(int i = 0; i < lTrials.size(); ++i) {
+        m_slidingWindow.append(lTrials.at(i), connectivitySettingsTemp);
+    }
+
+    if(m_slidingWindow.size() == 0) {
+        return;
+    }
+
+    emit slidingWindowResultReady(m_slidingWindow.getNetworks(connectivitySettingsTemp,
+                                                              connectivitySettingsTemp.getConnectivityMethods()));
+}
+
 //=============================================================================================================
 // DEFINE MEMBER METHODS RtConnectivity
 //=============================================================================================================
@@ -104,19 +134,9 @@ void RtConnectivityWorker::doWork(const ConnectivitySettings &connectivitySettin
 RtConnectivity::RtConnectivity(QObject *parent)
 : QObject(parent)
 {
-    RtConnectivityWorker *worker = new RtConnectivityWorker;
-    worker->moveToThread(&m_workerThread);
-
-    connect(&m_workerThread, &QThread::finished,
-            worker, &QObject::deleteLater);
+    qRegisterMetaType<QList<Eigen::MatrixXd> >("QList<Eigen::MatrixXd>");
 
-    connect(this, &RtConnectivity::operate,
-            worker, &RtConnectivityWorker::doWork);
-
-    connect(worker, &RtConnectivityWorker::resultReady,
-            this, &RtConnectivity::newConnectivityResultAvailable);
-
-    m_workerThread.start();
+    startWorker();
 }
 
 //=============================================================================================================
@@ -135,10 +155,36 @@ void RtConnectivity::append(const ConnectivitySettings& connectivitySettings)
 
 //=============================================================================================================
 
+void RtConnectivity::appendTrials(const QList<Eigen::MatrixXd>& lTrials,
+                                  const ConnectivitySettings& connectivitySettings,
+                                  int iWindowSize)
+{
+    emit operateSlidingWindow(lTrials, connectivitySettings, iWindowSize);
+}
+
+//=============================================================================================================
+
 void RtConnectivity::restart()
 {
     stop();
 
+    // A new worker starts with an empty sliding window
+    startWorker();
+}
+
+//=============================================================================================================
+
+void RtConnectivity::stop()
+{
+    m_workerThread.requestInterruption();
+    m_workerThread.quit();
+    m_workerThread.wait();
+}
+
+//=============================================================================================================
+
+void RtConnectivity::startWorker()
+{
     RtConnectivityWorker *worker = new RtConnectivityWorker;
     worker->moveToThread(&m_workerThread);
 
@@ -148,17 +194,14 @@ void RtConnectivity::restart()
     connect(this, &RtConnectivity::operate,
             worker, &RtConnectivityWorker::doWork);
 
+    connect(this, &RtConnectivity::operateSlidingWindow,
+            worker, &RtConnectivityWorker::doSlidingWindowWork);
+
     connect(worker, &RtConnectivityWorker::resultReady,
             this, &RtConnectivity::newConnectivityResultAvailable);
 
-    m_workerThread.start();
-}
+    connect(worker, &RtConnectivityWorker::slidingWindowResultReady,
+            this, &RtConnectivity::newSlidingWindowResultAvailable);
 
-//=============================================================================================================
-
-void RtConnectivity::stop()
-{
-    m_workerThread.requestInterruption();
-    m_workerThread.quit();
-    m_workerThread.wait();
+    m_workerThread.start();
 }
@@ -41,11 +41,14 @@
 
 #include "../dsp_global.h"
 #include <conn/network/network.h>
+#include <conn/metrics/slidingwindowmetric.h>
 
 //=============================================================================================================
 // EIGEN INCLUDES
 //=============================================================================================================
 
+#include <Eigen/Core>
+
 //=============================================================================================================
 // QT INCLUDES
 //=============================================================================================================
@@ -95,8 +98,25 @@ public:
      */
     void doWork(const CONNLIB::ConnectivitySettings& connectivitySettings);
 
+    //=========================================================================================================
+    /**
+     * Adds trials to the sliding window of this worker and computes the networks of the window.
+     *
+     * @param[in] lTrials                        The new trials (channels x samples).
+     * @param[in] connectivitySettings           The settings providing the methods, node positions, sampling frequency and window type. Their trials are not used.
+     * @param[in] iWindowSize                    The number of trials in the window.
+     */
+    void doSlidingWindowWork(const QList<Eigen::MatrixXd>& lTrials,
+                             const CONNLIB::ConnectivitySettings& connectivitySettings,
+                             int iWindowSize);
+
 signals:
     void resultReady(const  QList<CONNLIB::Network>& connectivityResults, const CONNLIB::ConnectivitySettings& connectivitySettings);
+
+    void slidingWindowResultReady(const QList<CONNLIB::Network>& connectivityResults);
+
+private:
+    CONNLIB::SlidingWindowMetric    m_slidingWindow;        /**< The spectral sums of the last trials. Only used from the worker thread. */
 };
 
 //=============================================================================================================
@@ -135,6 +155,19 @@ public:
      */
     void append(const CONNLIB::ConnectivitySettings& connectivitySettings);
 
+    //=========================================================================================================
+    /**
+     * Adds trials to the sliding window of the worker, which then publishes the networks of the window. Only for
+     * methods supported by CONNLIB::SlidingWindowMetric. restart() empties the window.
+     *
+     * @param[in] lTrials                        The new trials (channels x samples).
+     * @param[in] connectivitySettings           The settings providing the methods, node positions, sampling frequency and window type.
+     * @param[in] iWindowSize                    The number of trials in the window.
+     */
+    void appendTrials(const QList<Eigen::MatrixXd>& lTrials,
+                      const CONNLIB::ConnectivitySettings& connectivitySettings,
+                      int iWindowSize);
+
     //=========================================================================================================
     /**
      * Restarts the thread by interrupting its computation queue, quitting, waiting and then starting it again.
@@ -148,12 +181,24 @@ public:
     void stop();
 
 protected:
+    //=========================================================================================================
+    /**
+     * Creates a worker, moves it to the worker thread and starts the thread.
+     */
+    void startWorker();
+
     QThread             m_workerThread;         /**< The worker thread. */
 
 signals:
     void newConnectivityResultAvailable(const QList<CONNLIB::Network>& connectivityResults, const CONNLIB::ConnectivitySettings& connectivitySettings);
 
+    void newSlidingWindowResultAvailable(const QList<CONNLIB::Network>& connectivityResults);
+
     void operate(const CONNLIB::ConnectivitySettings& connectivitySettings);
+
+    void operateSlidingWindow(const QList<Eigen::MatrixXd>& lTrials,
+                              const CONNLIB::ConnectivitySettings& connectivitySettings,
+                              int iWindowSize);
 };
 
 //=============================================================================================================
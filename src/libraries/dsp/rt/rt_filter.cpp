@@ -38,12 +38,16 @@
 //=============================================================================================================
 
 #include "rt_filter.h"
+#include "rt_streaming_fir.h"
 
 #include <fiff/fiff_raw_data.h>
 #include <fiff/fiff_file.h>
+#include <fiff/fiff_raw_pipeline.h>
 #include <mne/mne_epoch_data.h>
 #include <mne/mne_epoch_data_list.h>
 
+#include <algorithm>
+
 //=============================================================================================================
 // QT INCLUDES
 //=============================================================================================================
@@ -113,79 +117,51 @@ bool RTPROCESSINGLIB::filterFile(QIODevice &pIODevice,
                                  const RowVectorXi& vecPicks,
                                  bool bUseThreads)
 {
-    int iOrder = filterKernel.getFilterOrder();
-
     RowVectorXd cals;
-    SparseMatrix<double> mult;
-    RowVectorXi sel;
     FiffStream::SPtr outfid = FiffStream::start_writing_raw(pIODevice, pFiffRawData->info, cals);
 
     //Setup reading parameters
     fiff_int_t from = pFiffRawData->first_samp;
-    fiff_int_t to = pFiffRawData->last_samp;
 
-    // slice input data into data junks with proper length so that the slices are always >= the filter order
-    float fFactor = 2.0f;
-    int iSize = fFactor * iOrder;
-    int residual = (to - from) % iSize;
-    while(residual < iOrder) {
-        fFactor = fFactor - 0.1f;
-        iSize = fFactor * iOrder;
-        residual = (to - from) % iSize;
-
-        if((iSize < iOrder)) {
-            qInfo() << "[Filter::filterData] Sliced data block size is too small. Filtering whole block at once.";
-            iSize = to - from;
-            break;
-        }
-    }
+    // The streaming filter carries the history between blocks, so the block size only trades memory for
+    // scheduling overhead. Read about one second, but at least twice the filter length.
+    StreamingFirFilter streamFilter(filterKernel, vecPicks);
+    fiff_int_t quantum = std::max<fiff_int_t>(2 * streamFilter.getNumTaps(), ceil(pFiffRawData->info.sfreq));
 
-    float quantum_sec = iSize/pFiffRawData->info.sfreq;
-    fiff_int_t quantum = ceil(quantum_sec*pFiffRawData->info.sfreq);
+    // The first getGroupDelay() output samples precede the first input sample and are dropped
+    int iSkip = streamFilter.getGroupDelay();
 
-    // Read, filter and write the data
-    bool first_buffer = true;
-
-    fiff_int_t first, last;
-    MatrixXd matData, matDataOverlap;
-    MatrixXd times;
-
-    for(first = from; first < to; first+=quantum) {
-        last = first+quantum-1;
-        if (last > to) {
-            last = to;
-        }
-
-        if (!pFiffRawData->read_raw_segment(matData, times, mult, first, last, sel)) {
-            qWarning("[Filter::filterData] Error during read_raw_segment\n");
-            return false;
-        }
-
-        qInfo() << "Filtering and writing block" << first << "to" << last;
-
-        if (first_buffer) {
-           if (first > 0) {
-               outfid->write_int(FIFF_FIRST_SAMPLE,&first);
-           }
-           first_buffer = false;
-        }
-
-        matData = filterDataBlock(matData,
-                                  vecPicks,
-                                  filterKernel,
-                                  bUseThreads);
-
-        if(first == from) {
-            outfid->write_raw_buffer(matData.block(0,iOrder/2,matData.rows(),matData.cols()-iOrder), cals);
-        } else if(first + quantum >= to) {
-            matData.block(0,0,matData.rows(),iOrder) += matDataOverlap;
-            outfid->write_raw_buffer(matData.block(0,0,matData.rows(),matData.cols()-iOrder), cals);
-        } else {
-            matData.block(0,0,matData.rows(),iOrder) += matDataOverlap;
-            outfid->write_raw_buffer(matData.block(0,0,matData.rows(),matData.cols()-iOrder), cals);
-        }
+    if (from > 0) {
+        outfid->write_int(FIFF_FIRST_SAMPLE,&from);
+    }
+    outfid->start_write_behind();
+
+    // Read, filter and write overlap each other. The filter is stateful, so one worker takes the blocks in order.
+    FiffRawPipeline pipeline(*pFiffRawData, quantum);
+    pipeline.setNumWorkers(1);
+
+    MatrixXd matFiltered;
+    FiffRawPipeline::Transform filterBlock = [&](FiffRawBlock& block) {
+        streamFilter.process(block.matData,
+                             matFiltered,
+                             bUseThreads);
+
+        const int iDrop = std::min<int>(iSkip, matFiltered.cols());
+        iSkip -= iDrop;
+        block.matData = matFiltered.rightCols(matFiltered.cols()-iDrop);
+        return true;
+    };
+
+    if(!pipeline.run(filterBlock, outfid, cals)) {
+        qWarning("[Filter::filterFile] Error while filtering the raw data\n");
+        outfid->finish_writing_raw();
+        return false;
+    }
 
-        matDataOverlap = matData.block(0,matData.cols()-iOrder,matData.rows(),iOrder);
+    // Write the tail the group delay still holds back
+    streamFilter.flush(matFiltered, bUseThreads);
+    if(matFiltered.cols() > iSkip) {
+        outfid->write_raw_buffer(matFiltered.rightCols(matFiltered.cols()-iSkip), cals);
     }
 
     outfid->finish_writing_raw();
@@ -256,6 +232,10 @@ MatrixXd RTPROCESSINGLIB::filterData(const MatrixXd& matData,
     matDataOut.setZero();
     MatrixXd sliceFiltered;
 
+    // All slices share one prepared kernel spectrum
+    FirFilterEngine firEngine;
+    firEngine.setFilterKernel(filterKernel);
+
     // slice input data into data junks with proper length so that the slices are always >= the filter order
     float fFactor = 2.0f;
     int iSize = fFactor * iOrder;
@@ -282,10 +262,10 @@ MatrixXd RTPROCESSINGLIB::filterData(const MatrixXd& matData,
             }
 
             // Filter the data block. This will return data with a fitler delay of iOrder/2 in front and back
-            sliceFiltered = filterDataBlock(matData.block(0,from,matData.rows(),iSize),
-                                            vecPicks,
-                                            filterKernel,
-                                            bUseThreads);
+            firEngine.filterBlock(matData.block(0,from,matData.rows(),iSize),
+                                  vecPicks,
+                                  sliceFiltered,
+                                  bUseThreads);
 
             // Perform overlap add
             if(i == 0) {
@@ -297,10 +277,10 @@ MatrixXd RTPROCESSINGLIB::filterData(const MatrixXd& matData,
             from += iSize;
         }
     } else {
-        matDataOut = filterDataBlock(matData,
-                                     vecPicks,
-                                     filterKernel,
-                                     bUseThreads);
+        firEngine.filterBlock(matData,
+                              vecPicks,
+                              matDataOut,
+                              bUseThreads);
     }
 
     if(bKeepOverhead) {
@@ -325,50 +305,12 @@ MatrixXd RTPROCESSINGLIB::filterDataBlock(const MatrixXd& matData,
         return matData;
     }
 
-    // Setup filters to the correct length, so we do not have to do this everytime we call the FFT filter function
-    FilterKernel filterKernelSetup = filterKernel;
-    filterKernelSetup.prepareFilter(matData.cols());
-
-    // Do the concurrent filtering
-    RowVectorXi vecPicksNew = vecPicks;
-    if(vecPicksNew.cols() == 0) {
-        vecPicksNew = RowVectorXi::LinSpaced(matData.rows(), 0, matData.rows());
-    }
-
-    // Generate QList structure which can be handled by the QConcurrent framework
-    QList<FilterObject> timeData;
-
-    // Only select channels specified in vecPicksNew
-    FilterObject data;
-    for(qint32 i = 0; i < vecPicksNew.cols(); ++i) {
-        data.filterKernel = filterKernelSetup;
-        data.iRow = vecPicksNew[i];
-        data.vecData = matData.row(vecPicksNew[i]);
-        timeData.append(data);
-    }
-
-    // Copy in data from last data block. This is necessary in order to also delay channels which are not filtered
-    MatrixXd matDataOut(matData.rows(), matData.cols()+iOrder);
-    matDataOut.setZero();
-    matDataOut.block(0, iOrder/2, matData.rows(), matData.cols()) = matData;
-
-    if(bUseThreads) {
-        QFuture<void> future = QtConcurrent::map(timeData,
-                                                 filterChannel);
-        future.waitForFinished();
-    } else {
-        for(int i = 0; i < timeData.size(); ++i) {
-            filterChannel(timeData[i]);
-        }
-    }
-
-    // Do the overlap add method and store in matDataOut
-    RowVectorXd tempData;
+    // One kernel spectrum shared by all channels, filtered in place in per-thread work buffers
+    FirFilterEngine firEngine;
+    firEngine.setFilterKernel(filterKernel);
 
-    for(int r = 0; r < timeData.size(); r++) {
-        // Write the newly calculated filtered data to the filter data matrix. This data has a delay of iOrder/2 in front and back
-        matDataOut.row(timeData.at(r).iRow) = timeData.at(r).vecData;
-    }
+    MatrixXd matDataOut;
+    firEngine.filterBlock(matData, vecPicks, matDataOut, bUseThreads);
 
     return matDataOut;
 }
@@ -444,6 +386,9 @@ MatrixXd FilterOverlapAdd::calculate(const MatrixXd& matData,
         return matData;
     }
 
+    // Prepares the kernel spectrum only when the kernel changed since the last block
+    m_firEngine.setFilterKernel(filterKernel);
+
     // Init overlaps from last block
     if(m_matOverlapBack.cols() != iOrder || m_matOverlapBack.rows() < matData.rows()) {
         m_matOverlapBack.resize(matData.rows(), iOrder);
@@ -486,10 +431,10 @@ MatrixXd FilterOverlapAdd::calculate(const MatrixXd& matData,
             }
 
             // Filter the data block. This will return data with a fitler delay of iOrder/2 in front and back
-            sliceFiltered = filterDataBlock(matData.block(0,from,matData.rows(),iSize),
-                                            vecPicks,
-                                            filterKernel,
-                                            bUseThreads);
+            m_firEngine.filterBlock(matData.block(0,from,matData.rows(),iSize),
+                                    vecPicks,
+                                    sliceFiltered,
+                                    bUseThreads);
 
             if(i == 0) {
                 matDataOut.block(0,0,matData.rows(),sliceFiltered.cols()) += sliceFiltered;
@@ -506,10 +451,10 @@ MatrixXd FilterOverlapAdd::calculate(const MatrixXd& matData,
             from += iSize;
         }
     } else {
-        matDataOut = filterDataBlock(matData,
-                                     vecPicks,
-                                     filterKernel,
-                                     bUseThreads);
+        m_firEngine.filterBlock(matData,
+                                vecPicks,
+                                matDataOut,
+                                bUseThreads);
 
         if(bFilterEnd) {
             matDataOut.block(0,0,matDataOut.rows(),iOrder) += m_matOverlapBack;
@@ -43,6 +43,7 @@
 #include "../dsp_global.h"
 
 #include "../filterkernel.h"
+#include "rt_fir_engine.h"
 
 #include <fiff/fiff_info.h>
 #include <fiff/fiff_evoked.h>
@@ -118,7 +119,8 @@ DSPSHARED_EXPORT bool filterFile(QIODevice& pIODevice,
 //=========================================================================================================
 /**
  * Filters data from an input file based on an existing filter kernel and writes the filtered data to a
- * pIODevice.
+ * pIODevice. The file is filtered block-wise with a StreamingFirFilter and written zero-phase aligned with
+ * the same number of samples as the input.
  *
  * @param[in] pIODevice            The IO device to write to.
  * @param[in] pFiffRawData         The fiff raw data object to read from.
@@ -247,6 +249,8 @@ DSPSHARED_EXPORT FIFFLIB::FiffEvoked computeFilteredAverage(const FIFFLIB::FiffR
 /**
  * Filtering with FFT convolution and the overlap add method for continuous data streams. This class will hold
  * all needed information about the last block in order to overlap it with the current one.
+ * StreamingFirFilter returns blocks of the input size with a constant delay and also accepts blocks shorter
+ * than the filter order.
  *
  * @brief Applies FIR filtering via FFT-based overlap-add convolution for continuous data streams.
  */
@@ -317,6 +321,7 @@ public:
 private:
     Eigen::MatrixXd                 m_matOverlapBack;                   /**< Overlap block for the end of the data block. */
     Eigen::MatrixXd                 m_matOverlapFront;                  /**< Overlap block for the beginning of the data block. */
+    FirFilterEngine                 m_firEngine;                        /**< Keeps the prepared kernel spectrum between blocks. */
 };
 
 //=============================================================================================================
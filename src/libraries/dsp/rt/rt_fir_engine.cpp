@@ -0,0 +1,283 @@
+//=============================================================================================================
+/**
+ * @file     rt_fir_engine.cpp
+ * @author   Christoph Dinh <christoph.dinh@mne-cpp.org>
+ * @since    2.1.0
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, Christoph Dinh. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    FirFilterEngine class definition.
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rt_fir_engine.h"
+
+#include <math/fft_plan_cache.h>
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtConcurrent>
+#include <QVector>
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <unsupported/Eigen/FFT>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace RTPROCESSINGLIB;
+using namespace UTILSLIB;
+using namespace Eigen;
+
+//=============================================================================================================
+// DEFINE LOCAL FUNCTIONS
+//=============================================================================================================
+
+namespace
+{
+
+/**
+ * Work buffers of one thread, reused across blocks.
+ */
+struct FirWorkspace
+{
+    VectorXd    vecTime;        /**< Zero-padded time domain samples of one channel. */
+    VectorXcd   vecSpectrum;    /**< Spectrum of one channel. */
+};
+
+//=============================================================================================================
+
+FirWorkspace& threadWorkspace()
+{
+    thread_local FirWorkspace workspace;
+    return workspace;
+}
+
+//=============================================================================================================
+
+inline int nextPow2(int iValue)
+{
+    int iPow = 1;
+    while(iPow < iValue) {
+        iPow <<= 1;
+    }
+    return iPow;
+}
+
+} // anonymous namespace
+
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+FirFilterEngine::FirFilterEngine()
+: m_iOrder(0)
+, m_iFftLength(0)
+, m_iBatchSize(0)
+{
+}
+
+//=============================================================================================================
+
+FirFilterEngine::FirFilterEngine(const QList<FilterKernel>& lFilterKernels)
+: FirFilterEngine()
+{
+    setFilterKernels(lFilterKernels);
+}
+
+//=============================================================================================================
+
+void FirFilterEngine::setFilterKernel(const FilterKernel& filterKernel)
+{
+    setFilterKernels(QList<FilterKernel>() << filterKernel);
+}
+
+//=============================================================================================================
+
+void FirFilterEngine::setFilterKernels(const QList<FilterKernel>& lFilterKernels)
+{
+    QList<RowVectorXd> lCoefficients;
+    int iOrder = 0;
+    for(const FilterKernel& filterKernel : lFilterKernels) {
+        lCoefficients.append(filterKernel.getCoefficients());
+        iOrder += lCoefficients.last().cols();
+    }
+
+    if(lCoefficients.size() == m_lCoefficients.size()
+       && std::equal(lCoefficients.cbegin(), lCoefficients.cend(), m_lCoefficients.cbegin(),
+                     [](const RowVectorXd& a, const RowVectorXd& b) { return a.cols() == b.cols() && a == b; })) {
+        return;
+    }
+
+    m_lCoefficients = lCoefficients;
+    m_iOrder = iOrder;
+    m_iFftLength = 0;
+}
+
+//=============================================================================================================
+
+int FirFilterEngine::getFilterOrder() const
+{
+    return m_iOrder;
+}
+
+//=============================================================================================================
+
+void FirFilterEngine::setBatchSize(int iBatchSize)
+{
+    m_iBatchSize = std::max(0, iBatchSize);
+}
+
+//=============================================================================================================
+
+void FirFilterEngine::prepare(int iDataLength)
+{
+    const int iFftLength = nextPow2(iDataLength + m_iOrder);
+    if(iFftLength == m_iFftLength) {
+        return;
+    }
+
+    FFT<double>& fft = FftPlanCache::get(true);
+    FirWorkspace& ws = threadWorkspace();
+    ws.vecTime.resize(iFftLength);
+    ws.vecSpectrum.resize(iFftLength);
+
+    m_vecSpectrum = RowVectorXcd::Ones(iFftLength / 2 + 1);
+    for(const RowVectorXd& vecCoeff : m_lCoefficients) {
+        ws.vecTime.setZero();
+        ws.vecTime.head(vecCoeff.cols()) = vecCoeff.transpose();
+        fft.fwd(ws.vecSpectrum.data(), ws.vecTime.data(), iFftLength);
+        m_vecSpectrum.array() *= ws.vecSpectrum.head(iFftLength / 2 + 1).transpose().array();
+    }
+
+    m_iFftLength = iFftLength;
+}
+
+//=============================================================================================================
+
+void FirFilterEngine::filterBlock(const Ref<const MatrixXd>& matData,
+                                  const RowVectorXi& vecPicks,
+                                  MatrixXd& matDataOut,
+                                  bool bUseThreads)
+{
+    const int iNRows = matData.rows();
+    const int iNSamples = matData.cols();
+    const int iNOut = iNSamples + m_iOrder;
+
+    if(matDataOut.rows() != iNRows || matDataOut.cols() != iNOut) {
+        matDataOut.resize(iNRows, iNOut);
+    }
+
+    // Collect the rows to filter, the others only get the filter delay
+    std::vector<char> vecFiltered(iNRows, 0);
+    std::vector<int> vecRows;
+    if(!m_lCoefficients.isEmpty()) {
+        if(vecPicks.size() == 0) {
+            vecRows.resize(iNRows);
+            for(int r = 0; r < iNRows; ++r) {
+                vecRows[r] = r;
+            }
+            std::fill(vecFiltered.begin(), vecFiltered.end(), 1);
+        } else {
+            vecRows.reserve(vecPicks.size());
+            for(int i = 0; i < vecPicks.size(); ++i) {
+                const int r = vecPicks[i];
+                if(r >= 0 && r < iNRows && !vecFiltered[r]) {
+                    vecRows.push_back(r);
+                    vecFiltered[r] = 1;
+                }
+            }
+        }
+    }
+
+    for(int r = 0; r < iNRows; ++r) {
+        if(!vecFiltered[r]) {
+            matDataOut.row(r).setZero();
+            matDataOut.row(r).segment(m_iOrder / 2, iNSamples) = matData.row(r);
+        }
+    }
+
+    if(vecRows.empty()) {
+        return;
+    }
+
+    prepare(iNSamples);
+
+    const int iFftLength = m_iFftLength;
+    const int iNFreqs = iFftLength / 2 + 1;
+    const RowVectorXcd& vecKernel = m_vecSpectrum;
+
+    // Give every task roughly 2^18 samples so that short blocks are not dominated by scheduling overhead
+    const int iBatchSize = m_iBatchSize > 0 ? m_iBatchSize
+                                            : std::max(1, std::min(64, (1 << 18) / iFftLength));
+
+    std::function<void(QPair<int,int>&)> filterRows = [&](QPair<int,int>& range) {
+        FFT<double>& fft = FftPlanCache::get(true);
+        FirWorkspace& ws = threadWorkspace();
+        if(ws.vecTime.size() != iFftLength) {
+            ws.vecTime.resize(iFftLength);
+            ws.vecSpectrum.resize(iFftLength);
+        }
+
+        for(int i = range.first; i < range.second; ++i) {
+            const int r = vecRows[i];
+            ws.vecTime.head(iNSamples) = matData.row(r).transpose();
+            ws.vecTime.tail(iFftLength - iNSamples).setZero();
+
+            fft.fwd(ws.vecSpectrum.data(), ws.vecTime.data(), iFftLength);
+            ws.vecSpectrum.head(iNFreqs).array() *= vecKernel.transpose().array();
+            fft.inv(ws.vecTime.data(), ws.vecSpectrum.data(), iFftLength);
+
+            matDataOut.row(r) = ws.vecTime.head(iNOut).transpose();
+        }
+    };
+
+    QVector<QPair<int,int> > vecBatches;
+    for(int i = 0; i < static_cast<int>(vecRows.size()); i += iBatchSize) {
+        vecBatches.append(qMakePair(i, std::min<int>(i + iBatchSize, vecRows.size())));
+    }
+
+    if(bUseThreads && vecBatches.size() > 1) {
+        QFuture<void> future = QtConcurrent::map(vecBatches, filterRows);
+        future.waitForFinished();
+    } else {
+        for(int i = 0; i < vecBatches.size(); ++i) {
+            filterRows(vecBatches[i]);
+        }
+    }
+}
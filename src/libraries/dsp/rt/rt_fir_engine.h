@@ -0,0 +1,166 @@
+//=============================================================================================================
+/**
+ * @file     rt_fir_engine.h
+ * @author   Christoph Dinh <christoph.dinh@mne-cpp.org>
+ * @since    2.1.0
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, Christoph Dinh. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    FirFilterEngine class declaration.
+ */
+
+#ifndef RT_FIR_ENGINE_H
+#define RT_FIR_ENGINE_H
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../dsp_global.h"
+
+#include "../filterkernel.h"
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QList>
+#include <QSharedPointer>
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+//=============================================================================================================
+// DEFINE NAMESPACE RTPROCESSINGLIB
+//=============================================================================================================
+
+namespace RTPROCESSINGLIB
+{
+
+//=============================================================================================================
+/**
+ * Applies one FIR kernel, or a chain of kernels, to many channels at once via FFT convolution. The kernel
+ * spectrum is prepared once per FFT length and shared by all channels, and every thread filters in its own
+ * reusable work buffers. Channels are handed to the global thread pool in batches of similar work.
+ *
+ * The output layout matches filterDataBlock: every row has the input length plus the total filter order,
+ * with a delay of half the order at the front and the back. The rows that are not picked are copied over
+ * with the same delay.
+ *
+ * A chain of kernels is applied as the product of their spectra, which equals applying them one after the
+ * other with FilterKernel::applyFftFilter(vecData, true).
+ *
+ * One engine must not be used from several threads at once.
+ *
+ * @brief Multi-channel FFT based FIR filter engine.
+ */
+class DSPSHARED_EXPORT FirFilterEngine
+{
+public:
+    typedef QSharedPointer<FirFilterEngine> SPtr;             /**< Shared pointer type for FirFilterEngine. */
+    typedef QSharedPointer<const FirFilterEngine> ConstSPtr;  /**< Const shared pointer type for FirFilterEngine. */
+
+    //=========================================================================================================
+    /**
+     * Constructs an engine without a kernel.
+     */
+    FirFilterEngine();
+
+    //=========================================================================================================
+    /**
+     * Constructs an engine for a chain of kernels.
+     *
+     * @param[in] lFilterKernels     The kernels, applied in order.
+     */
+    explicit FirFilterEngine(const QList<UTILSLIB::FilterKernel>& lFilterKernels);
+
+    //=========================================================================================================
+    /**
+     * Sets a single kernel. The prepared spectrum is kept if the coefficients did not change.
+     *
+     * @param[in] filterKernel       The kernel.
+     */
+    void setFilterKernel(const UTILSLIB::FilterKernel& filterKernel);
+
+    //=========================================================================================================
+    /**
+     * Sets a chain of kernels. The prepared spectrum is kept if the coefficients did not change.
+     *
+     * @param[in] lFilterKernels     The kernels, applied in order.
+     */
+    void setFilterKernels(const QList<UTILSLIB::FilterKernel>& lFilterKernels);
+
+    //=========================================================================================================
+    /**
+     * Returns the total filter order, i.e. the number of samples the output is longer than the input.
+     *
+     * @return The summed order of all kernels.
+     */
+    int getFilterOrder() const;
+
+    //=========================================================================================================
+    /**
+     * Sets the number of channels one task filters. 0 chooses a batch size from the FFT length.
+     *
+     * @param[in] iBatchSize         The number of channels per task.
+     */
+    void setBatchSize(int iBatchSize);
+
+    //=========================================================================================================
+    /**
+     * Filters the picked rows of matData into matDataOut, which is only reallocated if its size changes.
+     *
+     * @param[in] matData            The data (channels x samples).
+     * @param[in] vecPicks           The rows to filter. Default is all rows.
+     * @param[out] matDataOut        The filtered data (channels x (samples + order)).
+     * @param[in] bUseThreads        Whether to filter on the global thread pool. Default is true.
+     */
+    void filterBlock(const Eigen::Ref<const Eigen::MatrixXd>& matData,
+                     const Eigen::RowVectorXi& vecPicks,
+                     Eigen::MatrixXd& matDataOut,
+                     bool bUseThreads = true);
+
+private:
+    //=========================================================================================================
+    /**
+     * Prepares the combined kernel spectrum for the FFT length needed by iDataLength samples.
+     *
+     * @param[in] iDataLength        The number of samples per channel.
+     */
+    void prepare(int iDataLength);
+
+    QList<Eigen::RowVectorXd>   m_lCoefficients;    /**< The coefficients of the kernels, applied in order. */
+    int                         m_iOrder;           /**< The summed number of coefficients. */
+    int                         m_iFftLength;       /**< The FFT length m_vecSpectrum was prepared for, 0 if none. */
+    int                         m_iBatchSize;       /**< Channels per task, 0 for automatic. */
+    Eigen::RowVectorXcd         m_vecSpectrum;      /**< The combined half spectrum of all kernels. */
+};
+
+} // NAMESPACE RTPROCESSINGLIB
+
+#endif // RT_FIR_ENGINE_H
@@ -39,6 +39,8 @@
 
 #include "rt_noise.h"
 
+#include <math/fft_plan_cache.h>
+
 //=============================================================================================================
 // QT INCLUDES
 //=============================================================================================================
@@ -110,6 +112,7 @@ void RtNoiseWorker::doWork(const MatrixXd& matData)
     MatrixXd sum_psdx = MatrixXd::Zero(m_iSensors, iHalfSpec);
     RowVectorXd vecDataZeroPad = RowVectorXd::Zero(m_iFftLength);
     RowVectorXcd vecFreqData(iHalfSpec);
+    Eigen::FFT<double>& fft = UTILSLIB::FftPlanCache::get(true);
 
     for(int n = 0; n < nb; ++n) {
         const int iOffset = n * m_iFftLength;
@@ -126,8 +129,6 @@ void RtNoiseWorker::doWork(const MatrixXd& matData)
             }
 
             // FFT
-            Eigen::FFT<double> fft;
-            fft.SetFlag(fft.HalfSpectrum);
             fft.fwd(vecFreqData, vecDataZeroPad);
 
             // PSD from FFT
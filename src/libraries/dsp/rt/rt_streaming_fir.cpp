@@ -0,0 +1,356 @@
+//=============================================================================================================
+/**
+ * @file     rt_streaming_fir.cpp
+ * @author   Christoph Dinh <christoph.dinh@mne-cpp.org>
+ * @since    2.1.0
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, Christoph Dinh. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    StreamingFirFilter class definition.
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rt_streaming_fir.h"
+
+#include <math/fft_plan_cache.h>
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtConcurrent>
+#include <QVector>
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <unsupported/Eigen/FFT>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace RTPROCESSINGLIB;
+using namespace UTILSLIB;
+using namespace Eigen;
+
+//=============================================================================================================
+// DEFINE LOCAL FUNCTIONS
+//=============================================================================================================
+
+namespace
+{
+
+/**
+ * Work buffers of one thread, reused across blocks.
+ */
+struct StreamWorkspace
+{
+    VectorXd    vecSignal;      /**< History followed by the new block of one channel. */
+    VectorXd    vecTime;        /**< One zero-padded overlap-save window. */
+    VectorXcd   vecSpectrum;    /**< Spectrum of one window. */
+};
+
+//=============================================================================================================
+
+StreamWorkspace& threadWorkspace()
+{
+    thread_local StreamWorkspace workspace;
+    return workspace;
+}
+
+//=============================================================================================================
+
+inline int nextPow2(int iValue)
+{
+    int iPow = 1;
+    while(iPow < iValue) {
+        iPow <<= 1;
+    }
+    return iPow;
+}
+
+} // anonymous namespace
+
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+StreamingFirFilter::StreamingFirFilter()
+: m_iGroupDelay(0)
+, m_iMaxFftLength(0)
+, m_iBatchSize(0)
+{
+}
+
+//=============================================================================================================
+
+StreamingFirFilter::StreamingFirFilter(const FilterKernel& filterKernel,
+                                       const RowVectorXi& vecPicks)
+: StreamingFirFilter()
+{
+    setFilterKernel(filterKernel);
+    setPicks(vecPicks);
+}
+
+//=============================================================================================================
+
+StreamingFirFilter::StreamingFirFilter(const QList<FilterKernel>& lFilterKernels,
+                                       const RowVectorXi& vecPicks)
+: StreamingFirFilter()
+{
+    setFilterKernels(lFilterKernels);
+    setPicks(vecPicks);
+}
+
+//=============================================================================================================
+
+void StreamingFirFilter::setFilterKernel(const FilterKernel& filterKernel)
+{
+    setFilterKernels(QList<FilterKernel>() << filterKernel);
+}
+
+//=============================================================================================================
+
+void StreamingFirFilter::setFilterKernels(const QList<FilterKernel>& lFilterKernels)
+{
+    QList<RowVectorXd> lCoefficients;
+    for(const FilterKernel& filterKernel : lFilterKernels) {
+        RowVectorXd vecCoeff = filterKernel.getCoefficients();
+        if(vecCoeff.size() > 0) {
+            lCoefficients.append(vecCoeff);
+        }
+    }
+
+    if(lCoefficients.size() == m_lCoefficients.size()
+       && std::equal(lCoefficients.cbegin(), lCoefficients.cend(), m_lCoefficients.cbegin(),
+                     [](const RowVectorXd& a, const RowVectorXd& b) { return a.cols() == b.cols() && a == b; })) {
+        return;
+    }
+
+    // Combine the chain into one impulse response by time domain convolution
+    RowVectorXd vecImpulse;
+    for(const RowVectorXd& vecCoeff : lCoefficients) {
+        if(vecImpulse.size() == 0) {
+            vecImpulse = vecCoeff;
+            continue;
+        }
+
+        RowVectorXd vecConv = RowVectorXd::Zero(vecImpulse.size() + vecCoeff.size() - 1);
+        for(int i = 0; i < vecCoeff.size(); ++i) {
+            vecConv.segment(i, vecImpulse.size()) += vecCoeff[i] * vecImpulse;
+        }
+        vecImpulse = vecConv;
+    }
+
+    // Keep the most recent input samples so that the stream continues with the new kernel
+    const int iHistory = std::max<int>(0, vecImpulse.size() - 1);
+    if(m_matHistory.rows() > 0 && m_matHistory.cols() != iHistory) {
+        const int iKeep = std::min<int>(iHistory, m_matHistory.cols());
+        MatrixXd matHistory = MatrixXd::Zero(m_matHistory.rows(), iHistory);
+        matHistory.rightCols(iKeep) = m_matHistory.rightCols(iKeep);
+        m_matHistory = matHistory;
+    }
+
+    m_lCoefficients = lCoefficients;
+    m_vecImpulse = vecImpulse;
+    m_hashSpectra.clear();
+    m_iGroupDelay = vecImpulse.size() / 2;
+
+    // Windows of four times the impulse length keep at least three quarters of every FFT as new output
+    m_iMaxFftLength = nextPow2(4 * std::max<int>(1, vecImpulse.size()));
+}
+
+//=============================================================================================================
+
+void StreamingFirFilter::setPicks(const RowVectorXi& vecPicks)
+{
+    m_vecPicks = vecPicks;
+}
+
+//=============================================================================================================
+
+int StreamingFirFilter::getGroupDelay() const
+{
+    return m_iGroupDelay;
+}
+
+//=============================================================================================================
+
+int StreamingFirFilter::getNumTaps() const
+{
+    return m_vecImpulse.size();
+}
+
+//=============================================================================================================
+
+void StreamingFirFilter::setBatchSize(int iBatchSize)
+{
+    m_iBatchSize = std::max(0, iBatchSize);
+}
+
+//=============================================================================================================
+
+const RowVectorXcd& StreamingFirFilter::spectrum(int iFftLength)
+{
+    QHash<int,RowVectorXcd>::iterator it = m_hashSpectra.find(iFftLength);
+    if(it != m_hashSpectra.end()) {
+        return it.value();
+    }
+
+    VectorXd vecTime = VectorXd::Zero(iFftLength);
+    vecTime.head(m_vecImpulse.size()) = m_vecImpulse.transpose();
+
+    VectorXcd vecSpectrum(iFftLength);
+    FftPlanCache::get(true).fwd(vecSpectrum.data(), vecTime.data(), iFftLength);
+
+    return m_hashSpectra.insert(iFftLength, vecSpectrum.head(iFftLength / 2 + 1).transpose()).value();
+}
+
+//=============================================================================================================
+
+void StreamingFirFilter::process(const Ref<const MatrixXd>& matData,
+                                 MatrixXd& matDataOut,
+                                 bool bUseThreads)
+{
+    const int iNRows = matData.rows();
+    const int iNSamples = matData.cols();
+    const int iHistory = std::max<int>(0, m_vecImpulse.size() - 1);
+
+    if(matDataOut.rows() != iNRows || matDataOut.cols() != iNSamples) {
+        matDataOut.resize(iNRows, iNSamples);
+    }
+
+    if(m_matHistory.rows() != iNRows || m_matHistory.cols() != iHistory) {
+        m_matHistory = MatrixXd::Zero(iNRows, iHistory);
+    }
+
+    if(iNSamples == 0 || iNRows == 0) {
+        return;
+    }
+
+    std::vector<char> vecFiltered(iNRows, m_vecPicks.size() == 0 && m_vecImpulse.size() > 0 ? 1 : 0);
+    if(m_vecImpulse.size() > 0) {
+        for(int i = 0; i < m_vecPicks.size(); ++i) {
+            if(m_vecPicks[i] >= 0 && m_vecPicks[i] < iNRows) {
+                vecFiltered[m_vecPicks[i]] = 1;
+            }
+        }
+    }
+
+    // Short blocks are filtered in one window, long ones are split into windows of m_iMaxFftLength
+    const int iFftLength = std::min(m_iMaxFftLength, nextPow2(iHistory + iNSamples));
+    const int iStep = iFftLength - iHistory;
+    const int iNFreqs = iFftLength / 2 + 1;
+    const int iDelay = m_iGroupDelay;
+    const RowVectorXcd vecNone;
+    const RowVectorXcd& vecKernel = m_vecImpulse.size() > 0 ? spectrum(iFftLength) : vecNone;
+
+    // Give every task roughly 2^18 samples so that short blocks are not dominated by scheduling overhead
+    const int iBatchSize = m_iBatchSize > 0 ? m_iBatchSize
+                                            : std::max(1, std::min(64, (1 << 18) / std::max(iFftLength, iNSamples)));
+
+    std::function<void(QPair<int,int>&)> filterRows = [&](QPair<int,int>& range) {
+        FFT<double>& fft = FftPlanCache::get(true);
+        StreamWorkspace& ws = threadWorkspace();
+        ws.vecSignal.resize(iHistory + iNSamples);
+        if(ws.vecTime.size() != iFftLength) {
+            ws.vecTime.resize(iFftLength);
+            ws.vecSpectrum.resize(iFftLength);
+        }
+
+        for(int r = range.first; r < range.second; ++r) {
+            ws.vecSignal.head(iHistory) = m_matHistory.row(r).transpose();
+            ws.vecSignal.tail(iNSamples) = matData.row(r).transpose();
+
+            if(vecFiltered[r]) {
+                // Overlap-save: the first iHistory outputs of every window are wrapped around and dropped
+                for(int iPos = 0; iPos < iNSamples; iPos += iStep) {
+                    const int iCount = std::min(iStep, iNSamples - iPos);
+                    ws.vecTime.head(iHistory + iCount) = ws.vecSignal.segment(iPos, iHistory + iCount);
+                    ws.vecTime.tail(iFftLength - iHistory - iCount).setZero();
+
+                    fft.fwd(ws.vecSpectrum.data(), ws.vecTime.data(), iFftLength);
+                    ws.vecSpectrum.head(iNFreqs).array() *= vecKernel.transpose().array();
+                    fft.inv(ws.vecTime.data(), ws.vecSpectrum.data(), iFftLength);
+
+                    matDataOut.row(r).segment(iPos, iCount) = ws.vecTime.segment(iHistory, iCount).transpose();
+                }
+            } else {
+                matDataOut.row(r) = ws.vecSignal.segment(iHistory - iDelay, iNSamples).transpose();
+            }
+
+            m_matHistory.row(r) = ws.vecSignal.tail(iHistory).transpose();
+        }
+    };
+
+    QVector<QPair<int,int> > vecBatches;
+    for(int i = 0; i < iNRows; i += iBatchSize) {
+        vecBatches.append(qMakePair(i, std::min(i + iBatchSize, iNRows)));
+    }
+
+    if(bUseThreads && vecBatches.size() > 1) {
+        QFuture<void> future = QtConcurrent::map(vecBatches, filterRows);
+        future.waitForFinished();
+    } else {
+        for(int i = 0; i < vecBatches.size(); ++i) {
+            filterRows(vecBatches[i]);
+        }
+    }
+}
+
+//=============================================================================================================
+
+MatrixXd StreamingFirFilter::process(const MatrixXd& matData,
+                                     bool bUseThreads)
+{
+    MatrixXd matDataOut;
+    process(matData, matDataOut, bUseThreads);
+    return matDataOut;
+}
+
+//=============================================================================================================
+
+void StreamingFirFilter::flush(MatrixXd& matDataOut,
+                               bool bUseThreads)
+{
+    process(MatrixXd::Zero(m_matHistory.rows(), m_iGroupDelay), matDataOut, bUseThreads);
+    reset();
+}
+
+//=============================================================================================================
+
+void StreamingFirFilter::reset()
+{
+    m_matHistory.setZero();
+}
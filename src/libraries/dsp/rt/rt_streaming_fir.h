@@ -0,0 +1,229 @@
+//=============================================================================================================
+/**
+ * @file     rt_streaming_fir.h
+ * @author   Christoph Dinh <christoph.dinh@mne-cpp.org>
+ * @since    2.1.0
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, Christoph Dinh. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    StreamingFirFilter class declaration.
+ */
+
+#ifndef RT_STREAMING_FIR_H
+#define RT_STREAMING_FIR_H
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../dsp_global.h"
+
+#include "../filterkernel.h"
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QHash>
+#include <QList>
+#include <QSharedPointer>
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+//=============================================================================================================
+// DEFINE NAMESPACE RTPROCESSINGLIB
+//=============================================================================================================
+
+namespace RTPROCESSINGLIB
+{
+
+//=============================================================================================================
+/**
+ * Filters a continuous multi-channel stream with one FIR kernel, or a chain of kernels, using FFT based
+ * overlap-save convolution. The filter keeps the last input samples of every channel, so blocks of any length,
+ * also shorter than the filter order, can be passed one after the other without carrying overlaps around.
+ *
+ * Every call returns exactly as many samples as it was given. The output lags the input by a fixed group
+ * delay of getGroupDelay() samples, i.e. output sample n belongs to input sample n - getGroupDelay(). At the
+ * end of the stream flush() returns the remaining getGroupDelay() samples. Dropping the first getGroupDelay()
+ * output samples therefore yields the zero-phase result aligned with the input. Channels that are not picked
+ * are delayed by the same amount, so all channels stay aligned.
+ *
+ * Changing the kernel keeps the stored input history, so the stream continues without restarting.
+ *
+ * One filter must not be used from several threads at once.
+ *
+ * @brief Stateful streaming FIR filter with constant latency.
+ */
+class DSPSHARED_EXPORT StreamingFirFilter
+{
+public:
+    typedef QSharedPointer<StreamingFirFilter> SPtr;             /**< Shared pointer type for StreamingFirFilter. */
+    typedef QSharedPointer<const StreamingFirFilter> ConstSPtr;  /**< Const shared pointer type for StreamingFirFilter. */
+
+    //=========================================================================================================
+    /**
+     * Constructs a filter without a kernel, which passes the data through unchanged.
+     */
+    StreamingFirFilter();
+
+    //=========================================================================================================
+    /**
+     * Constructs a filter for a single kernel.
+     *
+     * @param[in] filterKernel       The kernel.
+     * @param[in] vecPicks           The channels to filter. Default is all channels.
+     */
+    explicit StreamingFirFilter(const UTILSLIB::FilterKernel& filterKernel,
+                                const Eigen::RowVectorXi& vecPicks = Eigen::RowVectorXi());
+
+    //=========================================================================================================
+    /**
+     * Constructs a filter for a chain of kernels.
+     *
+     * @param[in] lFilterKernels     The kernels, applied in order.
+     * @param[in] vecPicks           The channels to filter. Default is all channels.
+     */
+    explicit StreamingFirFilter(const QList<UTILSLIB::FilterKernel>& lFilterKernels,
+                                const Eigen::RowVectorXi& vecPicks = Eigen::RowVectorXi());
+
+    //=========================================================================================================
+    /**
+     * Sets a single kernel. Nothing changes if the coefficients are the same as before.
+     *
+     * @param[in] filterKernel       The kernel.
+     */
+    void setFilterKernel(const UTILSLIB::FilterKernel& filterKernel);
+
+    //=========================================================================================================
+    /**
+     * Sets a chain of kernels. Nothing changes if the coefficients are the same as before.
+     *
+     * @param[in] lFilterKernels     The kernels, applied in order.
+     */
+    void setFilterKernels(const QList<UTILSLIB::FilterKernel>& lFilterKernels);
+
+    //=========================================================================================================
+    /**
+     * Sets the channels to filter.
+     *
+     * @param[in] vecPicks           The channels to filter. An empty vector filters all channels.
+     */
+    void setPicks(const Eigen::RowVectorXi& vecPicks);
+
+    //=========================================================================================================
+    /**
+     * Returns the number of samples the output lags behind the input.
+     *
+     * @return The group delay in samples.
+     */
+    int getGroupDelay() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the length of the combined impulse response.
+     *
+     * @return The number of taps.
+     */
+    int getNumTaps() const;
+
+    //=========================================================================================================
+    /**
+     * Sets the number of channels one task filters. 0 chooses a batch size from the FFT length.
+     *
+     * @param[in] iBatchSize         The number of channels per task.
+     */
+    void setBatchSize(int iBatchSize);
+
+    //=========================================================================================================
+    /**
+     * Filters the next block of the stream. The channel count is taken from the first block; a block with a
+     * different channel count starts a new stream.
+     *
+     * @param[in] matData            The next block (channels x samples).
+     * @param[out] matDataOut        The filtered block with the same size, delayed by getGroupDelay().
+     *                               Only reallocated if its size changes.
+     * @param[in] bUseThreads        Whether to filter on the global thread pool. Default is true.
+     */
+    void process(const Eigen::Ref<const Eigen::MatrixXd>& matData,
+                 Eigen::MatrixXd& matDataOut,
+                 bool bUseThreads = true);
+
+    //=========================================================================================================
+    /**
+     * Filters the next block of the stream.
+     *
+     * @param[in] matData            The next block (channels x samples).
+     * @param[in] bUseThreads        Whether to filter on the global thread pool. Default is true.
+     *
+     * @return The filtered block with the same size, delayed by getGroupDelay().
+     */
+    Eigen::MatrixXd process(const Eigen::MatrixXd& matData,
+                            bool bUseThreads = true);
+
+    //=========================================================================================================
+    /**
+     * Ends the stream. Returns the last getGroupDelay() output samples and resets the filter.
+     *
+     * @param[out] matDataOut        The remaining samples (channels x getGroupDelay()).
+     * @param[in] bUseThreads        Whether to filter on the global thread pool. Default is true.
+     */
+    void flush(Eigen::MatrixXd& matDataOut,
+               bool bUseThreads = true);
+
+    //=========================================================================================================
+    /**
+     * Clears the stored input history, as if the stream started anew.
+     */
+    void reset();
+
+private:
+    //=========================================================================================================
+    /**
+     * Returns the half spectrum of the impulse response for the given FFT length, computing it if needed.
+     *
+     * @param[in] iFftLength         The FFT length.
+     *
+     * @return The half spectrum.
+     */
+    const Eigen::RowVectorXcd& spectrum(int iFftLength);
+
+    QList<Eigen::RowVectorXd>       m_lCoefficients;    /**< The coefficients of the kernels, applied in order. */
+    Eigen::RowVectorXd              m_vecImpulse;       /**< The combined impulse response of all kernels. */
+    QHash<int,Eigen::RowVectorXcd>  m_hashSpectra;      /**< Half spectra of m_vecImpulse per FFT length. */
+    Eigen::RowVectorXi              m_vecPicks;         /**< The channels to filter, empty for all. */
+    Eigen::MatrixXd                 m_matHistory;       /**< The last getNumTaps()-1 input samples per channel. */
+    int                             m_iGroupDelay;      /**< The output delay in samples. */
+    int                             m_iMaxFftLength;    /**< The FFT length long blocks are split into. */
+    int                             m_iBatchSize;       /**< Channels per task, 0 for automatic. */
+};
+
+} // NAMESPACE RTPROCESSINGLIB
+
+#endif // RT_STREAMING_FIR_H
@@ -0,0 +1,310 @@
+//=============================================================================================================
+/**
+ * @file     rt_streaming_iir.cpp
+ * @author   Christoph Dinh <christoph.dinh@mne-cpp.org>
+ * @since    2.1.0
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, Christoph Dinh. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    StreamingIirFilter class definition.
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rt_streaming_iir.h"
+
+#include <algorithm>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QDebug>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace RTPROCESSINGLIB;
+using namespace UTILSLIB;
+using namespace Eigen;
+
+//=============================================================================================================
+// DEFINE LOCAL FUNCTIONS
+//=============================================================================================================
+
+namespace
+{
+
+/**
+ * Runs one section over N neighbouring channels (Direct-Form II transposed, as IirFilter::applySos).
+ * pIn and pOut point at the first channel in the first sample, consecutive samples are iInStride and
+ * iOutStride apart. pIn may equal pOut. The delay lines pS1 and pS2 hold N values each and are updated.
+ */
+template<int N>
+void filterSection(const double* pIn,
+                   Index iInStride,
+                   double* pOut,
+                   Index iOutStride,
+                   Index iSamples,
+                   const IirBiquad& bq,
+                   double* pS1,
+                   double* pS2)
+{
+    typedef Array<double, N, 1> Lane;
+
+    const double b0 = bq.b0, b1 = bq.b1, b2 = bq.b2, a1 = bq.a1, a2 = bq.a2;
+    Lane s1 = Lane::Map(pS1);
+    Lane s2 = Lane::Map(pS2);
+
+    for(Index t = 0; t < iSamples; ++t) {
+        const Lane x = Lane::Map(pIn + t * iInStride);
+        const Lane y = b0 * x + s1;
+        s1 = b1 * x - a1 * y + s2;
+        s2 = b2 * x - a2 * y;
+        Lane::Map(pOut + t * iOutStride) = y;
+    }
+
+    Lane::Map(pS1) = s1;
+    Lane::Map(pS2) = s2;
+}
+
+//=============================================================================================================
+
+/**
+ * Runs the cascade over all rows of matIn into matOut, which have the same size and may be the same matrix.
+ * matState holds the delay lines of the rows, rows x (2 * sections).
+ */
+void filterRows(const Ref<const MatrixXd>& matIn,
+                MatrixXd& matOut,
+                const QVector<IirBiquad>& sos,
+                MatrixXd& matState)
+{
+    const Index iRows = matIn.rows();
+    const Index iSamples = matIn.cols();
+
+    for(Index c = 0; c < iRows; c += StreamingIirFilter::Lanes) {
+        const Index iLanes = std::min<Index>(StreamingIirFilter::Lanes, iRows - c);
+
+        for(int s = 0; s < sos.size(); ++s) {
+            // The first section reads the input, the others continue on the output
+            const double* pIn = (s == 0) ? matIn.data() + c : matOut.data() + c;
+            const Index iInStride = (s == 0) ? matIn.outerStride() : iRows;
+            double* pS1 = matState.col(2 * s).data() + c;
+            double* pS2 = matState.col(2 * s + 1).data() + c;
+
+            double* pOut = matOut.data() + c;
+
+            if(iLanes == StreamingIirFilter::Lanes) {
+                filterSection<StreamingIirFilter::Lanes>(pIn, iInStride, pOut, iRows, iSamples, sos[s], pS1, pS2);
+                continue;
+            }
+
+            // Remaining channels of the last group, in half groups where possible
+            constexpr int iHalf = StreamingIirFilter::Lanes / 2;
+            Index l = 0;
+            for(; l + iHalf <= iLanes; l += iHalf) {
+                filterSection<iHalf>(pIn + l, iInStride, pOut + l, iRows, iSamples, sos[s], pS1 + l, pS2 + l);
+            }
+            for(; l < iLanes; ++l) {
+                filterSection<1>(pIn + l, iInStride, pOut + l, iRows, iSamples, sos[s], pS1 + l, pS2 + l);
+            }
+        }
+    }
+}
+
+} // anonymous namespace
+
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+StreamingIirFilter::StreamingIirFilter()
+{
+}
+
+//=============================================================================================================
+
+StreamingIirFilter::StreamingIirFilter(const QVector<IirBiquad>& sos,
+                                       const RowVectorXi& vecPicks)
+: StreamingIirFilter()
+{
+    setSections(sos);
+    setPicks(vecPicks);
+}
+
+//=============================================================================================================
+
+void StreamingIirFilter::setSections(const QVector<IirBiquad>& sos)
+{
+    if(sos.size() == m_sos.size()
+       && std::equal(sos.cbegin(), sos.cend(), m_sos.cbegin(),
+                     [](const IirBiquad& a, const IirBiquad& b) {
+                         return a.b0 == b.b0 && a.b1 == b.b1 && a.b2 == b.b2 && a.a1 == b.a1 && a.a2 == b.a2;
+                     })) {
+        return;
+    }
+
+    m_sos = sos;
+    reset();
+}
+
+//=============================================================================================================
+
+const QVector<IirBiquad>& StreamingIirFilter::getSections() const
+{
+    return m_sos;
+}
+
+//=============================================================================================================
+
+void StreamingIirFilter::setPicks(const RowVectorXi& vecPicks)
+{
+    m_vecPicks = vecPicks;
+}
+
+//=============================================================================================================
+
+void StreamingIirFilter::process(const Ref<const MatrixXd>& matData,
+                                 MatrixXd& matDataOut)
+{
+    const Index iRows = matData.rows();
+    const Index iSamples = matData.cols();
+
+    if(matDataOut.data() != matData.data()) {
+        matDataOut.resize(iRows, iSamples);
+        // Without picks every value is written by the filter, with picks the others pass through
+        if(m_sos.isEmpty() || m_vecPicks.size() > 0) {
+            matDataOut = matData;
+        }
+    }
+
+    if(m_sos.isEmpty() || iRows == 0 || iSamples == 0) {
+        return;
+    }
+
+    // A new channel count starts a new stream
+    if(m_matState.rows() != iRows || m_matState.cols() != 2 * m_sos.size()) {
+        m_matState.setZero(iRows, 2 * m_sos.size());
+    }
+
+    if(m_vecPicks.size() == 0) {
+        filterRows(matData, matDataOut, m_sos, m_matState);
+        return;
+    }
+
+    if(m_vecPicks.minCoeff() < 0 || m_vecPicks.maxCoeff() >= iRows) {
+        qWarning() << "[StreamingIirFilter::process] Picks exceed the number of channels. Returning unfiltered data.";
+        return;
+    }
+
+    // Gather the picked channels and their delay lines into neighbouring rows, so that they fill whole lanes
+    const Index iPicks = m_vecPicks.size();
+    if(m_matPicked.rows() != iPicks || m_matPicked.cols() != iSamples) {
+        m_matPicked.resize(iPicks, iSamples);
+    }
+    if(m_matPickedState.rows() != iPicks || m_matPickedState.cols() != m_matState.cols()) {
+        m_matPickedState.resize(iPicks, m_matState.cols());
+    }
+    for(Index r = 0; r < iPicks; ++r) {
+        m_matPicked.row(r) = matDataOut.row(m_vecPicks[r]);
+        m_matPickedState.row(r) = m_matState.row(m_vecPicks[r]);
+    }
+
+    filterRows(m_matPicked, m_matPicked, m_sos, m_matPickedState);
+
+    for(Index r = 0; r < iPicks; ++r) {
+        matDataOut.row(m_vecPicks[r]) = m_matPicked.row(r);
+        m_matState.row(m_vecPicks[r]) = m_matPickedState.row(r);
+    }
+}
+
+//=============================================================================================================
+
+MatrixXd StreamingIirFilter::process(const MatrixXd& matData)
+{
+    MatrixXd matDataOut;
+    process(matData, matDataOut);
+    return matDataOut;
+}
+
+//=============================================================================================================
+
+void StreamingIirFilter::reset()
+{
+    m_matState.resize(0, 0);
+}
+
+//=============================================================================================================
+
+QVector<IirBiquad> StreamingIirFilter::designFromKernel(const FilterKernel& filterKernel,
+                                                        int iOrder)
+{
+    const QString sType = filterKernel.getFilterType().getName();
+    const double dSFreq = filterKernel.getSamplingFrequency();
+    const double dNyquist = dSFreq / 2.0;
+
+    // The kernel stores its band normalized to the Nyquist frequency
+    const double dCenter = filterKernel.getCenterFrequency() * dNyquist;
+    const double dHalfWidth = filterKernel.getBandwidth() * dNyquist / 2.0;
+
+    IirFilter::FilterType type;
+    double dLow = dCenter;
+    double dHigh = 0.0;
+
+    if(sType == "LPF") {
+        type = IirFilter::LowPass;
+    } else if(sType == "HPF") {
+        type = IirFilter::HighPass;
+    } else if(sType == "BPF" || sType == "NOTCH") {
+        type = (sType == "BPF") ? IirFilter::BandPass : IirFilter::BandStop;
+        dLow = dCenter - dHalfWidth;
+        dHigh = dCenter + dHalfWidth;
+    } else {
+        qWarning() << "[StreamingIirFilter::designFromKernel] No IIR design for filter type" << sType;
+        return QVector<IirBiquad>();
+    }
+
+    if(dSFreq <= 0.0 || dLow <= 0.0 || dLow >= dNyquist || (dHigh > 0.0 && (dHigh <= dLow || dHigh >= dNyquist))) {
+        qWarning() << "[StreamingIirFilter::designFromKernel] Band" << dLow << dHigh << "Hz is not within (0, Nyquist).";
+        return QVector<IirBiquad>();
+    }
+
+    return IirFilter::designButterworth(iOrder, type, dLow, dHigh, dSFreq);
+}
+
+//=============================================================================================================
+
+QVector<IirBiquad> StreamingIirFilter::designFromKernels(const QList<FilterKernel>& lFilterKernels,
+                                                         int iOrder)
+{
+    QVector<IirBiquad> sos;
+    for(const FilterKernel& filterKernel : lFilterKernels) {
+        sos += designFromKernel(filterKernel, iOrder);
+    }
+    return sos;
+}
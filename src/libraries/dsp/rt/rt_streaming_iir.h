@@ -0,0 +1,198 @@
+//=============================================================================================================
+/**
+ * @file     rt_streaming_iir.h
+ * @author   Christoph Dinh <christoph.dinh@mne-cpp.org>
+ * @since    2.1.0
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, Christoph Dinh. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    StreamingIirFilter class declaration.
+ */
+
+#ifndef RT_STREAMING_IIR_H
+#define RT_STREAMING_IIR_H
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../dsp_global.h"
+
+#include "../iirfilter.h"
+#include "../filterkernel.h"
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QList>
+#include <QSharedPointer>
+#include <QVector>
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+//=============================================================================================================
+// DEFINE NAMESPACE RTPROCESSINGLIB
+//=============================================================================================================
+
+namespace RTPROCESSINGLIB
+{
+
+//=============================================================================================================
+/**
+ * Filters a continuous multi-channel stream with a cascade of second-order sections, e.g. from
+ * UTILSLIB::IirFilter::designButterworth(). The two delay line values of every section and channel are kept
+ * between calls, so consecutive blocks of any length give the same result as one pass over the whole stream,
+ * without edge transients at the block borders.
+ *
+ * The filter is causal and works sample by sample, so it adds no block latency: every call returns the
+ * filtered block right away. Unlike the zero-phase FIR path it does not preserve the phase; it is meant for
+ * displays and closed-loop setups where latency matters more.
+ *
+ * Channels are processed in groups of Lanes neighbouring channels. Since matrices are stored column-major,
+ * the values of a group at one sample are contiguous and are updated together as one vector, which the
+ * compiler maps to SIMD instructions. After the first block of a given size, process() does not allocate.
+ *
+ * One filter must not be used from several threads at once.
+ *
+ * @brief Stateful multi-channel streaming IIR (biquad cascade) filter.
+ */
+class DSPSHARED_EXPORT StreamingIirFilter
+{
+public:
+    typedef QSharedPointer<StreamingIirFilter> SPtr;             /**< Shared pointer type for StreamingIirFilter. */
+    typedef QSharedPointer<const StreamingIirFilter> ConstSPtr;  /**< Const shared pointer type for StreamingIirFilter. */
+
+    static constexpr int Lanes = 8;     /**< Number of channels updated together, one AVX-512 or two AVX vectors. */
+
+    //=========================================================================================================
+    /**
+     * Constructs a filter without sections, which passes the data through unchanged.
+     */
+    StreamingIirFilter();
+
+    //=========================================================================================================
+    /**
+     * Constructs a filter for a cascade of sections.
+     *
+     * @param[in] sos                The sections, applied in order.
+     * @param[in] vecPicks           The channels to filter. Default is all channels.
+     */
+    explicit StreamingIirFilter(const QVector<UTILSLIB::IirBiquad>& sos,
+                                const Eigen::RowVectorXi& vecPicks = Eigen::RowVectorXi());
+
+    //=========================================================================================================
+    /**
+     * Sets the sections. Nothing changes if the coefficients are the same as before, otherwise the delay lines
+     * are cleared.
+     *
+     * @param[in] sos                The sections, applied in order.
+     */
+    void setSections(const QVector<UTILSLIB::IirBiquad>& sos);
+
+    //=========================================================================================================
+    /**
+     * Returns the sections.
+     *
+     * @return The sections, applied in order.
+     */
+    const QVector<UTILSLIB::IirBiquad>& getSections() const;
+
+    //=========================================================================================================
+    /**
+     * Sets the channels to filter. Channels keep their delay lines while they are not picked.
+     *
+     * @param[in] vecPicks           The channels to filter. An empty vector filters all channels.
+     */
+    void setPicks(const Eigen::RowVectorXi& vecPicks);
+
+    //=========================================================================================================
+    /**
+     * Filters the next block of the stream. The channel count is taken from the first block; a block with a
+     * different channel count starts a new stream. Channels that are not picked are copied unchanged.
+     *
+     * @param[in] matData            The next block (channels x samples).
+     * @param[out] matDataOut        The filtered block with the same size. Only reallocated if its size
+     *                               changes. May be the same matrix as matData.
+     */
+    void process(const Eigen::Ref<const Eigen::MatrixXd>& matData,
+                 Eigen::MatrixXd& matDataOut);
+
+    //=========================================================================================================
+    /**
+     * Filters the next block of the stream.
+     *
+     * @param[in] matData            The next block (channels x samples).
+     *
+     * @return The filtered block with the same size.
+     */
+    Eigen::MatrixXd process(const Eigen::MatrixXd& matData);
+
+    //=========================================================================================================
+    /**
+     * Clears the delay lines, as if the stream started anew.
+     */
+    void reset();
+
+    //=========================================================================================================
+    /**
+     * Designs a Butterworth cascade with the pass band of a FIR filter kernel, so that a kernel chosen in the
+     * filter design view can be applied with low latency.
+     *
+     * @param[in] filterKernel       The kernel whose type, band and sampling frequency are used.
+     * @param[in] iOrder             The Butterworth order. Default is 4.
+     *
+     * @return The sections, empty if the kernel type has no IIR counterpart.
+     */
+    static QVector<UTILSLIB::IirBiquad> designFromKernel(const UTILSLIB::FilterKernel& filterKernel,
+                                                          int iOrder = 4);
+
+    //=========================================================================================================
+    /**
+     * Designs the cascade of a chain of kernels, see designFromKernel().
+     *
+     * @param[in] lFilterKernels     The kernels, applied in order.
+     * @param[in] iOrder             The Butterworth order of each kernel. Default is 4.
+     *
+     * @return The sections of all kernels, applied in order.
+     */
+    static QVector<UTILSLIB::IirBiquad> designFromKernels(const QList<UTILSLIB::FilterKernel>& lFilterKernels,
+                                                           int iOrder = 4);
+
+private:
+    QVector<UTILSLIB::IirBiquad>    m_sos;              /**< The sections, applied in order. */
+    Eigen::RowVectorXi              m_vecPicks;         /**< The channels to filter, empty for all. */
+    Eigen::MatrixXd                 m_matState;         /**< Delay lines, channels x (2 * sections): s1, s2 per section. */
+    Eigen::MatrixXd                 m_matPicked;        /**< Picked channels gathered into neighbouring rows. */
+    Eigen::MatrixXd                 m_matPickedState;   /**< Delay lines of the picked channels in the order of m_matPicked. */
+};
+
+} // NAMESPACE RTPROCESSINGLIB
+
+#endif // RT_STREAMING_IIR_H
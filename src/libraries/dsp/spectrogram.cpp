@@ -37,6 +37,8 @@
 
 #include "spectrogram.h"
 
+#include <math/fft_plan_cache.h>
+
 //=============================================================================================================
 // EIGEN INCLUDES
 //=============================================================================================================
@@ -124,7 +126,7 @@ MatrixXd Spectrogram::compute(const SpectogramInputData& inputData)
         fftw_make_planner_thread_safe();
     #endif
 
-    Eigen::FFT<double> fft;
+    Eigen::FFT<double>& fft = FftPlanCache::get();
     MatrixXd tf_matrix = MatrixXd::Zero(inputData.vecInputData.rows()/2, inputData.vecInputData.rows());
     VectorXd envelope, windowed_sig, real_coeffs;
     VectorXcd fft_win_sig;
@@ -43,6 +43,9 @@
 
 #include <fiff/fiff_constants.h>
 #include <fiff/fiff_ch_info.h>
+#include <fiff/fiff_file.h>
+#include <fiff/fiff_raw_data.h>
+#include <fiff/fiff_raw_pipeline.h>
 
 //=============================================================================================================
 // EIGEN INCLUDES
@@ -56,6 +59,7 @@
 //=============================================================================================================
 
 #include <QDebug>
+#include <QtConcurrent>
 
 //=============================================================================================================
 // C++ INCLUDES
@@ -120,6 +124,21 @@ MatrixXd orthonormalCols(const MatrixXd& A)
     return qr.householderQ() * MatrixXd::Identity(A.rows(), rank);
 }
 
+//=============================================================================================================
+/**
+ * @brief Apply tSSS to one window of MEG data (n_meg × winLen) in place.
+ */
+void temporalProjectWindow(Ref<MatrixXd> megWin, const SSS::Basis& basis, double dCorrLimit)
+{
+    MatrixXd cIn  = basis.matPinvAll.topRows(basis.iNin) * megWin;      // N_in  × winLen
+    MatrixXd cOut = basis.matPinvAll.bottomRows(basis.iNout) * megWin;  // N_out × winLen
+
+    SSS::temporalProject(cIn, cOut, dCorrLimit);
+
+    // Reconstruct cleaned MEG data from internal expansion
+    megWin = basis.matSin * cIn;
+}
+
 } // anonymous namespace
 
 //=============================================================================================================
@@ -452,7 +471,8 @@ MatrixXd SSS::apply(const MatrixXd& matData, const Basis& basis)
 MatrixXd SSS::applyTemporal(const MatrixXd& matData,
                               const Basis&   basis,
                               int            iBufferLength,
-                              double         dCorrLimit)
+                              double         dCorrLimit,
+                              bool           bUseThreads)
 {
     if (basis.megChannelIdx.isEmpty()) {
         return matData;
@@ -460,7 +480,7 @@ MatrixXd SSS::applyTemporal(const MatrixXd& matData,
 
     const int nMeg    = basis.megChannelIdx.size();
     const int nSamp   = static_cast<int>(matData.cols());
-    const int bufLen  = std::min(iBufferLength, nSamp);
+    const int bufLen  = std::max(1, std::min(iBufferLength, nSamp));
 
     MatrixXd matOut = matData;
 
@@ -470,66 +490,134 @@ MatrixXd SSS::applyTemporal(const MatrixXd& matData,
         megData.row(i) = matData.row(basis.megChannelIdx[i]);
     }
 
-    // Decompose time series into expansion coefficients
-    // c_in  (N_in  × nSamp) = pinv_all[:N_in , :] * megData
-    // c_out (N_out × nSamp) = pinv_all[N_in: , :] * megData
-    MatrixXd cIn  = basis.matPinvAll.topRows(basis.iNin)  * megData;   // N_in  × nSamp
-    MatrixXd cOut = basis.matPinvAll.bottomRows(basis.iNout) * megData; // N_out × nSamp
-
-    // Process in sliding windows
-    int offset = 0;
-    while (offset < nSamp) {
-        int winLen = std::min(bufLen, nSamp - offset);
-
-        // Window slices
-        MatrixXd cInWin  = cIn.middleCols(offset, winLen);   // N_in  × winLen
-        MatrixXd cOutWin = cOut.middleCols(offset, winLen);  // N_out × winLen
-
-        // ---- Temporal tSSS projection ----
-        // SVD of external coefficient matrix (column = time point):
-        // cOutWin = U * S * V^T   (N_out × winLen)
-        // Right singular vectors V (winLen × min) form the temporal subspace of external signals.
-        JacobiSVD<MatrixXd> svd(cOutWin, ComputeThinU | ComputeThinV);
-        const VectorXd& sv   = svd.singularValues();
-        const MatrixXd& V    = svd.matrixV();   // winLen × rank_out
-
-        // Determine how many external temporal components to suppress
-        double svMax = (sv.size() > 0) ? sv(0) : 0.0;
-        if (svMax < 1e-30) {
-            offset += winLen;
-            continue;
+    // The windows do not overlap and are independent, each one only touches its own columns
+    QVector<int> vecOffsets;
+    for (int offset = 0; offset < nSamp; offset += bufLen) {
+        vecOffsets.append(offset);
+    }
+
+    auto processWindow = [&](int offset) {
+        temporalProjectWindow(megData.middleCols(offset, std::min(bufLen, nSamp - offset)), basis, dCorrLimit);
+    };
+
+    if (bUseThreads && vecOffsets.size() > 1) {
+        QtConcurrent::blockingMap(vecOffsets, processWindow);
+    } else {
+        for (int offset : vecOffsets) {
+            processWindow(offset);
         }
+    }
 
-        // Build temporal projector to remove the correlated subspace
-        // P_remove: (winLen × winLen) = V_r * V_r^T
-        // Applied: cInWin_clean = cInWin * (I - P_remove)
-        MatrixXd Vr;   // winLen × n_remove
-        int nRemove = 0;
-        for (int k = 0; k < sv.size(); ++k) {
-            if (sv(k) / svMax > dCorrLimit) {
-                ++nRemove;
-            } else {
-                break;
-            }
+    // Write back
+    for (int i = 0; i < nMeg; ++i) {
+        matOut.row(basis.megChannelIdx[i]) = megData.row(i);
+    }
+
+    return matOut;
+}
+
+//=============================================================================================================
+
+void SSS::temporalProject(Ref<MatrixXd>              matCoeffIn,
+                          const Ref<const MatrixXd>& matCoeffOut,
+                          double                     dCorrLimit)
+{
+    // The temporal subspace of the external expansion is obtained from the N_out × N_out Gram matrix
+    // c_out * c_out^T instead of an SVD of c_out: its eigenvectors are the left singular vectors U and its
+    // eigenvalues the squared singular values, so the right singular vectors follow as V = c_out^T * U / s.
+    SelfAdjointEigenSolver<MatrixXd> eig(matCoeffOut * matCoeffOut.transpose());
+    if (eig.info() != Success) {
+        return;
+    }
+
+    // Eigenvalues are in increasing order, the dominant component is the last one
+    const VectorXd sv = eig.eigenvalues().cwiseMax(0.0).cwiseSqrt();
+    const int nOut = static_cast<int>(sv.size());
+    const double svMax = (nOut > 0) ? sv(nOut - 1) : 0.0;
+
+    int nRemove = 0;
+    if (svMax >= 1e-30) {
+        while (nRemove < nOut && sv(nOut - 1 - nRemove) / svMax > dCorrLimit) {
+            ++nRemove;
         }
+    }
+
+    if (nRemove == 0) {
+        return;
+    }
+
+    // V_r = c_out^T * U_r * S_r^-1   (winLen × nRemove)
+    const VectorXd invSv = sv.tail(nRemove).cwiseInverse();
+    MatrixXd Vr = matCoeffOut.transpose() * (eig.eigenvectors().rightCols(nRemove) * invSv.asDiagonal());
+
+    // c_in_clean = c_in - (c_in * V_r) * V_r^T, never forming the winLen × winLen projector
+    matCoeffIn -= (matCoeffIn * Vr) * Vr.transpose();
+}
 
-        if (nRemove > 0) {
-            Vr = V.leftCols(nRemove);   // winLen × nRemove
-            // cInWin_clean = cInWin * (I - Vr * Vr^T)
-            MatrixXd cInWinClean = cInWin - cInWin * (Vr * Vr.transpose());
-            cIn.middleCols(offset, winLen) = cInWinClean;
+//=============================================================================================================
+
+bool SSS::applyTemporalFile(QIODevice&         pIODevice,
+                            const FiffRawData& raw,
+                            const Basis&       basis,
+                            int                iBufferLength,
+                            double             dCorrLimit,
+                            int                iNumWorkers)
+{
+    if (raw.isEmpty() || iBufferLength < 1) {
+        qWarning("[SSS::applyTemporalFile] No raw data or invalid window length.");
+        return false;
+    }
+
+    for (int idx : basis.megChannelIdx) {
+        if (idx >= raw.info.nchan) {
+            qWarning("[SSS::applyTemporalFile] The basis does not match the channels of the raw data.");
+            return false;
         }
+    }
 
-        offset += winLen;
+    RowVectorXd cals;
+    FiffStream::SPtr outfid = FiffStream::start_writing_raw(pIODevice, raw.info, cals);
+    if (!outfid) {
+        qWarning("[SSS::applyTemporalFile] Could not start writing the raw file.");
+        return false;
     }
 
-    // Reconstruct cleaned MEG data from internal expansion
-    MatrixXd megTsss = basis.matSin * cIn;   // n_meg × nSamp
+    fiff_int_t from = raw.first_samp;
+    if (from > 0) {
+        outfid->write_int(FIFF_FIRST_SAMPLE, &from);
+    }
+    outfid->start_write_behind();
 
-    // Write back
-    for (int i = 0; i < nMeg; ++i) {
-        matOut.row(basis.megChannelIdx[i]) = megTsss.row(i);
+    // One block is one tSSS window, so the windows are the same as for applyTemporal on the whole recording
+    FiffRawPipeline pipeline(raw, iBufferLength);
+    pipeline.setNumWorkers(iNumWorkers);
+
+    const int nMeg = basis.megChannelIdx.size();
+    FiffRawPipeline::Transform tsssBlock = [&](FiffRawBlock& block) {
+        if (nMeg == 0) {
+            return true;
+        }
+
+        MatrixXd megWin(nMeg, block.matData.cols());
+        for (int i = 0; i < nMeg; ++i) {
+            megWin.row(i) = block.matData.row(basis.megChannelIdx[i]);
+        }
+
+        temporalProjectWindow(megWin, basis, dCorrLimit);
+
+        for (int i = 0; i < nMeg; ++i) {
+            block.matData.row(basis.megChannelIdx[i]) = megWin.row(i);
+        }
+        return true;
+    };
+
+    if (!pipeline.run(tsssBlock, outfid, cals)) {
+        qWarning("[SSS::applyTemporalFile] Error while processing the raw data.");
+        outfid->finish_writing_raw();
+        return false;
     }
 
-    return matOut;
+    outfid->finish_writing_raw();
+
+    return true;
 }
@@ -71,6 +71,16 @@
 
 #include <QVector>
 
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+class QIODevice;
+
+namespace FIFFLIB {
+    class FiffRawData;
+}
+
 //=============================================================================================================
 // DEFINE NAMESPACE UTILSLIB
 //=============================================================================================================
@@ -96,6 +106,10 @@ namespace UTILSLIB
  *
  *   // Apply tSSS (additionally suppress near-field artefacts)
  *   Eigen::MatrixXd tSssData  = SSS::applyTemporal(rawMegData, basis);
+ *
+ *   // Apply tSSS to a whole raw file in bounded memory
+ *   QFile outFile("raw_tsss.fif");
+ *   SSS::applyTemporalFile(outFile, raw, basis);
  * @endcode
  */
 /** @brief Configuration parameters for SSS/tSSS (defined outside class to work around a Clang default-argument/nested-struct limitation). */
@@ -172,13 +186,55 @@ public:
      * @param[in] dCorrLimit    Correlation threshold [0, 1]; singular vectors of the external
      *                          subspace whose normalised value exceeds this are removed from the
      *                          internal expansion (default 0.98).
+     * @param[in] bUseThreads   Whether to process the windows in parallel (default true).
      *
      * @return tSSS-cleaned data (n_channels × n_samples).
      */
     static Eigen::MatrixXd applyTemporal(const Eigen::MatrixXd& matData,
                                           const Basis&           basis,
                                           int                    iBufferLength = 10000,
-                                          double                 dCorrLimit    = 0.98);
+                                          double                 dCorrLimit    = 0.98,
+                                          bool                   bUseThreads   = true);
+
+    //=========================================================================================================
+    /**
+     * Remove the temporal subspace of the external expansion from the internal expansion of one tSSS window.
+     *
+     * This is the temporal step of applyTemporal() on expansion coefficients, for callers that compute the
+     * coefficients themselves, e.g. with a different basis for each head position of the window.
+     *
+     * @param[in, out] matCoeffIn   Internal expansion coefficients of the window (N_in × winLen).
+     * @param[in] matCoeffOut       External expansion coefficients of the window (N_out × winLen).
+     * @param[in] dCorrLimit        Correlation threshold [0, 1], see applyTemporal().
+     */
+    static void temporalProject(Eigen::Ref<Eigen::MatrixXd>              matCoeffIn,
+                                const Eigen::Ref<const Eigen::MatrixXd>& matCoeffOut,
+                                double                                   dCorrLimit = 0.98);
+
+    //=========================================================================================================
+    /**
+     * Apply tSSS to a raw file and write the result as a new raw file.
+     *
+     * The file is read window by window, each block of the pipeline being one tSSS window, so only the
+     * windows in flight are held in memory and recordings of any length can be processed. The windows are
+     * independent and are processed by several workers; they are written in file order. The result equals
+     * applyTemporal() on the whole recording with the same window length.
+     *
+     * @param[in] pIODevice     The IO device to write the raw file to.
+     * @param[in] raw           The raw data to read. basis must have been computed from its measurement info.
+     * @param[in] basis         Precomputed basis from computeBasis().
+     * @param[in] iBufferLength Window length in samples (default 10000 ≈ 10 s at 1 kHz).
+     * @param[in] dCorrLimit    Correlation threshold [0, 1], see applyTemporal() (default 0.98).
+     * @param[in] iNumWorkers   Number of worker threads, 0 for one per core (default 0).
+     *
+     * @return true if successful, false otherwise.
+     */
+    static bool applyTemporalFile(QIODevice&                  pIODevice,
+                                  const FIFFLIB::FiffRawData& raw,
+                                  const Basis&                basis,
+                                  int                         iBufferLength = 10000,
+                                  double                      dCorrLimit    = 0.98,
+                                  int                         iNumWorkers   = 0);
 
 private:
     //=========================================================================================================
@@ -37,6 +37,8 @@
 
 #include "welch_psd.h"
 
+#include <math/fft_plan_cache.h>
+
 //=============================================================================================================
 // EIGEN INCLUDES
 //=============================================================================================================
@@ -130,7 +132,7 @@ RowVectorXd WelchPsd::computeVector(const RowVectorXd& vecData,
     const VectorXd w       = buildWindow(iNfft, window);
     const double   dWinPow = w.squaredNorm();  // Σ w²
 
-    Eigen::FFT<double> fft;
+    Eigen::FFT<double>& fft = FftPlanCache::get();
     RowVectorXd psd = RowVectorXd::Zero(iNFreqs);
     int nSeg = 0;
 
@@ -577,6 +577,29 @@ FiffCov FiffCov::compute_from_epochs(const FiffRawData &raw,
         return cov;
     }
 
+    cov = compute_from_sums(raw.info, covAccum, meanAccum, totalSamples, removeMean);
+
+    qInfo() << "[FiffCov::compute_from_epochs] Computed:" << nchan << "channels,"
+            << nAccepted << "epochs," << totalSamples << "total samples.";
+
+    return cov;
+}
+
+//=============================================================================================================
+
+FiffCov FiffCov::compute_from_sums(const FiffInfo &info,
+                                   const MatrixXd &covAccum,
+                                   const VectorXd &meanAccum,
+                                   int totalSamples,
+                                   bool removeMean)
+{
+    FiffCov cov;
+
+    if (totalSamples < 2) {
+        qWarning() << "[FiffCov::compute_from_sums] Not enough data.";
+        return cov;
+    }
+
     if (removeMean) {
         VectorXd grandMean = meanAccum / static_cast<double>(totalSamples);
         cov.data = (covAccum / static_cast<double>(totalSamples - 1))
@@ -586,14 +609,11 @@ FiffCov FiffCov::compute_from_epochs(const FiffRawData &raw,
     }
 
     cov.kind  = FIFFV_MNE_NOISE_COV;
-    cov.dim   = nchan;
-    cov.names = raw.info.ch_names;
+    cov.dim   = info.nchan;
+    cov.names = info.ch_names;
     cov.nfree = totalSamples - 1;
-    cov.bads  = raw.info.bads;
-    cov.projs = raw.info.projs;
-
-    qInfo() << "[FiffCov::compute_from_epochs] Computed:" << nchan << "channels,"
-            << nAccepted << "epochs," << totalSamples << "total samples.";
+    cov.bads  = info.bads;
+    cov.projs = info.projs;
 
     return cov;
 }
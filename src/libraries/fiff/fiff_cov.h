@@ -205,6 +205,25 @@ public:
                                        unsigned int ignoreMask = 0,
                                        float delay = 0.0f);
 
+    //=========================================================================================================
+    /**
+     * Finishes a noise covariance from the sums compute_from_epochs accumulates over the epochs, for callers
+     * that gather the epochs themselves, e.g. while streaming the raw data.
+     *
+     * @param[in] info          The measurement info of the epochs.
+     * @param[in] covAccum      Sum of epoch * epoch^T over all epochs (nchan x nchan).
+     * @param[in] meanAccum     Sum of the per-epoch channel means times the epoch length (nchan).
+     * @param[in] totalSamples  Total number of samples in all epochs.
+     * @param[in] removeMean    Whether to remove the grand mean.
+     *
+     * @return The noise covariance matrix, or empty FiffCov if there are less than two samples.
+     */
+    static FiffCov compute_from_sums(const FiffInfo &info,
+                                     const Eigen::MatrixXd &covAccum,
+                                     const Eigen::VectorXd &meanAccum,
+                                     int totalSamples,
+                                     bool removeMean = true);
+
     //=========================================================================================================
     /**
      * Save this covariance matrix to a FIFF file.
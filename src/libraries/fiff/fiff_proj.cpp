@@ -294,7 +294,6 @@ QList<FiffProj> FiffProj::compute_from_raw(const FiffRawData &raw,
 {
     QList<FiffProj> projs;
     float sfreq = raw.info.sfreq;
-    int nchan   = raw.info.nchan;
 
     int minSamp = static_cast<int>(std::round(tmin * sfreq));
     int maxSamp = static_cast<int>(std::round(tmax * sfreq));
@@ -305,26 +304,8 @@ QList<FiffProj> FiffProj::compute_from_raw(const FiffRawData &raw,
         return projs;
     }
 
-    // Classify channels
-    QList<int> gradIdx, magIdx, eegIdx;
-    for (int k = 0; k < nchan; ++k) {
-        if (raw.info.bads.contains(raw.info.ch_names[k]))
-            continue;
-        if (raw.info.chs[k].kind == FIFFV_MEG_CH) {
-            if (raw.info.chs[k].unit == FIFF_UNIT_T)
-                magIdx.append(k);
-            else
-                gradIdx.append(k);
-        } else if (raw.info.chs[k].kind == FIFFV_EEG_CH) {
-            eegIdx.append(k);
-        }
-    }
-
     // Collect matching epochs
     QList<MatrixXd> epochs;
-    double gradReject = mapReject.value("grad", 0.0);
-    double magReject  = mapReject.value("mag", 0.0);
-    double eegReject  = mapReject.value("eeg", 0.0);
 
     for (int k = 0; k < events.rows(); ++k) {
         if (events(k, 1) != 0 || events(k, 2) != eventCode)
@@ -341,22 +322,8 @@ QList<FiffProj> FiffProj::compute_from_raw(const FiffRawData &raw,
         if (!raw.read_raw_segment(epochData, epochTimes, epochStart, epochEnd))
             continue;
 
-        // Simple peak-to-peak rejection
-        bool ok = true;
-        for (int c = 0; c < nchan && ok; ++c) {
-            if (raw.info.bads.contains(raw.info.ch_names[c]))
-                continue;
-            double pp = epochData.row(c).maxCoeff() - epochData.row(c).minCoeff();
-            if (raw.info.chs[c].kind == FIFFV_MEG_CH) {
-                if (raw.info.chs[c].unit == FIFF_UNIT_T && magReject > 0 && pp > magReject)
-                    ok = false;
-                else if (raw.info.chs[c].unit != FIFF_UNIT_T && gradReject > 0 && pp > gradReject)
-                    ok = false;
-            } else if (raw.info.chs[c].kind == FIFFV_EEG_CH && eegReject > 0 && pp > eegReject) {
-                ok = false;
-            }
-        }
-        if (!ok) continue;
+        if (!check_epoch(raw.info, epochData, mapReject))
+            continue;
 
         epochs.append(epochData);
     }
@@ -368,6 +335,70 @@ QList<FiffProj> FiffProj::compute_from_raw(const FiffRawData &raw,
 
     qInfo() << "[FiffProj::compute_from_raw]" << epochs.size() << "epochs collected for event" << eventCode;
 
+    return compute_from_epochs(raw.info, epochs, nGrad, nMag, nEeg);
+}
+
+//=============================================================================================================
+
+bool FiffProj::check_epoch(const FiffInfo &info,
+                           const MatrixXd &epoch,
+                           const QMap<QString,double> &mapReject)
+{
+    double gradReject = mapReject.value("grad", 0.0);
+    double magReject  = mapReject.value("mag", 0.0);
+    double eegReject  = mapReject.value("eeg", 0.0);
+
+    // Simple peak-to-peak rejection
+    for (int c = 0; c < info.nchan; ++c) {
+        if (info.bads.contains(info.ch_names[c]))
+            continue;
+        double pp = epoch.row(c).maxCoeff() - epoch.row(c).minCoeff();
+        if (info.chs[c].kind == FIFFV_MEG_CH) {
+            if (info.chs[c].unit == FIFF_UNIT_T && magReject > 0 && pp > magReject)
+                return false;
+            else if (info.chs[c].unit != FIFF_UNIT_T && gradReject > 0 && pp > gradReject)
+                return false;
+        } else if (info.chs[c].kind == FIFFV_EEG_CH && eegReject > 0 && pp > eegReject) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//=============================================================================================================
+
+QList<FiffProj> FiffProj::compute_from_epochs(const FiffInfo &info,
+                                              const QList<MatrixXd> &epochs,
+                                              int nGrad,
+                                              int nMag,
+                                              int nEeg)
+{
+    QList<FiffProj> projs;
+    int nchan = info.nchan;
+
+    if (epochs.isEmpty()) {
+        qWarning() << "[FiffProj::compute_from_epochs] No epochs.";
+        return projs;
+    }
+
+    int ns = static_cast<int>(epochs.first().cols());
+
+    // Classify channels
+    QList<int> gradIdx, magIdx, eegIdx;
+    for (int k = 0; k < nchan; ++k) {
+        if (info.bads.contains(info.ch_names[k]))
+            continue;
+        if (info.chs[k].kind == FIFFV_MEG_CH) {
+            if (info.chs[k].unit == FIFF_UNIT_T)
+                magIdx.append(k);
+            else
+                gradIdx.append(k);
+        } else if (info.chs[k].kind == FIFFV_EEG_CH) {
+            eegIdx.append(k);
+        }
+    }
+
     // Lambda: compute SVD-based projectors for a channel subset
     auto computeProjForChannels = [&](const QList<int> &chIdx, int nVec, const QString &desc) {
         if (nVec <= 0 || chIdx.isEmpty())
@@ -402,7 +433,7 @@ QList<FiffProj> FiffProj::compute_from_raw(const FiffRawData &raw,
             namedMatrix->nrow = 1;
             namedMatrix->ncol = nchan;
             namedMatrix->row_names.clear();
-            namedMatrix->col_names = raw.info.ch_names;
+            namedMatrix->col_names = info.ch_names;
             namedMatrix->data = MatrixXd::Zero(1, nchan);
 
             for (int c = 0; c < chIdx.size(); ++c) {
@@ -413,7 +444,7 @@ QList<FiffProj> FiffProj::compute_from_raw(const FiffRawData &raw,
             projs.append(proj);
         }
 
-        qInfo() << "[FiffProj::compute_from_raw] Created" << nComp << desc << "projection vector(s)";
+        qInfo() << "[FiffProj::compute_from_epochs] Created" << nComp << desc << "projection vector(s)";
     };
 
     computeProjForChannels(gradIdx, nGrad, "PCA-grad");
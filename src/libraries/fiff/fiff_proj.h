@@ -73,6 +73,7 @@ namespace FIFFLIB
 //=============================================================================================================
 
 class FiffRawData;
+class FiffInfo;
 
 //=============================================================================================================
 /**
@@ -176,6 +177,39 @@ public:
                                             int nEeg,
                                             const QMap<QString,double> &mapReject = QMap<QString,double>());
 
+    //=========================================================================================================
+    /**
+     * Create SSP operators from already collected epochs via SVD. This is the second half of
+     * compute_from_raw, for callers that gather the epochs themselves, e.g. while streaming the raw data.
+     *
+     * @param[in] info          The measurement info of the epochs.
+     * @param[in] epochs        The accepted epochs (channels x samples), all of the same length.
+     * @param[in] nGrad         Number of gradiometer projection vectors.
+     * @param[in] nMag          Number of magnetometer projection vectors.
+     * @param[in] nEeg          Number of EEG projection vectors.
+     *
+     * @return List of FiffProj items, or empty list on failure.
+     */
+    static QList<FiffProj> compute_from_epochs(const FiffInfo &info,
+                                               const QList<Eigen::MatrixXd> &epochs,
+                                               int nGrad,
+                                               int nMag,
+                                               int nEeg);
+
+    //=========================================================================================================
+    /**
+     * Peak-to-peak rejection used for the epochs of compute_from_raw. Bad channels are skipped.
+     *
+     * @param[in] info          The measurement info of the epoch.
+     * @param[in] epoch         The epoch (channels x samples).
+     * @param[in] mapReject     Rejection thresholds (key = channel type string, value = threshold).
+     *
+     * @return True if the epoch is accepted.
+     */
+    static bool check_epoch(const FiffInfo &info,
+                            const Eigen::MatrixXd &epoch,
+                            const QMap<QString,double> &mapReject);
+
     //=========================================================================================================
     /**
      * overloading the stream out operator<<
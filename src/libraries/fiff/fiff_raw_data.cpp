@@ -42,9 +42,15 @@
 #include "fiff_events.h"
 #include "fiff_tag.h"
 #include "fiff_stream.h"
+#include "fiff_byte_swap.h"
 #include "cstdlib"
 
+#include <cstring>
 #include <stdexcept>
+
+#include <QDebug>
+#include <QMutex>
+#include <QMutexLocker>
 //=============================================================================================================
 // USED NAMESPACES
 //=============================================================================================================
@@ -52,6 +58,86 @@
 using namespace FIFFLIB;
 using namespace Eigen;
 
+//=============================================================================================================
+// DEFINE LOCAL FUNCTIONS
+//=============================================================================================================
+
+namespace
+{
+
+const qint64 FIFF_TAG_HEADER_SIZE = 4 * sizeof(fiff_int_t);   /**< kind, type, size and next precede the tag data. */
+
+inline qint16 swap_sample(qint16 value) { return swap_short(value); }
+inline qint32 swap_sample(qint32 value) { return swap_int(value); }
+inline float swap_sample(float value) { return swap_float(value); }
+
+//=============================================================================================================
+
+template<typename T>
+inline double load_sample(const uchar* pSrc, bool bSwap)
+{
+    T value;
+    std::memcpy(&value, pSrc, sizeof(T));
+    return static_cast<double>(bSwap ? swap_sample(value) : value);
+}
+
+//=============================================================================================================
+/**
+ * Decodes picksamp samples, starting at first_pick, of a memory-mapped data buffer into data.
+ * With a multiplication matrix the raw channels are staged column by column in work and multiplied once,
+ * otherwise the calibrated samples of the selected channels are written to data directly.
+ */
+template<typename T>
+void decode_mapped_buffer(const uchar* pPayload,
+                          qint32 nchan,
+                          fiff_int_t first_pick,
+                          fiff_int_t picksamp,
+                          bool bSwap,
+                          const SparseMatrix<double>& mult,
+                          const VectorXi& rows,
+                          const VectorXd& scale,
+                          MatrixXd& work,
+                          MatrixXd& data,
+                          qint32 dest)
+{
+    const qint64 colBytes = static_cast<qint64>(nchan) * sizeof(T);
+    const uchar* pCol = pPayload + first_pick * colBytes;
+
+    if(mult.cols() > 0) {
+        for(fiff_int_t c = 0; c < picksamp; ++c, pCol += colBytes) {
+            double* pWork = work.col(c).data();
+            for(qint32 ch = 0; ch < nchan; ++ch) {
+                pWork[ch] = load_sample<T>(pCol + ch * sizeof(T), bSwap);
+            }
+        }
+        data.middleCols(dest, picksamp).noalias() = mult * work.leftCols(picksamp);
+    } else {
+        for(fiff_int_t c = 0; c < picksamp; ++c, pCol += colBytes) {
+            double* pOut = data.col(dest + c).data();
+            for(Index r = 0; r < rows.size(); ++r) {
+                pOut[r] = scale[r] * load_sample<T>(pCol + rows[r] * sizeof(T), bSwap);
+            }
+        }
+    }
+}
+
+} // anonymous namespace
+
+//=============================================================================================================
+// DEFINE PRIVATE TYPES
+//=============================================================================================================
+
+struct FiffRawData::OperatorCache
+{
+    QMutex                              mutex;      /**< Guards the cache, read_raw_segment may be called concurrently. */
+    RowVectorXi                         sel;        /**< Channel selection the operator was built for. */
+    fiff_int_t                          compKind = -1;  /**< Compensation kind the operator was built for. */
+    MatrixXd                            proj;       /**< SSP operator the operator was built from. */
+    MatrixXd                            compData;   /**< Compensation matrix the operator was built from. */
+    RowVectorXd                         cals;       /**< Calibration values the operator was built from. */
+    QSharedPointer<const RawOperator>   pOperator;  /**< The cached operator, null if nothing is cached. */
+};
+
 //=============================================================================================================
 // DEFINE MEMBER METHODS
 //=============================================================================================================
@@ -59,6 +145,9 @@ using namespace Eigen;
 FiffRawData::FiffRawData()
 : first_samp(-1)
 , last_samp(-1)
+, m_pMappedData(nullptr)
+, m_iMappedSize(0)
+, m_pOperatorCache(new OperatorCache)
 {
 }
 
@@ -67,6 +156,9 @@ FiffRawData::FiffRawData()
 FiffRawData::FiffRawData(QIODevice &p_IODevice)
 : first_samp(-1)
 , last_samp(-1)
+, m_pMappedData(nullptr)
+, m_iMappedSize(0)
+, m_pOperatorCache(new OperatorCache)
 {
     //setup FiffRawData object
     if(!FiffStream::setup_read_raw(p_IODevice, *this))
@@ -80,6 +172,9 @@ FiffRawData::FiffRawData(QIODevice &p_IODevice)
 FiffRawData::FiffRawData(QIODevice &p_IODevice, bool b_littleEndian)
 : first_samp(-1)
 , last_samp(-1)
+, m_pMappedData(nullptr)
+, m_iMappedSize(0)
+, m_pOperatorCache(new OperatorCache)
 {
     //setup FiffRawData object
     if(!FiffStream::setup_read_raw(p_IODevice, *this, false, b_littleEndian))
@@ -99,6 +194,10 @@ FiffRawData::FiffRawData(const FiffRawData &p_FiffRawData)
 , rawdir(p_FiffRawData.rawdir)
 , proj(p_FiffRawData.proj)
 , comp(p_FiffRawData.comp)
+, m_pMappedFile(p_FiffRawData.m_pMappedFile)
+, m_pMappedData(p_FiffRawData.m_pMappedData)
+, m_iMappedSize(p_FiffRawData.m_iMappedSize)
+, m_pOperatorCache(new OperatorCache)
 {
 }
 
@@ -119,6 +218,51 @@ void FiffRawData::clear()
     rawdir.clear();
     proj = MatrixXd();
     comp.clear();
+    unmapFile();
+    m_pOperatorCache.reset(new OperatorCache);
+}
+
+//=============================================================================================================
+
+bool FiffRawData::mapFile()
+{
+    if(isMapped()) {
+        return true;
+    }
+
+    QFile* pStreamFile = this->file ? qobject_cast<QFile*>(this->file->device()) : nullptr;
+    if(!pStreamFile) {
+        qWarning() << "[FiffRawData::mapFile] Only file-based raw data can be memory-mapped.";
+        return false;
+    }
+
+    // Map through a separate handle so that opening/closing the stream does not drop the mapping
+    QSharedPointer<QFile> pMappedFile(new QFile(pStreamFile->fileName()));
+    if(!pMappedFile->open(QIODevice::ReadOnly)) {
+        qWarning() << "[FiffRawData::mapFile] Cannot open" << pStreamFile->fileName();
+        return false;
+    }
+
+    const uchar* pData = pMappedFile->map(0, pMappedFile->size());
+    if(!pData) {
+        qWarning() << "[FiffRawData::mapFile] Cannot map" << pStreamFile->fileName() << ":" << pMappedFile->errorString();
+        return false;
+    }
+
+    m_pMappedFile = pMappedFile;
+    m_pMappedData = pData;
+    m_iMappedSize = pMappedFile->size();
+
+    return true;
+}
+
+//=============================================================================================================
+
+void FiffRawData::unmapFile()
+{
+    m_pMappedFile.reset();
+    m_pMappedData = nullptr;
+    m_iMappedSize = 0;
 }
 
 //=============================================================================================================
@@ -131,13 +275,6 @@ bool FiffRawData::read_raw_segment(MatrixXd& data,
                                    const RowVectorXi& sel,
                                    bool do_debug) const
 {
-    bool projAvailable = true;
-
-    if (this->proj.size() == 0) {
-        //qDebug() << "FiffRawData::read_raw_segment - No projectors setup. Consider calling MNE::setup_compensators.";
-        projAvailable = false;
-    }
-
     if(from == -1)
         from = this->first_samp;
     if(to == -1)
@@ -163,92 +300,25 @@ bool FiffRawData::read_raw_segment(MatrixXd& data,
     qint32 dest  = 0;//1;
     qint32 i, k, r;
 
-    using T = Eigen::Triplet<double>;
-    std::vector<T> tripletList;
-    tripletList.reserve(nchan);
-    for(i = 0; i < nchan; ++i)
-        tripletList.push_back(T(i, i, this->cals[i]));
+    data = MatrixXd(sel.size() == 0 ? nchan : sel.size(), to-from+1);
 
-    SparseMatrix<double> cal(nchan, nchan);
-    cal.setFromTriplets(tripletList.begin(), tripletList.end());
-//    cal.makeCompressed();
+    QSharedPointer<const RawOperator> pOperator = get_operator(sel);
+    const SparseMatrix<double>& cal = pOperator->cal;
+    const SparseMatrix<double>& mult = pOperator->mult;
 
-    MatrixXd mult_full;
-    //
-    if (sel.size() == 0)
+    if (this->isMapped())
     {
-        data = MatrixXd(nchan, to-from+1);
-//            data->setZero();
-        if (projAvailable || this->comp.kind != -1)
-        {
-            if (!projAvailable)
-                mult_full = this->comp.data->data*cal;
-            else if (this->comp.kind == -1)
-                mult_full = this->proj*cal;
-            else
-                mult_full = this->proj*this->comp.data->data*cal;
-        }
-    }
-    else
-    {
-        data = MatrixXd(sel.size(),to-from+1);
-//            data->setZero();
+        if (!read_mapped_segment(data, from, to, sel, mult, cal))
+            return false;
 
-        MatrixXd selVect(sel.size(), nchan);
+        times = MatrixXd(1, to-from+1);
 
-        selVect.setZero();
+        for (i = 0; i < times.cols(); ++i)
+            times(0, i) = static_cast<float>(from+i) / this->info.sfreq;
 
-        if (!projAvailable && this->comp.kind == -1)
-        {
-            tripletList.clear();
-            tripletList.reserve(sel.size());
-            for(i = 0; i < sel.size(); ++i)
-                tripletList.push_back(T(i, i, this->cals[sel[i]]));
-            cal = SparseMatrix<double>(sel.size(), sel.size());
-            cal.setFromTriplets(tripletList.begin(), tripletList.end());
-        }
-        else
-        {
-            if (!projAvailable)
-            {
-                qDebug() << "This has to be debugged! #1";
-                for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->comp.data->data.block(sel[i],0,1,nchan);
-                mult_full = selVect*cal;
-            }
-            else if (this->comp.kind == -1)
-            {
-                for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->proj.block(sel[i],0,1,nchan);
-
-                mult_full = selVect*cal;
-            }
-            else
-            {
-                qDebug() << "This has to be debugged! #3";
-                for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->proj.block(sel[i],0,1,nchan);
-
-                mult_full = selVect*this->comp.data->data*cal;
-            }
-        }
+        return true;
     }
 
-    //
-    // Make mult sparse
-    //
-    tripletList.clear();
-    tripletList.reserve(mult_full.rows()*mult_full.cols());
-    for(i = 0; i < mult_full.rows(); ++i)
-        for(k = 0; k < mult_full.cols(); ++k)
-            if(mult_full(i,k) != 0)
-                tripletList.push_back(T(i, k, mult_full(i,k)));
-
-    SparseMatrix<double> mult(mult_full.rows(),mult_full.cols());
-    if(tripletList.size() > 0)
-        mult.setFromTriplets(tripletList.begin(), tripletList.end());
-//    mult.makeCompressed();
-
     FiffStream::SPtr fid;
     if (!this->file->device()->isOpen())
     {
@@ -360,6 +430,8 @@ bool FiffRawData::read_raw_segment(MatrixXd& data,
                         one = mult*(Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
                     else if(t_pTag->type == FIFFT_FLOAT)
                         one = mult*(Map< MatrixXf >( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
+                    else if(t_pTag->type == FIFFT_SHORT)
+                        one = mult*(Map< MatrixShort >( t_pTag->toShort(),nchan, thisRawDir.nsamp)).cast<double>();
                     else
                         qWarning("Data Storage Format not known yet [3]!! Type: %d\n", t_pTag->type);
                 }
@@ -464,13 +536,6 @@ bool FiffRawData::read_raw_segment(MatrixXd& data,
                                    const RowVectorXi& sel,
                                    bool do_debug) const
 {
-    bool projAvailable = true;
-
-    if (this->proj.size() == 0) {
-        //qInfo() << "FiffRawData::read_raw_segment - No projectors setup. Consider calling MNE::setup_compensators.";
-        projAvailable = false;
-    }
-
     if(from == -1)
         from = this->first_samp;
     if(to == -1)
@@ -496,93 +561,30 @@ bool FiffRawData::read_raw_segment(MatrixXd& data,
     qint32 dest  = 0;//1;
     qint32 i, k, r;
 
-    using T = Eigen::Triplet<double>;
-    std::vector<T> tripletList;
-    tripletList.reserve(nchan);
-    for(i = 0; i < nchan; ++i)
-        tripletList.push_back(T(i, i, this->cals[i]));
+    data = MatrixXd(sel.size() == 0 ? nchan : sel.size(), to-from+1);
 
-    SparseMatrix<double> cal(nchan, nchan);
-    cal.setFromTriplets(tripletList.begin(), tripletList.end());
-//    cal.makeCompressed();
+    QSharedPointer<const RawOperator> pOperator = get_operator(sel);
+    const SparseMatrix<double>& cal = pOperator->cal;
+    const SparseMatrix<double>& mult = pOperator->mult;
 
-    MatrixXd mult_full;
     //
-    if (sel.size() == 0)
+    if (this->isMapped())
     {
-        data = MatrixXd(nchan, to-from+1);
-//            data->setZero();
-        if (projAvailable || this->comp.kind != -1)
-        {
-            if (!projAvailable)
-                mult_full = this->comp.data->data*cal;
-            else if (this->comp.kind == -1)
-                mult_full = this->proj*cal;
-            else
-                mult_full = this->proj*this->comp.data->data*cal;
-        }
-    }
-    else
-    {
-        data = MatrixXd(sel.size(),to-from+1);
-//            data->setZero();
-
-        MatrixXd selVect(sel.size(), nchan);
-
-        selVect.setZero();
+        if (!read_mapped_segment(data, from, to, sel, mult, cal))
+            return false;
 
-        if (!projAvailable && this->comp.kind == -1)
-        {
-            tripletList.clear();
-            tripletList.reserve(sel.size());
-            for(i = 0; i < sel.size(); ++i)
-                tripletList.push_back(T(i, i, this->cals[sel[i]]));
-            cal = SparseMatrix<double>(sel.size(), sel.size());
-            cal.setFromTriplets(tripletList.begin(), tripletList.end());
-        }
+        if(mult.cols()==0)
+            multSegment = cal;
         else
-        {
-            if (!projAvailable)
-            {
-                qDebug() << "This has to be debugged! #1";
-                for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->comp.data->data.block(sel[i],0,1,nchan);
-                mult_full = selVect*cal;
-            }
-            else if (this->comp.kind == -1)
-            {
-                for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->proj.block(sel[i],0,1,nchan);
+            multSegment = mult;
 
-                mult_full = selVect*cal;
-            }
-            else
-            {
-                qDebug() << "This has to be debugged! #3";
-                for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->proj.block(sel[i],0,1,nchan);
+        times = MatrixXd(1, to-from+1);
 
-                mult_full = selVect*this->comp.data->data*cal;
-            }
-        }
-    }
+        for (i = 0; i < times.cols(); ++i)
+            times(0, i) = static_cast<float>(from+i) / this->info.sfreq;
 
-    //
-    // Make mult sparse
-    //
-    tripletList.clear();
-    tripletList.reserve(mult_full.rows()*mult_full.cols());
-    for(i = 0; i < mult_full.rows(); ++i)
-        for(k = 0; k < mult_full.cols(); ++k)
-            if(mult_full(i,k) != 0)
-                tripletList.push_back(T(i, k, mult_full(i,k)));
-
-    SparseMatrix<double> mult(mult_full.rows(),mult_full.cols());
-    if(tripletList.size() > 0)
-        mult.setFromTriplets(tripletList.begin(), tripletList.end());
-//    mult.makeCompressed();
-
-    //
+        return true;
+    }
 
     FiffStream::SPtr fid;
     if (!this->file->device()->isOpen())
@@ -695,6 +697,8 @@ bool FiffRawData::read_raw_segment(MatrixXd& data,
                         one = mult*(Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
                     else if(t_pTag->type == FIFFT_FLOAT)
                         one = mult*(Map< MatrixXf >( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
+                    else if(t_pTag->type == FIFFT_SHORT)
+                        one = mult*(Map< MatrixShort >( t_pTag->toShort(),nchan, thisRawDir.nsamp)).cast<double>();
                     else
                         qWarning("Data Storage Format not known yet [3]!! Type: %d\n", t_pTag->type);
                 }
@@ -815,11 +819,254 @@ bool FiffRawData::read_raw_segment_times(MatrixXd& data,
 
 //=============================================================================================================
 
+QSharedPointer<const FiffRawData::RawOperator> FiffRawData::get_operator(const RowVectorXi& sel) const
+{
+    auto sameMatrix = [](const auto& a, const auto& b) {
+        return a.rows() == b.rows() && a.cols() == b.cols() && a == b;
+    };
+
+    const bool bComp = this->comp.kind != -1;
+
+    QMutexLocker locker(&m_pOperatorCache->mutex);
+    OperatorCache& cache = *m_pOperatorCache;
+
+    if (cache.pOperator
+        && cache.compKind == this->comp.kind
+        && sameMatrix(cache.sel, sel)
+        && sameMatrix(cache.cals, this->cals)
+        && sameMatrix(cache.proj, this->proj)
+        && (!bComp || sameMatrix(cache.compData, this->comp.data->data)))
+    {
+        return cache.pOperator;
+    }
+
+    cache.pOperator = compute_operator(sel);
+    cache.sel = sel;
+    cache.compKind = this->comp.kind;
+    cache.cals = this->cals;
+    cache.proj = this->proj;
+    cache.compData = bComp ? this->comp.data->data : MatrixXd();
+
+    return cache.pOperator;
+}
+
+//=============================================================================================================
+
+QSharedPointer<const FiffRawData::RawOperator> FiffRawData::compute_operator(const RowVectorXi& sel) const
+{
+    bool projAvailable = this->proj.size() != 0;
+
+    qint32 nchan = this->info.nchan;
+    qint32 i, k;
+
+    QSharedPointer<RawOperator> pOperator(new RawOperator);
+
+    using T = Eigen::Triplet<double>;
+    std::vector<T> tripletList;
+    tripletList.reserve(nchan);
+    for(i = 0; i < nchan; ++i)
+        tripletList.push_back(T(i, i, this->cals[i]));
+
+    SparseMatrix<double>& cal = pOperator->cal;
+    cal.resize(nchan, nchan);
+    cal.setFromTriplets(tripletList.begin(), tripletList.end());
+//    cal.makeCompressed();
+
+    MatrixXd mult_full;
+    //
+    if (sel.size() == 0)
+    {
+        if (projAvailable || this->comp.kind != -1)
+        {
+            if (!projAvailable)
+                mult_full = this->comp.data->data*cal;
+            else if (this->comp.kind == -1)
+                mult_full = this->proj*cal;
+            else
+                mult_full = this->proj*this->comp.data->data*cal;
+        }
+    }
+    else
+    {
+        MatrixXd selVect(sel.size(), nchan);
+
+        selVect.setZero();
+
+        if (!projAvailable && this->comp.kind == -1)
+        {
+            tripletList.clear();
+            tripletList.reserve(sel.size());
+            for(i = 0; i < sel.size(); ++i)
+                tripletList.push_back(T(i, i, this->cals[sel[i]]));
+            cal = SparseMatrix<double>(sel.size(), sel.size());
+            cal.setFromTriplets(tripletList.begin(), tripletList.end());
+        }
+        else
+        {
+            if (!projAvailable)
+            {
+                qDebug() << "This has to be debugged! #1";
+                for( i = 0; i  < sel.size(); ++i)
+                    selVect.row(i) = this->comp.data->data.block(sel[i],0,1,nchan);
+                mult_full = selVect*cal;
+            }
+            else if (this->comp.kind == -1)
+            {
+                for( i = 0; i  < sel.size(); ++i)
+                    selVect.row(i) = this->proj.block(sel[i],0,1,nchan);
+
+                mult_full = selVect*cal;
+            }
+            else
+            {
+                qDebug() << "This has to be debugged! #3";
+                for( i = 0; i  < sel.size(); ++i)
+                    selVect.row(i) = this->proj.block(sel[i],0,1,nchan);
+
+                mult_full = selVect*this->comp.data->data*cal;
+            }
+        }
+    }
+
+    //
+    // Make mult sparse
+    //
+    tripletList.clear();
+    tripletList.reserve(mult_full.rows()*mult_full.cols());
+    for(i = 0; i < mult_full.rows(); ++i)
+        for(k = 0; k < mult_full.cols(); ++k)
+            if(mult_full(i,k) != 0)
+                tripletList.push_back(T(i, k, mult_full(i,k)));
+
+    SparseMatrix<double>& mult = pOperator->mult;
+    mult.resize(mult_full.rows(),mult_full.cols());
+    if(tripletList.size() > 0)
+        mult.setFromTriplets(tripletList.begin(), tripletList.end());
+//    mult.makeCompressed();
+
+    return pOperator;
+}
+
+//=============================================================================================================
+
+bool FiffRawData::read_mapped_segment(MatrixXd& data,
+                                      fiff_int_t from,
+                                      fiff_int_t to,
+                                      const RowVectorXi& sel,
+                                      const SparseMatrix<double>& mult,
+                                      const SparseMatrix<double>& cal) const
+{
+    const qint32 nchan = this->info.nchan;
+    const bool bFileLittleEndian = this->file->byteOrder() == QDataStream::LittleEndian;
+    const bool bSwap = bFileLittleEndian != (Q_BYTE_ORDER == Q_LITTLE_ENDIAN);
+
+    //
+    //  Source channel and calibration factor of every output row when no projection is applied
+    //
+    VectorXi rows;
+    VectorXd scale;
+    if (mult.cols() == 0)
+    {
+        rows.resize(data.rows());
+        scale.resize(data.rows());
+        for (Index r = 0; r < data.rows(); ++r)
+        {
+            rows[r] = sel.size() > 0 ? sel[r] : static_cast<int>(r);
+            scale[r] = cal.coeff(r, r);
+        }
+    }
+
+    MatrixXd work;
+    qint32 dest = 0;
+    for (const FiffRawDir& thisRawDir : this->rawdir)
+    {
+        if (thisRawDir.last < from)
+            continue;
+        if (thisRawDir.first > to)
+            break;
+
+        const fiff_int_t first_pick = qMax(from, thisRawDir.first) - thisRawDir.first;
+        const fiff_int_t picksamp = qMin(to, thisRawDir.last) - thisRawDir.first - first_pick + 1;
+
+        if (!thisRawDir.ent || thisRawDir.ent->kind == -1)
+        {
+            //
+            //  Skips are translated to zeros
+            //
+            data.middleCols(dest, picksamp).setZero();
+        }
+        else
+        {
+            const FiffDirEntry& ent = *thisRawDir.ent;
+            const qint64 payloadPos = static_cast<qint64>(ent.pos) + FIFF_TAG_HEADER_SIZE;
+            if (payloadPos + ent.size > m_iMappedSize)
+            {
+                qWarning() << "[FiffRawData::read_mapped_segment] Data buffer at" << ent.pos << "exceeds the mapped file.";
+                return false;
+            }
+            const uchar* pPayload = m_pMappedData + payloadPos;
+
+            // A short or corrupt buffer tag must not be decoded into the following tag
+            qint64 iSampleSize = 0;
+            switch (ent.type)
+            {
+                case FIFFT_DAU_PACK16:
+                case FIFFT_SHORT:
+                    iSampleSize = sizeof(qint16);
+                    break;
+                case FIFFT_INT:
+                    iSampleSize = sizeof(qint32);
+                    break;
+                case FIFFT_FLOAT:
+                    iSampleSize = sizeof(float);
+                    break;
+                default:
+                    qWarning("Data Storage Format not known yet [4]!! Type: %d\n", ent.type);
+                    return false;
+            }
+            if (ent.size < static_cast<qint64>(nchan) * thisRawDir.nsamp * iSampleSize)
+            {
+                qWarning() << "[FiffRawData::read_mapped_segment] Data buffer at" << ent.pos << "is shorter than" << thisRawDir.nsamp << "samples of" << nchan << "channels.";
+                return false;
+            }
+
+            if (mult.cols() > 0 && work.cols() < picksamp)
+                work.resize(nchan, picksamp);
+
+            switch (ent.type)
+            {
+                case FIFFT_DAU_PACK16:
+                case FIFFT_SHORT:
+                    decode_mapped_buffer<qint16>(pPayload, nchan, first_pick, picksamp, bSwap, mult, rows, scale, work, data, dest);
+                    break;
+                case FIFFT_INT:
+                    decode_mapped_buffer<qint32>(pPayload, nchan, first_pick, picksamp, bSwap, mult, rows, scale, work, data, dest);
+                    break;
+                case FIFFT_FLOAT:
+                    decode_mapped_buffer<float>(pPayload, nchan, first_pick, picksamp, bSwap, mult, rows, scale, work, data, dest);
+                    break;
+                default:
+                    return false;
+            }
+        }
+
+        dest += picksamp;
+
+        if (thisRawDir.last >= to)
+            break;
+    }
+
+    return true;
+}
+
+//=============================================================================================================
+
 bool FiffRawData::save(QIODevice &p_IODevice,
                         const RowVectorXi &picks,
                         int decim,
                         int from,
-                        int to) const
+                        int to,
+                        fiff_int_t data_type) const
 {
     if (decim < 1) decim = 1;
 
@@ -844,17 +1091,39 @@ bool FiffRawData::save(QIODevice &p_IODevice,
         outInfo.sfreq = info.sfreq / static_cast<float>(decim);
     }
 
+    const int blockSize = 2000;
+    int blockSamples = decim * blockSize;
+
+    // Integer output: find the per-channel peak so that it maps onto the full integer scale
+    RowVectorXd maxAbs;
+    if (data_type != FIFFT_FLOAT) {
+        for (int samp = firstSamp; samp <= lastSamp; samp += blockSamples) {
+            int nsamp = qMin(blockSamples, lastSamp - samp + 1);
+
+            MatrixXd segData;
+            MatrixXd segTimes;
+            if (!read_raw_segment(segData, segTimes, samp, samp + nsamp - 1, picks)) {
+                qWarning() << "[FiffRawData::save] Error reading data at sample" << samp;
+                return false;
+            }
+
+            RowVectorXd segMax = segData.cwiseAbs().rowwise().maxCoeff().transpose();
+            maxAbs = (maxAbs.size() == 0) ? segMax : RowVectorXd(maxAbs.cwiseMax(segMax));
+        }
+    }
+
     // Use the standard start_writing_raw pipeline
     RowVectorXd calsOut;
-    FiffStream::SPtr pStream = FiffStream::start_writing_raw(p_IODevice, outInfo, calsOut, picks);
+    FiffStream::SPtr pStream = FiffStream::start_writing_raw(p_IODevice, outInfo, calsOut, picks, true, data_type, maxAbs);
     if (!pStream) {
         qWarning() << "[FiffRawData::save] Cannot start writing raw file.";
         return false;
     }
 
+    // Encode blocks on this thread, write them to disk in the background
+    pStream->start_write_behind();
+
     // Write data in blocks
-    const int blockSize = 2000;
-    int blockSamples = decim * blockSize;
 
     for (int samp = firstSamp; samp <= lastSamp; samp += blockSamples) {
         int nsamp = qMin(blockSamples, lastSamp - samp + 1);
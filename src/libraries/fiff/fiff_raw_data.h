@@ -57,6 +57,7 @@
 // QT INCLUDES
 //=============================================================================================================
 
+#include <QFile>
 #include <QList>
 #include <QSharedPointer>
 #include <QString>
@@ -197,6 +198,34 @@ public:
                                 float to,
                                 const Eigen::RowVectorXi& sel = defaultRowVectorXi) const;
 
+    //=========================================================================================================
+    /**
+     * Memory-maps the underlying raw file so that subsequent read_raw_segment calls decode the data buffers
+     * directly from the mapping instead of going through FiffStream::read_tag. The mapping is shared between
+     * copies of this object and released by unmapFile, clear or the destruction of the last copy.
+     * Only streams backed by a QFile can be mapped.
+     *
+     * @return true if the file is mapped, false otherwise (reads then fall back to the stream path).
+     */
+    bool mapFile();
+
+    //=========================================================================================================
+    /**
+     * Releases the memory mapping set up by mapFile. Subsequent reads use the stream path again.
+     */
+    void unmapFile();
+
+    //=========================================================================================================
+    /**
+     * True if read_raw_segment uses the memory-mapped read path.
+     *
+     * @return true if the raw file is memory-mapped.
+     */
+    inline bool isMapped() const
+    {
+        return m_pMappedData != nullptr;
+    }
+
     //=========================================================================================================
     /**
      * Save raw data to a FIFF file, optionally with decimation and channel picking.
@@ -207,6 +236,8 @@ public:
      * @param[in] decim     Decimation factor (1 = no decimation).
      * @param[in] from      First sample to save (-1 = from start of raw data).
      * @param[in] to        Last sample to save (-1 = to end of raw data).
+     * @param[in] data_type Output sample format: FIFFT_FLOAT (default), FIFFT_INT or FIFFT_SHORT. The integer
+     *                      formats scan the data once beforehand to choose a per-channel range.
      *
      * @return true on success.
      */
@@ -214,7 +245,8 @@ public:
               const Eigen::RowVectorXi &picks = Eigen::RowVectorXi(),
               int decim = 1,
               int from = -1,
-              int to = -1) const;
+              int to = -1,
+              fiff_int_t data_type = FIFFT_FLOAT) const;
 
 public:
     FiffStream::SPtr file;      /**< replaces fid. */
@@ -226,6 +258,66 @@ public:
     Eigen::MatrixXd proj;       /**< SSP operator to apply to the data. */
     FiffCtfComp comp;           /**< Compensator. */
 
+private:
+    //=========================================================================================================
+    /**
+     * Calibration and combined (projection * compensation * calibration) operators for one channel selection.
+     */
+    struct RawOperator
+    {
+        Eigen::SparseMatrix<double> cal;    /**< Diagonal calibration matrix. */
+        Eigen::SparseMatrix<double> mult;   /**< Combined operator, empty if neither projection nor compensation is active. */
+    };
+
+    struct OperatorCache;
+
+    //=========================================================================================================
+    /**
+     * Returns the operator for the given channel selection. The operator is built lazily and reused by
+     * subsequent calls until the selection, proj, comp or cals change.
+     *
+     * @param[in] sel        Channel selection vector.
+     *
+     * @return the operator.
+     */
+    QSharedPointer<const RawOperator> get_operator(const Eigen::RowVectorXi& sel) const;
+
+    //=========================================================================================================
+    /**
+     * Builds the operator for the given channel selection from the current proj, comp and cals.
+     *
+     * @param[in] sel        Channel selection vector.
+     *
+     * @return the operator.
+     */
+    QSharedPointer<const RawOperator> compute_operator(const Eigen::RowVectorXi& sel) const;
+
+    //=========================================================================================================
+    /**
+     * Reads the buffers overlapping [from, to] from the memory-mapped file and writes the calibrated (and
+     * optionally projected/compensated) samples straight into data.
+     *
+     * @param[out] data      The preallocated data matrix (channels x samples).
+     * @param[in] from       First sample to include.
+     * @param[in] to         Last sample to include.
+     * @param[in] sel        Channel selection vector.
+     * @param[in] mult       Multiplication matrix (projection, compensation, calibration), empty if not needed.
+     * @param[in] cal        Diagonal calibration matrix, used when mult is empty.
+     *
+     * @return true if succeeded, false otherwise.
+     */
+    bool read_mapped_segment(Eigen::MatrixXd& data,
+                             fiff_int_t from,
+                             fiff_int_t to,
+                             const Eigen::RowVectorXi& sel,
+                             const Eigen::SparseMatrix<double>& mult,
+                             const Eigen::SparseMatrix<double>& cal) const;
+
+    QSharedPointer<QFile>   m_pMappedFile;      /**< File holding the memory mapping, if any. */
+    const uchar*            m_pMappedData;      /**< Start of the memory-mapped file, nullptr if not mapped. */
+    qint64                  m_iMappedSize;      /**< Size of the mapping in bytes. */
+
+    QSharedPointer<OperatorCache>   m_pOperatorCache;   /**< Operator reused across read_raw_segment calls. */
 };
 } // NAMESPACE
 
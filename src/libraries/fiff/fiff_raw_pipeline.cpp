@@ -0,0 +1,328 @@
+//=============================================================================================================
+/**
+ * @file     fiff_raw_pipeline.cpp
+ * @author   Christoph Dinh <christoph.dinh@mne-cpp.org>
+ * @since    2.1.0
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, Christoph Dinh. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    FiffRawPipeline class definition.
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_raw_pipeline.h"
+#include "fiff_raw_data.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QDebug>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace Eigen;
+
+//=============================================================================================================
+// DEFINE LOCAL FUNCTIONS
+//=============================================================================================================
+
+namespace
+{
+
+typedef std::chrono::steady_clock Clock;
+
+inline double secondsSince(const Clock::time_point& start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+//=============================================================================================================
+
+inline QString throughput(qint64 iSamples, int iChannels, double dSec)
+{
+    if(dSec <= 0.0) {
+        return QStringLiteral("n/a");
+    }
+    return QString("%1 samples/s, %2 MB/s").arg(iSamples / dSec, 0, 'f', 0)
+                                         .arg(iSamples * iChannels * sizeof(double) / dSec / 1.0e6, 0, 'f', 1);
+}
+
+} // anonymous namespace
+
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+FiffRawPipeline::FiffRawPipeline(const FiffRawData& raw,
+                                 fiff_int_t iBlockSize)
+: m_raw(raw)
+, m_iBlockSize(std::max<fiff_int_t>(1, iBlockSize))
+, m_from(raw.first_samp)
+, m_to(raw.last_samp)
+, m_iNumWorkers(1)
+, m_iQueueLength(4)
+{
+}
+
+//=============================================================================================================
+
+void FiffRawPipeline::setRange(fiff_int_t from,
+                               fiff_int_t to)
+{
+    m_from = from;
+    m_to = to;
+}
+
+//=============================================================================================================
+
+void FiffRawPipeline::setSelection(const RowVectorXi& sel)
+{
+    m_vecSel = sel;
+}
+
+//=============================================================================================================
+
+void FiffRawPipeline::setNumWorkers(int iNumWorkers)
+{
+    m_iNumWorkers = std::max(0, iNumWorkers);
+}
+
+//=============================================================================================================
+
+void FiffRawPipeline::setQueueLength(int iQueueLength)
+{
+    m_iQueueLength = std::max(1, iQueueLength);
+}
+
+//=============================================================================================================
+
+void FiffRawPipeline::setThreadInit(const std::function<void()>& threadInit)
+{
+    m_threadInit = threadInit;
+}
+
+//=============================================================================================================
+
+int FiffRawPipeline::getQueueLength() const
+{
+    return m_iQueueLength;
+}
+
+//=============================================================================================================
+
+bool FiffRawPipeline::run(const Transform& transform,
+                          const Writer& writer)
+{
+    m_stats = FiffRawPipelineStats();
+
+    if(m_to < m_from) {
+        qWarning() << "[FiffRawPipeline::run] Empty sample range" << m_from << "to" << m_to;
+        return false;
+    }
+
+    const int iNumBlocks = static_cast<int>((static_cast<qint64>(m_to) - m_from) / m_iBlockSize + 1);
+    const int iNumWorkers = m_iNumWorkers > 0 ? m_iNumWorkers
+                                              : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    const int iMaxInFlight = std::max(m_iQueueLength, iNumWorkers);
+
+    std::mutex mutex;
+    std::condition_variable cvChanged;
+    std::deque<FiffRawBlock> queueRead;             // Read and waiting for a worker
+    std::map<int,FiffRawBlock> mapDone;             // Transformed and waiting for the writer
+    int iInFlight = 0;
+    bool bReadDone = false;
+    bool bAbort = false;
+
+    const Clock::time_point tStart = Clock::now();
+
+    // Stage 1: read the blocks in file order, at most iMaxInFlight ahead of the writer
+    std::thread reader([&]() {
+        if(m_threadInit) {
+            m_threadInit();
+        }
+
+        for(int i = 0; i < iNumBlocks; ++i) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cvChanged.wait(lock, [&]() { return iInFlight < iMaxInFlight || bAbort; });
+                if(bAbort) {
+                    break;
+                }
+                ++iInFlight;
+            }
+
+            FiffRawBlock block;
+            block.iIndex = i;
+            block.first = m_from + i * m_iBlockSize;
+            block.last = std::min<fiff_int_t>(block.first + m_iBlockSize - 1, m_to);
+
+            MatrixXd times;
+            const Clock::time_point t = Clock::now();
+            const bool bOk = m_raw.read_raw_segment(block.matData, times, block.first, block.last, m_vecSel);
+            const double dSec = secondsSince(t);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            m_stats.dReadSec += dSec;
+            if(!bOk) {
+                qWarning() << "[FiffRawPipeline::run] Reading samples" << block.first << "to" << block.last << "failed.";
+                bAbort = true;
+                cvChanged.notify_all();
+                break;
+            }
+            m_stats.iSamples += block.matData.cols();
+            m_stats.iChannels = block.matData.rows();
+            queueRead.push_back(std::move(block));
+            cvChanged.notify_all();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        bReadDone = true;
+        cvChanged.notify_all();
+    });
+
+    // Stage 2: transform the blocks. A single worker takes them in file order.
+    std::vector<std::thread> workers;
+    for(int w = 0; w < iNumWorkers; ++w) {
+        workers.emplace_back([&]() {
+            if(m_threadInit) {
+                m_threadInit();
+            }
+
+            while(true) {
+                FiffRawBlock block;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    cvChanged.wait(lock, [&]() { return !queueRead.empty() || bReadDone || bAbort; });
+                    if(bAbort || queueRead.empty()) {
+                        return;
+                    }
+                    block = std::move(queueRead.front());
+                    queueRead.pop_front();
+                }
+
+                const Clock::time_point t = Clock::now();
+                const bool bOk = !transform || transform(block);
+                const double dSec = secondsSince(t);
+
+                std::lock_guard<std::mutex> lock(mutex);
+                m_stats.dTransformSec += dSec;
+                if(!bOk) {
+                    qWarning() << "[FiffRawPipeline::run] Transforming block" << block.iIndex << "failed.";
+                    bAbort = true;
+                } else {
+                    const int iIndex = block.iIndex;
+                    mapDone.emplace(iIndex, std::move(block));
+                }
+                cvChanged.notify_all();
+            }
+        });
+    }
+
+    // Stage 3: write the blocks in file order on the calling thread
+    for(int i = 0; i < iNumBlocks; ++i) {
+        FiffRawBlock block;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cvChanged.wait(lock, [&]() { return mapDone.count(i) > 0 || bAbort; });
+            if(bAbort) {
+                break;
+            }
+            std::map<int,FiffRawBlock>::iterator it = mapDone.find(i);
+            block = std::move(it->second);
+            mapDone.erase(it);
+        }
+
+        const Clock::time_point t = Clock::now();
+        const bool bOk = writer(block);
+        const double dSec = secondsSince(t);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        m_stats.dWriteSec += dSec;
+        if(!bOk) {
+            qWarning() << "[FiffRawPipeline::run] Writing block" << i << "failed.";
+            bAbort = true;
+        } else {
+            ++m_stats.iBlocks;
+        }
+        --iInFlight;
+        cvChanged.notify_all();
+    }
+
+    reader.join();
+    for(std::thread& worker : workers) {
+        worker.join();
+    }
+
+    m_stats.dWallSec = secondsSince(tStart);
+
+    qInfo().noquote() << QString("[FiffRawPipeline::run] %1 blocks, %2 channels x %3 samples in %4 s with %5 worker(s)")
+                         .arg(m_stats.iBlocks).arg(m_stats.iChannels).arg(m_stats.iSamples)
+                         .arg(m_stats.dWallSec, 0, 'f', 2).arg(iNumWorkers);
+    qInfo().noquote() << QString("[FiffRawPipeline::run] read %1 s (%2), transform %3 s (%4), write %5 s (%6)")
+                         .arg(m_stats.dReadSec, 0, 'f', 2).arg(throughput(m_stats.iSamples, m_stats.iChannels, m_stats.dReadSec))
+                         .arg(m_stats.dTransformSec, 0, 'f', 2).arg(throughput(m_stats.iSamples, m_stats.iChannels, m_stats.dTransformSec))
+                         .arg(m_stats.dWriteSec, 0, 'f', 2).arg(throughput(m_stats.iSamples, m_stats.iChannels, m_stats.dWriteSec));
+
+    return !bAbort && m_stats.iBlocks == iNumBlocks;
+}
+
+//=============================================================================================================
+
+bool FiffRawPipeline::run(const Transform& transform,
+                          FiffStream::SPtr& pStream,
+                          const RowVectorXd& cals)
+{
+    if(!pStream) {
+        qWarning() << "[FiffRawPipeline::run] No output stream.";
+        return false;
+    }
+
+    return run(transform, [&pStream, &cals](const FiffRawBlock& block) {
+        return block.matData.cols() == 0 || pStream->write_raw_buffer(block.matData, cals);
+    });
+}
+
+//=============================================================================================================
+
+FiffRawPipelineStats FiffRawPipeline::getStats() const
+{
+    return m_stats;
+}
@@ -0,0 +1,225 @@
+//=============================================================================================================
+/**
+ * @file     fiff_raw_pipeline.h
+ * @author   Christoph Dinh <christoph.dinh@mne-cpp.org>
+ * @since    2.1.0
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, Christoph Dinh. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    FiffRawPipeline class declaration.
+ */
+
+#ifndef FIFF_RAW_PIPELINE_H
+#define FIFF_RAW_PIPELINE_H
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_global.h"
+#include "fiff_types.h"
+#include "fiff_stream.h"
+
+#include <functional>
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+//=============================================================================================================
+// DEFINE NAMESPACE FIFFLIB
+//=============================================================================================================
+
+namespace FIFFLIB
+{
+
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+class FiffRawData;
+
+//=============================================================================================================
+/**
+ * One block of raw data travelling through a FiffRawPipeline.
+ */
+struct FiffRawBlock
+{
+    int                 iIndex;     /**< Position of the block in the file, starting at 0. */
+    fiff_int_t          first;      /**< First sample of the block. */
+    fiff_int_t          last;       /**< Last sample of the block. */
+    Eigen::MatrixXd     matData;    /**< The data (channels x samples). A transform may change the number of columns. */
+};
+
+//=============================================================================================================
+/**
+ * Processing time and throughput of the pipeline stages. The stage times are the time spent working, summed
+ * over all threads of the stage, so they can exceed the wall time.
+ */
+struct FiffRawPipelineStats
+{
+    int         iBlocks = 0;            /**< Number of blocks written. */
+    qint64      iSamples = 0;           /**< Number of samples read. */
+    int         iChannels = 0;          /**< Number of channels read. */
+    double      dReadSec = 0.0;         /**< Time spent reading. */
+    double      dTransformSec = 0.0;    /**< Time spent in the transform. */
+    double      dWriteSec = 0.0;        /**< Time spent writing. */
+    double      dWallSec = 0.0;         /**< Wall time of the whole run. */
+};
+
+//=============================================================================================================
+/**
+ * Processes a raw file block by block in three overlapping stages: a reader thread, a pool of worker threads
+ * applying a transform to every block, and the calling thread writing the blocks in file order. The queues
+ * between the stages are bounded, so at most getQueueLength() blocks are in memory at any time and the reader
+ * waits while the writer falls behind.
+ *
+ * With one worker the blocks are transformed in file order, as needed for transforms that carry state from
+ * one block to the next, e.g. a streaming filter. Stateless transforms can use several workers.
+ *
+ * The raw data object must not be read from elsewhere while run() is active.
+ *
+ * @brief Pipelined read, transform and write of raw data.
+ */
+class FIFFSHARED_EXPORT FiffRawPipeline
+{
+public:
+    typedef std::function<bool(FiffRawBlock&)> Transform;          /**< Changes a block in place. Returns false to abort. */
+    typedef std::function<bool(const FiffRawBlock&)> Writer;       /**< Consumes a block in file order. Returns false to abort. */
+
+    //=========================================================================================================
+    /**
+     * Constructs a pipeline over the whole file.
+     *
+     * @param[in] raw            The raw data to read. Must outlive the pipeline.
+     * @param[in] iBlockSize     The number of samples per block.
+     */
+    FiffRawPipeline(const FiffRawData& raw,
+                    fiff_int_t iBlockSize);
+
+    //=========================================================================================================
+    /**
+     * Restricts the pipeline to the samples from to to, both inclusive.
+     *
+     * @param[in] from           The first sample.
+     * @param[in] to             The last sample.
+     */
+    void setRange(fiff_int_t from,
+                  fiff_int_t to);
+
+    //=========================================================================================================
+    /**
+     * Sets the channels to read.
+     *
+     * @param[in] sel            The channel indices. Default is all channels.
+     */
+    void setSelection(const Eigen::RowVectorXi& sel);
+
+    //=========================================================================================================
+    /**
+     * Sets the number of worker threads. 1 transforms the blocks in file order. 0 uses one worker per core.
+     * Default is 1.
+     *
+     * @param[in] iNumWorkers    The number of workers.
+     */
+    void setNumWorkers(int iNumWorkers);
+
+    //=========================================================================================================
+    /**
+     * Sets the maximum number of blocks in flight between the reader and the writer. Default is 4.
+     *
+     * @param[in] iQueueLength   The number of blocks.
+     */
+    void setQueueLength(int iQueueLength);
+
+    //=========================================================================================================
+    /**
+     * Sets a function the reader and every worker thread call before their first block, e.g. to route the
+     * messages logged on these threads. Default is none.
+     *
+     * @param[in] threadInit     The function.
+     */
+    void setThreadInit(const std::function<void()>& threadInit);
+
+    //=========================================================================================================
+    /**
+     * Returns the maximum number of blocks in flight between the reader and the writer.
+     *
+     * @return The number of blocks.
+     */
+    int getQueueLength() const;
+
+    //=========================================================================================================
+    /**
+     * Runs the pipeline until all blocks are written or a stage fails.
+     *
+     * @param[in] transform      Applied to every block by the workers. May be empty.
+     * @param[in] writer         Called on the calling thread for every block in file order.
+     *
+     * @return True if all blocks were read, transformed and written.
+     */
+    bool run(const Transform& transform,
+             const Writer& writer);
+
+    //=========================================================================================================
+    /**
+     * Runs the pipeline and writes every block with FiffStream::write_raw_buffer. The stream must have been
+     * started with FiffStream::start_writing_raw; it is not finished.
+     *
+     * @param[in] transform      Applied to every block by the workers. May be empty.
+     * @param[in] pStream        The output stream.
+     * @param[in] cals           The calibration factors returned by start_writing_raw.
+     *
+     * @return True if all blocks were read, transformed and written.
+     */
+    bool run(const Transform& transform,
+             FiffStream::SPtr& pStream,
+             const Eigen::RowVectorXd& cals);
+
+    //=========================================================================================================
+    /**
+     * Returns the stage timings of the last run.
+     *
+     * @return The statistics.
+     */
+    FiffRawPipelineStats getStats() const;
+
+private:
+    const FiffRawData&      m_raw;              /**< The raw data to read. */
+    fiff_int_t              m_iBlockSize;       /**< Samples per block. */
+    fiff_int_t              m_from;             /**< First sample to read. */
+    fiff_int_t              m_to;               /**< Last sample to read. */
+    Eigen::RowVectorXi      m_vecSel;           /**< Channels to read, empty for all. */
+    int                     m_iNumWorkers;      /**< Number of worker threads, 0 for one per core. */
+    int                     m_iQueueLength;     /**< Maximum number of blocks in flight. */
+    std::function<void()>   m_threadInit;       /**< Called at the start of the stage threads, may be empty. */
+    FiffRawPipelineStats    m_stats;            /**< Timings of the last run. */
+};
+
+} // NAMESPACE FIFFLIB
+
+#endif // FIFF_RAW_PIPELINE_H
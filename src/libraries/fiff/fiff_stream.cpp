@@ -60,8 +60,18 @@
 #include <math/numerics.h>
 #include <utils/ioutils.h>
 
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
 #include <iostream>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <type_traits>
 #include <time.h>
+#include <vector>
 
 //=============================================================================================================
 // EIGEN INCLUDES
@@ -77,6 +87,7 @@
 #include <QFile>
 #include <QTcpSocket>
 #include <QDebug>
+#include <QtEndian>
 
 //=============================================================================================================
 // USED NAMESPACES
@@ -86,12 +97,230 @@ using namespace FIFFLIB;
 using namespace UTILSLIB;
 using namespace Eigen;
 
+//=============================================================================================================
+// DEFINE LOCAL FUNCTIONS
+//=============================================================================================================
+
+namespace
+{
+
+const fiff_int_t FIFF_TAG_HEADER_SIZE = 4 * sizeof(fiff_int_t);   /**< kind, type, size and next precede the tag data. */
+
+//=============================================================================================================
+/**
+ * Converts one sample to the on-disk type. Integer types are rounded to nearest and saturated.
+ */
+template<typename Out>
+inline Out convert_sample(double value)
+{
+    const double lo = static_cast<double>(std::numeric_limits<Out>::lowest());
+    const double hi = static_cast<double>(std::numeric_limits<Out>::max());
+    return static_cast<Out>(std::nearbyint(std::min(std::max(value, lo), hi)));
+}
+
+template<>
+inline float convert_sample<float>(double value)
+{
+    return static_cast<float>(value);
+}
+
+//=============================================================================================================
+/**
+ * Converts an ncols x nrows column-major block to the 32 or 16 bit sample type Out, optionally scales every
+ * row, and stores it byte-swapped if requested. The loop body is branch-free so that the compiler can
+ * vectorize it.
+ */
+template<bool bSwap, typename Out, typename T>
+void encode_sample_block(const T* pSrc,
+                         Index nrows,
+                         Index ncols,
+                         Index srcStride,
+                         const double* pScale,
+                         char* pDst)
+{
+    typedef typename std::conditional<sizeof(Out) == 4, quint32, quint16>::type Bits;
+    static_assert(sizeof(Bits) == sizeof(Out), "Unsupported sample size");
+
+    for(Index c = 0; c < ncols; ++c) {
+        const T* pCol = pSrc + c * srcStride;
+        char* pOut = pDst + c * nrows * static_cast<Index>(sizeof(Out));
+        for(Index r = 0; r < nrows; ++r) {
+            const Out value = convert_sample<Out>(pScale ? pCol[r] * pScale[r] : static_cast<double>(pCol[r]));
+            Bits bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            if(bSwap) {
+                bits = qbswap(bits);
+            }
+            std::memcpy(pOut + r * static_cast<Index>(sizeof(bits)), &bits, sizeof(bits));
+        }
+    }
+}
+
+//=============================================================================================================
+
+template<typename Out, typename T>
+void encode_sample_block(const T* pSrc,
+                         Index nrows,
+                         Index ncols,
+                         Index srcStride,
+                         const double* pScale,
+                         char* pDst,
+                         QDataStream::ByteOrder byteOrder)
+{
+    const bool bHostLittleEndian = (Q_BYTE_ORDER == Q_LITTLE_ENDIAN);
+    if((byteOrder == QDataStream::LittleEndian) != bHostLittleEndian) {
+        encode_sample_block<true, Out>(pSrc, nrows, ncols, srcStride, pScale, pDst);
+    } else {
+        encode_sample_block<false, Out>(pSrc, nrows, ncols, srcStride, pScale, pDst);
+    }
+}
+
+//=============================================================================================================
+/**
+ * Returns the size in bytes of one sample of a raw data type, 0 if the type cannot be written.
+ */
+inline int raw_sample_size(fiff_int_t type)
+{
+    switch(type) {
+    case FIFFT_FLOAT:
+    case FIFFT_INT:
+        return 4;
+    case FIFFT_SHORT:
+        return 2;
+    default:
+        return 0;
+    }
+}
+
+} // anonymous namespace
+
+//=============================================================================================================
+// DEFINE PRIVATE CLASSES
+//=============================================================================================================
+
+namespace FIFFLIB
+{
+
+//=============================================================================================================
+/**
+ * Background thread writing encoded tags to a file device in submission order. The queue is bounded, so a
+ * producer only blocks when the disk falls behind by more than the queue length. Written buffers are kept in
+ * a pool and handed back to the producer, so steady-state writing does not allocate.
+ */
+class FiffStreamWriteBehind
+{
+public:
+    FiffStreamWriteBehind(QIODevice* pDevice, int iMaxQueued)
+    : m_pDevice(pDevice)
+    , m_iMaxQueued(qMax(1, iMaxQueued))
+    {
+        m_thread = std::thread(&FiffStreamWriteBehind::run, this);
+    }
+
+    ~FiffStreamWriteBehind()
+    {
+        finish();
+    }
+
+    //=========================================================================================================
+    /**
+     * Queues baBlock for writing and replaces it with a recycled buffer. Blocks while the queue is full.
+     */
+    bool push(QByteArray& baBlock)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cvNotFull.wait(lock, [this]() { return static_cast<int>(m_queue.size()) < m_iMaxQueued; });
+        if(!m_bOk) {
+            return false;
+        }
+
+        m_queue.push_back(std::move(baBlock));
+        if(m_pool.empty()) {
+            baBlock = QByteArray();
+        } else {
+            baBlock = std::move(m_pool.back());
+            m_pool.pop_back();
+        }
+        lock.unlock();
+        m_cvNotEmpty.notify_one();
+
+        return true;
+    }
+
+    //=========================================================================================================
+    /**
+     * Writes all queued buffers and joins the thread.
+     */
+    bool finish()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_bStop = true;
+        }
+        m_cvNotEmpty.notify_one();
+        if(m_thread.joinable()) {
+            m_thread.join();
+        }
+
+        // Reported here, so that the message comes from the thread that owns the stream
+        if(!m_sError.isEmpty()) {
+            qWarning() << "[FiffStreamWriteBehind::run] Writing to the device failed:" << m_sError;
+            m_sError.clear();
+        }
+
+        return m_bOk;
+    }
+
+private:
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while(true) {
+            m_cvNotEmpty.wait(lock, [this]() { return !m_queue.empty() || m_bStop; });
+            if(m_queue.empty()) {
+                break;
+            }
+
+            QByteArray baBlock = std::move(m_queue.front());
+            m_queue.pop_front();
+            lock.unlock();
+            m_cvNotFull.notify_one();
+
+            const bool bOk = m_pDevice->write(baBlock) == baBlock.size();
+
+            lock.lock();
+            if(!bOk && m_bOk) {
+                m_sError = m_pDevice->errorString();
+                m_bOk = false;
+            }
+            if(static_cast<int>(m_pool.size()) < m_iMaxQueued) {
+                m_pool.push_back(std::move(baBlock));
+            }
+        }
+    }
+
+    QIODevice*                  m_pDevice;          /**< The device written to. */
+    int                         m_iMaxQueued;       /**< Maximum number of queued buffers. */
+    std::mutex                  m_mutex;            /**< Protects the queue, the pool and the flags. */
+    std::condition_variable     m_cvNotEmpty;       /**< Signaled when a buffer was queued or on stop. */
+    std::condition_variable     m_cvNotFull;        /**< Signaled when a buffer was taken from the queue. */
+    std::deque<QByteArray>      m_queue;            /**< Buffers waiting to be written. */
+    std::vector<QByteArray>     m_pool;             /**< Written buffers available for reuse. */
+    bool                        m_bStop = false;    /**< Set when the thread should exit after draining. */
+    bool                        m_bOk = true;       /**< False once a device write failed. */
+    QString                     m_sError;           /**< Error of the first failed write, reported by finish. */
+    std::thread                 m_thread;           /**< The writer thread. */
+};
+
+} // NAMESPACE FIFFLIB
+
 //=============================================================================================================
 // DEFINE MEMBER METHODS
 //=============================================================================================================
 
 FiffStream::FiffStream(QIODevice *p_pIODevice)
 : QDataStream(p_pIODevice)
+, m_iRawDataType(FIFFT_FLOAT)
 {
     this->setFloatingPointPrecision(QDataStream::SinglePrecision);
     this->setByteOrder(QDataStream::BigEndian);
@@ -103,6 +332,7 @@ FiffStream::FiffStream(QIODevice *p_pIODevice)
 FiffStream::FiffStream(QByteArray * a,
                        QIODevice::OpenMode mode)
 : QDataStream(a, mode)
+, m_iRawDataType(FIFFT_FLOAT)
 {
     this->setFloatingPointPrecision(QDataStream::SinglePrecision);
     this->setByteOrder(QDataStream::BigEndian);
@@ -111,6 +341,15 @@ FiffStream::FiffStream(QByteArray * a,
 
 //=============================================================================================================
 
+FiffStream::~FiffStream()
+{
+    if(m_pWriteBehind) {
+        finish_write_behind();
+    }
+}
+
+//=============================================================================================================
+
 QString FiffStream::streamName()
 {
     QFile* t_pFile = qobject_cast<QFile*>(this->device());
@@ -169,6 +408,10 @@ fiff_long_t FiffStream::end_block(fiff_int_t kind, fiff_int_t next)
 
 void FiffStream::end_file()
 {
+    if(m_pWriteBehind) {
+        finish_write_behind();
+    }
+
     fiff_int_t datasize = 0;
 
      *this << (qint32)FIFF_NOP;
@@ -335,10 +578,15 @@ bool FiffStream::open(QIODevice::OpenModeFlag mode)
 
 bool FiffStream::close()
 {
+    bool bOk = true;
+    if(m_pWriteBehind) {
+        bOk = finish_write_behind();
+    }
+
     if(this->device()->isOpen())
         this->device()->close();
 
-    return true;
+    return bOk;
 }
 
 //=============================================================================================================
@@ -1827,7 +2075,8 @@ bool FiffStream::read_tag(FiffTag::UPtr &p_pTag,
 bool FiffStream::setup_read_raw(QIODevice &p_IODevice,
                                 FiffRawData& data,
                                 bool allow_maxshield,
-                                bool is_littleEndian)
+                                bool is_littleEndian,
+                                bool use_mmap)
 {
     //
     //   Open the file
@@ -2022,6 +2271,9 @@ bool FiffStream::setup_read_raw(QIODevice &p_IODevice,
     qInfo("Ready.");
     data.file->close();
 
+    if(use_mmap)
+        data.mapFile();
+
     return true;
 }
 
@@ -2141,12 +2393,22 @@ FiffStream::SPtr FiffStream::start_writing_raw(QIODevice &p_IODevice,
                                                const FiffInfo& info,
                                                RowVectorXd& cals,
                                                MatrixXi sel,
-                                               bool bResetRange)
+                                               bool bResetRange,
+                                               fiff_int_t data_type,
+                                               const RowVectorXd& maxAbs)
 {
     //
-    //   We will always write floats
+    //   Floats by default, 32 or 16 bit integers on request
     //
-    fiff_int_t data_type = 4;
+    double dIntLimit = 0.0;
+    if(data_type == FIFFT_INT) {
+        dIntLimit = static_cast<double>(std::numeric_limits<qint32>::max());
+    } else if(data_type == FIFFT_SHORT) {
+        dIntLimit = static_cast<double>(std::numeric_limits<qint16>::max());
+    } else if(data_type != FIFFT_FLOAT) {
+        qWarning("[FiffStream::start_writing_raw] Unsupported raw data type %d, writing floats instead.\n", data_type);
+        data_type = FIFFT_FLOAT;
+    }
     qint32 k;
 
     if(sel.cols() == 0)
@@ -2167,6 +2429,7 @@ FiffStream::SPtr FiffStream::start_writing_raw(QIODevice &p_IODevice,
     //  Create the file and save the essentials
     //
     FiffStream::SPtr t_pStream = start_file(p_IODevice);//1, 2, 3
+    t_pStream->m_iRawDataType = data_type;
     t_pStream->start_block(FIFFB_MEAS);//4
     t_pStream->write_id(FIFF_BLOCK_ID);//5
     if(info.meas_id.version != -1)
@@ -2296,10 +2559,26 @@ FiffStream::SPtr FiffStream::start_writing_raw(QIODevice &p_IODevice,
         //    Scan numbers may have been messed up
         //
         chs[k].scanNo = k+1;
-        if(bResetRange) {
-            chs[k].range = 1.0; // Reset to 1.0 because we always write floats.
+        if(data_type == FIFFT_FLOAT) {
+            if(bResetRange) {
+                chs[k].range = 1.0; // Reset to 1.0 because floats need no range.
+            }
+            cals[k] = chs[k].cal;
+        } else {
+            //
+            //    Spread the largest expected value over the full integer scale
+            //
+            if(k < maxAbs.size() && maxAbs[k] > 0.0 && chs[k].cal != 0.0f) {
+                const double dCal = std::fabs(static_cast<double>(chs[k].cal));
+                float range = static_cast<float>(maxAbs[k] / (dCal * dIntLimit));
+                // The range is stored in single precision, round it up so that the peak does not saturate
+                while(static_cast<double>(range) * dCal * dIntLimit < maxAbs[k]) {
+                    range = std::nextafter(range, std::numeric_limits<float>::max());
+                }
+                chs[k].range = range;
+            }
+            cals[k] = static_cast<double>(chs[k].range) * chs[k].cal;
         }
-        cals[k] = chs[k].cal;
         t_pStream->write_ch_info(chs[k]);
     }
     //
@@ -2756,17 +3035,17 @@ fiff_long_t FiffStream::write_double(fiff_int_t kind, const double* data, fiff_i
 
 fiff_long_t FiffStream::write_float(fiff_int_t kind, const float* data, fiff_int_t nel)
 {
+    if(m_pWriteBehind) {
+        finish_write_behind();
+    }
+
     fiff_long_t pos = this->device()->pos();
 
     qint32 datasize = nel * 4;
 
-    *this << (qint32)kind;
-    *this << (qint32)FIFFT_FLOAT;
-    *this << (qint32)datasize;
-    *this << (qint32)FIFFV_NEXT_SEQ;
-
-    for(qint32 i = 0; i < nel; ++i)
-        *this << data[i];
+    char* pData = stage_tag(kind, FIFFT_FLOAT, datasize);
+    encode_sample_block<float>(data, nel, 1, nel, nullptr, pData, this->byteOrder());
+    write_staged();
 
     return pos;
 }
@@ -2999,6 +3278,10 @@ fiff_long_t FiffStream::write_float_sparse_rcs(fiff_int_t kind, const SparseMatr
 
 fiff_long_t FiffStream::write_id(fiff_int_t kind, const FiffId& id)
 {
+    if(m_pWriteBehind) {
+        finish_write_behind();
+    }
+
     fiff_long_t pos = this->device()->pos();
 
     FiffId t_id = id;
@@ -3105,6 +3388,10 @@ fiff_long_t FiffStream::write_info_base(const FiffInfoBase & p_FiffInfoBase)
 
 fiff_long_t FiffStream::write_int(fiff_int_t kind, const fiff_int_t* data, fiff_int_t nel, fiff_int_t next)
 {
+    if(m_pWriteBehind) {
+        finish_write_behind();
+    }
+
     fiff_long_t pos = this->device()->pos();
 
     fiff_int_t datasize = nel * 4;
@@ -3302,18 +3589,9 @@ bool FiffStream::write_raw_buffer(const MatrixXd& buf,
         return false;
     }
 
-    using T = Eigen::Triplet<double>;
-    std::vector<T> tripletList;
-    tripletList.reserve(cals.cols());
-    for(qint32 i = 0; i < cals.cols(); ++i)
-        tripletList.push_back(T(i, i, 1.0/cals[i]));
-
-    SparseMatrix<double> inv_calsMat(cals.cols(), cals.cols());
-    inv_calsMat.setFromTriplets(tripletList.begin(), tripletList.end());
+    m_vecScale = cals.transpose().cwiseInverse();
 
-    MatrixXf tmp = (inv_calsMat*buf).cast<float>();
-    this->write_float(FIFF_DATA_BUFFER,tmp.data(),tmp.rows()*tmp.cols());
-    return true;
+    return write_sample_block(FIFF_DATA_BUFFER, m_iRawDataType, buf, m_vecScale.data());
 }
 
 //=============================================================================================================
@@ -3331,25 +3609,65 @@ bool FiffStream::write_raw_buffer(const MatrixXd& buf,
       for (SparseMatrix<double>::InnerIterator it(mult,k); it; ++it)
         inv_mult.coeffRef(it.row(),it.col()) = 1/it.value();
 
-    MatrixXf tmp = (inv_mult*buf).cast<float>();
-    this->write_float(FIFF_DATA_BUFFER,tmp.data(),tmp.rows()*tmp.cols());
-    return true;
+    MatrixXd tmp = inv_mult*buf;
+    return write_sample_block(FIFF_DATA_BUFFER, m_iRawDataType, tmp, nullptr);
 }
 
 //=============================================================================================================
 
 bool FiffStream::write_raw_buffer(const MatrixXd& buf)
 {
-    MatrixXf tmp = buf.cast<float>();
-    this->write_float(FIFF_DATA_BUFFER,tmp.data(),tmp.rows()*tmp.cols());
+    return write_sample_block(FIFF_DATA_BUFFER, m_iRawDataType, buf, nullptr);
+}
+
+//=============================================================================================================
+
+bool FiffStream::start_write_behind(int max_queued)
+{
+    if(m_pWriteBehind) {
+        return true;
+    }
+
+    if(!qobject_cast<QFile*>(this->device())) {
+        qDebug() << "[FiffStream::start_write_behind] Write-behind is only supported for files.";
+        return false;
+    }
+
+    m_pWriteBehind = std::make_unique<FiffStreamWriteBehind>(this->device(), max_queued);
+
     return true;
 }
 
 //=============================================================================================================
 
+bool FiffStream::finish_write_behind()
+{
+    if(!m_pWriteBehind) {
+        return true;
+    }
+
+    bool bOk = m_pWriteBehind->finish();
+    m_pWriteBehind.reset();
+
+    return bOk;
+}
+
+//=============================================================================================================
+
+bool FiffStream::is_write_behind() const
+{
+    return m_pWriteBehind != nullptr;
+}
+
+//=============================================================================================================
+
 fiff_long_t FiffStream::write_string(fiff_int_t kind,
                                      const QString& data)
 {
+    if(m_pWriteBehind) {
+        finish_write_behind();
+    }
+
     fiff_long_t pos = this->device()->pos();
 
     fiff_int_t datasize = data.size();
@@ -3379,6 +3697,64 @@ void FiffStream::write_rt_command(fiff_int_t command, const QString& data)
 
 //=============================================================================================================
 
+char* FiffStream::stage_tag(fiff_int_t kind, fiff_int_t type, fiff_int_t datasize)
+{
+    m_baStaging.resize(FIFF_TAG_HEADER_SIZE + datasize);
+
+    const fiff_int_t header[4] = { kind, type, datasize, FIFFV_NEXT_SEQ };
+    char* pHeader = m_baStaging.data();
+    for(int i = 0; i < 4; ++i) {
+        if(this->byteOrder() == QDataStream::BigEndian) {
+            qToBigEndian<qint32>(header[i], pHeader + i * sizeof(fiff_int_t));
+        } else {
+            qToLittleEndian<qint32>(header[i], pHeader + i * sizeof(fiff_int_t));
+        }
+    }
+
+    return pHeader + FIFF_TAG_HEADER_SIZE;
+}
+
+//=============================================================================================================
+
+bool FiffStream::write_staged()
+{
+    if(m_pWriteBehind) {
+        return m_pWriteBehind->push(m_baStaging);
+    }
+
+    return this->writeRawData(m_baStaging.constData(), m_baStaging.size()) == m_baStaging.size();
+}
+
+//=============================================================================================================
+
+bool FiffStream::write_sample_block(fiff_int_t kind, fiff_int_t type, const MatrixXd& buf, const double* pScale)
+{
+    const int iSampleSize = raw_sample_size(type);
+    if(iSampleSize == 0) {
+        qWarning("[FiffStream::write_sample_block] Unsupported sample type %d\n", type);
+        return false;
+    }
+
+    const fiff_int_t datasize = static_cast<fiff_int_t>(buf.size() * iSampleSize);
+
+    char* pData = stage_tag(kind, type, datasize);
+    switch(type) {
+    case FIFFT_INT:
+        encode_sample_block<qint32>(buf.data(), buf.rows(), buf.cols(), buf.rows(), pScale, pData, this->byteOrder());
+        break;
+    case FIFFT_SHORT:
+        encode_sample_block<qint16>(buf.data(), buf.rows(), buf.cols(), buf.rows(), pScale, pData, this->byteOrder());
+        break;
+    default:
+        encode_sample_block<float>(buf.data(), buf.rows(), buf.cols(), buf.rows(), pScale, pData, this->byteOrder());
+        break;
+    }
+
+    return write_staged();
+}
+
+//=============================================================================================================
+
 QList<FiffDirEntry::SPtr> FiffStream::make_dir(bool *ok)
 {
     FiffTag::UPtr t_pTag;
@@ -43,6 +43,7 @@
 
 #include "fiff_global.h"
 #include "fiff_types.h"
+#include "fiff_file.h"
 #include "fiff_id.h"
 
 #include "fiff_dir_node.h"
@@ -94,6 +95,7 @@ class FiffChInfo;
 class FiffChPos;
 class FiffCoordTrans;
 class FiffDigitizerData;
+class FiffStreamWriteBehind;
 
 //=============================================================================================================
 /**
@@ -128,6 +130,12 @@ public:
      */
     explicit FiffStream(QByteArray * a, QIODevice::OpenMode mode);
 
+    //=========================================================================================================
+    /**
+     * Destroys the fiff stream. Pending write-behind buffers are written before the stream goes away.
+     */
+    ~FiffStream();
+
     //=========================================================================================================
     /**
      * Get the stream name
@@ -440,13 +448,17 @@ public:
      * @param[in] p_IODevice        An fiff IO device like a fiff QFile or QTCPSocket.
      * @param[out] data              The raw data information - contains the opened fiff file.
      * @param[in] allow_maxshield    Accept unprocessed MaxShield data.
+     * @param[in] is_littleEndian    Read the file as little-endian.
+     * @param[in] use_mmap           Memory-map the file so that read_raw_segment decodes the data buffers directly
+     *                               from the mapping (see FiffRawData::mapFile). Falls back to stream reads on failure.
      *
      * @return true if succeeded, false otherwise.
      */
     static bool setup_read_raw(QIODevice &p_IODevice,
                                FiffRawData& data,
                                bool allow_maxshield = true,
-                               bool is_littleEndian = false);
+                               bool is_littleEndian = false,
+                               bool use_mmap = false);
 
     //=========================================================================================================
     /**
@@ -501,6 +513,10 @@ public:
      * @param[out] cals          A copy of the calibration values.
      * @param[in] sel            Which channels will be included in the output file (optional).
      * @param[in] bResetRange    Flag whether to reset the channel range to 1.0. Default is true.
+     * @param[in] data_type      Sample format of the raw buffers: FIFFT_FLOAT (default), FIFFT_INT or FIFFT_SHORT.
+     * @param[in] maxAbs         Largest absolute physical value per selected channel (optional). For the integer
+     *                           formats the channel range is chosen so that this value maps onto the full integer
+     *                           scale. Channels without an entry keep their original range.
      *
      * @return the started fiff file.
      */
@@ -508,7 +524,9 @@ public:
                                               const FiffInfo& info,
                                               Eigen::RowVectorXd& cals,
                                               Eigen::MatrixXi sel = defaultMatrixXi,
-                                              bool bResetRange = true);
+                                              bool bResetRange = true,
+                                              fiff_int_t data_type = FIFFT_FLOAT,
+                                              const Eigen::RowVectorXd& maxAbs = Eigen::RowVectorXd());
 
     //=========================================================================================================
     /**
@@ -778,7 +796,8 @@ public:
     /**
      * fiff_write_raw_buffer
      *
-     * Writes a raw buffer.
+     * Writes a raw buffer in the sample format chosen in start_writing_raw. Integer formats are rounded and
+     * saturated.
      *
      * @param[in] buf        the buffer to write.
      * @param[in] cals       calibration factors.
@@ -813,6 +832,38 @@ public:
      */
     bool write_raw_buffer(const Eigen::MatrixXd& buf);
 
+    //=========================================================================================================
+    /**
+     * Starts a background writer thread. Subsequent write_raw_buffer calls only encode the buffer and queue
+     * it; the thread writes the queued buffers to the device in order, so the calling thread does not block
+     * on disk I/O unless max_queued buffers are pending. Only file devices are supported.
+     *
+     * The tag writers used around raw data (start_block, end_block, write_int, write_id, write_string,
+     * write_float, end_file, finish_writing_raw) and close finish the write-behind before writing; other
+     * writers must not be used while write-behind is active.
+     *
+     * @param[in] max_queued     Maximum number of buffers waiting to be written (default = 8).
+     *
+     * @return true if the writer thread was started, false otherwise.
+     */
+    bool start_write_behind(int max_queued = 8);
+
+    //=========================================================================================================
+    /**
+     * Writes all queued buffers and stops the background writer thread started by start_write_behind.
+     *
+     * @return true if all queued buffers were written successfully, false otherwise.
+     */
+    bool finish_write_behind();
+
+    //=========================================================================================================
+    /**
+     * True if a background writer thread is active.
+     *
+     * @return true if write-behind is active.
+     */
+    bool is_write_behind() const;
+
     //=========================================================================================================
     /**
      * Writes a string tag
@@ -854,6 +905,40 @@ private:
      */
     QList<FiffDirEntry::SPtr> make_dir(bool *ok=nullptr);
 
+    //=========================================================================================================
+    /**
+     * Prepares the staging buffer for a tag with datasize bytes of data and fills in the tag header.
+     *
+     * @param[in] kind       The tag kind.
+     * @param[in] type       The tag data type.
+     * @param[in] datasize   The number of data bytes.
+     *
+     * @return pointer to the (uninitialized) data section of the staging buffer.
+     */
+    char* stage_tag(fiff_int_t kind, fiff_int_t type, fiff_int_t datasize);
+
+    //=========================================================================================================
+    /**
+     * Writes the staging buffer with a single device write, or hands it to the write-behind thread.
+     *
+     * @return true if succeeded, false otherwise.
+     */
+    bool write_staged();
+
+    //=========================================================================================================
+    /**
+     * Writes buf, optionally with every row multiplied by pScale, as one tag of the given sample type in one
+     * block. Integer types are rounded to the nearest value and saturated.
+     *
+     * @param[in] kind       The tag kind.
+     * @param[in] type       The sample type: FIFFT_FLOAT, FIFFT_INT or FIFFT_SHORT.
+     * @param[in] buf        The data (channels x samples).
+     * @param[in] pScale     Per-row scale factors, nullptr for none.
+     *
+     * @return true if succeeded, false otherwise.
+     */
+    bool write_sample_block(fiff_int_t kind, fiff_int_t type, const Eigen::MatrixXd& buf, const double* pScale);
+
 private:
 
 //    char         *file_name;    /**< Name of the file. */ -> Use streamName() instead
@@ -865,6 +950,11 @@ private:
 //    char        *ext_file_name; /**< Name of the file holding the external data. */
 //    FILE        *ext_fd;        /**< The file descriptor of the above file if open . */
 
+    QByteArray                              m_baStaging;        /**< Reusable buffer a whole tag is encoded into before writing. */
+    std::unique_ptr<FiffStreamWriteBehind>  m_pWriteBehind;     /**< Background writer, null if write-behind is off. */
+    Eigen::VectorXd                         m_vecScale;         /**< Reusable per-channel scale factors. */
+    fiff_int_t                              m_iRawDataType;     /**< Sample type write_raw_buffer stores, see start_writing_raw. */
+
 };
 } // NAMESPACE
 
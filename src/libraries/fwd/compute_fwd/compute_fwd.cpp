@@ -564,7 +564,8 @@ std::unique_ptr<MNEForwardSolution> ComputeFwd::calculateFwd()
                                               m_pSettings->use_threads,
                                               *m_meg_forward.data(),
                                               *m_meg_forward_grad.data(),
-                                              m_pSettings->compute_grad)) == FAIL) {
+                                              m_pSettings->compute_grad,
+                                              m_pSettings->nthreads)) == FAIL) {
             return nullptr;
         }
     }
@@ -576,7 +577,8 @@ std::unique_ptr<MNEForwardSolution> ComputeFwd::calculateFwd()
                                               m_pSettings->use_threads,
                                               *m_eeg_forward.data(),
                                               *m_eeg_forward_grad.data(),
-                                              m_pSettings->compute_grad))== FAIL) {
+                                              m_pSettings->compute_grad,
+                                              m_pSettings->nthreads))== FAIL) {
             return nullptr;
         }
     }
@@ -700,7 +702,8 @@ bool ComputeFwd::updateHeadPos(const FiffCoordTrans& transDevHead, MNEForwardSol
                                           m_pSettings->use_threads,
                                           *m_meg_forward.data(),
                                           *m_meg_forward_grad.data(),
-                                          m_pSettings->compute_grad)) == FAIL) {
+                                          m_pSettings->compute_grad,
+                                          m_pSettings->nthreads)) == FAIL) {
         return false;
     }
 
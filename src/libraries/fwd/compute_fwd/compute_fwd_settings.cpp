@@ -138,6 +138,7 @@ void ComputeFwdSettings::initMembers()
     scale_eeg_pos = false;    
     use_equiv_eeg = true;     
     use_threads = true;
+    nthreads = 0;
 
     pFiffInfo = nullptr;
     meg_head_t = FiffCoordTrans();
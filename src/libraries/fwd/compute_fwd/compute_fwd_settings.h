@@ -129,6 +129,7 @@ public:
     bool scale_eeg_pos;     	/**< Scale the electrode locations to scalp in the sphere model. */
     bool use_equiv_eeg;      	/**< Use the equivalent source approach for the EEG sphere model. */
     bool use_threads;        	/**< Parallelize?. */
+    int nthreads;               /**< Number of threads for the forward computation (0 = all cores). */
 
     QSharedPointer<FIFFLIB::FiffInfo> pFiffInfo;    /**< The FiffInfo file from the measurement.*/
     FIFFLIB::FiffCoordTrans meg_head_t;         /**< The meg <-> head transformation.*/
@@ -54,10 +54,21 @@
 #include <fiff/fiff_stream.h>
 #include <fiff/fiff_named_matrix.h>
 
+#include <QCryptographicHash>
+#include <QDir>
 #include <QFile>
+#include <QFileInfo>
 #include <QList>
+#include <QSaveFile>
+#include <QStandardPaths>
 #include <QThread>
 #include <QtConcurrent>
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 #define _USE_MATH_DEFINES
 #include <math.h>
@@ -85,6 +96,109 @@ constexpr auto BEM_SUFFIX     = "-bem.fif";
 constexpr auto BEM_SOL_SUFFIX = "-bem-sol.fif";
 constexpr float EPS  = 1e-5f;  // Points closer to origin than this are considered at the origin
 constexpr float CEPS = 1e-5f;
+
+constexpr int FWD_CHUNK_BYTES       = 256 * 1024;  // Target size of the result columns of one source chunk
+constexpr int FWD_CHUNKS_PER_THREAD = 4;           // Minimum number of chunks per thread for load balancing
+constexpr int FWD_BATCH_DIPOLES     = 96;          // Dipoles per call of the batched field and potential kernels
+
+constexpr auto BEM_SOL_CACHE_ENV     = "MNE_BEM_SOL_CACHE";
+constexpr int  BEM_SOL_CACHE_VERSION = 2;          // Change when the solution computation changes its result
+
+constexpr int BEM_ROW_BLOCK       = 32;            // Rows of the coefficient matrix assembled by one task
+constexpr int BEM_LU_PANEL        = 64;            // Width of the panels of the blocked LU factorization
+constexpr int BEM_LU_COLUMN_BLOCK = 256;           // Columns updated or solved by one task
+
+std::mutex bem_sol_cache_mutex;                     // Protects the two below
+bool       bem_sol_cache_dir_set = false;
+QString    bem_sol_cache_dir;
+
+//=============================================================================================================
+
+/*
+ * Call body(from,to) for consecutive blocks of [0,n) on all cores.
+ * The blocks must be independent; the result then does not depend on the number of threads.
+ */
+template<typename Body>
+void bem_parallel_blocks(int n, int block, const Body& body)
+{
+    int nblock  = (n + block - 1)/block;
+    int nthread = std::min(std::max(1, QThread::idealThreadCount()), nblock);
+    std::atomic<int> next(0);
+    std::vector<std::thread> workers;
+
+    auto worker = [&]() {
+        int b;
+        while ((b = next++) < nblock)
+            body(b*block, std::min(n, (b+1)*block));
+    };
+    for (int t = 1; t < nthread; t++)
+        workers.emplace_back(worker);
+    worker();
+    for (std::thread& thread : workers)
+        thread.join();
+}
+
+//=============================================================================================================
+
+/*
+ * Blocked right-looking LU factorization with partial pivoting, P a = L U, in place.
+ * Each panel is factored serially; the triangular solve for the block row to its right
+ * and the update of the trailing matrix, which take almost all of the time, are matrix
+ * products distributed over column blocks. Row j of P a is row perm[j] of a.
+ */
+bool bem_lu_factor(Eigen::MatrixXf& a, Eigen::VectorXi& perm)
+{
+    const int n = static_cast<int>(a.rows());
+    int p,c,r,nb,nend;
+    Eigen::Index piv;
+
+    perm = Eigen::VectorXi::LinSpaced(n, 0, n-1);
+    for (p = 0; p < n; p += BEM_LU_PANEL) {
+        nb   = std::min(BEM_LU_PANEL, n-p);
+        nend = p + nb;
+        for (c = p; c < nend; c++) {
+            if (a.col(c).tail(n-c).cwiseAbs().maxCoeff(&piv) == 0.0f)
+                return false;
+            r = c + static_cast<int>(piv);
+            if (r != c) {
+                a.row(c).swap(a.row(r));
+                std::swap(perm[c],perm[r]);
+            }
+            a.col(c).tail(n-c-1) /= a(c,c);
+            a.block(c+1,c+1,n-c-1,nend-c-1).noalias() -= a.col(c).tail(n-c-1)*a.row(c).segment(c+1,nend-c-1);
+        }
+        if (nend == n)
+            break;
+        bem_parallel_blocks(n-nend, BEM_LU_COLUMN_BLOCK, [&](int from, int to) {
+            auto a12 = a.block(p,nend+from,nb,to-from);
+            a.block(p,p,nb,nb).triangularView<Eigen::UnitLower>().solveInPlace(a12);
+            a.block(nend,nend+from,n-nend,to-from).noalias() -= a.block(nend,p,n-nend,nb)*a12;
+        });
+    }
+    return true;
+}
+
+//=============================================================================================================
+
+/*
+ * The inverse from the factors of bem_lu_factor, solved for blocks of unit vectors on all cores
+ */
+Eigen::MatrixXf bem_lu_inverse(const Eigen::MatrixXf& lu, const Eigen::VectorXi& perm)
+{
+    const int n = static_cast<int>(lu.rows());
+    Eigen::MatrixXf inv(n,n);
+
+    bem_parallel_blocks(n, BEM_LU_COLUMN_BLOCK, [&](int from, int to) {
+        auto x = inv.middleCols(from,to-from);
+        x.setZero();
+        for (int j = 0; j < n; j++)
+            if (perm[j] >= from && perm[j] < to)
+                x(j,perm[j]-from) = 1.0f;
+        lu.triangularView<Eigen::UnitLower>().solveInPlace(x);
+        lu.triangularView<Eigen::Upper>().solveInPlace(x);
+    });
+    return inv;
+}
 }
 
 namespace FWDLIB
@@ -206,6 +320,7 @@ void FwdBemModel::fwd_bem_free_solution()
     this->solution.resize(0, 0);
     this->sol_name.clear();
     this->v0.resize(0);
+    this->v0_batch.resize(0,0);
     this->bem_method = FWD_BEM_UNKNOWN;
     this->nsol       = 0;
 }
@@ -647,15 +762,13 @@ void FwdBemModel::correct_auto_elements(MNESurface& surf, Eigen::MatrixXf& mat)
           * Improve auto-element approximation...
           */
 {
-    float sum,miss;
     int   nnode = surf.np;
     int   ntri  = surf.ntri;
-    int   nmemb;
-    int   j,k;
     float pi2 = 2.0*M_PI;
-    MNETriangle*   tri;
 
 #ifdef SIMPLE
+    float sum;
+    int   j,k;
     for (j = 0; j < nnode; j++) {
         sum = 0.0;
         for (k = 0; k < nnode; k++)
@@ -665,45 +778,48 @@ void FwdBemModel::correct_auto_elements(MNESurface& surf, Eigen::MatrixXf& mat)
         mat(j,j) = pi2 - sum;
     }
 #else
-    for (j = 0; j < nnode; j++) {
-        /*
-         * How much is missing?
-         */
-        sum = 0.0;
-        for (k = 0; k < nnode; k++)
-            sum = sum + mat(j,k);
-        miss  = pi2-sum;
-        nmemb = surf.nneighbor_tri[j];
-        /*
-         * The node itself receives one half
-         */
-        mat(j,j) = miss/2.0;
-        /*
-         * The rest is divided evenly among the member nodes...
-         */
-        miss = miss/(4.0*nmemb);
-        for (k = 0,tri = surf.tris.data(); k < ntri; k++,tri++) {
-            if (tri->vert[0] == j) {
-                mat(j,tri->vert[1]) = mat(j,tri->vert[1]) + miss;
-                mat(j,tri->vert[2]) = mat(j,tri->vert[2]) + miss;
-            }
-            else if (tri->vert[1] == j) {
-                mat(j,tri->vert[0]) = mat(j,tri->vert[0]) + miss;
-                mat(j,tri->vert[2]) = mat(j,tri->vert[2]) + miss;
-            }
-            else if (tri->vert[2] == j) {
-                mat(j,tri->vert[0]) = mat(j,tri->vert[0]) + miss;
-                mat(j,tri->vert[1]) = mat(j,tri->vert[1]) + miss;
+    /*
+     * Each row is corrected independently
+     */
+    bem_parallel_blocks(nnode, BEM_ROW_BLOCK, [&](int from, int to) {
+        float sum,miss;
+        int   nmemb;
+        int   j,k;
+        const MNETriangle* tri;
+
+        for (j = from; j < to; j++) {
+            /*
+             * How much is missing?
+             */
+            sum = 0.0;
+            for (k = 0; k < nnode; k++)
+                sum = sum + mat(j,k);
+            miss  = pi2-sum;
+            nmemb = surf.nneighbor_tri[j];
+            /*
+             * The node itself receives one half
+             */
+            mat(j,j) = miss/2.0;
+            /*
+             * The rest is divided evenly among the member nodes...
+             */
+            miss = miss/(4.0*nmemb);
+            for (k = 0,tri = surf.tris.data(); k < ntri; k++,tri++) {
+                if (tri->vert[0] == j) {
+                    mat(j,tri->vert[1]) = mat(j,tri->vert[1]) + miss;
+                    mat(j,tri->vert[2]) = mat(j,tri->vert[2]) + miss;
+                }
+                else if (tri->vert[1] == j) {
+                    mat(j,tri->vert[0]) = mat(j,tri->vert[0]) + miss;
+                    mat(j,tri->vert[2]) = mat(j,tri->vert[2]) + miss;
+                }
+                else if (tri->vert[2] == j) {
+                    mat(j,tri->vert[0]) = mat(j,tri->vert[0]) + miss;
+                    mat(j,tri->vert[1]) = mat(j,tri->vert[1]) + miss;
+                }
             }
         }
-        /*
-         * Just check it it out...
-         *
-        for (k = 0, sum = 0; k < nnode; k++)
-          sum = sum + mat(j,k);
-        fprintf (stderr,"row %d sum = %g\n",j+1,sum/pi2);
-        */
-    }
+    });
 #endif
     return;
 }
@@ -715,22 +831,16 @@ Eigen::MatrixXf FwdBemModel::fwd_bem_lin_pot_coeff(const std::vector<MNESurface*
  * Calculate the coefficients for linear collocation approach
  */
 {
-    int   np1,np2,ntri,np_tot,np_max;
-    MNETriangle*   tri;
-    Eigen::Vector3d omega;
-    int    j,k,p,q,c;
+    int   np1,np2,ntri,np_tot;
+    int    p,q;
     int    joff,koff;
     MNESurface* surf1;
     MNESurface* surf2;
 
-    for (p = 0, np_tot = np_max = 0; p < surfs.size(); p++) {
+    for (p = 0, np_tot = 0; p < surfs.size(); p++)
         np_tot += surfs[p]->np;
-        if (surfs[p]->np > np_max)
-            np_max = surfs[p]->np;
-    }
 
     Eigen::MatrixXf mat = Eigen::MatrixXf::Zero(np_tot, np_tot);
-    Eigen::VectorXd row(np_max);
     for (p = 0, joff = 0; p < surfs.size(); p++, joff = joff + np1) {
         surf1 = surfs[p];
         np1   = surf1->np;
@@ -743,26 +853,34 @@ Eigen::MatrixXf FwdBemModel::fwd_bem_lin_pot_coeff(const std::vector<MNESurface*
                     fwd_bem_explain_surface(surf1->id).toUtf8().constData(),np1,
                     fwd_bem_explain_surface(surf2->id).toUtf8().constData(),np2);
 
-            for (j = 0; j < np1; j++) {
-                for (k = 0; k < np2; k++)
-                    row[k] = 0.0;
-                for (k = 0, tri = surf2->tris.data(); k < ntri; k++,tri++) {
-                    /*
-               * No contribution from a triangle that
-               * this vertex belongs to
-               */
-                    if (p == q && (tri->vert[0] == j || tri->vert[1] == j || tri->vert[2] == j))
-                        continue;
-                    /*
-               * Otherwise do the hard job
-               */
-                    lin_pot_coeff(surf1->point(j),*tri,omega);
-                    for (c = 0; c < 3; c++)
-                        row[tri->vert[c]] = row[tri->vert[c]] - omega[c];
+            /*
+             * The rows are computed in blocks on all cores
+             */
+            bem_parallel_blocks(np1, BEM_ROW_BLOCK, [&](int from, int to) {
+                Eigen::VectorXd row(np2);
+                Eigen::Vector3d omega;
+                MNETriangle* tri;
+                int j,k,c;
+
+                for (j = from; j < to; j++) {
+                    row.setZero();
+                    for (k = 0, tri = surf2->tris.data(); k < ntri; k++,tri++) {
+                        /*
+                         * No contribution from a triangle that
+                         * this vertex belongs to
+                         */
+                        if (p == q && (tri->vert[0] == j || tri->vert[1] == j || tri->vert[2] == j))
+                            continue;
+                        /*
+                         * Otherwise do the hard job
+                         */
+                        lin_pot_coeff(surf1->point(j),*tri,omega);
+                        for (c = 0; c < 3; c++)
+                            row[tri->vert[c]] = row[tri->vert[c]] - omega[c];
+                    }
+                    mat.block(j+joff,koff,1,np2) = row.transpose().cast<float>();
                 }
-                for (k = 0; k < np2; k++)
-                    mat(j+joff,k+koff) = row[k];
-            }
+            });
             if (p == q) {
                 Eigen::MatrixXf sub_mat = mat.block(joff, koff, np1, np1);
                 correct_auto_elements(*surf1, sub_mat);
@@ -879,9 +997,15 @@ Eigen::MatrixXf FwdBemModel::fwd_bem_multi_solution(Eigen::MatrixXf& solids, con
     }
     for (k = 0; k < ntot; k++)
         solids(k,k) = solids(k,k) + 1.0;
-
-    Eigen::MatrixXf result = solids.inverse();
-    return result;
+    /*
+     * Factor in place and solve for the columns of the inverse on all cores
+     */
+    Eigen::VectorXi perm;
+    if (!bem_lu_factor(solids, perm)) {
+        qWarning("The BEM coefficient matrix is singular.");
+        return Eigen::MatrixXf();
+    }
+    return bem_lu_inverse(solids, perm);
 }
 
 //=============================================================================================================
@@ -905,46 +1029,25 @@ void FwdBemModel::fwd_bem_ip_modify_solution(Eigen::MatrixXf &solution, Eigen::M
           */
 {
     int s;
-    int j,k,joff,koff,ntot,nlast;
+    int koff,nlast;
     float mult;
 
     for (s = 0, koff = 0; s < nsurf-1; s++)
         koff = koff + ntri[s];
     nlast = ntri[nsurf-1];
-    ntot  = koff + nlast;
 
-    Eigen::VectorXf row(nlast);
     mult = (1.0 + ip_mult)/ip_mult;
 
     qInfo("\t\tCombining...");
-    qInfo("t ");
-    ip_solution.transposeInPlace();
-
-    for (s = 0, joff = 0; s < nsurf; s++) {
-        qInfo("%d3 ",s+1);
-        /*
-         * For each row in this surface block, compute dot products
-         * with the transposed ip_solution and subtract 2x the result
-         */
-        for (j = 0; j < ntri[s]; j++) {
-            for (k = 0; k < nlast; k++) {
-                row[k] = solution.row(j + joff).segment(koff, nlast).dot(ip_solution.row(k).head(nlast));
-            }
-            solution.row(j + joff).segment(koff, nlast) -= 2.0f * row.transpose();
-        }
-        joff = joff + ntri[s];
-    }
-
-    qInfo("t ");
-    ip_solution.transposeInPlace();
-
-    qInfo("33 ");
+    /*
+     * The columns of the last surface for all surface blocks at once
+     */
+    Eigen::MatrixXf last = solution.middleCols(koff, nlast);
+    solution.middleCols(koff, nlast).noalias() -= 2.0f * (last * ip_solution);
     /*
      * The lower right corner is a special case
      */
-    for (j = 0; j < nlast; j++)
-        for (k = 0; k < nlast; k++)
-            solution(j + koff, k + koff) += mult * ip_solution(j,k);
+    solution.block(koff, koff, nlast, nlast) += mult * ip_solution;
     /*
      * Final scaling
      */
@@ -997,11 +1100,9 @@ Eigen::MatrixXf FwdBemModel::fwd_bem_solid_angles(const std::vector<MNESurface*>
 {
     MNESurface* surf1;
     MNESurface* surf2;
-    MNETriangle* tri;
     int ntri1,ntri2,ntri_tot;
-    int j,k,p,q;
+    int p,q;
     int joff,koff;
-    float result;
     float desired;
 
     for (p = 0,ntri_tot = 0; p < surfs.size(); p++)
@@ -1015,14 +1116,21 @@ Eigen::MatrixXf FwdBemModel::fwd_bem_solid_angles(const std::vector<MNESurface*>
             surf2 = surfs[q];
             ntri2 = surf2->ntri;
             qInfo("\t\t%s (%d) -> %s (%d) ... ",fwd_bem_explain_surface(surf1->id).toUtf8().constData(),ntri1,fwd_bem_explain_surface(surf2->id).toUtf8().constData(),ntri2);
-            for (j = 0; j < ntri1; j++)
-                for (k = 0, tri = surf2->tris.data(); k < ntri2; k++, tri++) {
-                    if (p == q && j == k)
-                        result = 0.0;
-                    else
-                        result = MNESurfaceOrVolume::solid_angle (surf1->tris[j].cent,*tri);
-                    solids(j+joff,k+koff) = result;
-                }
+            /*
+             * The rows are computed in blocks on all cores
+             */
+            bem_parallel_blocks(ntri1, BEM_ROW_BLOCK, [&](int from, int to) {
+                const MNETriangle* tri;
+                int j,k;
+
+                for (j = from; j < to; j++)
+                    for (k = 0, tri = surf2->tris.data(); k < ntri2; k++, tri++) {
+                        if (p == q && j == k)
+                            solids(j+joff,k+koff) = 0.0;
+                        else
+                            solids(j+joff,k+koff) = MNESurfaceOrVolume::solid_angle (surf1->tris[j].cent,*tri);
+                    }
+            });
             qInfo("[done]");
             if (p == q)
                 desired = 1;
@@ -1152,7 +1260,134 @@ int FwdBemModel::fwd_bem_load_recompute_solution(const QString& name, int bem_me
     }
     if (bem_method == FWD_BEM_UNKNOWN)
         bem_method = FWD_BEM_LINEAR_COLL;
-    return fwd_bem_compute_solution(bem_method);
+    if (force_recompute) {
+        /*
+         * Do not trust the cache but refresh it
+         */
+        QString cache_dir = fwd_bem_solution_cache_dir();
+        if (fwd_bem_compute_solution(bem_method) == FAIL)
+            return FAIL;
+        if (!cache_dir.isEmpty() &&
+                fwd_bem_write_solution(QDir(cache_dir).filePath(fwd_bem_solution_hash(bem_method) + BEM_SOL_SUFFIX)) == OK)
+            qInfo("BEM solution cache updated.");
+        return OK;
+    }
+    return fwd_bem_compute_cached_solution(bem_method);
+}
+
+//=============================================================================================================
+
+int FwdBemModel::fwd_bem_compute_cached_solution(int bem_method)
+/*
+ * Reuse the cached solution for this model or compute it and add it to the cache
+ */
+{
+    QString cache_dir = fwd_bem_solution_cache_dir();
+    QString cache_name;
+
+    if (!cache_dir.isEmpty()) {
+        cache_name = QDir(cache_dir).filePath(fwd_bem_solution_hash(bem_method) + BEM_SOL_SUFFIX);
+        if (QFile::exists(cache_name)) {
+            if (fwd_bem_load_solution(cache_name,bem_method) == LOADED) {
+                qInfo("\nLoaded %s BEM solution from the cache (%s)",fwd_bem_explain_method(this->bem_method).toUtf8().constData(),cache_name.toUtf8().constData());
+                return OK;
+            }
+            qWarning("Ignoring the unusable cached BEM solution %s",cache_name.toUtf8().constData());
+        }
+    }
+    if (fwd_bem_compute_solution(bem_method) == FAIL)
+        return FAIL;
+    if (!cache_name.isEmpty() && fwd_bem_write_solution(cache_name) == OK)
+        qInfo("BEM solution added to the cache (%s)",cache_name.toUtf8().constData());
+    return OK;
+}
+
+//=============================================================================================================
+
+int FwdBemModel::fwd_bem_write_solution(const QString& name) const
+/*
+ * Write the solution in the format read by fwd_bem_load_solution.
+ * The file appears under its final name only when it is complete so that
+ * concurrent computations never see a partial one.
+ */
+{
+    int method = (bem_method == FWD_BEM_CONSTANT_COLL) ? FIFFV_BEM_APPROX_CONST : FIFFV_BEM_APPROX_LINEAR;
+
+    if (solution.size() == 0)
+        return FAIL;
+    if (!QDir().mkpath(QFileInfo(name).absolutePath())) {
+        qWarning("Cannot create the directory for %s",name.toUtf8().constData());
+        return FAIL;
+    }
+    QSaveFile file(name);
+    FiffStream::SPtr stream = FiffStream::start_file(file);
+    if (!stream) {
+        qWarning("Cannot write the BEM solution to %s",name.toUtf8().constData());
+        return FAIL;
+    }
+    stream->start_block(FIFFB_BEM);
+    stream->write_int(FIFF_BEM_APPROX,&method);
+    stream->write_float_matrix(FIFF_BEM_POT_SOLUTION,solution);
+    stream->end_block(FIFFB_BEM);
+    stream->end_file();
+    if (!file.commit()) {
+        qWarning("Cannot write the BEM solution to %s",name.toUtf8().constData());
+        return FAIL;
+    }
+    return OK;
+}
+
+//=============================================================================================================
+
+QString FwdBemModel::fwd_bem_solution_hash(int bem_method) const
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    int version = BEM_SOL_CACHE_VERSION;
+
+    auto add = [&hash](const void* data, qint64 size) {
+        hash.addData(QByteArray::fromRawData(static_cast<const char*>(data), static_cast<int>(size)));
+    };
+    add(&version,sizeof(version));
+    add(&bem_method,sizeof(bem_method));
+    add(&nsurf,sizeof(nsurf));
+    add(&ip_approach_limit,sizeof(ip_approach_limit));
+    add(sigma.data(),sigma.size()*sizeof(float));
+    for (const auto& surf : surfs) {
+        add(&surf->id,sizeof(surf->id));
+        add(&surf->np,sizeof(surf->np));
+        add(&surf->ntri,sizeof(surf->ntri));
+        add(surf->rr.data(),surf->rr.size()*sizeof(float));
+        add(surf->itris.data(),surf->itris.size()*sizeof(int));
+    }
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+//=============================================================================================================
+
+void FwdBemModel::fwd_bem_set_solution_cache_dir(const QString& dir)
+{
+    std::lock_guard<std::mutex> lock(bem_sol_cache_mutex);
+    bem_sol_cache_dir     = dir;
+    bem_sol_cache_dir_set = true;
+}
+
+//=============================================================================================================
+
+QString FwdBemModel::fwd_bem_solution_cache_dir()
+{
+    std::lock_guard<std::mutex> lock(bem_sol_cache_mutex);
+    if (!bem_sol_cache_dir_set) {
+        if (qEnvironmentVariableIsSet(BEM_SOL_CACHE_ENV)) {
+            bem_sol_cache_dir = qEnvironmentVariable(BEM_SOL_CACHE_ENV);
+        }
+        else {
+            QString location = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation);
+            if (!location.isEmpty())
+                bem_sol_cache_dir = QDir(location).filePath("mne-cpp/bem-solutions");
+        }
+        bem_sol_cache_dir_set = true;
+    }
+    return bem_sol_cache_dir;
 }
 
 //=============================================================================================================
@@ -1472,7 +1707,7 @@ int FwdBemModel::fwd_bem_pot_els(const Eigen::Vector3f& rd, const Eigen::Vector3
         qWarning("No BEM model specified to fwd_bem_pot_els");
         return FAIL;
     }
-    if (m->solution.size() == 0) {
+    if (!sol || sol->solution.size() == 0) {
         qWarning("No solution available for fwd_bem_pot_els");
         return FAIL;
     }
@@ -1495,6 +1730,81 @@ int FwdBemModel::fwd_bem_pot_els(const Eigen::Vector3f& rd, const Eigen::Vector3
 
 //=============================================================================================================
 
+void FwdBemModel::fwd_bem_inf_pots_batch(const Eigen::MatrixX3f& rd, const Eigen::MatrixX3f& Q, Eigen::MatrixXf& V0t) const
+/*
+ * Compute the weighted infinite-medium potentials of a block of dipoles at the
+ * triangle centers (constant collocation) or at the vertices (linear collocation).
+ * The dipoles are in the inner loop so that the arithmetic vectorizes.
+ */
+{
+    int   ndip = static_cast<int>(rd.rows());
+    int   s,k,p;
+    float mult;
+    /*
+       * The dipole locations and orientations must be transformed
+       */
+    const Eigen::MatrixX3f mri_rd = head_mri_t.isEmpty() ? rd : head_mri_t.apply_trans(rd,FIFFV_MOVE);
+    const Eigen::MatrixX3f mri_Q  = head_mri_t.isEmpty() ? Q  : head_mri_t.apply_trans(Q,FIFFV_NO_MOVE);
+    Eigen::ArrayXf dx(ndip), dy(ndip), dz(ndip), diff2(ndip);
+
+    auto inf_pot = [&](const Eigen::Vector3f& rp, Eigen::Ref<Eigen::VectorXf> v0) {
+        dx    = rp[0] - mri_rd.col(0).array();
+        dy    = rp[1] - mri_rd.col(1).array();
+        dz    = rp[2] - mri_rd.col(2).array();
+        diff2 = dx*dx + dy*dy + dz*dz;
+        v0.array() = mult*(mri_Q.col(0).array()*dx + mri_Q.col(1).array()*dy + mri_Q.col(2).array()*dz)/(diff2*diff2.sqrt());
+    };
+
+    V0t.resize(ndip,nsol);
+    for (s = 0, p = 0; s < nsurf; s++) {
+        mult = static_cast<float>(source_mult[s]/(4.0*M_PI));
+        if (bem_method == FWD_BEM_CONSTANT_COLL) {
+            const MNETriangle* tri = surfs[s]->tris.data();
+            for (k = 0; k < surfs[s]->ntri; k++, tri++)
+                inf_pot(tri->cent,V0t.col(p++));
+        }
+        else {
+            for (k = 0; k < surfs[s]->np; k++)
+                inf_pot(surfs[s]->point(k),V0t.col(p++));
+        }
+    }
+    return;
+}
+
+//=============================================================================================================
+
+int FwdBemModel::fwd_bem_pot_els_batch(const Eigen::MatrixX3f& rd, const Eigen::MatrixX3f& Q, FwdCoilSet &els, Eigen::Ref<Eigen::MatrixXf> pot, void *client) /* The model */
+/*
+     * Potentials of a block of dipoles at the electrodes: one product of the
+     * electrode-specific solution with the infinite-medium potentials of all dipoles
+     */
+{
+    auto* m = static_cast<FwdBemModel*>(client);
+    FwdBemSolution* sol = els.user_data.get();
+
+    if (!m) {
+        qWarning("No BEM model specified to fwd_bem_pot_els_batch");
+        return FAIL;
+    }
+    if (!sol || sol->solution.size() == 0) {
+        qWarning("No solution available for fwd_bem_pot_els_batch");
+        return FAIL;
+    }
+    if (sol->ncoil != els.ncoil()) {
+        qWarning("No appropriate electrode-specific data available in fwd_bem_pot_els_batch");
+        return FAIL;
+    }
+    if (m->bem_method != FWD_BEM_CONSTANT_COLL && m->bem_method != FWD_BEM_LINEAR_COLL) {
+        qWarning("Unknown BEM method : %d",m->bem_method);
+        return FAIL;
+    }
+    m->fwd_bem_inf_pots_batch(rd,Q,m->v0_batch);
+    pot.noalias() = sol->solution*m->v0_batch.transpose();
+    return OK;
+}
+
+//=============================================================================================================
+
 int FwdBemModel::fwd_bem_pot_grad_els(const Eigen::Vector3f& rd, const Eigen::Vector3f& Q, FwdCoilSet &els, Eigen::Ref<Eigen::VectorXf> pot, Eigen::Ref<Eigen::VectorXf> xgrad, Eigen::Ref<Eigen::VectorXf> ygrad, Eigen::Ref<Eigen::VectorXf> zgrad, void *client) /* The model */
 /*
      * This version calculates the potential on all surfaces
@@ -1507,7 +1817,7 @@ int FwdBemModel::fwd_bem_pot_grad_els(const Eigen::Vector3f& rd, const Eigen::Ve
         qCritical("No BEM model specified to fwd_bem_pot_els");
         return FAIL;
     }
-    if (m->solution.size() == 0) {
+    if (!sol || sol->solution.size() == 0) {
         qCritical("No solution available for fwd_bem_pot_els");
         return FAIL;
     }
@@ -2374,6 +2684,66 @@ int FwdBemModel::fwd_bem_field(const Eigen::Vector3f& rd, const Eigen::Vector3f&
 
 //=============================================================================================================
 
+int FwdBemModel::fwd_bem_field_batch(const Eigen::MatrixX3f& rd, const Eigen::MatrixX3f& Q, FwdCoilSet &coils, Eigen::Ref<Eigen::MatrixXf> B, void *client)  /* The model */
+/*
+     * Magnetic fields of a block of dipoles in a set of coils.
+     * The volume current contribution of all dipoles is one product
+     * of the coil-specific solution with the infinite-medium potentials
+     */
+{
+    auto* m = static_cast<FwdBemModel*>(client);
+    FwdBemSolution* sol = coils.user_data.get();
+    int   ndip = static_cast<int>(rd.rows());
+    int   k,p;
+    FwdCoil* coil;
+
+    if (!m) {
+        qWarning("No BEM model specified to fwd_bem_field_batch");
+        return FAIL;
+    }
+    if (!sol || sol->solution.size() == 0 || sol->ncoil != coils.ncoil()) {
+        qWarning("No appropriate coil-specific data available in fwd_bem_field_batch");
+        return FAIL;
+    }
+    if (m->bem_method != FWD_BEM_CONSTANT_COLL && m->bem_method != FWD_BEM_LINEAR_COLL) {
+        qWarning("Unknown BEM method : %d",m->bem_method);
+        return FAIL;
+    }
+    /*
+       * Volume current contribution
+       */
+    m->fwd_bem_inf_pots_batch(rd,Q,m->v0_batch);
+    B.noalias() = sol->solution*m->v0_batch.transpose();
+    /*
+       * Primary current contribution
+       * (can be calculated in the coil/dipole coordinates)
+       */
+    Eigen::ArrayXf dx(ndip), dy(ndip), dz(ndip), diff2(ndip), prim(ndip);
+    for (k = 0; k < coils.ncoil(); k++) {
+        coil = coils.coils[k].get();
+        prim.setZero();
+        for (p = 0; p < coil->np; p++) {
+            Eigen::Map<const Eigen::Vector3f> pos = coil->pos(p);
+            Eigen::Map<const Eigen::Vector3f> dir = coil->dir(p);
+            dx    = pos[0] - rd.col(0).array();
+            dy    = pos[1] - rd.col(1).array();
+            dz    = pos[2] - rd.col(2).array();
+            diff2 = dx*dx + dy*dy + dz*dz;
+            prim += coil->w[p]*((Q.col(1).array()*dz - Q.col(2).array()*dy)*dir[0] +
+                                (Q.col(2).array()*dx - Q.col(0).array()*dz)*dir[1] +
+                                (Q.col(0).array()*dy - Q.col(1).array()*dx)*dir[2])/(diff2*diff2.sqrt());
+        }
+        B.row(k) += prim.matrix().transpose();
+    }
+    /*
+       * Scale correctly
+       */
+    B *= static_cast<float>(MAG_FACTOR);
+    return OK;
+}
+
+//=============================================================================================================
+
 int FwdBemModel::fwd_bem_field_grad(const Eigen::Vector3f& rd,
                                     const Eigen::Vector3f& Q,
                                     FwdCoilSet &coils,
@@ -2419,11 +2789,13 @@ int FwdBemModel::fwd_bem_field_grad(const Eigen::Vector3f& rd,
 void FwdBemModel::meg_eeg_fwd_one_source_space(FwdThreadArg* a)
 /*
  * Compute the MEG or EEG forward solution for one source space
- * and possibly for only one source component
+ * (or a range of its vertices) and possibly for only one source component
  */
 {
     MNESourceSpace* s = a->s;
     int            j,p,q;
+    int            from = a->vert_from;
+    int            to   = a->vert_to < 0 ? s->np : a->vert_to;
 
     int ncoil = a->coils_els->ncoil();
     Eigen::MatrixXf tmp_vec_res(3, ncoil);  /* Only needed for vec_field_pot (3 rows → 3 columns) */
@@ -2432,9 +2804,44 @@ void FwdBemModel::meg_eeg_fwd_one_source_space(FwdThreadArg* a)
 
     p = a->off;
     q = 3*a->off;
-    if (a->fixed_ori) {					  /* The normal source component only */
+    if (a->field_pot_batch && !(a->field_pot_grad && a->res_grad) && a->comp < 0) {
+        /*
+         * Blocks of dipoles through the batched kernel
+         * (three orthogonal dipoles per vertex unless the orientation is fixed)
+         */
+        int ncomp = a->fixed_ori ? 1 : 3;
+        int nvert = std::max(1, FWD_BATCH_DIPOLES/ncomp);
+        int ndip  = 0;
+        Eigen::MatrixX3f rd(nvert*ncomp,3);
+        Eigen::MatrixX3f Q(nvert*ncomp,3);
+
+        for (j = from; j < to; j++) {
+            if (!s->inuse[j])
+                continue;
+            for (int c = 0; c < ncomp; c++, ndip++) {
+                rd.row(ndip) = s->point(j).transpose();
+                if (a->fixed_ori)
+                    Q.row(ndip) = s->normal(j).transpose();
+                else
+                    Q.row(ndip) = Eigen::RowVector3f::Unit(c);
+            }
+            if (ndip == rd.rows()) {
+                if (a->field_pot_batch(rd,Q,*a->coils_els,a->res->middleCols(p,ndip),a->client) != OK) {
+                    fail(); return;
+                }
+                p += ndip;
+                ndip = 0;
+            }
+        }
+        if (ndip > 0) {
+            if (a->field_pot_batch(rd.topRows(ndip),Q.topRows(ndip),*a->coils_els,a->res->middleCols(p,ndip),a->client) != OK) {
+                fail(); return;
+            }
+        }
+    }
+    else if (a->fixed_ori) {					  /* The normal source component only */
         if (a->field_pot_grad && a->res_grad) {                   /* Gradient requested? */
-            for (j = 0; j < s->np; j++) {
+            for (j = from; j < to; j++) {
                 if (s->inuse[j]) {
                     if (a->field_pot_grad(s->point(j),
                                           s->normal(j),
@@ -2451,7 +2858,7 @@ void FwdBemModel::meg_eeg_fwd_one_source_space(FwdThreadArg* a)
                 }
             }
         } else {
-            for (j = 0; j < s->np; j++)
+            for (j = from; j < to; j++)
                 if (s->inuse[j]) {
                     if (a->field_pot(s->point(j),
                                      s->normal(j),
@@ -2466,7 +2873,7 @@ void FwdBemModel::meg_eeg_fwd_one_source_space(FwdThreadArg* a)
     }
     else {						  /* All source components */
         if (a->field_pot_grad && a->res_grad) {               /* Gradient requested? */
-            for (j = 0; j < s->np; j++) {
+            for (j = from; j < to; j++) {
                 if (s->inuse[j]) {
                     if (a->comp < 0) {				  /* Compute all components */
                         if (a->field_pot_grad(s->point(j),
@@ -2522,7 +2929,7 @@ void FwdBemModel::meg_eeg_fwd_one_source_space(FwdThreadArg* a)
             }
         }
         else {
-            for (j = 0; j < s->np; j++) {
+            for (j = from; j < to; j++) {
                 if (s->inuse[j]) {
                     if (a->vec_field_pot) {
                         if (a->vec_field_pot(s->point(j),*a->coils_els,tmp_vec_res,a->client) != OK) {
@@ -2574,6 +2981,107 @@ void FwdBemModel::meg_eeg_fwd_one_source_space(FwdThreadArg* a)
 
 //=============================================================================================================
 
+int FwdBemModel::compute_forward_chunked(std::vector<std::unique_ptr<MNESourceSpace>>& spaces,
+                                         FwdThreadArg& one_arg,
+                                         bool meg,
+                                         int nthread)
+/*
+ * Split the source spaces into chunks of sources whose result columns fit the cache
+ * and let each thread take the next chunk as soon as it is done with the previous one.
+ * Every chunk writes its own column range of res and res_grad, so the result does not
+ * depend on the number of threads or on the order in which the chunks are processed.
+ */
+{
+    struct SourceChunk {
+        MNESourceSpace* s;
+        int             from;
+        int             to;
+        int             off;
+    };
+    std::vector<SourceChunk> chunks;
+    std::vector<FwdThreadArg::UPtr> args;
+    std::vector<std::thread> workers;
+    std::atomic<int>  next(0);
+    std::atomic<bool> failed(false);
+    int ncoil   = one_arg.coils_els->ncoil();
+    int ncomp   = one_arg.fixed_ori ? 1 : 3;
+    int ncol    = one_arg.res_grad ? 4*ncomp : ncomp;   /* Result columns per source */
+    int nsource = 0;
+    int chunk_size,nuse,from,off,chunk_off,j;
+
+    for (const auto& space : spaces)
+        nsource += space->nuse;
+    if (nsource == 0)
+        return OK;
+    /*
+     * Chunk size: the columns of one chunk should fit the cache, and there should be
+     * enough chunks for the threads which finish early to take over work
+     */
+    chunk_size = std::max(1, FWD_CHUNK_BYTES / std::max(1, ncoil*ncol*static_cast<int>(sizeof(float))));
+    chunk_size = std::min(chunk_size, std::max(1, nsource / (FWD_CHUNKS_PER_THREAD*nthread)));
+    if (one_arg.field_pot_batch && !(one_arg.field_pot_grad && one_arg.res_grad)) {
+        /*
+         * Whole dipole blocks only: the blocks are then the same as in the serial
+         * computation and so are the results, bit by bit
+         */
+        int nvert  = std::max(1, FWD_BATCH_DIPOLES/ncomp);
+        chunk_size = ((chunk_size + nvert - 1)/nvert)*nvert;
+    }
+
+    off = 0;
+    for (const auto& space : spaces) {
+        MNESourceSpace* s = space.get();
+        from      = 0;
+        nuse      = 0;
+        chunk_off = off;
+        for (j = 0; j < s->np; j++) {
+            if (s->inuse[j]) {
+                if (nuse == chunk_size) {
+                    chunks.push_back({s, from, j, chunk_off});
+                    from      = j;
+                    nuse      = 0;
+                    chunk_off = off;
+                }
+                nuse++;
+                off += ncomp;
+            }
+        }
+        if (nuse > 0)
+            chunks.push_back({s, from, s->np, chunk_off});
+    }
+    /*
+     * We need copies to allocate separate workspace for each thread
+     */
+    nthread = std::min(nthread, static_cast<int>(chunks.size()));
+    for (j = 0; j < nthread; j++)
+        args.push_back(meg ? FwdThreadArg::create_meg_multi_thread_duplicate(one_arg,true)
+                           : FwdThreadArg::create_eeg_multi_thread_duplicate(one_arg,true));
+    qInfo("%d processors. I will use %d threads for %d chunks of up to %d sources.",
+          QThread::idealThreadCount(),nthread,static_cast<int>(chunks.size()),chunk_size);
+
+    auto worker = [&](FwdThreadArg* a) {
+        int c;
+        while (!failed && (c = next++) < static_cast<int>(chunks.size())) {
+            a->s         = chunks[c].s;
+            a->vert_from = chunks[c].from;
+            a->vert_to   = chunks[c].to;
+            a->off       = chunks[c].off;
+            a->comp      = -1;
+            meg_eeg_fwd_one_source_space(a);
+            if (a->stat != OK)
+                failed = true;
+        }
+    };
+    for (j = 0; j < nthread; j++)
+        workers.emplace_back(worker, args[j].get());
+    for (std::thread& thread : workers)
+        thread.join();
+
+    return failed ? FAIL : OK;
+}
+
+//=============================================================================================================
+
 int FwdBemModel::compute_forward_meg(std::vector<std::unique_ptr<MNESourceSpace>>& spaces,
                                      FwdCoilSet *coils,
                                      FwdCoilSet *comp_coils,
@@ -2583,7 +3091,8 @@ int FwdBemModel::compute_forward_meg(std::vector<std::unique_ptr<MNESourceSpace>
                                      bool use_threads,
                                      FiffNamedMatrix& resp,
                                      FiffNamedMatrix& resp_grad,
-                                     bool bDoGrad)
+                                     bool bDoGrad,
+                                     int nthread)
 /*
  * Compute the MEG forward solution
  * Use either the sphere model or BEM in the calculations
@@ -2599,14 +3108,15 @@ int FwdBemModel::compute_forward_meg(std::vector<std::unique_ptr<MNESourceSpace>
     fwdVecFieldFunc     vec_field;          /* Computes the field for all dipole orientations */
     fwdFieldGradFunc    field_grad;         /* Computes the field and gradient with respect to dipole position
                                              * for one dipole orientation */
+    fwdFieldBatchFunc   field_batch;        /* Computes the fields of a block of dipoles */
     int                 nmeg = coils->ncoil();/* Number of channels */
     int                 nsource;            /* Total number of sources */
     int                 nspace = static_cast<int>(spaces.size());
-    int                 k,p,q,off;
+    int                 k,off;
     QStringList         names;              /* Channel names */
     void                *client;
     FwdThreadArg::UPtr one_arg;
-    int                 nproc = QThread::idealThreadCount();
+    QElapsedTimer       timer;
     QStringList         emptyList;
 
     auto cleanup_fail = [&]() { one_arg.reset(); delete comp; return FAIL; };
@@ -2649,10 +3159,13 @@ int FwdBemModel::compute_forward_meg(std::vector<std::unique_ptr<MNESourceSpace>
                 return cleanup_fail();
             qInfo("[done]");
         }
-        field      = FwdCompData::fwd_comp_field;
-        vec_field  = nullptr;
-        field_grad = FwdCompData::fwd_comp_field_grad;
-        client     = comp;
+        comp->field_batch = FwdBemModel::fwd_bem_field_batch;
+
+        field       = FwdCompData::fwd_comp_field;
+        vec_field   = nullptr;
+        field_grad  = FwdCompData::fwd_comp_field_grad;
+        field_batch = FwdCompData::fwd_comp_field_batch;
+        client      = comp;
     }
     else {
         /*
@@ -2675,9 +3188,12 @@ int FwdBemModel::compute_forward_meg(std::vector<std::unique_ptr<MNESourceSpace>
 #endif
         if (!comp)
             return cleanup_fail();
+        comp->field_batch = fwd_sphere_field_batch;
+
         field       = FwdCompData::fwd_comp_field;
         vec_field   = FwdCompData::fwd_comp_field_vec;
         field_grad  = FwdCompData::fwd_comp_field_grad;
+        field_batch = FwdCompData::fwd_comp_field_batch;
         client      = comp;
     }
     /*
@@ -2710,58 +3226,26 @@ int FwdBemModel::compute_forward_meg(std::vector<std::unique_ptr<MNESourceSpace>
     one_arg->field_pot      = field;
     one_arg->vec_field_pot  = vec_field;
     one_arg->field_pot_grad = field_grad;
+    one_arg->field_pot_batch = field_batch;
 
-    if (nproc < 2)
+    if (nthread <= 0)
+        nthread = QThread::idealThreadCount();
+    if (nthread < 2)
         use_threads = false;
 
+    timer.start();
     if (use_threads) {
-        int            nthread  = (fixed_ori || vec_field || nproc < 6) ? nspace : 3*nspace;
-        std::vector<FwdThreadArg::UPtr> args;
-        int            stat;
-        /*
-        * We need copies to allocate separate workspace for each thread
-        */
-        if (fixed_ori || vec_field || nproc < 6) {
-            for (k = 0, off = 0; k < nthread; k++) {
-                auto t_arg = FwdThreadArg::create_meg_multi_thread_duplicate(*one_arg,true);
-                t_arg->s   = spaces[k].get();
-                t_arg->off = off;
-                off = fixed_ori ? off + spaces[k]->nuse : off + 3*spaces[k]->nuse;
-                args.push_back(std::move(t_arg));
-            }
-            qInfo("%d processors. I will use one thread for each of the %d source spaces.",
-                    nproc,nspace);
-        }
-        else {
-            for (k = 0, off = 0, q = 0; k < nspace; k++) {
-                for (p = 0; p < 3; p++,q++) {
-                    auto t_arg = FwdThreadArg::create_meg_multi_thread_duplicate(*one_arg,true);
-                    t_arg->s    = spaces[k].get();
-                    t_arg->off  = off;
-                    t_arg->comp = p;
-                    args.push_back(std::move(t_arg));
-                }
-                off = fixed_ori ? off + spaces[k]->nuse : off + 3*spaces[k]->nuse;
-            }
-            qInfo("%d processors. I will use %d threads : %d source spaces x 3 source components.",
-                    nproc,nthread,nspace);
-        }
+        Eigen::MatrixXf full_solution;
+        int             stat;
+
         qInfo("Computing MEG at %d source locations (%s orientations)...",
                 nsource,fixed_ori ? "fixed" : "free");
         /*
-        * Ready to start the threads & Wait for them to complete
-        */
-        QtConcurrent::blockingMap(args, [](FwdThreadArg::UPtr& a) {
-            meg_eeg_fwd_one_source_space(a.get());
-        });
-        /*
-        * Check the results
-        */
-        for (k = 0, stat = OK; k < nthread; k++)
-            if (args[k]->stat != OK) {
-                stat = FAIL;
-                break;
-            }
+         * The threads use the coil-specific solutions. Keep the full solution matrix out of their model copies.
+         */
+        full_solution.swap(solution);
+        stat = compute_forward_chunked(spaces,*one_arg,true,nthread);
+        solution.swap(full_solution);
         if (stat != OK)
             return cleanup_fail();
     }
@@ -2777,7 +3261,7 @@ int FwdBemModel::compute_forward_meg(std::vector<std::unique_ptr<MNESourceSpace>
             off = fixed_ori ? off + one_arg->s->nuse : off + 3*one_arg->s->nuse;
         }
     }
-    qInfo("done.");
+    qInfo("done (%.2f s).",timer.elapsed()/1000.0);
     {
         QStringList orig_names;
         for (k = 0; k < nmeg; k++)
@@ -2818,7 +3302,8 @@ int FwdBemModel::compute_forward_eeg(std::vector<std::unique_ptr<MNESourceSpace>
                                      bool use_threads,
                                      FiffNamedMatrix& resp,
                                      FiffNamedMatrix& resp_grad,
-                                     bool bDoGrad)
+                                     bool bDoGrad,
+                                     int nthread)
 /*
      * Compute the EEG forward solution
      * Use either the sphere model or BEM in the calculations
@@ -2833,14 +3318,15 @@ int FwdBemModel::compute_forward_eeg(std::vector<std::unique_ptr<MNESourceSpace>
     fwdVecFieldFunc  vec_pot;               /* Computes the potentials for all dipole orientations */
     fwdFieldGradFunc pot_grad;              /* Computes the potential and gradient with respect to dipole position
                                              * for one dipole orientation */
+    fwdFieldBatchFunc pot_batch = nullptr;  /* Computes the potentials of a block of dipoles */
     int             nsource;                /* Total number of sources */
     int             nspace = static_cast<int>(spaces.size());
     int             neeg = els->ncoil();      /* Number of channels */
-    int             k,p,q,off;
+    int             k,off;
     QStringList     names;                  /* Channel names */
     void            *client;
     FwdThreadArg::UPtr one_arg;
-    int             nproc = QThread::idealThreadCount();
+    QElapsedTimer   timer;
     QStringList     emptyList;
     /*
        * Count the sources
@@ -2851,9 +3337,10 @@ int FwdBemModel::compute_forward_eeg(std::vector<std::unique_ptr<MNESourceSpace>
     if (true) {
         if (fwd_bem_specify_els(els) == FAIL)
             return FAIL;
-        client   = this;
-        pot      = fwd_bem_pot_els;
-        vec_pot  = nullptr;
+        client    = this;
+        pot       = fwd_bem_pot_els;
+        vec_pot   = nullptr;
+        pot_batch = fwd_bem_pot_els_batch;
 #ifdef TEST
         qInfo("Using differences.");
         pot_grad = my_bem_pot_grad;
@@ -2905,56 +3392,26 @@ int FwdBemModel::compute_forward_eeg(std::vector<std::unique_ptr<MNESourceSpace>
     one_arg->field_pot      = pot;
     one_arg->vec_field_pot  = vec_pot;
     one_arg->field_pot_grad = pot_grad;
+    one_arg->field_pot_batch = pot_batch;
 
-    if (nproc < 2)
+    if (nthread <= 0)
+        nthread = QThread::idealThreadCount();
+    if (nthread < 2)
         use_threads = false;
 
+    timer.start();
     if (use_threads) {
-        int            nthread  = (fixed_ori || vec_pot || nproc < 6) ? nspace : 3*nspace;
-        std::vector<FwdThreadArg::UPtr> args;
-        int            stat;
-        /*
-        * We need copies to allocate separate workspace for each thread
-        */
-        if (fixed_ori || vec_pot || nproc < 6) {
-            for (k = 0, off = 0; k < nthread; k++) {
-                auto t_arg = FwdThreadArg::create_eeg_multi_thread_duplicate(*one_arg,true);
-                t_arg->s   = spaces[k].get();
-                t_arg->off = off;
-                off = fixed_ori ? off + spaces[k]->nuse : off + 3*spaces[k]->nuse;
-                args.push_back(std::move(t_arg));
-            }
-            qInfo("%d processors. I will use one thread for each of the %d source spaces.",nproc,nspace);
-        }
-        else {
-            for (k = 0, off = 0, q = 0; k < nspace; k++) {
-                for (p = 0; p < 3; p++,q++) {
-                    auto t_arg = FwdThreadArg::create_eeg_multi_thread_duplicate(*one_arg,true);
-                    t_arg->s    = spaces[k].get();
-                    t_arg->off  = off;
-                    t_arg->comp = p;
-                    args.push_back(std::move(t_arg));
-                }
-                off = fixed_ori ? off + spaces[k]->nuse : off + 3*spaces[k]->nuse;
-            }
-            qInfo("%d processors. I will use %d threads : %d source spaces x 3 source components.",nproc,nthread,nspace);
-        }
+        Eigen::MatrixXf full_solution;
+        int             stat;
+
         qInfo("Computing EEG at %d source locations (%s orientations)...",
                 nsource,fixed_ori ? "fixed" : "free");
         /*
-        * Ready to start the threads & Wait for them to complete
-        */
-        QtConcurrent::blockingMap(args, [](FwdThreadArg::UPtr& a) {
-            meg_eeg_fwd_one_source_space(a.get());
-        });
-        /*
-        * Check the results
-        */
-        for (k = 0, stat = OK; k < nthread; k++)
-            if (args[k]->stat != OK) {
-                stat = FAIL;
-                break;
-            }
+         * The threads use the coil-specific solutions. Keep the full solution matrix out of their model copies.
+         */
+        full_solution.swap(solution);
+        stat = compute_forward_chunked(spaces,*one_arg,false,nthread);
+        solution.swap(full_solution);
         if (stat != OK)
             return FAIL;
     }
@@ -2970,7 +3427,7 @@ int FwdBemModel::compute_forward_eeg(std::vector<std::unique_ptr<MNESourceSpace>
             off = fixed_ori ? off + one_arg->s->nuse : off + 3*one_arg->s->nuse;
         }
     }
-    qInfo("done.");
+    qInfo("done (%.2f s).",timer.elapsed()/1000.0);
     {
         QStringList orig_names;
         for (k = 0; k < neeg; k++)
@@ -3098,6 +3555,82 @@ int FwdBemModel::fwd_sphere_field(const Eigen::Vector3f& rd, const Eigen::Vector
 
 //=============================================================================================================
 
+int FwdBemModel::fwd_sphere_field_batch(const Eigen::MatrixX3f& rd, const Eigen::MatrixX3f& Q, FwdCoilSet &coils, Eigen::Ref<Eigen::MatrixXf> Bval, void *client)	/* Client data will be the sphere model origin */
+/*
+ * The formula of fwd_sphere_field evaluated for a block of dipoles at once.
+ * The special cases (dipole at the origin, dipole and field point on the same line)
+ * are handled with masks instead of branches.
+ */
+{
+    auto* r0 = static_cast<float*>(client);
+    int   ndip = static_cast<int>(rd.rows());
+    int   j,k;
+    FwdCoil* this_coil;
+    /*
+       * Shift to the sphere model coordinates
+       */
+    const Eigen::ArrayXf rdx = rd.col(0).array() - r0[0];
+    const Eigen::ArrayXf rdy = rd.col(1).array() - r0[1];
+    const Eigen::ArrayXf rdz = rd.col(2).array() - r0[2];
+    /*
+       * Dipoles at the origin produce no field
+       */
+    const Eigen::ArrayXf rd_norm = (rdx*rdx + rdy*rdy + rdz*rdz).sqrt();
+    const Eigen::ArrayXf vx = Q.col(1).array()*rdz - Q.col(2).array()*rdy;
+    const Eigen::ArrayXf vy = Q.col(2).array()*rdx - Q.col(0).array()*rdz;
+    const Eigen::ArrayXf vz = Q.col(0).array()*rdy - Q.col(1).array()*rdx;
+    Eigen::ArrayXf ax(ndip), ay(ndip), az(ndip), a(ndip), a2(ndip), ar(ndip), ar0(ndip);
+    Eigen::ArrayXf F(ndip), gr(ndip), g0(ndip), term(ndip), sum(ndip);
+
+    for (k = 0; k < coils.ncoil(); k++) {
+        this_coil = coils.coils[k].get();
+        if (FWD_IS_MEG_COIL(this_coil->coil_class))
+            Bval.row(k).setZero();
+        if (!FWD_IS_MEG_COIL(this_coil->type))
+            continue;
+        sum.setZero();
+        for (j = 0; j < this_coil->np; j++) {
+            Eigen::Vector3f pos = this_coil->pos(j) - Eigen::Map<const Eigen::Vector3f>(r0);
+            Eigen::Map<const Eigen::Vector3f> this_dir = this_coil->dir(j);
+            float r2 = pos.squaredNorm();
+            float r  = std::sqrt(r2);
+            float re = pos.dot(this_dir);
+
+            if (r <= 0.0)
+                continue;
+            /* Vector from dipole to the field point */
+
+            ax  = pos[0] - rdx;
+            ay  = pos[1] - rdy;
+            az  = pos[2] - rdz;
+            a2  = ax*ax + ay*ay + az*az;
+            a   = a2.sqrt();
+            ar  = r2 - (pos[0]*rdx + pos[1]*rdy + pos[2]*rdz);
+            ar0 = ar/a;
+
+            /* The main ingredients */
+
+            F  = a*(r*a + ar);
+            gr = a2/r + ar0 + 2.0f*(a + r);
+            g0 = a + 2.0f*r + ar0;
+
+            /* Mix them together... */
+
+            term = ((vx*this_dir[0] + vy*this_dir[1] + vz*this_dir[2])*F +
+                    (vx*pos[0] + vy*pos[1] + vz*pos[2])*(g0*(rdx*this_dir[0] + rdy*this_dir[1] + rdz*this_dir[2]) - gr*re))/(F*F);
+            /*
+             * There is a problem on the negative 'z' axis if the dipole location
+             * and the field point are on the same line
+             */
+            sum += (a > 0.0f && (ar/(a*r) + 1.0f).abs() > CEPS).select(this_coil->w[j]*term,0.0f);
+        }
+        Bval.row(k) = (rd_norm > EPS).select(static_cast<float>(MAG_FACTOR)*sum,0.0f).matrix().transpose();
+    }
+    return OK;          /* Happy conclusion: this works always */
+}
+
+//=============================================================================================================
+
 int FwdBemModel::fwd_sphere_field_vec(const Eigen::Vector3f& rd, FwdCoilSet &coils, Eigen::Ref<Eigen::MatrixXf> Bval, void *client)	/* Client data will be the sphere model origin */
 {
     /* This version uses Jukka Sarvas' field computation
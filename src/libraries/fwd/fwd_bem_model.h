@@ -152,7 +152,7 @@ public:
     /**
      * @brief Release the potential solution matrix and associated workspace.
      *
-     * Resets solution, v0, sol_name, nsol, and bem_method to their
+     * Resets solution, v0, v0_batch, sol_name, nsol, and bem_method to their
      * default (empty / unknown) state.
      */
     void fwd_bem_free_solution();
@@ -240,6 +240,18 @@ public:
      */
     int fwd_bem_load_solution(const QString& name, int bem_method);
 
+    //=========================================================================================================
+    /**
+     * @brief Write the BEM solution of this model to a FIFF file.
+     *
+     * The file holds the method and the solution matrix as read by fwd_bem_load_solution.
+     * It replaces an existing file only once it has been written completely.
+     *
+     * @param[in] name  Path to the solution FIFF file.
+     * @return OK on success, FAIL on error.
+     */
+    int fwd_bem_write_solution(const QString& name) const;
+
     //=========================================================================================================
     /**
      * @brief Set the Head-to-MRI coordinate transform for this BEM model.
@@ -338,10 +350,12 @@ public:
     /**
      * @brief Compute the multi-surface BEM solution from solid-angle coefficients.
      *
-     * Applies the deflation technique and LU decomposition to produce
-     * the final BEM solution matrix for a multi-compartment model.
+     * Applies the deflation technique and a blocked LU decomposition with
+     * partial pivoting to produce the final BEM solution matrix for a
+     * multi-compartment model. The factorization and the solution for the
+     * columns of the inverse run on all cores.
      *
-     * @param[in] solids  Solid-angle coefficient matrix.
+     * @param[in] solids  Solid-angle coefficient matrix (overwritten by its LU factors).
      * @param[in] gamma   Conductivity-ratio coupling matrix (nullptr for homogeneous).
      * @param[in] nsurf   Number of surfaces.
      * @param[in] ntri    Triangle or node count per surface.
@@ -439,6 +453,50 @@ public:
                                         int bem_method,
                                         int force_recompute);
 
+    //=========================================================================================================
+    /**
+     * @brief Compute the BEM solution matrix, reusing a cached one if available.
+     *
+     * The cache holds the solutions computed earlier for the same surfaces, conductivities
+     * and method (see fwd_bem_solution_hash). A newly computed solution is added to the cache.
+     *
+     * @param[in] bem_method  BEM method (FWD_BEM_CONSTANT_COLL or FWD_BEM_LINEAR_COLL).
+     * @return OK on success, FAIL on error.
+     */
+    int fwd_bem_compute_cached_solution(int bem_method);
+
+    //=========================================================================================================
+    /**
+     * @brief Hash of everything the BEM solution matrix depends on.
+     *
+     * Covers the surface vertices and triangles, the conductivities, the method and
+     * the isolated-problem approach limit. Used as the file name in the solution cache.
+     *
+     * @param[in] bem_method  BEM method (FWD_BEM_CONSTANT_COLL or FWD_BEM_LINEAR_COLL).
+     * @return The hash as a hexadecimal string.
+     */
+    QString fwd_bem_solution_hash(int bem_method) const;
+
+    //=========================================================================================================
+    /**
+     * @brief Set the directory of the BEM solution cache.
+     *
+     * An empty string disables the cache. Without a call to this function the
+     * directory is taken from the MNE_BEM_SOL_CACHE environment variable or, if it is
+     * not set, is mne-cpp/bem-solutions in the user's cache location.
+     *
+     * @param[in] dir  The cache directory.
+     */
+    static void fwd_bem_set_solution_cache_dir(const QString& dir);
+
+    //=========================================================================================================
+    /**
+     * @brief Get the directory of the BEM solution cache.
+     *
+     * @return The cache directory, or an empty string if the cache is disabled.
+     */
+    static QString fwd_bem_solution_cache_dir();
+
     //============================= fwd_bem_pot.c =============================
 
     //=========================================================================================================
@@ -558,6 +616,38 @@ public:
                                FwdCoilSet& els, Eigen::Ref<Eigen::VectorXf> pot,
                                void *client);
 
+    //=========================================================================================================
+    /**
+     * @brief Compute the weighted infinite-medium potentials of a block of dipoles at the BEM nodes.
+     *
+     * The nodes are the triangle centers (constant collocation) or the vertices (linear collocation).
+     * The dipoles are processed together, so that the inner loop runs over dipoles with SIMD.
+     *
+     * @param[in]  rd      Dipole positions (one row per dipole, head coordinates).
+     * @param[in]  Q       Dipole orientations (one row per dipole).
+     * @param[out] V0t     Potentials (ndipole x nsol).
+     */
+    void fwd_bem_inf_pots_batch(const Eigen::MatrixX3f& rd, const Eigen::MatrixX3f& Q,
+                                Eigen::MatrixXf& V0t) const;
+
+    //=========================================================================================================
+    /**
+     * @brief Callback: compute BEM potentials at electrodes for a block of dipoles.
+     *
+     * Matches the fwdFieldBatchFunc signature. The electrode-specific solution is applied
+     * to all dipoles with one matrix-matrix product.
+     *
+     * @param[in]  rd      Dipole positions (one row per dipole).
+     * @param[in]  Q       Dipole orientations (one row per dipole).
+     * @param[in]  els     Electrode descriptors.
+     * @param[out] pot     Output potentials (nel x ndipole).
+     * @param[in]  client  Opaque pointer to the FwdBemModel instance.
+     * @return OK on success, FAIL on error.
+     */
+    static int fwd_bem_pot_els_batch(const Eigen::MatrixX3f& rd, const Eigen::MatrixX3f& Q,
+                                     FwdCoilSet& els, Eigen::Ref<Eigen::MatrixXf> pot,
+                                     void *client);
+
     //=========================================================================================================
     /**
      * @brief Callback: compute BEM potentials and position gradients at electrodes.
@@ -846,6 +936,24 @@ public:
                              FwdCoilSet& coils, Eigen::Ref<Eigen::VectorXf> B,
                              void *client);
 
+    //=========================================================================================================
+    /**
+     * @brief Callback: compute BEM magnetic fields at coils for a block of dipoles.
+     *
+     * Matches the fwdFieldBatchFunc signature. The coil-specific solution is applied
+     * to all dipoles with one matrix-matrix product.
+     *
+     * @param[in]  rd      Dipole positions (one row per dipole).
+     * @param[in]  Q       Dipole orientations (one row per dipole).
+     * @param[in]  coils   MEG coil descriptors.
+     * @param[out] B       Output magnetic fields (ncoil x ndipole).
+     * @param[in]  client  Opaque pointer to the FwdBemModel instance.
+     * @return OK on success, FAIL on error.
+     */
+    static int fwd_bem_field_batch(const Eigen::MatrixX3f& rd, const Eigen::MatrixX3f& Q,
+                                   FwdCoilSet& coils, Eigen::Ref<Eigen::MatrixXf> B,
+                                   void *client);
+
     //=========================================================================================================
     /**
      * @brief Callback: compute BEM magnetic fields and position gradients at coils.
@@ -880,6 +988,25 @@ public:
      */
     static void meg_eeg_fwd_one_source_space(FwdThreadArg* arg);
 
+    //=========================================================================================================
+    /**
+     * @brief Compute the forward solution in chunks of sources distributed dynamically over threads.
+     *
+     * The source spaces are split into chunks whose result columns fit the cache. Each thread takes
+     * the next unprocessed chunk when it is done with the previous one and writes directly into the
+     * column range of the chunk, so the result is identical for any number of threads.
+     *
+     * @param[in] spaces   Source spaces.
+     * @param[in] one_arg  Template work descriptor holding the result matrices and field functions.
+     * @param[in] meg      If true, duplicate one_arg for MEG, otherwise for EEG.
+     * @param[in] nthread  Number of threads.
+     * @return OK on success, FAIL on error.
+     */
+    static int compute_forward_chunked(std::vector<std::unique_ptr<MNELIB::MNESourceSpace>>& spaces,
+                                       FwdThreadArg& one_arg,
+                                       bool meg,
+                                       int nthread);
+
     //=========================================================================================================
     /**
      * @brief Compute the MEG forward solution for one or more source spaces.
@@ -890,10 +1017,11 @@ public:
      * @param[in]     comp_data   CTF compensation data (may be nullptr).
      * @param[in]     fixed_ori   If true, use fixed-orientation dipoles.
      * @param[in]     r0          Sphere model origin.
-     * @param[in]     use_threads If true, parallelize across source spaces.
+     * @param[in]     use_threads If true, parallelize over chunks of sources.
      * @param[out]    resp        Forward solution matrix.
      * @param[out]    resp_grad   Gradient forward solution matrix.
      * @param[in]     bDoGRad     If true, also compute the gradient solution.
+     * @param[in]     nthread     Number of threads (0 = QThread::idealThreadCount()).
      * @return OK on success, FAIL on error.
      */
     int compute_forward_meg(std::vector<std::unique_ptr<MNELIB::MNESourceSpace>>& spaces,
@@ -905,7 +1033,8 @@ public:
                             bool                        use_threads,
                             FIFFLIB::FiffNamedMatrix&   resp,
                             FIFFLIB::FiffNamedMatrix&   resp_grad,
-                            bool                        bDoGRad);
+                            bool                        bDoGRad,
+                            int                         nthread = 0);
 
     //=========================================================================================================
     /**
@@ -915,10 +1044,11 @@ public:
      * @param[in]     els         Electrode locations.
      * @param[in]     fixed_ori   If true, use fixed-orientation dipoles.
      * @param[in]     eeg_model   Sphere model definition.
-     * @param[in]     use_threads If true, parallelize across source spaces.
+     * @param[in]     use_threads If true, parallelize over chunks of sources.
      * @param[out]    resp        Forward solution matrix.
      * @param[out]    resp_grad   Gradient forward solution matrix.
      * @param[in]     bDoGrad     If true, also compute the gradient solution.
+     * @param[in]     nthread     Number of threads (0 = QThread::idealThreadCount()).
      * @return OK on success, FAIL on error.
      */
     int compute_forward_eeg(std::vector<std::unique_ptr<MNELIB::MNESourceSpace>>& spaces,
@@ -928,7 +1058,8 @@ public:
                             bool                        use_threads,
                             FIFFLIB::FiffNamedMatrix&   resp,
                             FIFFLIB::FiffNamedMatrix&   resp_grad,
-                            bool                        bDoGrad);
+                            bool                        bDoGrad,
+                            int                         nthread = 0);
 
     //============================= fwd_spherefield.c =============================
 
@@ -949,6 +1080,24 @@ public:
                                 FwdCoilSet& coils, Eigen::Ref<Eigen::VectorXf> Bval,
                                 void *client);
 
+    //=========================================================================================================
+    /**
+     * @brief Callback: compute the spherical-model magnetic field at coils for a block of dipoles.
+     *
+     * Matches the fwdFieldBatchFunc signature. Evaluates the same formula as fwd_sphere_field
+     * with the dipoles in the inner (SIMD) loop.
+     *
+     * @param[in]  rd      Dipole positions (one row per dipole).
+     * @param[in]  Q       Dipole components (one row per dipole).
+     * @param[in]  coils   MEG coil definitions.
+     * @param[out] Bval    Output magnetic fields (ncoil x ndipole).
+     * @param[in]  client  Opaque pointer to client data (sphere model origin).
+     * @return OK on success, FAIL on error.
+     */
+    static int fwd_sphere_field_batch(const Eigen::MatrixX3f& rd, const Eigen::MatrixX3f& Q,
+                                      FwdCoilSet& coils, Eigen::Ref<Eigen::MatrixXf> Bval,
+                                      void *client);
+
     //=========================================================================================================
     /**
      * @brief Callback: compute the spherical-model vector magnetic field at coils.
@@ -1039,6 +1188,7 @@ public:
 
     Eigen::MatrixXf solution;           /**< Potential solution matrix (nsol x nsol). */
     Eigen::VectorXf v0;                 /**< Workspace for infinite-medium potentials (length nsol). */
+    Eigen::MatrixXf v0_batch;           /**< Workspace for infinite-medium potentials of a dipole block (ndipole x nsol). */
     int             nsol;               /**< Dimension of the solution matrix. */
 
     FIFFLIB::FiffCoordTrans head_mri_t; /**< Head-to-MRI coordinate transform. */
@@ -66,6 +66,7 @@ FwdCompData::FwdCompData()
 ,field      (nullptr)
 ,vec_field  (nullptr)
 ,field_grad (nullptr)
+,field_batch(nullptr)
 ,client     (nullptr)
 ,set        (nullptr)
 {
@@ -201,6 +202,42 @@ FwdCompData *FwdCompData::fwd_make_comp_data(MNECTFCompDataSet *set,
 
 //=============================================================================================================
 
+int FwdCompData::fwd_comp_field_batch(const Eigen::MatrixX3f& rd, const Eigen::MatrixX3f& Q, FwdCoilSet &coils, Eigen::Ref<Eigen::MatrixXf> res, void *client)
+{
+    FwdCompData* comp = static_cast<FwdCompData*>(client);
+
+    if (!comp->field_batch) {
+        qWarning("Field computation function is missing in fwd_comp_field_batch");
+        return FAIL;
+    }
+    /*
+       * First compute the field in the primary set of coils
+       */
+    if (comp->field_batch(rd,Q,coils,res,comp->client) == FAIL)
+        return FAIL;
+    /*
+       * Compensation needed?
+       */
+    if (!comp->comp_coils || comp->comp_coils->ncoil() <= 0 || !comp->set || !comp->set->current)
+        return OK;
+    /*
+       * Compute the field in the compensation coils
+       */
+    Eigen::MatrixXf work(comp->comp_coils->ncoil(), rd.rows());
+    if (comp->field_batch(rd,Q,*comp->comp_coils,work,comp->client) == FAIL)
+        return FAIL;
+    /*
+       * Compute the compensated field of each dipole
+       */
+    for (int k = 0; k < rd.rows(); k++) {
+        if (comp->set->apply(true, res.col(k), work.col(k)) == FAIL)
+            return FAIL;
+    }
+    return OK;
+}
+
+//=============================================================================================================
+
 int FwdCompData::fwd_comp_field_vec(const Eigen::Vector3f& rd, FwdCoilSet &coils, Eigen::Ref<Eigen::MatrixXf> res, void *client)
 {
     FwdCompData* comp = static_cast<FwdCompData*>(client);
@@ -112,6 +112,20 @@ public:
      */
     static int fwd_comp_field(const Eigen::Vector3f& rd, const Eigen::Vector3f& Q, FwdCoilSet& coils, Eigen::Ref<Eigen::VectorXf> res, void *client);
 
+    //=========================================================================================================
+    /**
+     * Calculate the compensated fields for a block of dipoles.
+     *
+     * @param[in] rd       Dipole positions (one row per dipole).
+     * @param[in] Q        Dipole moment directions (one row per dipole).
+     * @param[in] coils    Coil definitions.
+     * @param[out] res     Result matrix (ncoil x ndipole).
+     * @param[in] client   Pointer to FwdCompData.
+     *
+     * @return OK on success, FAIL on error.
+     */
+    static int fwd_comp_field_batch(const Eigen::MatrixX3f& rd, const Eigen::MatrixX3f& Q, FwdCoilSet& coils, Eigen::Ref<Eigen::MatrixXf> res, void *client);
+
     //=========================================================================================================
     /**
      * Set up CTF compensation coils for field computations.
@@ -186,6 +200,7 @@ public:
     fwdFieldFunc        field;      /**< Computes the field of given direction dipole. */
     fwdVecFieldFunc     vec_field;  /**< Computes the fields of all three dipole components. */
     fwdFieldGradFunc    field_grad; /**< Computes the field and gradient of one dipole direction. */
+    fwdFieldBatchFunc   field_batch;/**< Computes the fields of a block of dipoles (optional). */
     void                *client;    /**< Client data to pass to the above functions. */
     Eigen::VectorXf     work;       /**< The work area. */
     Eigen::MatrixXf     vec_work;   /**< The vector work area (3 x ncoil). */
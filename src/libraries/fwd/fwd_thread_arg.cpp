@@ -64,9 +64,12 @@ FwdThreadArg::FwdThreadArg()
 ,field_pot     (nullptr)
 ,vec_field_pot (nullptr)
 ,field_pot_grad(nullptr)
+,field_pot_batch(nullptr)
 ,coils_els     (nullptr)
 ,client        (nullptr)
 ,s             (nullptr)
+,vert_from     (0)
+,vert_to       (-1)
 ,fixed_ori     (false)
 ,stat          (-1)
 ,comp          (-1)
@@ -93,6 +96,7 @@ FwdThreadArg::UPtr FwdThreadArg::create_eeg_multi_thread_duplicate(FwdThreadArg&
         auto bem = std::make_shared<FwdBemModel>();
         *bem = *static_cast<FwdBemModel*>(res->client);
         bem->v0.resize(0);
+        bem->v0_batch.resize(0,0);
         res->client = bem.get();
         res->client_free = [bem]() {};  /* shared_ptr releases FwdBemModel on destruction */
     }
@@ -126,6 +130,7 @@ FwdThreadArg::UPtr FwdThreadArg::create_meg_multi_thread_duplicate(FwdThreadArg&
         auto bem = std::make_shared<FwdBemModel>();
         *bem = *static_cast<FwdBemModel*>(comp->client);
         bem->v0.resize(0);
+        bem->v0_batch.resize(0,0);
         comp->client = bem.get();
         /* shared_ptrs release their objects when client_free is destroyed */
         res->client_free = [comp, set_guard, bem]() {
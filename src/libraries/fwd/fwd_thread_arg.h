@@ -131,9 +131,12 @@ public:
     fwdFieldFunc        field_pot;         /**< Computes the field or potential for one dipole orientation. */
     fwdVecFieldFunc     vec_field_pot;     /**< Computes the field or potential for all dipole orientations. */
     fwdFieldGradFunc    field_pot_grad;    /**< Computes the gradient of field or potential for one dipole orientation. */
+    fwdFieldBatchFunc   field_pot_batch;   /**< Computes the fields or potentials of a block of dipoles (optional). */
     FwdCoilSet          *coils_els;        /**< The coil definitions. */
     void                *client;           /**< Client data for the field computation function. */
     MNELIB::MNESourceSpace   *s;           /**< The source space to process. */
+    int                 vert_from;         /**< First vertex of the source space to process. */
+    int                 vert_to;           /**< One past the last vertex to process (-1 = up to the end). */
     bool                fixed_ori;         /**< Compute fixed orientation solution? */
     int                 comp;              /**< Which component to compute for free orientations. */
     int                 stat;              /**< Result status (OK or FAIL). */
@@ -57,5 +57,11 @@ using fwdVecFieldFunc = std::function<int(const Eigen::Vector3f& rd,
 using fwdFieldGradFunc = std::function<int(const Eigen::Vector3f& rd, const Eigen::Vector3f& Q,
                                            FWDLIB::FwdCoilSet& coils, Eigen::Ref<Eigen::VectorXf> res,
                                            Eigen::Ref<Eigen::VectorXf> xgrad, Eigen::Ref<Eigen::VectorXf> ygrad, Eigen::Ref<Eigen::VectorXf> zgrad, void *client)>;
+/*
+ * Field / potential computation for a block of dipoles: one row of rd and Q per dipole,
+ * one column of res (ncoil x ndipole) per dipole
+ */
+using fwdFieldBatchFunc = std::function<int(const Eigen::MatrixX3f& rd, const Eigen::MatrixX3f& Q,
+                                            FWDLIB::FwdCoilSet& coils, Eigen::Ref<Eigen::MatrixXf> res, void *client)>;
 
 #endif // FWD_TYPES_H
@@ -39,6 +39,8 @@
 #include "inv_beamformer_compute.h"
 
 #include <QDebug>
+#include <QVector>
+#include <QtConcurrent/QtConcurrent>
 
 //=============================================================================================================
 // EIGEN INCLUDES
@@ -64,6 +66,8 @@ using namespace INVLIB;
 
 namespace {
 
+constexpr int SOURCE_BLOCK_SIZE = 256;   // Sources per leadfield-covariance product and per parallel task
+
 /**
  * Invert a small symmetric positive-definite matrix using eigendecomposition.
  * Handles 1x1 (scalar) and 3x3 (free orientation) cases.
@@ -138,6 +142,16 @@ void InvBeamformerCompute::regPinv(const MatrixXd &C,
 
 void InvBeamformerCompute::reduceLeadfieldRank(MatrixXd &Gk)
 {
+    if(Gk.cols() == 3) {
+        // Gk = U S V^T, so dropping the smallest singular component is Gk (I - v v^T) with v the eigenvector
+        // of the smallest eigenvalue of Gk^T Gk, which the closed-form 3x3 solver provides directly
+        SelfAdjointEigenSolver<Matrix3d> eig;
+        eig.computeDirect(Matrix3d(Gk.transpose() * Gk));
+        const Vector3d v = eig.eigenvectors().col(0);
+        Gk -= (Gk * v) * v.transpose();
+        return;
+    }
+
     // SVD of per-source leadfield: Gk (n_channels, n_orient)
     JacobiSVD<MatrixXd> svd(Gk, ComputeThinU | ComputeThinV);
     MatrixXd U = svd.matrixU();
@@ -157,9 +171,19 @@ void InvBeamformerCompute::reduceLeadfieldRank(MatrixXd &Gk)
 MatrixXd InvBeamformerCompute::symMatPow(const MatrixXd &X, double p, bool reduceRank)
 {
     const int n = static_cast<int>(X.rows());
-    SelfAdjointEigenSolver<MatrixXd> eig(X);
-    VectorXd eigVals = eig.eigenvalues();
-    MatrixXd eigVecs = eig.eigenvectors();
+    VectorXd eigVals;
+    MatrixXd eigVecs;
+    if(n == 3) {
+        // Closed-form solver for the per-source matrices of free-orientation filters
+        SelfAdjointEigenSolver<Matrix3d> eig;
+        eig.computeDirect(Matrix3d(X));
+        eigVals = eig.eigenvalues();
+        eigVecs = eig.eigenvectors();
+    } else {
+        SelfAdjointEigenSolver<MatrixXd> eig(X);
+        eigVals = eig.eigenvalues();
+        eigVecs = eig.eigenvectors();
+    }
 
     // Find threshold
     double maxEig = eigVals.cwiseAbs().maxCoeff();
@@ -246,133 +270,153 @@ bool InvBeamformerCompute::computeBeamformer(const MatrixXd &G,
         maxPowerOri.resize(0, 3);
     }
 
-    for(int s = 0; s < nSources; ++s) {
-        // Extract per-source leadfield block: Gk (n_channels, n_orient)
-        MatrixXd Gk = G.middleCols(s * nOrient, nOrient);
+    // Sources are processed in blocks: one product Cm^{-1} G for all sources of a block replaces the
+    // per-source products with Cm^{-1}, and the blocks are computed in parallel. Every block writes its own
+    // rows of W and maxPowerOri.
+    auto computeBlock = [&](int iFirst) {
+        const int nBlock = std::min(SOURCE_BLOCK_SIZE, nSources - iFirst);
+
+        // Per-source leadfield blocks: Gb (n_channels, nBlock * n_orient)
+        MatrixXd Gb = G.middleCols(iFirst * nOrient, nBlock * nOrient);
 
         // Step 3: Optional rank reduction
         if(reduceRank && nOrient > 1) {
-            reduceLeadfieldRank(Gk);
-        }
-
-        // ------------------------------------------------------------------
-        // Step 4: Orientation selection
-        // ------------------------------------------------------------------
-        int orientForFilter = nOrient;
-
-        if(pickOri == BeamformerPickOri::MaxPower) {
-            // Compute optimal orientation via max eigenvalue criterion
-            // bf_numer = Gk^T Cm^{-1}   (n_orient, n_channels)
-            // bf_denom = Gk^T Cm^{-1} Gk (n_orient, n_orient)
-            MatrixXd bfNumer = Gk.transpose() * CmInv;               // (n_orient, n_ch)
-            MatrixXd bfDenom = bfNumer * Gk;                         // (n_orient, n_orient)
-
-            MatrixXd oriNumer, oriDenom;
-            if(weightNorm == BeamformerWeightNorm::None) {
-                oriNumer = MatrixXd::Identity(nOrient, nOrient);
-                oriDenom = bfDenom;
-            } else {
-                // Sekihara & Nagarajan 2008, eq. 4.47
-                oriNumer = bfDenom;
-                oriDenom = Gk.transpose() * (CmInv * CmInv) * Gk;   // (n_orient, n_orient)
+            for(int b = 0; b < nBlock; ++b) {
+                MatrixXd Gk = Gb.middleCols(b * nOrient, nOrient);
+                reduceLeadfieldRank(Gk);
+                Gb.middleCols(b * nOrient, nOrient) = Gk;
             }
+        }
 
-            // Compute oriDenom^{-1} @ oriNumer
-            MatrixXd oriDenomInv = invertSmallSym(oriDenom, reduceRank);
-            MatrixXd oriPick = oriDenomInv * oriNumer;
-
-            // Pick eigenvector with maximum absolute eigenvalue
-            // Note: oriPick is NOT necessarily symmetric -> use general eigensolver
-            EigenSolver<MatrixXd> eigSolve(oriPick);
-            VectorXcd eigVals = eigSolve.eigenvalues();
-            MatrixXcd eigVecs = eigSolve.eigenvectors();
-
-            int maxIdx = 0;
-            double maxVal = 0.0;
-            for(int i = 0; i < eigVals.size(); ++i) {
-                double absVal = std::abs(eigVals(i));
-                if(absVal > maxVal) {
-                    maxVal = absVal;
-                    maxIdx = i;
+        // Cm^{-1} G of all sources of the block; Cm^{-1} is symmetric, so G^T Cm^{-1} = (Cm^{-1} G)^T
+        const MatrixXd CiGb = CmInv * Gb;   // (n_channels, nBlock * n_orient)
+
+        for(int b = 0; b < nBlock; ++b) {
+            const int s = iFirst + b;
+            MatrixXd Gk = Gb.middleCols(b * nOrient, nOrient);
+            MatrixXd CiGk = CiGb.middleCols(b * nOrient, nOrient);
+
+            // ------------------------------------------------------------------
+            // Step 4: Orientation selection
+            // ------------------------------------------------------------------
+            if(pickOri == BeamformerPickOri::MaxPower) {
+                // Compute optimal orientation via max eigenvalue criterion
+                // bf_denom = Gk^T Cm^{-1} Gk (n_orient, n_orient)
+                MatrixXd bfDenom = Gk.transpose() * CiGk;
+
+                MatrixXd oriNumer, oriDenom;
+                if(weightNorm == BeamformerWeightNorm::None) {
+                    oriNumer = MatrixXd::Identity(nOrient, nOrient);
+                    oriDenom = bfDenom;
+                } else {
+                    // Sekihara & Nagarajan 2008, eq. 4.47
+                    oriNumer = bfDenom;
+                    oriDenom = CiGk.transpose() * CiGk;   // Gk^T Cm^{-1} Cm^{-1} Gk (n_orient, n_orient)
                 }
-            }
 
-            // Optimal orientation (real part)
-            Vector3d ori = eigVecs.col(maxIdx).real().head(3).normalized();
+                // Compute oriDenom^{-1} @ oriNumer
+                MatrixXd oriDenomInv = invertSmallSym(oriDenom, reduceRank);
+                MatrixXd oriPick = oriDenomInv * oriNumer;
+
+                // Pick eigenvector with maximum absolute eigenvalue
+                // Note: oriPick is NOT necessarily symmetric -> use general eigensolver
+                EigenSolver<MatrixXd> eigSolve(oriPick);
+                VectorXcd eigVals = eigSolve.eigenvalues();
+                MatrixXcd eigVecs = eigSolve.eigenvectors();
+
+                int maxIdx = 0;
+                double maxVal = 0.0;
+                for(int i = 0; i < eigVals.size(); ++i) {
+                    double absVal = std::abs(eigVals(i));
+                    if(absVal > maxVal) {
+                        maxVal = absVal;
+                        maxIdx = i;
+                    }
+                }
 
-            // Align sign with surface normal
-            if(nn.rows() > s) {
-                double dot = ori.dot(nn.row(s).transpose());
-                if(dot < 0.0) ori = -ori;
-            }
+                // Optimal orientation (real part)
+                Vector3d ori = eigVecs.col(maxIdx).real().head(3).normalized();
 
-            maxPowerOri.row(s) = ori.transpose();
+                // Align sign with surface normal
+                if(nn.rows() > s) {
+                    double dot = ori.dot(nn.row(s).transpose());
+                    if(dot < 0.0) ori = -ori;
+                }
 
-            // Project leadfield to optimal orientation
-            Gk = Gk * ori;  // (n_channels, 1)
-            orientForFilter = 1;
+                maxPowerOri.row(s) = ori.transpose();
 
-        } else if(pickOri == BeamformerPickOri::Normal && nOrient >= 3) {
-            // Extract Z-component (normal to surface in local source coords)
-            Gk = Gk.col(2);  // (n_channels, 1)
-            orientForFilter = 1;
-        }
+                // Project leadfield to optimal orientation
+                Gk = (Gk * ori).eval();        // (n_channels, 1)
+                CiGk = (CiGk * ori).eval();
 
-        // ------------------------------------------------------------------
-        // Step 5: Compute unit-gain filter
-        //   bf_numer = Gk^T Cm^{-1}          (n_ori_filt, n_channels)
-        //   bf_denom = Gk^T Cm^{-1} Gk       (n_ori_filt, n_ori_filt)
-        //   W_ug     = bf_denom^{-1} bf_numer (n_ori_filt, n_channels)
-        // ------------------------------------------------------------------
-        MatrixXd bfNumer = Gk.transpose() * CmInv;    // (orientForFilter, n_ch)
-        MatrixXd bfDenom = bfNumer * Gk;               // (orientForFilter, orientForFilter)
-
-        MatrixXd bfDenomInv;
-        if(invMethod == BeamformerInversion::Single && orientForFilter > 1) {
-            // Scalar inversion of diagonal elements
-            bfDenomInv = MatrixXd::Zero(orientForFilter, orientForFilter);
-            for(int d = 0; d < orientForFilter; ++d) {
-                double val = bfDenom(d, d);
-                bfDenomInv(d, d) = (std::abs(val) > 1e-30) ? 1.0 / val : 0.0;
+            } else if(pickOri == BeamformerPickOri::Normal && nOrient >= 3) {
+                // Extract Z-component (normal to surface in local source coords)
+                Gk = Gk.col(2).eval();          // (n_channels, 1)
+                CiGk = CiGk.col(2).eval();
             }
-        } else {
-            bfDenomInv = invertSmallSym(bfDenom, reduceRank);
-        }
-
-        MatrixXd Wug = bfDenomInv * bfNumer;  // (orientForFilter, n_channels)
 
-        // ------------------------------------------------------------------
-        // Step 6: Weight normalization
-        // ------------------------------------------------------------------
-        if(weightNorm == BeamformerWeightNorm::UnitNoiseGain || weightNorm == BeamformerWeightNorm::NAI) {
-            // Sekihara 2008: normalize by sqrt(diag(W W^T))
-            MatrixXd noiseNorm = Wug * Wug.transpose();   // (orientForFilter, orientForFilter)
-
-            for(int d = 0; d < orientForFilter; ++d) {
-                double normVal = std::sqrt(std::abs(noiseNorm(d, d)));
-                if(normVal > 1e-30) {
-                    Wug.row(d) /= normVal;
+            const int orientForFilter = static_cast<int>(Gk.cols());
+
+            // ------------------------------------------------------------------
+            // Step 5: Compute unit-gain filter
+            //   bf_numer = Gk^T Cm^{-1}          (n_ori_filt, n_channels)
+            //   bf_denom = Gk^T Cm^{-1} Gk       (n_ori_filt, n_ori_filt)
+            //   W_ug     = bf_denom^{-1} bf_numer (n_ori_filt, n_channels)
+            // ------------------------------------------------------------------
+            MatrixXd bfNumer = CiGk.transpose();           // (orientForFilter, n_ch)
+            MatrixXd bfDenom = Gk.transpose() * CiGk;      // (orientForFilter, orientForFilter)
+
+            MatrixXd bfDenomInv;
+            if(invMethod == BeamformerInversion::Single && orientForFilter > 1) {
+                // Scalar inversion of diagonal elements
+                bfDenomInv = MatrixXd::Zero(orientForFilter, orientForFilter);
+                for(int d = 0; d < orientForFilter; ++d) {
+                    double val = bfDenom(d, d);
+                    bfDenomInv(d, d) = (std::abs(val) > 1e-30) ? 1.0 / val : 0.0;
                 }
+            } else {
+                bfDenomInv = invertSmallSym(bfDenom, reduceRank);
             }
 
-            if(weightNorm == BeamformerWeightNorm::NAI) {
-                // Additional normalization by noise level
-                double noise = loadingFactor;
-                if(noise > 1e-30) {
-                    Wug /= std::sqrt(noise);
+            MatrixXd Wug = bfDenomInv * bfNumer;  // (orientForFilter, n_channels)
+
+            // ------------------------------------------------------------------
+            // Step 6: Weight normalization
+            // ------------------------------------------------------------------
+            if(weightNorm == BeamformerWeightNorm::UnitNoiseGain || weightNorm == BeamformerWeightNorm::NAI) {
+                // Sekihara 2008: normalize by sqrt(diag(W W^T))
+                for(int d = 0; d < orientForFilter; ++d) {
+                    double normVal = Wug.row(d).norm();
+                    if(normVal > 1e-30) {
+                        Wug.row(d) /= normVal;
+                    }
+                }
+
+                if(weightNorm == BeamformerWeightNorm::NAI) {
+                    // Additional normalization by noise level
+                    double noise = loadingFactor;
+                    if(noise > 1e-30) {
+                        Wug /= std::sqrt(noise);
+                    }
                 }
+
+            } else if(weightNorm == BeamformerWeightNorm::UnitNoiseGainInv) {
+                // Rotation-invariant version: sqrtm(inner)^{-0.5} @ G^T Cm^{-1}
+                MatrixXd inner = CiGk.transpose() * CiGk;   // (orientForFilter, orientForFilter)
+                MatrixXd innerPow = symMatPow(inner, -0.5, reduceRank);
+                Wug = innerPow * bfNumer;
             }
 
-        } else if(weightNorm == BeamformerWeightNorm::UnitNoiseGainInv) {
-            // Rotation-invariant version: sqrtm(inner)^{-0.5} @ G^T Cm^{-1}
-            MatrixXd inner = bfNumer * bfNumer.transpose();   // (orientForFilter, orientForFilter)
-            MatrixXd innerPow = symMatPow(inner, -0.5, reduceRank);
-            Wug = innerPow * bfNumer;
+            // Store result
+            W.middleRows(s * nOrientOut, nOrientOut) = Wug;
         }
+    };
 
-        // Store result
-        W.middleRows(s * nOrientOut, nOrientOut) = Wug;
+    QVector<int> vecBlocks;
+    for(int s = 0; s < nSources; s += SOURCE_BLOCK_SIZE) {
+        vecBlocks.append(s);
     }
+    QtConcurrent::blockingMap(vecBlocks, computeBlock);
 
     return true;
 }
@@ -386,13 +430,12 @@ VectorXd InvBeamformerCompute::computePower(const MatrixXd &Cm,
     const int nTotal = static_cast<int>(W.rows());
     const int nSources = nTotal / nOrient;
 
+    // power_i = sum over the rows r of W_i of (W Cm)_r . W_r, with W Cm computed for all sources at once
+    const VectorXd rowPower = (W * Cm).cwiseProduct(W).rowwise().sum();
+
     VectorXd power(nSources);
     for(int s = 0; s < nSources; ++s) {
-        // W_k: (n_orient, n_channels)
-        MatrixXd Wk = W.middleRows(s * nOrient, nOrient);
-        // power = trace(W_k Cm W_k^T)
-        MatrixXd WCW = Wk * Cm * Wk.transpose();
-        power(s) = WCW.trace();
+        power(s) = rowPower.segment(s * nOrient, nOrient).sum();
     }
 
     return power;
@@ -88,6 +88,9 @@ public:
      *   5. Invert denominator G^T Cm^{-1} G
      *   6. Apply weight normalization
      *
+     * Sources are processed in blocks in parallel. Cm^{-1} G is formed with one matrix product per block,
+     * and the per-source 3x3 eigendecompositions use the closed-form solver.
+     *
      * @param[in] G             Leadfield matrix (n_channels, n_sources * n_orient).
      * @param[in] Cm            Data covariance or CSD matrix (n_channels, n_channels). Real-valued.
      * @param[in] reg           Regularization parameter (fraction of trace to add, e.g. 0.05).
@@ -167,7 +170,8 @@ private:
      * Reduce the rank of a per-source leadfield block by removing the smallest singular component.
      *
      * Used for rank-deficient forward models (e.g., MEG spherical models where the radial
-     * component carries no information).
+     * component carries no information). For three orientations the component is found from the
+     * eigendecomposition of Gk^T Gk with the closed-form 3x3 solver.
      *
      * @param[in,out] Gk   Leadfield block (n_channels, n_orient). Modified in place.
      */
@@ -44,6 +44,11 @@
 #include <fiff/fiff_info.h>
 
 #include <QDebug>
+#include <QVector>
+#include <QtConcurrent/QtConcurrent>
+
+#include <atomic>
+#include <numeric>
 
 //=============================================================================================================
 // EIGEN INCLUDES
@@ -133,12 +138,22 @@ InvBeamformer InvDICS::makeDICS(const FiffInfo &info,
     // Compute filter for each frequency
     // -----------------------------------------------------------------------
     for(int fi = 0; fi < nFreqs; ++fi) {
-        MatrixXd Cm = csdMatrices[fi];
-
-        if(Cm.rows() != nChannels || Cm.cols() != nChannels) {
+        if(csdMatrices[fi].rows() != nChannels || csdMatrices[fi].cols() != nChannels) {
             qWarning("InvDICS::makeDICS - CSD[%d] dimension mismatch!", fi);
             return InvBeamformer();
         }
+    }
+
+    // The frequencies are independent and are computed in parallel, each one in parallel across sources
+    std::vector<MatrixXd> weights(nFreqs);
+    MatrixX3d mpOriFirst;
+    std::atomic<int> iFailedFreq(nFreqs);
+
+    QVector<int> vecFreqIdx(nFreqs);
+    std::iota(vecFreqIdx.begin(), vecFreqIdx.end(), 0);
+
+    QtConcurrent::blockingMap(vecFreqIdx, [&](int fi) {
+        MatrixXd Cm = csdMatrices[fi];
 
         // Optional: take real part of CSD
         if(realFilter) {
@@ -152,26 +167,35 @@ InvBeamformer InvDICS::makeDICS(const FiffInfo &info,
         CmW = (CmW + CmW.transpose()) * 0.5;  // Ensure symmetry
 
         // Compute filter
-        MatrixXd W;
         MatrixX3d mpOri;
 
         bool ok = InvBeamformerCompute::computeBeamformer(
             Gw, CmW, reg, nOrient,
             weightNorm, pickOri, reduceRank, invMethod,
-            nn, W, mpOri);
+            nn, weights[fi], mpOri);
 
         if(!ok) {
-            qWarning("InvDICS::makeDICS - Filter computation failed at frequency %d (%.1f Hz)!",
-                     fi, frequencies(fi));
-            return InvBeamformer();
+            // Keep the lowest failed frequency for the report
+            int iFailed = iFailedFreq.load();
+            while(fi < iFailed && !iFailedFreq.compare_exchange_weak(iFailed, fi)) {}
+            return;
         }
 
-        result.weights.push_back(W);
-
         // Store max-power orientation from first frequency
         if(fi == 0 && pickOri == BeamformerPickOri::MaxPower) {
-            result.maxPowerOri = mpOri;
+            mpOriFirst = mpOri;
         }
+    });
+
+    if(iFailedFreq < nFreqs) {
+        qWarning("InvDICS::makeDICS - Filter computation failed at frequency %d (%.1f Hz)!",
+                 iFailedFreq.load(), frequencies(iFailedFreq.load()));
+        return InvBeamformer();
+    }
+
+    result.weights = std::move(weights);
+    if(pickOri == BeamformerPickOri::MaxPower) {
+        result.maxPowerOri = mpOriFirst;
     }
 
     // -----------------------------------------------------------------------
@@ -102,6 +102,7 @@ public:
     //=========================================================================================================
     /**
      * Compute DICS beamformer spatial filters for one or more frequencies.
+     * The frequencies are computed in parallel.
      *
      * @param[in] info          Measurement info.
      * @param[in] forward       Forward solution containing the leadfield.
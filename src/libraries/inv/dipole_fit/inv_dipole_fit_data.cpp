@@ -202,8 +202,11 @@ int InvDipoleFitData::setup_forward_model(InvDipoleFitData *d, MNECTFCompDataSet
                 return FAIL;
             qInfo("[done]");
 
+            comp->field_batch  = FwdBemModel::fwd_bem_field_batch;
+
             f->meg_field       = FwdCompData::fwd_comp_field;
             f->meg_vec_field   = nullptr;
+            f->meg_field_batch = FwdCompData::fwd_comp_field_batch;
             f->meg_client      = comp;
             f->meg_client_free = [](void* d) { delete static_cast<FwdCompData*>(d); };
         }
@@ -212,9 +215,10 @@ int InvDipoleFitData::setup_forward_model(InvDipoleFitData *d, MNECTFCompDataSet
             if (d->bem_model->fwd_bem_specify_els(d->eeg_els.get()) == FAIL)
                 return FAIL;
             qInfo("[done]");
-            f->eeg_pot     = FwdBemModel::fwd_bem_pot_els;
-            f->eeg_vec_pot = nullptr;
-            f->eeg_client  = d->bem_model.get();
+            f->eeg_pot       = FwdBemModel::fwd_bem_pot_els;
+            f->eeg_vec_pot   = nullptr;
+            f->eeg_pot_batch = FwdBemModel::fwd_bem_pot_els_batch;
+            f->eeg_client    = d->bem_model.get();
         }
     }
     if (d->neeg > 0 && !d->eeg_model) {
@@ -241,8 +245,11 @@ int InvDipoleFitData::setup_forward_model(InvDipoleFitData *d, MNECTFCompDataSet
                                   d->r0.data());
         if (!comp)
             return FAIL;
+        comp->field_batch  = FwdBemModel::fwd_sphere_field_batch;
+
         f->meg_field       = FwdCompData::fwd_comp_field;
         f->meg_vec_field   = FwdCompData::fwd_comp_field_vec;
+        f->meg_field_batch = FwdCompData::fwd_comp_field_batch;
         f->meg_client      = comp;
         f->meg_client_free = [](void* d) { delete static_cast<FwdCompData*>(d); };
     }
@@ -905,10 +912,37 @@ InvDipoleForward* dipole_forward(InvDipoleFitData* d,
                               float         **rd,
                               int           ndip,
                               InvDipoleForward* old)
+{
+    Eigen::MatrixX3f rds(ndip,3);
+    Eigen::MatrixXf  fields(d->nmeg + d->neeg, 3*ndip);
+    int              k;
+
+    for (k = 0; k < ndip; k++)
+        rds.row(k) = Eigen::Map<const Eigen::Vector3f>(rd[k]).transpose();
+    /*
+   * Calculate the field of three orthogonal dipoles at each location
+   */
+    if (InvDipoleFitData::compute_dipole_fields(*d,rds,true,fields) == FAIL) {
+        delete old;
+        return nullptr;
+    }
+    return InvDipoleFitData::dipole_forward_fields(d,rds,fields,old);
+}
+
+//=============================================================================================================
+
+/**
+ * @brief Set up the forward solution from whitened fields: column normalization and SVD.
+ */
+InvDipoleForward* InvDipoleFitData::dipole_forward_fields(InvDipoleFitData* d,
+                                                    const Eigen::MatrixX3f& rd,
+                                                    const Eigen::Ref<const Eigen::MatrixXf>& fields,
+                                                    InvDipoleForward* old)
 {
     InvDipoleForward* res;
     float         S[3];
     int           k,p;
+    int           ndip = static_cast<int>(rd.rows());
     /*
    * Allocate data if necessary
    */
@@ -929,21 +963,10 @@ InvDipoleForward* dipole_forward(InvDipoleFitData* d,
         res->nch  = nch;
         res->ndip = ndip;
     }
+    res->rd  = rd;
+    res->fwd = fields.transpose();
 
     for (k = 0; k < ndip; k++) {
-        res->rd.row(k) = Eigen::Map<const Eigen::Vector3f>(rd[k]).transpose();
-        /*
-     * Calculate the field of three orthogonal dipoles
-     */
-        Eigen::MatrixXf this_fwd(d->nmeg + d->neeg, 3);
-        Eigen::Map<const Eigen::Vector3f> rd_k(rd[k]);
-        if ((InvDipoleFitData::compute_dipole_field(*d,rd_k,true,this_fwd)) == FAIL) {
-            if (!old)
-                delete res;
-            return nullptr;
-        }
-        for (int p = 0; p < 3; p++)
-            res->fwd.row(3*k+p) = this_fwd.col(p).transpose();
         /*
      * Choice of column normalization
      * (componentwise normalization is not recommended)
@@ -1299,16 +1322,24 @@ bool InvDipoleFitData::fit_one(InvDipoleFitData* fit,
  * The output matrix fwd is nch x 3, with columns corresponding to X, Y, Z orientations.
  */
 int InvDipoleFitData::compute_dipole_field(InvDipoleFitData& d, const Eigen::Vector3f& rd, int whiten, Eigen::Ref<Eigen::MatrixXf> fwd)
+{
+    return compute_dipole_fields(d,rd.transpose(),whiten,fwd);
+}
+
+//=============================================================================================================
+
+/**
+ * @brief Compute the MEG and/or EEG fields of three orthogonal dipoles at one location, one dipole at a time.
+ *
+ * No projection or whitening is applied.
+ */
+static int compute_location_field(InvDipoleFitData& d, const Eigen::Vector3f& rd, bool do_meg, bool do_eeg, Eigen::Ref<Eigen::MatrixXf> fwd)
 {
     static const Eigen::Vector3f Qx(1.0f, 0.0f, 0.0f);
     static const Eigen::Vector3f Qy(0.0f, 1.0f, 0.0f);
     static const Eigen::Vector3f Qz(0.0f, 0.0f, 1.0f);
-    int nch = d.nmeg + d.neeg;
-    int k;
-    /*
-   * Compute the fields
-   */
-    if (d.nmeg > 0) {
+
+    if (do_meg && d.nmeg > 0) {
         int nmeg = d.meg_coils->ncoil();
         if (d.funcs->meg_vec_field) {
             /*
@@ -1332,7 +1363,7 @@ int InvDipoleFitData::compute_dipole_field(InvDipoleFitData& d, const Eigen::Vec
         }
     }
 
-    if (d.neeg > 0) {
+    if (do_eeg && d.neeg > 0) {
         int neeg = d.eeg_els->ncoil();
         if (d.funcs->eeg_vec_pot) {
             /*
@@ -1355,11 +1386,51 @@ int InvDipoleFitData::compute_dipole_field(InvDipoleFitData& d, const Eigen::Vec
                 return FAIL;
         }
     }
+    return OK;
+}
+
+//=============================================================================================================
+
+/**
+ * @brief Compute the forward fields for a block of dipole locations, applying projection and whitening.
+ *
+ * The output matrix fwd is nch x 3*nlocation. A batched forward function sees all
+ * locations (three orthogonal dipoles each) in one call.
+ */
+int InvDipoleFitData::compute_dipole_fields(InvDipoleFitData& d, const Eigen::MatrixX3f& rd, int whiten, Eigen::Ref<Eigen::MatrixXf> fwd)
+{
+    int  nch  = d.nmeg + d.neeg;
+    int  nloc = static_cast<int>(rd.rows());
+    int  k;
+    bool meg_batch = d.nmeg > 0 && d.funcs->meg_field_batch;
+    bool eeg_batch = d.neeg > 0 && d.funcs->eeg_pot_batch;
+    /*
+   * Compute the fields
+   */
+    if (meg_batch || eeg_batch) {
+        Eigen::MatrixX3f rd3(3*nloc,3);
+        Eigen::MatrixX3f Q3(3*nloc,3);
+        for (k = 0; k < nloc; k++) {
+            rd3.middleRows(3*k,3) = rd.row(k).replicate(3,1);
+            Q3.middleRows(3*k,3).setIdentity();
+        }
+        if (meg_batch &&
+                d.funcs->meg_field_batch(rd3,Q3,*d.meg_coils,fwd.topRows(d.nmeg),d.funcs->meg_client) != OK)
+            return FAIL;
+        if (eeg_batch &&
+                d.funcs->eeg_pot_batch(rd3,Q3,*d.eeg_els,fwd.middleRows(d.nmeg,d.neeg),d.funcs->eeg_client) != OK)
+            return FAIL;
+    }
+    if ((d.nmeg > 0 && !meg_batch) || (d.neeg > 0 && !eeg_batch)) {
+        for (k = 0; k < nloc; k++)
+            if (compute_location_field(d,rd.row(k).transpose(),!meg_batch,!eeg_batch,fwd.middleCols(3*k,3)) == FAIL)
+                return FAIL;
+    }
 
     /*
    * Apply projection
    */
-    for (k = 0; k < 3; k++)
+    for (k = 0; k < 3*nloc; k++)
         if (d.proj && d.proj->project_vector(fwd.col(k),true) == FAIL)
             return FAIL;
 
@@ -1367,7 +1438,7 @@ int InvDipoleFitData::compute_dipole_field(InvDipoleFitData& d, const Eigen::Vec
    * Whiten
    */
     if (d.noise && whiten) {
-        for (k = 0; k < 3; k++) {
+        for (k = 0; k < 3*nloc; k++) {
             auto col_k = fwd.col(k);
             if (d.noise->whiten_vector(col_k,col_k,nch) == FAIL)
                 return FAIL;
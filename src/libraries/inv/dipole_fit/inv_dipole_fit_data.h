@@ -91,11 +91,13 @@ struct dipoleFitFuncsRec {
   }
   fwdFieldFunc    meg_field = nullptr;       /**< MEG forward calculation function. */
   fwdVecFieldFunc meg_vec_field = nullptr;   /**< MEG vectorized forward calculation function. */
+  fwdFieldBatchFunc meg_field_batch = nullptr; /**< MEG forward calculation for a block of dipoles (optional). */
   void            *meg_client = nullptr;     /**< Client data for MEG field computations. */
   MNELIB::mneUserFreeFunc meg_client_free = nullptr;  /**< Destructor for MEG client data. */
 
   fwdFieldFunc    eeg_pot = nullptr;         /**< EEG forward calculation function. */
   fwdVecFieldFunc eeg_vec_pot = nullptr;     /**< EEG vectorized forward calculation function. */
+  fwdFieldBatchFunc eeg_pot_batch = nullptr; /**< EEG forward calculation for a block of dipoles (optional). */
   void            *eeg_client = nullptr;     /**< Client data for EEG field computations. */
   MNELIB::mneUserFreeFunc eeg_client_free = nullptr;  /**< Destructor for EEG client data. */
 };
@@ -336,6 +338,23 @@ public:
      */
     static int compute_dipole_field(InvDipoleFitData& d, const Eigen::Vector3f& rd, int whiten, Eigen::Ref<Eigen::MatrixXf> fwd);
 
+    //=========================================================================================================
+    /**
+     * @brief Compute the forward fields for a block of dipole locations.
+     *
+     * Uses the batched forward functions when the model provides them and
+     * falls back to one location at a time otherwise.
+     *
+     * @param[in]     d        Dipole fit workspace.
+     * @param[in]     rd       Dipole positions in head coordinates (m), one row per location.
+     * @param[in]     whiten   If non-zero, whiten the result using the noise covariance.
+     * @param[in,out] fwd      Forward field matrix (nchan x 3*nlocation), X, Y, Z orientations
+     *                         of each location in consecutive columns, filled on output.
+     *
+     * @return OK on success, FAIL on error.
+     */
+    static int compute_dipole_fields(InvDipoleFitData& d, const Eigen::MatrixX3f& rd, int whiten, Eigen::Ref<Eigen::MatrixXf> fwd);
+
     //=========================================================================================================
     /**
      * @brief Compute the forward solution for a single dipole position.
@@ -356,6 +375,25 @@ public:
                                      const Eigen::Vector3f& rd,
                                      InvDipoleForward* old);
 
+    //=========================================================================================================
+    /**
+     * @brief Set up the forward solution from precomputed whitened fields.
+     *
+     * Applies the column normalization and computes the SVD, as dipole_forward_one
+     * does after the field computation.
+     *
+     * @param[in]     d        Dipole fit workspace.
+     * @param[in]     rd       Dipole positions in head coordinates (m), one row per dipole.
+     * @param[in]     fields   Whitened forward fields (nchan x 3*ndip), see compute_dipole_fields.
+     * @param[in,out] old      Existing forward to recycle (may be nullptr).
+     *
+     * @return The populated forward object, or nullptr on error.
+     */
+    static InvDipoleForward* dipole_forward_fields(InvDipoleFitData* d,
+                                        const Eigen::MatrixX3f& rd,
+                                        const Eigen::Ref<const Eigen::MatrixXf>& fields,
+                                        InvDipoleForward* old);
+
 public:
       std::unique_ptr<FIFFLIB::FiffCoordTrans>    mri_head_t; /**< MRI <-> head coordinate transformation. */
       std::unique_ptr<FIFFLIB::FiffCoordTrans>    meg_head_t; /**< MEG <-> head coordinate transformation. */
@@ -47,6 +47,7 @@
 #include <fiff/fiff_stream.h>
 #include <fiff/fiff_tag.h>
 
+#include <algorithm>
 #include <memory>
 #include <QFile>
 
@@ -63,6 +64,8 @@ using namespace INVLIB;
 constexpr int FAIL = -1;
 constexpr int OK   =  0;
 
+constexpr int GUESS_BLOCK_SIZE = 32;    /* Guess locations per batched field computation */
+
 #define X_16 0
 #define Y_16 1
 #define Z_16 2
@@ -190,14 +193,9 @@ InvGuessData::InvGuessData(const QString &guessname, const QString &guess_surfna
     else
         f->funcs = f->sphere_funcs.get();
 
-    for (k = 0; k < this->nguess; k++) {
-        this->guess_fwd[k].reset(InvDipoleFitData::dipole_forward_one(f,Eigen::Vector3f(this->rr.row(k).transpose()),nullptr));
-        if (!this->guess_fwd[k])
-            goto bad;
-#ifdef DEBUG
-        sing = this->guess_fwd[k]->sing;
-        printf("%f %f %f\n",sing[0],sing[1],sing[2]);
-#endif
+    if (!compute_guess_forwards(f)) {
+        f->funcs = orig;
+        goto bad;
     }
     f->funcs = orig;
 
@@ -330,20 +328,42 @@ bool InvGuessData::compute_guess_fields(InvDipoleFitData* f)
         f->funcs = f->mag_dipole_funcs.get();
     else
         f->funcs = f->sphere_funcs.get();
-    for (int k = 0; k < this->nguess; k++) {
-        this->guess_fwd[k].reset(InvDipoleFitData::dipole_forward_one(f,Eigen::Vector3f(this->rr.row(k).transpose()),this->guess_fwd[k].release()));
-        if (!this->guess_fwd[k]) {
-            if (orig)
-                f->funcs = orig;
-            return false;
-        }
-#ifdef DEBUG
-        sing = this->guess_fwd[k]->sing;
-        printf("%f %f %f\n",sing[0],sing[1],sing[2]);
-#endif
+    if (!compute_guess_forwards(f)) {
+        if (orig)
+            f->funcs = orig;
+        return false;
     }
     f->funcs = orig;
     printf("[done %d sources]\n",this->nguess);
 
     return true;
 }
+
+//=============================================================================================================
+
+bool InvGuessData::compute_guess_forwards(InvDipoleFitData* f)
+{
+    int             nch = f->nmeg + f->neeg;
+    Eigen::MatrixXf fields(nch, 3*GUESS_BLOCK_SIZE);
+    /*
+     * The fields of a block of guesses are computed together,
+     * the normalization and the SVD are done one guess at a time
+     */
+    for (int k = 0; k < this->nguess; k += GUESS_BLOCK_SIZE) {
+        int              nblock = std::min(GUESS_BLOCK_SIZE, this->nguess - k);
+        Eigen::MatrixX3f rd     = this->rr.middleRows(k,nblock);
+
+        if (InvDipoleFitData::compute_dipole_fields(*f,rd,true,fields.leftCols(3*nblock)) == FAIL)
+            return false;
+        for (int p = 0; p < nblock; p++) {
+            this->guess_fwd[k+p].reset(InvDipoleFitData::dipole_forward_fields(f,rd.middleRows(p,1),fields.middleCols(3*p,3),this->guess_fwd[k+p].release()));
+            if (!this->guess_fwd[k+p])
+                return false;
+#ifdef DEBUG
+            Eigen::VectorXf sing = this->guess_fwd[k+p]->sing;
+            printf("%f %f %f\n",sing[0],sing[1],sing[2]);
+#endif
+        }
+    }
+    return true;
+}
@@ -132,6 +132,18 @@ public:
      */
     bool compute_guess_fields(InvDipoleFitData* f);
 
+private:
+    //=========================================================================================================
+    /**
+     * Compute the forward solutions of all guesses with the current forward functions of f,
+     * with the fields of a block of guesses computed in one call.
+     *
+     * @param[in] f      Dipole Fit Data with the forward functions to use.
+     *
+     * @return true when successful.
+     */
+    bool compute_guess_forwards(InvDipoleFitData* f);
+
 public:
     Eigen::Matrix<float, Eigen::Dynamic, 3, Eigen::RowMajor> rr; /**< Guess dipole locations (nguess x 3, row-major). */
     std::vector<InvDipoleForward::UPtr> guess_fwd; /**< Forward solutions for the guesses. */
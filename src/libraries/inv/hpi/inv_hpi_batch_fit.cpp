@@ -0,0 +1,385 @@
+//=============================================================================================================
+/**
+ * @file     inv_hpi_batch_fit.cpp
+ * @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>
+ * @since    2.0.0
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, Christoph Dinh. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    InvHpiBatchFit class definition.
+ *
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "inv_hpi_batch_fit.h"
+#include "inv_hpi_data_updater.h"
+#include "inv_hpi_model_parameters.h"
+
+#include <fiff/fiff_raw_data.h>
+#include <fiff/fiff_info.h>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrent>
+#include <QDebug>
+
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <numeric>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace INVLIB;
+using namespace FIFFLIB;
+using namespace Eigen;
+
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+InvHpiBatchFit::InvHpiBatchFit(const QString& sFileName,
+                               const QVector<int>& vecHpiFreqs)
+    : m_sFileName(sFileName),
+      m_vecHpiFreqs(vecHpiFreqs),
+      m_dWindow(0.2),
+      m_dStep(0.2),
+      m_dMaxError(0.005),
+      m_iThreads(0),
+      m_dipoleSolver(HpiDipoleSolver::LevenbergMarquardt),
+      m_dSFreq(0.0),
+      m_dLineFreq(0.0),
+      m_iWindowSamples(0),
+      m_iStepSamples(0)
+{
+}
+
+//=============================================================================================================
+
+void InvHpiBatchFit::setWindowLength(double dWindow)
+{
+    m_dWindow = dWindow;
+}
+
+//=============================================================================================================
+
+void InvHpiBatchFit::setStep(double dStep)
+{
+    m_dStep = dStep;
+}
+
+//=============================================================================================================
+
+void InvHpiBatchFit::setMaxError(double dMaxError)
+{
+    m_dMaxError = dMaxError;
+}
+
+//=============================================================================================================
+
+void InvHpiBatchFit::setNumThreads(int iThreads)
+{
+    m_iThreads = iThreads;
+}
+
+//=============================================================================================================
+
+void InvHpiBatchFit::setDipoleSolver(HpiDipoleSolver solver)
+{
+    m_dipoleSolver = solver;
+}
+
+//=============================================================================================================
+
+bool InvHpiBatchFit::run()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    m_vecWindows.clear();
+    m_stats = HpiBatchStats();
+
+    QFile file(m_sFileName);
+    FiffRawData raw(file);
+    if(raw.isEmpty()) {
+        qWarning() << "[InvHpiBatchFit::run] Cannot read raw data from" << m_sFileName;
+        return false;
+    }
+    if(m_vecHpiFreqs.isEmpty()) {
+        qWarning() << "[InvHpiBatchFit::run] No HPI frequencies given.";
+        return false;
+    }
+
+    m_dSFreq = raw.info.sfreq;
+    m_dLineFreq = raw.info.linefreq;
+    m_iWindowSamples = std::max<fiff_int_t>(1, std::lround(m_dWindow * m_dSFreq));
+    m_iStepSamples = std::max<fiff_int_t>(1, std::lround(m_dStep * m_dSFreq));
+
+    // SSP projectors with the bad channels removed, as for the online fit
+    FiffInfo infoProj = raw.info;
+    for(int i = 0; i < infoProj.projs.size(); ++i) {
+        infoProj.projs[i].active = true;
+    }
+    MatrixXd matProjectors = MatrixXd::Identity(infoProj.chs.size(), infoProj.chs.size());
+    infoProj.make_projector(matProjectors);
+    for(int j = 0; j < infoProj.bads.size(); ++j) {
+        const int iBad = infoProj.ch_names.indexOf(infoProj.bads.at(j));
+        if(iBad >= 0) {
+            matProjectors.col(iBad).setZero();
+        }
+    }
+
+    // The first fit orders the frequencies to the digitized coils and seeds every part
+    QSharedPointer<FiffInfo> pInfo = QSharedPointer<FiffInfo>(new FiffInfo(raw.info));
+    InvHpiDataUpdater hpiDataUpdater(pInfo);
+    if(hpiDataUpdater.getHpiDigitizer().rows() != m_vecHpiFreqs.size()) {
+        qWarning() << "[InvHpiBatchFit::run] The number of HPI frequencies does not match the digitized coils.";
+        return false;
+    }
+
+    InvHpiFit hpiFit(hpiDataUpdater.getSensors());
+    hpiFit.setDipoleSolver(m_dipoleSolver);
+
+    MatrixXd matData, matTimes;
+    if(!raw.read_raw_segment(matData, matTimes, raw.first_samp,
+                             std::min(raw.first_samp + m_iWindowSamples - 1, raw.last_samp))) {
+        qWarning() << "[InvHpiBatchFit::run] Cannot read the first window.";
+        return false;
+    }
+
+    HpiFitResult initialFit;
+    hpiDataUpdater.prepareDataAndProjectors(matData, matProjectors);
+    hpiFit.fit(hpiDataUpdater.getProjectedData(),
+               hpiDataUpdater.getProjectors(),
+               InvHpiModelParameters(m_vecHpiFreqs, m_dSFreq, m_dLineFreq, false),
+               hpiDataUpdater.getHpiDigitizer(),
+               true,
+               initialFit);
+    m_vecHpiFreqs = initialFit.hpiFreqs;
+
+    const int iNumWindows = (raw.last_samp - raw.first_samp) / m_iStepSamples + 1;
+    m_vecWindows.resize(iNumWindows);
+    for(int k = 0; k < iNumWindows; ++k) {
+        m_vecWindows[k].first = raw.first_samp + k * m_iStepSamples;
+        m_vecWindows[k].fTime = static_cast<float>(m_vecWindows[k].first / m_dSFreq);
+    }
+
+    // Contiguous parts, one per thread, so that every fit but the first of a part is warm-started
+    const int iThreads = std::max(1, m_iThreads > 0 ? m_iThreads : QThreadPool::globalInstance()->maxThreadCount());
+    const int iPartSize = (iNumWindows + iThreads - 1) / iThreads;
+    QVector<QPair<int,int> > vecParts;
+    for(int k = 0; k < iNumWindows; k += iPartSize) {
+        vecParts.append(qMakePair(k, std::min(iPartSize, iNumWindows - k)));
+    }
+
+    std::atomic<bool> bOk(true);
+    QtConcurrent::blockingMap(vecParts, [&](const QPair<int,int>& part) {
+        if(!fitPart(part.first, part.second, matProjectors, initialFit)) {
+            bOk = false;
+        }
+    });
+    if(!bOk) {
+        qWarning() << "[InvHpiBatchFit::run] Cannot read raw data from" << m_sFileName;
+        m_vecWindows.clear();
+        return false;
+    }
+
+    // Rejected fits keep the last valid position, the initial position before the first valid fit
+    HpiBatchWindow::TransMatrix matLast = raw.info.dev_head_t.isEmpty() ? HpiBatchWindow::TransMatrix::Identity()
+                                                                        : HpiBatchWindow::TransMatrix(raw.info.dev_head_t.trans);
+    std::vector<double> vecErrors;
+    vecErrors.reserve(iNumWindows);
+    double dGoF = 0.0;
+
+    for(HpiBatchWindow& window : m_vecWindows) {
+        if(window.bValid) {
+            matLast = window.matDevHead;
+            vecErrors.push_back(window.dError);
+            dGoF += window.vecGoF.mean();
+        } else {
+            window.matDevHead = matLast;
+            ++m_stats.iRejected;
+        }
+    }
+
+    m_stats.iWindows = iNumWindows;
+    m_stats.iThreads = vecParts.size();
+    m_stats.dWallTime = timer.nsecsElapsed() * 1e-9;
+    m_stats.dWindowsPerSec = m_stats.dWallTime > 0.0 ? iNumWindows / m_stats.dWallTime : 0.0;
+
+    if(!vecErrors.empty()) {
+        m_stats.dMeanError = std::accumulate(vecErrors.begin(), vecErrors.end(), 0.0) / vecErrors.size();
+        m_stats.dMaxError = *std::max_element(vecErrors.begin(), vecErrors.end());
+        m_stats.dMeanGoF = dGoF / vecErrors.size();
+
+        std::vector<double>::iterator itMid = vecErrors.begin() + vecErrors.size() / 2;
+        std::nth_element(vecErrors.begin(), itMid, vecErrors.end());
+        m_stats.dMedianError = *itMid;
+        if(vecErrors.size() % 2 == 0) {
+            m_stats.dMedianError = 0.5 * (m_stats.dMedianError + *std::max_element(vecErrors.begin(), itMid));
+        }
+    }
+
+    return true;
+}
+
+//=============================================================================================================
+
+const QVector<HpiBatchWindow>& InvHpiBatchFit::getWindows() const
+{
+    return m_vecWindows;
+}
+
+//=============================================================================================================
+
+fiff_int_t InvHpiBatchFit::getStepSamples() const
+{
+    return m_iStepSamples;
+}
+
+//=============================================================================================================
+
+HpiBatchStats InvHpiBatchFit::getStats() const
+{
+    return m_stats;
+}
+
+//=============================================================================================================
+
+MatrixXd InvHpiBatchFit::getHeadPositions() const
+{
+    MatrixXd matPosition;
+    for(const HpiBatchWindow& window : m_vecWindows) {
+        InvHpiFit::storeHeadPosition(window.fTime,
+                                     window.matDevHead,
+                                     matPosition,
+                                     window.vecGoF,
+                                     window.vecError);
+    }
+
+    // The last column holds the speed of the head in m/s
+    for(int k = 1; k < matPosition.rows(); ++k) {
+        const double dt = matPosition(k, 0) - matPosition(k - 1, 0);
+        if(dt > 0.0) {
+            matPosition(k, 9) = (matPosition.row(k).segment(4, 3) - matPosition.row(k - 1).segment(4, 3)).norm() / dt;
+        }
+    }
+
+    return matPosition;
+}
+
+//=============================================================================================================
+
+bool InvHpiBatchFit::writeHeadPositions(const QString& sFileName) const
+{
+    QFile file(sFileName);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning() << "[InvHpiBatchFit::writeHeadPositions] Cannot open" << sFileName;
+        return false;
+    }
+
+    const MatrixXd matPosition = getHeadPositions();
+
+    QTextStream out(&file);
+    out << " Time       q1       q2       q3       x        y        z        gof      err      v\n";
+    for(int k = 0; k < matPosition.rows(); ++k) {
+        out << QString::asprintf("%9.3f", matPosition(k, 0));
+        for(int c = 1; c < 10; ++c) {
+            out << QString::asprintf(" %8.5f", matPosition(k, c));
+        }
+        out << "\n";
+    }
+
+    return true;
+}
+
+//=============================================================================================================
+
+bool InvHpiBatchFit::fitPart(int iFirst,
+                             int iNum,
+                             const MatrixXd& matProjectors,
+                             const HpiFitResult& initialFit)
+{
+    QFile file(m_sFileName);
+    FiffRawData raw(file);
+    if(raw.isEmpty()) {
+        return false;
+    }
+
+    QSharedPointer<FiffInfo> pInfo = QSharedPointer<FiffInfo>(new FiffInfo(raw.info));
+    InvHpiDataUpdater hpiDataUpdater(pInfo);
+    InvHpiFit hpiFit(hpiDataUpdater.getSensors());
+    hpiFit.setDipoleSolver(m_dipoleSolver);
+    const MatrixXd matCoilsHead = hpiDataUpdater.getHpiDigitizer();
+    const InvHpiModelParameters modelParameters(m_vecHpiFreqs, m_dSFreq, m_dLineFreq, false);
+
+    HpiFitResult hpiFitResult = initialFit;
+    MatrixXd matData, matTimes;
+
+    for(int k = iFirst; k < iFirst + iNum; ++k) {
+        HpiBatchWindow& window = m_vecWindows[k];
+        const fiff_int_t to = std::min(window.first + m_iWindowSamples - 1, raw.last_samp);
+
+        if(!raw.read_raw_segment(matData, matTimes, window.first, to)) {
+            return false;
+        }
+
+        hpiDataUpdater.prepareDataAndProjectors(matData, matProjectors);
+        hpiFit.fit(hpiDataUpdater.getProjectedData(),
+                   hpiDataUpdater.getProjectors(),
+                   modelParameters,
+                   matCoilsHead,
+                   hpiFitResult);
+
+        window.matDevHead = hpiFitResult.devHeadTrans.trans;
+        window.vecGoF = hpiFitResult.GoF;
+        window.vecError = hpiFitResult.errorDistances;
+        window.dError = window.vecError.isEmpty() ? 0.0
+                                                  : std::accumulate(window.vecError.begin(), window.vecError.end(), 0.0) / window.vecError.size();
+        window.bValid = window.dError <= m_dMaxError;
+
+        // A rejected fit must not seed the next one
+        if(!window.bValid) {
+            hpiFitResult = initialFit;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,264 @@
+//=============================================================================================================
+/**
+ * @file     inv_hpi_batch_fit.h
+ * @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>
+ * @since    2.0.0
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, Christoph Dinh. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    InvHpiBatchFit class declaration.
+ *
+ */
+
+#ifndef INV_HPI_BATCH_FIT_H
+#define INV_HPI_BATCH_FIT_H
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../inv_global.h"
+#include "inv_hpi_fit.h"
+
+#include <fiff/fiff_types.h>
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QString>
+#include <QVector>
+
+//=============================================================================================================
+// DEFINE NAMESPACE INVLIB
+//=============================================================================================================
+
+namespace INVLIB
+{
+
+//=============================================================================================================
+/**
+ * The head position fitted from one HPI window.
+ *
+ * @brief Head position, fit quality and time stamp of one HPI window
+ */
+struct HpiBatchWindow {
+    typedef Eigen::Matrix<float, 4, 4, Eigen::DontAlign> TransMatrix;   /**< Unaligned 4x4 transformation, storable in Qt containers. */
+
+    FIFFLIB::fiff_int_t first = 0;                      /**< First sample of the window. */
+    float               fTime = 0.0f;                   /**< Time of the first sample in s, including first_samp as in MaxFilter. */
+    TransMatrix         matDevHead = TransMatrix::Identity(); /**< Device to head transformation, the last valid one for rejected windows. */
+    Eigen::VectorXd     vecGoF;                         /**< Goodness of fit per coil. */
+    QVector<double>     vecError;                       /**< Estimation error per coil in m. */
+    double              dError = 0.0;                   /**< Mean estimation error in m. */
+    bool                bValid = false;                 /**< Whether the fit met the error limit. */
+};
+
+//=============================================================================================================
+/**
+ * Timing and error statistics of a batch fit.
+ *
+ * @brief Throughput and fit error statistics of InvHpiBatchFit::run
+ */
+struct HpiBatchStats {
+    int     iWindows = 0;           /**< Number of fitted windows. */
+    int     iRejected = 0;          /**< Number of windows above the error limit. */
+    int     iThreads = 0;           /**< Number of parts fitted at once. */
+    double  dWallTime = 0.0;        /**< Wall time of the fit in s. */
+    double  dWindowsPerSec = 0.0;   /**< Fitted windows per second of wall time. */
+    double  dMeanError = 0.0;       /**< Mean estimation error of the valid windows in m. */
+    double  dMedianError = 0.0;     /**< Median estimation error of the valid windows in m. */
+    double  dMaxError = 0.0;        /**< Largest estimation error of the valid windows in m. */
+    double  dMeanGoF = 0.0;         /**< Mean goodness of fit of the valid windows. */
+};
+
+//=============================================================================================================
+/**
+ * Offline head position estimation for a whole raw file with continuous HPI. The file is cut into windows at a
+ * fixed step. The first window is fitted once to order the coil frequencies; then the windows are split into
+ * contiguous parts, one per thread, and each part is fitted in order with every fit seeded from the previous
+ * one. Every part opens its own copy of the file, so no data is shared between the threads. Rejected fits do
+ * not seed the next window and keep the last valid position.
+ *
+ * @code
+ *     InvHpiBatchFit batchFit("raw.fif", {154, 158, 161, 166});
+ *     if(batchFit.run()) {
+ *         batchFit.writeHeadPositions("raw.pos");
+ *     }
+ * @endcode
+ *
+ * @brief Whole-file continuous head position estimation with warm-started fits.
+ */
+class INVSHARED_EXPORT InvHpiBatchFit
+{
+
+public:
+    typedef QSharedPointer<InvHpiBatchFit> SPtr;             /**< Shared pointer type for InvHpiBatchFit. */
+    typedef QSharedPointer<const InvHpiBatchFit> ConstSPtr;  /**< Const shared pointer type for InvHpiBatchFit. */
+
+    //=========================================================================================================
+    /**
+     * Constructs the batch fit for a raw file.
+     *
+     * @param[in] sFileName      The raw file with continuous HPI.
+     * @param[in] vecHpiFreqs    The HPI coil frequencies in Hz, in any order.
+     */
+    InvHpiBatchFit(const QString& sFileName,
+                   const QVector<int>& vecHpiFreqs);
+
+    //=========================================================================================================
+    /**
+     * Sets the length of the fit windows.
+     *
+     * @param[in] dWindow    The window length in s. Default is 0.2.
+     */
+    void setWindowLength(double dWindow);
+
+    //=========================================================================================================
+    /**
+     * Sets the time between the starts of consecutive windows.
+     *
+     * @param[in] dStep      The step in s. Default is 0.2.
+     */
+    void setStep(double dStep);
+
+    //=========================================================================================================
+    /**
+     * Sets the largest accepted mean coil error.
+     *
+     * @param[in] dMaxError  The error limit in m. Default is 0.005.
+     */
+    void setMaxError(double dMaxError);
+
+    //=========================================================================================================
+    /**
+     * Sets the number of parts fitted at once.
+     *
+     * @param[in] iThreads   The number of threads, 0 for the size of the global thread pool. Default is 0.
+     */
+    void setNumThreads(int iThreads);
+
+    //=========================================================================================================
+    /**
+     * Sets the solver used for the dipole fits.
+     *
+     * @param[in] solver     The dipole solver. Default is HpiDipoleSolver::LevenbergMarquardt.
+     */
+    void setDipoleSolver(HpiDipoleSolver solver);
+
+    //=========================================================================================================
+    /**
+     * Fits all windows of the file.
+     *
+     * @return true if successful, false if the file or the HPI information could not be read.
+     */
+    bool run();
+
+    //=========================================================================================================
+    /**
+     * Returns the fitted windows in time order.
+     *
+     * @return The windows of the last run.
+     */
+    const QVector<HpiBatchWindow>& getWindows() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the step between the windows of the last run in samples.
+     *
+     * @return The step in samples.
+     */
+    FIFFLIB::fiff_int_t getStepSamples() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the timing and error statistics of the last run.
+     *
+     * @return The statistics.
+     */
+    HpiBatchStats getStats() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the head positions in the layout of InvHpiFit::storeHeadPosition, one row per window: time,
+     * rotation quaternion q1..q3, translation x, y, z in m, goodness of fit, error in m and speed in m/s.
+     *
+     * @return The head positions (nWindows x 10).
+     */
+    Eigen::MatrixXd getHeadPositions() const;
+
+    //=========================================================================================================
+    /**
+     * Writes the head positions in the MaxFilter .pos text format.
+     *
+     * @param[in] sFileName  The file to write.
+     *
+     * @return true if successful, false otherwise.
+     */
+    bool writeHeadPositions(const QString& sFileName) const;
+
+private:
+    //=========================================================================================================
+    /**
+     * Fits the windows [iFirst, iFirst + iNum) in order, each one seeded with the previous.
+     *
+     * @param[in] iFirst             The first window of the part.
+     * @param[in] iNum               The number of windows of the part.
+     * @param[in] matProjectors      The projectors with the bad channels zeroed.
+     * @param[in] initialFit         The fit of the first window, seed of the part.
+     *
+     * @return true if successful, false if the data could not be read.
+     */
+    bool fitPart(int iFirst,
+                 int iNum,
+                 const Eigen::MatrixXd& matProjectors,
+                 const HpiFitResult& initialFit);
+
+    QString                 m_sFileName;        /**< The raw file, opened by every part. */
+    QVector<int>            m_vecHpiFreqs;      /**< The HPI frequencies, ordered to the digitized coils by run. */
+    double                  m_dWindow;          /**< Window length in s. */
+    double                  m_dStep;            /**< Step between windows in s. */
+    double                  m_dMaxError;        /**< Largest accepted mean coil error in m. */
+    int                     m_iThreads;         /**< Number of parts fitted at once, 0 for the pool size. */
+    HpiDipoleSolver         m_dipoleSolver;     /**< The solver used for the dipole fits. */
+
+    double                  m_dSFreq;           /**< Sampling frequency of the file. */
+    double                  m_dLineFreq;        /**< Line frequency of the file. */
+    FIFFLIB::fiff_int_t     m_iWindowSamples;   /**< Window length in samples. */
+    FIFFLIB::fiff_int_t     m_iStepSamples;     /**< Step in samples. */
+    QVector<HpiBatchWindow> m_vecWindows;       /**< The fitted windows. */
+    HpiBatchStats           m_stats;            /**< Statistics of the last run. */
+};
+
+} // NAMESPACE
+
+#endif // INV_HPI_BATCH_FIT_H
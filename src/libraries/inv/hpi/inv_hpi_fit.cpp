@@ -94,7 +94,8 @@ using namespace FWDLIB;
 
 InvHpiFit::InvHpiFit(const InvSensorSet& sensorSet)
     : m_sensors(sensorSet),
-      m_signalModel(InvSignalModel())
+      m_signalModel(InvSignalModel()),
+      m_dipoleSolver(HpiDipoleSolver::Simplex)
 {
 
 }
@@ -110,6 +111,20 @@ void InvHpiFit::checkForUpdate(const InvSensorSet &sensorSet)
 
 //=============================================================================================================
 
+void InvHpiFit::setDipoleSolver(HpiDipoleSolver solver)
+{
+    m_dipoleSolver = solver;
+}
+
+//=============================================================================================================
+
+HpiDipoleSolver InvHpiFit::getDipoleSolver() const
+{
+    return m_dipoleSolver;
+}
+
+//=============================================================================================================
+
 void InvHpiFit::fit(const MatrixXd& matProjectedData,
                  const MatrixXd& matProjectors,
                  const InvHpiModelParameters& hpiModelParameters,
@@ -260,6 +275,27 @@ CoilParam InvHpiFit::dipfit(const MatrixXd matCoilsSeed,
                          const int iMaxIterations,
                          const float fAbortError)
 {
+    if(m_dipoleSolver == HpiDipoleSolver::LevenbergMarquardt) {
+        //Fit the coils one after another, callers running many fits parallelize across fits instead
+        CoilParam coil(iNumCoils);
+
+        for(qint32 i = 0; i < iNumCoils; ++i) {
+            DipFitError errorInfo;
+            coil.pos.row(i) = InvHpiFitData::fitLevenbergMarquardt(matCoilsSeed.row(i),
+                                                                   matData.col(i),
+                                                                   matProjectors,
+                                                                   sensors,
+                                                                   iMaxIterations,
+                                                                   fAbortError,
+                                                                   errorInfo);
+            coil.mom.row(i) = errorInfo.moment.transpose();
+            coil.dpfiterror(i) = errorInfo.error;
+            coil.dpfitnumitr(i) = errorInfo.numIterations;
+        }
+
+        return coil;
+    }
+
     //Do this in conncurrent mode
     //Generate QList structure which can be handled by the QConcurrent framework
     QList<InvHpiFitData> lCoilData;
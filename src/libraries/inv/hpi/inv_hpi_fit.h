@@ -110,6 +110,17 @@ struct CoilParam {
     {}
 };
 
+//=========================================================================================================
+/**
+ * The nonlinear solver used to fit the coil dipole positions.
+ *
+ * @brief Dipole solver selection for the HPI fit
+ */
+enum class HpiDipoleSolver : int {
+    Simplex = 0,                /**< Nelder-Mead simplex, coils fitted concurrently. */
+    LevenbergMarquardt = 1      /**< Levenberg-Marquardt on the analytic Jacobian, coils fitted in the calling thread. */
+};
+
 /**
  * The struct specifing all data needed to perform coil-wise fitting.
  *
@@ -167,6 +178,24 @@ public:
      */
     void checkForUpdate(const InvSensorSet& sensorSet);
 
+    //=========================================================================================================
+    /**
+     * Sets the solver used for the dipole fits. The simplex is the default. The Levenberg-Marquardt solver
+     * needs far fewer lead field evaluations when seeded from a previous fit and does not spawn threads of its
+     * own, which makes it the better choice when many fits are run in parallel.
+     *
+     * @param[in] solver     The dipole solver.
+     */
+    void setDipoleSolver(HpiDipoleSolver solver);
+
+    //=========================================================================================================
+    /**
+     * Returns the solver used for the dipole fits.
+     *
+     * @return The dipole solver.
+     */
+    HpiDipoleSolver getDipoleSolver() const;
+
     //=========================================================================================================
     /**
      * Perform one single HPI fit.
@@ -378,6 +407,7 @@ private:
 
     InvSensorSet m_sensors;            /**< The sensor struct that contains information about all sensors. */
     InvSignalModel m_signalModel;      /**< The signal model for the Hpi signals used to compute extract the coil amplitudes */
+    HpiDipoleSolver m_dipoleSolver;    /**< The solver used for the dipole fits. */
 
 };
 
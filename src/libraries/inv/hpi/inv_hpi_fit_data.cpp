@@ -51,6 +51,8 @@
 // EIGEN INCLUDES
 //=============================================================================================================
 
+#include <Eigen/Dense>
+
 //=============================================================================================================
 // QT INCLUDES
 //=============================================================================================================
@@ -83,7 +85,6 @@ void InvHpiFitData::doDipfitConcurrent()
     // Initialize variables
     Eigen::RowVectorXd vecCurrentCoil = this->m_coilPos;
     Eigen::VectorXd vecCurrentData = this->m_sensorData;
-    InvSensorSet currentSensors = this->m_sensors;
 
     int iDisplay = 0;
     int iMaxiter = m_iMaxIterations;
@@ -95,12 +96,12 @@ void InvHpiFitData::doDipfitConcurrent()
                                 iDisplay,
                                 vecCurrentData,
                                 this->m_matProjector,
-                                currentSensors,
+                                this->m_sensors,
                                 iSimplexNumitr);
 
     this->m_errorInfo = dipfitError(vecCurrentCoil,
                                     vecCurrentData,
-                                    currentSensors,
+                                    this->m_sensors,
                                     this->m_matProjector);
 
     this->m_errorInfo.numIterations = iSimplexNumitr;
@@ -108,6 +109,126 @@ void InvHpiFitData::doDipfitConcurrent()
 
 //=============================================================================================================
 
+Eigen::RowVectorXd InvHpiFitData::fitLevenbergMarquardt(const Eigen::RowVectorXd& vecSeed,
+                                                        const Eigen::VectorXd& vecData,
+                                                        const Eigen::MatrixXd& matProjectors,
+                                                        const InvSensorSet& sensors,
+                                                        int iMaxIterations,
+                                                        float fAbortError,
+                                                        DipFitError& errorInfo)
+{
+    const int iNchan = sensors.ncoils();
+    const double dDataNorm = vecData.squaredNorm();
+    const double dTol = std::max(static_cast<double>(fAbortError), 1e-12);
+
+    Eigen::MatrixXd matLf, matDLf, matLfProj, matJacobian;
+    Eigen::VectorXd vecResidual, vecMoment;
+
+    // Residual of the linear moment fit at vecPos and, optionally, its Jacobian with respect to the position
+    auto evaluate = [&](const Eigen::Vector3d& vecPos, Eigen::VectorXd& vecRes, Eigen::VectorXd& vecMom, Eigen::MatrixXd* pJacobian) {
+        compute_leadfield_derivatives(vecPos, sensors, matLf, pJacobian ? &matDLf : nullptr);
+        matLfProj = matProjectors * matLf;
+        Eigen::ColPivHouseholderQR<Eigen::MatrixXd> qr(matLfProj);
+        vecMom = qr.solve(vecData);
+        vecRes = vecData - matLfProj * vecMom;
+
+        if(pJacobian) {
+            pJacobian->resize(iNchan, 3);
+            for(int k = 0; k < 3; ++k) {
+                const Eigen::VectorXd v = matProjectors * (matDLf.middleCols(3 * k, 3) * vecMom);
+                pJacobian->col(k) = -(v - matLfProj * qr.solve(v));
+            }
+        }
+
+        return vecRes.squaredNorm();
+    };
+
+    Eigen::Vector3d vecPos = vecSeed.head(3).transpose();
+    double dCost = evaluate(vecPos, vecResidual, vecMoment, &matJacobian);
+    double dLambda = 1e-3;
+    int iItr = 0;
+
+    for(; iItr < iMaxIterations; ++iItr) {
+        const Eigen::Matrix3d matA = matJacobian.transpose() * matJacobian;
+        const Eigen::Vector3d vecGrad = matJacobian.transpose() * vecResidual;
+
+        Eigen::Matrix3d matDamped = matA;
+        matDamped.diagonal() *= 1.0 + dLambda;
+        const Eigen::Vector3d vecStep = matDamped.ldlt().solve(-vecGrad);
+
+        Eigen::VectorXd vecResTrial, vecMomTrial;
+        const double dCostTrial = evaluate(vecPos + vecStep, vecResTrial, vecMomTrial, nullptr);
+
+        if(dCostTrial < dCost) {
+            const bool bConverged = (dCost - dCostTrial) <= dTol * dCost || vecStep.norm() < dTol;
+            vecPos += vecStep;
+            dCost = evaluate(vecPos, vecResidual, vecMoment, &matJacobian);
+            dLambda *= 0.1;
+            if(bConverged) {
+                ++iItr;
+                break;
+            }
+        } else {
+            dLambda *= 10.0;
+            if(dLambda > 1e10) {
+                break;
+            }
+        }
+    }
+
+    errorInfo.error = dDataNorm > 0.0 ? dCost / dDataNorm : 0.0;
+    errorInfo.moment = vecMoment;
+    errorInfo.numIterations = iItr;
+
+    return vecPos.transpose();
+}
+
+//=============================================================================================================
+
+void InvHpiFitData::compute_leadfield_derivatives(const Eigen::Vector3d& vecPos,
+                                                  const InvSensorSet& sensors,
+                                                  Eigen::MatrixXd& matLf,
+                                                  Eigen::MatrixXd* pMatDLf)
+{
+    const double dScale = 1e-7 / (4.0 * M_PI);
+    const int iNp = sensors.np();
+    const Eigen::MatrixXd& matPnt = sensors.rmag();
+    const Eigen::MatrixXd& matOri = sensors.cosmag();
+    const Eigen::RowVectorXd& vecW = sensors.w();
+
+    matLf.setZero(sensors.ncoils(), 3);
+    if(pMatDLf) {
+        pMatDLf->setZero(sensors.ncoils(), 9);
+    }
+
+    for(int i = 0; i < sensors.ncoils(); ++i) {
+        for(int q = i * iNp; q < (i + 1) * iNp; ++q) {
+            const Eigen::Vector3d r = matPnt.row(q).transpose() - vecPos;
+            const Eigen::Vector3d n = matOri.row(q).transpose();
+            const double r2 = r.squaredNorm();
+            const double r5 = r2 * r2 * std::sqrt(r2);
+            const double rn = r.dot(n);
+            const Eigen::Vector3d f = (3.0 * rn * r - r2 * n) / r5;
+            const double w = vecW(q) * dScale;
+
+            matLf.row(i) += w * f.transpose();
+
+            if(pMatDLf) {
+                // d f / d r; the derivative with respect to the dipole position is its negative
+                const Eigen::Matrix3d matG = (3.0 * rn * Eigen::Matrix3d::Identity()
+                                              + 3.0 * r * n.transpose()
+                                              - 2.0 * n * r.transpose()) / r5
+                                             - 5.0 * f * r.transpose() / r2;
+                for(int k = 0; k < 3; ++k) {
+                    pMatDLf->block(i, 3 * k, 1, 3) -= w * matG.col(k).transpose();
+                }
+            }
+        }
+    }
+}
+
+//=============================================================================================================
+
 Eigen::MatrixXd InvHpiFitData::magnetic_dipole(Eigen::MatrixXd matPos,
                                             Eigen::MatrixXd matPnt,
                                             Eigen::MatrixXd matOri)
@@ -128,6 +128,31 @@ public:
      */
     void doDipfitConcurrent();
 
+    //=========================================================================================================
+    /**
+     * Fits a single magnetic dipole with a Levenberg-Marquardt solver on the analytic Jacobian of the lead field.
+     * The dipole moment is eliminated by linear least squares at every position (variable projection), so only
+     * the three position parameters are iterated. Converges in a few iterations when seeded close to the
+     * solution, e.g., from the fit of the previous data window.
+     *
+     * @param[in]   vecSeed             The start position (1 x 3) in device space.
+     * @param[in]   vecData             The coil amplitudes for all channels.
+     * @param[in]   matProjectors       The projectors to apply.
+     * @param[in]   sensors             The sensor information.
+     * @param[in]   iMaxIterations      The maximum number of iterations.
+     * @param[in]   fAbortError         Relative change of the residual at which the iteration is stopped.
+     * @param[out]  errorInfo           The relative residual, the dipole moment and the number of iterations.
+     *
+     * @return The fitted position (1 x 3).
+     */
+    static Eigen::RowVectorXd fitLevenbergMarquardt(const Eigen::RowVectorXd& vecSeed,
+                                                    const Eigen::VectorXd& vecData,
+                                                    const Eigen::MatrixXd& matProjectors,
+                                                    const InvSensorSet& sensors,
+                                                    int iMaxIterations,
+                                                    float fAbortError,
+                                                    DipFitError& errorInfo);
+
     Eigen::MatrixXd         m_coilPos;
     Eigen::RowVectorXd      m_sensorData;
     DipFitError             m_errorInfo;
@@ -159,6 +184,21 @@ protected:
     Eigen::MatrixXd compute_leadfield(const Eigen::MatrixXd& matPos,
                                       const InvSensorSet& sensors);
 
+    //=========================================================================================================
+    /**
+     * Computes the coil-averaged lead field of a magnetic dipole and, optionally, its derivatives with respect
+     * to the dipole position. Same model as magnetic_dipole, evaluated without temporaries per integration point.
+     *
+     * @param[in]   vecPos      The dipole position.
+     * @param[in]   sensors     The sensor information.
+     * @param[out]  matLf       The lead field (nCoils x 3).
+     * @param[out]  pMatDLf     If not null, receives the derivatives (nCoils x 9), columns 3k..3k+2 hold d matLf / d pos_k.
+     */
+    static void compute_leadfield_derivatives(const Eigen::Vector3d& vecPos,
+                                              const InvSensorSet& sensors,
+                                              Eigen::MatrixXd& matLf,
+                                              Eigen::MatrixXd* pMatDLf);
+
     //=========================================================================================================
     /**
      * dipfitError computes the error between measured and model data
@@ -104,22 +104,22 @@ public:
     inline int np() const;
     inline int ncoils() const;
     inline Eigen::VectorXd ez(int iSensor) const;
-    inline Eigen::MatrixXd ez() const;
+    inline const Eigen::MatrixXd& ez() const;
 
     inline Eigen::VectorXd r0(int iSensor) const;
-    inline Eigen::MatrixXd r0() const;
+    inline const Eigen::MatrixXd& r0() const;
 
     inline Eigen::MatrixXd rmag(int iSensor) const;
-    inline Eigen::MatrixXd rmag() const;
+    inline const Eigen::MatrixXd& rmag() const;
 
     inline Eigen::MatrixXd cosmag(int iSensor) const;
-    inline Eigen::MatrixXd cosmag() const;
+    inline const Eigen::MatrixXd& cosmag() const;
 
     inline Eigen::MatrixXd tra(int iSensor) const;
-    inline Eigen::MatrixXd tra() const;
+    inline const Eigen::MatrixXd& tra() const;
 
     inline Eigen::RowVectorXd w(int iSensor) const;
-    inline Eigen::RowVectorXd w() const;
+    inline const Eigen::RowVectorXd& w() const;
 
     inline bool operator== (const InvSensorSet &b) const;
     inline bool operator!= (const InvSensorSet &b) const;
@@ -170,7 +170,7 @@ inline Eigen::VectorXd InvSensorSet::ez(int iSensor) const
     return m_ez.row(iSensor);
 }
 
-inline Eigen::MatrixXd InvSensorSet::ez() const
+inline const Eigen::MatrixXd& InvSensorSet::ez() const
 {
     return m_ez;
 }
@@ -180,7 +180,7 @@ inline Eigen::VectorXd InvSensorSet::r0(int iSensor) const
     return m_r0.row(iSensor);
 }
 
-inline Eigen::MatrixXd InvSensorSet::r0() const
+inline const Eigen::MatrixXd& InvSensorSet::r0() const
 {
     return m_r0;
 }
@@ -190,7 +190,7 @@ inline Eigen::RowVectorXd InvSensorSet::w(int iSensor) const
     return m_w.segment(iSensor*m_np,m_np);
 }
 
-inline Eigen::RowVectorXd InvSensorSet::w() const
+inline const Eigen::RowVectorXd& InvSensorSet::w() const
 {
     return m_w;
 }
@@ -200,7 +200,7 @@ inline Eigen::MatrixXd InvSensorSet::rmag(int iSensor) const
     return m_rmag.block(iSensor*m_np,0,m_np,3);
 }
 
-inline Eigen::MatrixXd InvSensorSet::rmag() const
+inline const Eigen::MatrixXd& InvSensorSet::rmag() const
 {
     return m_rmag;
 }
@@ -210,12 +210,12 @@ inline Eigen::MatrixXd InvSensorSet::cosmag(int iSensor) const
     return m_cosmag.block(iSensor*m_np,0,m_np,3);
 }
 
-inline Eigen::MatrixXd InvSensorSet::cosmag() const
+inline const Eigen::MatrixXd& InvSensorSet::cosmag() const
 {
     return m_cosmag;
 }
 
-inline Eigen::MatrixXd InvSensorSet::tra() const
+inline const Eigen::MatrixXd& InvSensorSet::tra() const
 {
     return m_tra;
 }
@@ -48,7 +48,9 @@
 #include <QDataStream>
 #include <QSharedPointer>
 #include <QDebug>
+#include <QtEndian>
 
+#include <limits>
 #include <stdexcept>
 //=============================================================================================================
 // USED NAMESPACES
@@ -200,13 +202,23 @@ bool InvSourceEstimate::read(QIODevice &p_IODevice, InvSourceEstimate& p_stc)
     //
     // read the data
     //
-    p_stc.data = MatrixXd(t_nVertices, t_nTimePts);
-    for(qint32 i = 0; i < p_stc.data.array().size(); ++i)
-    {
-        float value;
-        *t_pStream >> value;
-        p_stc.data.array()(i) = value;
+    // The time points are stored one after the other: read them as one block and swap the byte order in place.
+    // QDataStream takes int sizes on Qt5, larger payloads are read in chunks.
+    MatrixXf values(t_nVertices, t_nTimePts);
+    char* pData = reinterpret_cast<char*>(values.data());
+    qint64 nBytesLeft = static_cast<qint64>(sizeof(float)) * values.size();
+    while(nBytesLeft > 0) {
+        const int nChunk = static_cast<int>(qMin<qint64>(nBytesLeft, std::numeric_limits<int>::max()));
+        if(t_pStream->readRawData(pData, nChunk) != nChunk) {
+            qWarning("InvSourceEstimate::read - The data is truncated.");
+            t_pStream->device()->close();
+            return false;
+        }
+        pData += nChunk;
+        nBytesLeft -= nChunk;
     }
+    qFromBigEndian<quint32>(values.data(), values.size(), values.data());
+    p_stc.data = values.cast<double>();
 
     //Update time vector
     p_stc.update_times();
@@ -256,8 +268,20 @@ bool InvSourceEstimate::write(QIODevice &p_IODevice)
     //
     // write the data
     //
-    for(qint32 i = 0; i < this->data.array().size(); ++i)
-        *t_pStream << static_cast<float>(this->data.array()(i));
+    MatrixXf values = this->data.cast<float>();
+    qToBigEndian<quint32>(values.data(), values.size(), values.data());
+    const char* pData = reinterpret_cast<const char*>(values.data());
+    qint64 nBytesLeft = static_cast<qint64>(sizeof(float)) * values.size();
+    while(nBytesLeft > 0) {
+        const int nChunk = static_cast<int>(qMin<qint64>(nBytesLeft, std::numeric_limits<int>::max()));
+        if(t_pStream->writeRawData(pData, nChunk) != nChunk) {
+            qWarning("InvSourceEstimate::write - Failed to write the data.");
+            t_pStream->device()->close();
+            return false;
+        }
+        pData += nChunk;
+        nBytesLeft -= nChunk;
+    }
 
     // close the file
     t_pStream->device()->close();
@@ -0,0 +1,334 @@
+//=============================================================================================================
+/**
+ * @file     inv_stc_file.cpp
+ * @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>
+ * @since    2.0.0
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, Christoph Dinh. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    InvStcFile class definition.
+ *
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "inv_stc_file.h"
+#include "inv_source_estimate.h"
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QDataStream>
+#include <QtEndian>
+#include <QDebug>
+
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <algorithm>
+#include <cstring>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace INVLIB;
+using namespace Eigen;
+
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace
+{
+
+constexpr qint64 STC_MIN_HEADER_SIZE = 16;     // tmin, tstep, number of vertices and number of time points
+
+float readFloat(const uchar *src)
+{
+    quint32 bits = qFromBigEndian<quint32>(src);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+}
+
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+InvStcFile::InvStcFile()
+: m_pMap(nullptr)
+, m_iMapSize(0)
+, m_iDataOffset(0)
+, m_iTimesOffset(0)
+, m_bWritable(false)
+, m_fTmin(0.0f)
+, m_fTstep(-1.0f)
+, m_iTimes(0)
+{
+}
+
+//=============================================================================================================
+
+InvStcFile::~InvStcFile()
+{
+    close();
+}
+
+//=============================================================================================================
+
+bool InvStcFile::open(const QString &fileName, bool writable)
+{
+    close();
+
+    m_file.setFileName(fileName);
+    if(!m_file.open(writable ? QIODevice::ReadWrite : QIODevice::ReadOnly)) {
+        qWarning("InvStcFile::open - Cannot open %s", fileName.toUtf8().constData());
+        return false;
+    }
+    m_bWritable = writable;
+
+    if(!map()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+//=============================================================================================================
+
+bool InvStcFile::create(const QString &fileName, float tmin, float tstep, const VectorXi &vertices)
+{
+    close();
+
+    m_file.setFileName(fileName);
+    if(!m_file.open(QIODevice::ReadWrite | QIODevice::Truncate)) {
+        qWarning("InvStcFile::create - Cannot create %s", fileName.toUtf8().constData());
+        return false;
+    }
+    m_bWritable = true;
+
+    QDataStream stream(&m_file);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    stream.setByteOrder(QDataStream::BigEndian);
+
+    stream << 1000.0f * tmin << 1000.0f * tstep << static_cast<quint32>(vertices.size());
+    for(int i = 0; i < vertices.size(); ++i)
+        stream << static_cast<quint32>(vertices[i]);
+    stream << static_cast<quint32>(0);
+
+    if(stream.status() != QDataStream::Ok || !m_file.flush() || !map()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+//=============================================================================================================
+
+void InvStcFile::close()
+{
+    if(m_pMap) {
+        m_file.unmap(m_pMap);
+        m_pMap = nullptr;
+
+        // Cut off the space reserved by append()
+        const qint64 end = m_iDataOffset + 4 * static_cast<qint64>(m_iTimes) * nVertices();
+        if(m_bWritable && m_file.size() > end && !m_file.resize(end))
+            qWarning("InvStcFile::close - Cannot truncate %s", m_file.fileName().toUtf8().constData());
+    }
+    if(m_file.isOpen())
+        m_file.close();
+
+    m_iMapSize = 0;
+    m_iDataOffset = 0;
+    m_iTimesOffset = 0;
+    m_bWritable = false;
+    m_fTmin = 0.0f;
+    m_fTstep = -1.0f;
+    m_vecVertices.resize(0);
+    m_iTimes = 0;
+}
+
+//=============================================================================================================
+
+bool InvStcFile::map()
+{
+    if(m_pMap) {
+        m_file.unmap(m_pMap);
+        m_pMap = nullptr;
+    }
+
+    qint64 size = m_file.size();
+    if(size < STC_MIN_HEADER_SIZE) {
+        qWarning("InvStcFile - %s is too short for an STC file", m_file.fileName().toUtf8().constData());
+        return false;
+    }
+    uchar *header = m_file.map(0, size);
+    if(!header) {
+        qWarning("InvStcFile - Cannot map %s", m_file.fileName().toUtf8().constData());
+        return false;
+    }
+
+    // The header is tmin and tstep in ms, the vertices and the number of time points
+    quint32 nVertices = qFromBigEndian<quint32>(header + 8);
+    m_iTimesOffset = 12 + 4 * static_cast<qint64>(nVertices);
+    m_iDataOffset = m_iTimesOffset + 4;
+    if(size < m_iDataOffset) {
+        qWarning("InvStcFile - The header of %s is truncated", m_file.fileName().toUtf8().constData());
+        m_file.unmap(header);
+        return false;
+    }
+    m_pMap = header;
+    m_iMapSize = size;
+
+    m_fTmin = readFloat(header) / 1000.0f;
+    m_fTstep = readFloat(header + 4) / 1000.0f;
+    m_vecVertices.resize(nVertices);
+    for(quint32 i = 0; i < nVertices; ++i)
+        m_vecVertices[i] = static_cast<int>(qFromBigEndian<quint32>(header + 12 + 4 * static_cast<qint64>(i)));
+
+    // Only complete time points count, in case the file is still being written
+    qint64 nTimes = qFromBigEndian<quint32>(header + m_iTimesOffset);
+    if(nVertices > 0)
+        nTimes = std::min(nTimes, (size - m_iDataOffset) / (4 * static_cast<qint64>(nVertices)));
+    m_iTimes = static_cast<int>(nTimes);
+
+    return true;
+}
+
+//=============================================================================================================
+
+void InvStcFile::decode(qint64 offset, qint64 n, float *dest) const
+{
+    qFromBigEndian<quint32>(m_pMap + m_iDataOffset + 4 * offset, n, dest);
+}
+
+//=============================================================================================================
+
+MatrixXd InvStcFile::readTimes(int from, int n) const
+{
+    if(!m_pMap || from < 0 || n < 0 || from + n > m_iTimes)
+        return MatrixXd();
+
+    MatrixXf values(nVertices(), n);
+    decode(static_cast<qint64>(from) * nVertices(), values.size(), values.data());
+    return values.cast<double>();
+}
+
+//=============================================================================================================
+
+VectorXd InvStcFile::readTime(int t) const
+{
+    MatrixXd values = readTimes(t, 1);
+    if(values.size() == 0)
+        return VectorXd();
+    return values.col(0);
+}
+
+//=============================================================================================================
+
+MatrixXd InvStcFile::readVertices(const VectorXi &rows, int from, int n) const
+{
+    if(n < 0)
+        n = m_iTimes - from;
+    if(!m_pMap || from < 0 || n < 0 || from + n > m_iTimes)
+        return MatrixXd();
+    if(rows.size() > 0 && (rows.minCoeff() < 0 || rows.maxCoeff() >= nVertices()))
+        return MatrixXd();
+
+    MatrixXd values(rows.size(), n);
+    for(int t = 0; t < n; ++t) {
+        const uchar *timePoint = m_pMap + m_iDataOffset + 4 * static_cast<qint64>(from + t) * nVertices();
+        for(int r = 0; r < rows.size(); ++r)
+            values(r, t) = readFloat(timePoint + 4 * static_cast<qint64>(rows[r]));
+    }
+    return values;
+}
+
+//=============================================================================================================
+
+bool InvStcFile::read(InvSourceEstimate &stc) const
+{
+    if(!m_pMap)
+        return false;
+
+    stc = InvSourceEstimate(readTimes(0, m_iTimes), m_vecVertices, m_fTmin, m_fTstep);
+    return true;
+}
+
+//=============================================================================================================
+
+bool InvStcFile::append(const MatrixXd &data)
+{
+    if(!m_pMap || !m_bWritable) {
+        qWarning("InvStcFile::append - The file is not open for writing");
+        return false;
+    }
+    if(data.rows() != nVertices()) {
+        qWarning("InvStcFile::append - Expected %d rows but got %d", nVertices(), static_cast<int>(data.rows()));
+        return false;
+    }
+
+    // Time points are stored one after the other, i.e., in the column-major order of the data
+    MatrixXf values = data.cast<float>();
+    qToBigEndian<quint32>(values.data(), values.size(), values.data());
+
+    const qint64 end = m_iDataOffset + 4 * static_cast<qint64>(m_iTimes) * nVertices();
+    const qint64 bytes = 4 * static_cast<qint64>(values.size());
+
+    // Grow the file by at least half of its size, so that most appends fit into the current mapping.
+    // The mapping must not be in place while the file grows.
+    if(end + bytes > m_iMapSize) {
+        m_file.unmap(m_pMap);
+        m_pMap = nullptr;
+
+        const bool ok = m_file.resize(std::max(end + bytes, m_iMapSize + m_iMapSize / 2));
+        if(!map()) {
+            // Without a mapping close() cannot cut off the reserved space
+            if(!m_file.resize(end))
+                qWarning("InvStcFile::append - Cannot truncate %s", m_file.fileName().toUtf8().constData());
+            close();
+            return false;
+        }
+        if(!ok) {
+            qWarning("InvStcFile::append - Failed to write to %s", m_file.fileName().toUtf8().constData());
+            return false;
+        }
+    }
+
+    // The data first, then the number of time points, so that readers never see incomplete time points
+    std::memcpy(m_pMap + end, values.data(), bytes);
+    m_iTimes += static_cast<int>(data.cols());
+    qToBigEndian<quint32>(static_cast<quint32>(m_iTimes), m_pMap + m_iTimesOffset);
+
+    return true;
+}
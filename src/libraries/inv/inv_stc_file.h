@@ -0,0 +1,327 @@
+//=============================================================================================================
+/**
+ * @file     inv_stc_file.h
+ * @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>
+ * @since    2.0.0
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, Christoph Dinh. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    InvStcFile class declaration: random access to memory-mapped STC files.
+ *
+ */
+
+#ifndef INV_STC_FILE_H
+#define INV_STC_FILE_H
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "inv_global.h"
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QFile>
+#include <QString>
+
+//=============================================================================================================
+// DEFINE NAMESPACE INVLIB
+//=============================================================================================================
+
+namespace INVLIB
+{
+
+class InvSourceEstimate;
+
+//=============================================================================================================
+/**
+ * Random access to an STC file without reading all of it. The header is parsed once on open and the file is
+ * memory-mapped, so time slices and vertex subsets are decoded directly from the mapping, with the byte order
+ * swapped in bulk. Files created with create() can be extended with append(); the number of time points in
+ * the header is updated with every append, so the file is readable at all times. The file and its mapping grow
+ * ahead of the data, so that appends are written into the mapping and only some of them remap the file; the
+ * unused space after the data is cut off on close().
+ *
+ * Reads are const and may be done from several threads at once, but not concurrently with append().
+ *
+ * @brief Memory-mapped STC file reader and writer.
+ */
+class INVSHARED_EXPORT InvStcFile
+{
+public:
+    typedef QSharedPointer<InvStcFile> SPtr;             /**< Shared pointer type for InvStcFile. */
+    typedef QSharedPointer<const InvStcFile> ConstSPtr;  /**< Const shared pointer type for InvStcFile. */
+
+    //=========================================================================================================
+    /**
+     * Default constructor
+     */
+    InvStcFile();
+
+    //=========================================================================================================
+    /**
+     * Destructor, closes the file.
+     */
+    ~InvStcFile();
+
+    InvStcFile(const InvStcFile&) = delete;
+    InvStcFile& operator= (const InvStcFile&) = delete;
+
+    //=========================================================================================================
+    /**
+     * Opens an existing STC file, parses its header and maps it.
+     *
+     * If the header announces more time points than the file holds, e.g., while another process is still
+     * writing it, only the complete time points are used.
+     *
+     * @param[in] fileName   The STC file.
+     * @param[in] writable   Open for append() as well.
+     *
+     * @return true if successful, false otherwise.
+     */
+    bool open(const QString &fileName, bool writable = false);
+
+    //=========================================================================================================
+    /**
+     * Creates a new STC file without time points, to be filled with append().
+     *
+     * @param[in] fileName   The STC file, overwritten if it exists.
+     * @param[in] tmin       Time of the first time point in s.
+     * @param[in] tstep      Time between the time points in s.
+     * @param[in] vertices   The vertex numbers.
+     *
+     * @return true if successful, false otherwise.
+     */
+    bool create(const QString &fileName, float tmin, float tstep, const Eigen::VectorXi &vertices);
+
+    //=========================================================================================================
+    /**
+     * Unmaps and closes the file.
+     */
+    void close();
+
+    //=========================================================================================================
+    /**
+     * Returns whether a file is open.
+     *
+     * @return true if a file is open.
+     */
+    inline bool isOpen() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the name of the open file.
+     *
+     * @return the file name.
+     */
+    inline QString fileName() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the time of the first time point.
+     *
+     * @return tmin in s.
+     */
+    inline float tmin() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the time between time points.
+     *
+     * @return tstep in s.
+     */
+    inline float tstep() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the vertex numbers.
+     *
+     * @return the vertices, one per row of the data.
+     */
+    inline const Eigen::VectorXi& vertices() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the number of vertices.
+     *
+     * @return the number of vertices.
+     */
+    inline int nVertices() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the number of time points.
+     *
+     * @return the number of time points.
+     */
+    inline int nTimes() const;
+
+    //=========================================================================================================
+    /**
+     * Reads consecutive time points of all vertices.
+     *
+     * @param[in] from   The first time point.
+     * @param[in] n      The number of time points.
+     *
+     * @return nVertices x n data, empty if the range is not in the file.
+     */
+    Eigen::MatrixXd readTimes(int from, int n) const;
+
+    //=========================================================================================================
+    /**
+     * Reads one time point of all vertices.
+     *
+     * @param[in] t   The time point.
+     *
+     * @return the values of all vertices, empty if t is not in the file.
+     */
+    Eigen::VectorXd readTime(int t) const;
+
+    //=========================================================================================================
+    /**
+     * Reads consecutive time points of some vertices.
+     *
+     * @param[in] rows   Indices of the vertices to read (rows of the data, not vertex numbers).
+     * @param[in] from   The first time point.
+     * @param[in] n      The number of time points, -1 for all from 'from' on.
+     *
+     * @return rows.size() x n data, empty if a row or the range is not in the file.
+     */
+    Eigen::MatrixXd readVertices(const Eigen::VectorXi &rows, int from = 0, int n = -1) const;
+
+    //=========================================================================================================
+    /**
+     * Reads the whole file.
+     *
+     * @param[out] stc   The source estimate.
+     *
+     * @return true if successful, false otherwise.
+     */
+    bool read(InvSourceEstimate &stc) const;
+
+    //=========================================================================================================
+    /**
+     * Appends time points at the end of the file and updates the header.
+     *
+     * @param[in] data   nVertices x n data of the new time points.
+     *
+     * @return true if successful, false otherwise.
+     */
+    bool append(const Eigen::MatrixXd &data);
+
+private:
+    //=========================================================================================================
+    /**
+     * Maps the file as it is now.
+     *
+     * @return true if successful, false otherwise.
+     */
+    bool map();
+
+    //=========================================================================================================
+    /**
+     * Decodes n big-endian floats of the data part starting at value index offset.
+     *
+     * @param[in] offset   Index of the first value (time point * nVertices + row).
+     * @param[in] n        Number of values.
+     * @param[out] dest    Receives the values.
+     */
+    void decode(qint64 offset, qint64 n, float *dest) const;
+
+    QFile           m_file;             /**< The STC file. */
+    uchar*          m_pMap;             /**< The mapping of the whole file. */
+    qint64          m_iMapSize;         /**< Size of the mapping, may be larger than the data while appending. */
+    qint64          m_iDataOffset;      /**< Offset of the data from the start of the file. */
+    qint64          m_iTimesOffset;     /**< Offset of the number of time points in the header. */
+    bool            m_bWritable;        /**< Whether append is allowed. */
+    float           m_fTmin;            /**< Time of the first time point in s. */
+    float           m_fTstep;           /**< Time between time points in s. */
+    Eigen::VectorXi m_vecVertices;      /**< Vertex numbers. */
+    int             m_iTimes;           /**< Number of time points. */
+};
+
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline bool InvStcFile::isOpen() const
+{
+    return m_pMap != nullptr;
+}
+
+//=============================================================================================================
+
+inline QString InvStcFile::fileName() const
+{
+    return m_file.fileName();
+}
+
+//=============================================================================================================
+
+inline float InvStcFile::tmin() const
+{
+    return m_fTmin;
+}
+
+//=============================================================================================================
+
+inline float InvStcFile::tstep() const
+{
+    return m_fTstep;
+}
+
+//=============================================================================================================
+
+inline const Eigen::VectorXi& InvStcFile::vertices() const
+{
+    return m_vecVertices;
+}
+
+//=============================================================================================================
+
+inline int InvStcFile::nVertices() const
+{
+    return static_cast<int>(m_vecVertices.size());
+}
+
+//=============================================================================================================
+
+inline int InvStcFile::nTimes() const
+{
+    return m_iTimes;
+}
+
+} //NAMESPACE
+
+#endif // INV_STC_FILE_H
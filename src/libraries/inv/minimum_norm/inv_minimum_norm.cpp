@@ -142,37 +142,17 @@ InvSourceEstimate InvMinimumNorm::calculateInverse(const MatrixXd &data, float t
         return InvSourceEstimate();
     }
 
-    MatrixXd sol = K * data; //apply imaging kernel
-
     if (inv.source_ori == FIFFV_MNE_FREE_ORI && pick_normal == false)
-    {
         qInfo("combining the current components...");
 
-        MatrixXd sol1(sol.rows()/3,sol.cols());
-        for(qint32 i = 0; i < sol.cols(); ++i)
-        {
-            VectorXd tmp = Linalg::combine_xyz(sol.col(i));
-            sol1.block(0,i,sol.rows()/3,1) = tmp.cwiseSqrt();
-        }
-        sol.resize(sol1.rows(),sol1.cols());
-        sol = sol1;
-    }
-
     if (m_bdSPM)
-    {
         qInfo("(dSPM)...");
-        sol = inv.noisenorm*sol;
-    }
     else if (m_bsLORETA)
-    {
         qInfo("(sLORETA)...");
-        sol = inv.noisenorm*sol;
-    }
     else if (m_beLoreta)
-    {
         qInfo("(eLORETA)...");
-        sol = inv.noisenorm*sol;
-    }
+
+    MatrixXd sol = applyInverse(data, pick_normal);
     qInfo("[done]");
 
     //Results
@@ -188,6 +168,37 @@ InvSourceEstimate InvMinimumNorm::calculateInverse(const MatrixXd &data, float t
 
 //=============================================================================================================
 
+MatrixXd InvMinimumNorm::applyInverse(const MatrixXd &data, bool pick_normal) const
+{
+    if(!inverseSetup || K.cols() != data.rows()) {
+        qWarning("InvMinimumNorm::applyInverse - Inverse not setup or dimension mismatch!");
+        return MatrixXd();
+    }
+
+    MatrixXd sol = K * data; //apply imaging kernel
+
+    if (inv.source_ori == FIFFV_MNE_FREE_ORI && pick_normal == false)
+    {
+        MatrixXd sol1(sol.rows()/3,sol.cols());
+        for(qint32 i = 0; i < sol.cols(); ++i)
+        {
+            VectorXd tmp = Linalg::combine_xyz(sol.col(i));
+            sol1.block(0,i,sol.rows()/3,1) = tmp.cwiseSqrt();
+        }
+        sol.resize(sol1.rows(),sol1.cols());
+        sol = sol1;
+    }
+
+    if (m_bdSPM || m_bsLORETA || m_beLoreta)
+    {
+        sol = inv.noisenorm*sol;
+    }
+
+    return sol;
+}
+
+//=============================================================================================================
+
 void InvMinimumNorm::doInverseSetup(qint32 nave, bool pick_normal)
 {
     //
@@ -122,6 +122,19 @@ public:
 
     virtual InvSourceEstimate calculateInverse(const Eigen::MatrixXd &data, float tmin, float tstep, bool pick_normal = false) const;
 
+    //=========================================================================================================
+    /**
+     * Applies the set up inverse to the data without logging, e.g., for data streamed block by block. The
+     * orientations are combined and the noise normalization is applied as in calculateInverse.
+     *
+     * @param[in] data           The data, one row per channel of the kernel.
+     * @param[in] pick_normal    If True, rather than pooling the orientations by taking the norm, only the.
+     *                           radial component is kept. This is only applied when working with loose orientations.
+     *
+     * @return the source amplitudes, an empty matrix if the inverse is not set up or the data does not match.
+     */
+    Eigen::MatrixXd applyInverse(const Eigen::MatrixXd &data, bool pick_normal = false) const;
+
     //=========================================================================================================
     /**
      * Perform the inverse setup: Prepares this inverse operator and assembles the kernel.
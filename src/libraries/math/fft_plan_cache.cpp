@@ -0,0 +1,164 @@
+//=============================================================================================================
+/**
+ * @file     fft_plan_cache.cpp
+ * @author   Christoph Dinh <christoph.dinh@mne-cpp.org>
+ * @since    2.1.0
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, Christoph Dinh. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    FftPlanCache class definition.
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fft_plan_cache.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace Eigen;
+
+//=============================================================================================================
+// DEFINE LOCAL FUNCTIONS
+//=============================================================================================================
+
+namespace
+{
+
+//=============================================================================================================
+/**
+ * The engines and work buffers owned by one thread.
+ */
+struct ThreadFftCache
+{
+    std::unique_ptr<FFT<double> > engines[4];   /**< Indexed by HalfSpectrum | Unscaled << 1. */
+    VectorXd vecReal;                           /**< Contiguous real work buffer. */
+    VectorXcd vecComplex;                       /**< Contiguous complex work buffer. */
+};
+
+//=============================================================================================================
+
+ThreadFftCache& threadCache()
+{
+    thread_local ThreadFftCache cache;
+    return cache;
+}
+
+} // anonymous namespace
+
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+FFT<double>& FftPlanCache::get(bool bHalfSpectrum,
+                               bool bUnscaled)
+{
+    #ifdef EIGEN_FFTW_DEFAULT
+        static std::once_flag s_threadSafePlanner;
+        std::call_once(s_threadSafePlanner, fftw_make_planner_thread_safe);
+    #endif
+
+    std::unique_ptr<FFT<double> >& pEngine = threadCache().engines[(bHalfSpectrum ? 1 : 0) | (bUnscaled ? 2 : 0)];
+
+    if(!pEngine) {
+        pEngine.reset(new FFT<double>());
+        if(bHalfSpectrum) {
+            pEngine->SetFlag(FFT<double>::HalfSpectrum);
+        }
+        if(bUnscaled) {
+            pEngine->SetFlag(FFT<double>::Unscaled);
+        }
+    }
+
+    return *pEngine;
+}
+
+//=============================================================================================================
+
+void FftPlanCache::fwdRows(MatrixXcd& matSpectra,
+                           const MatrixXd& matData,
+                           int iNfft,
+                           bool bHalfSpectrum)
+{
+    FFT<double>& fft = get(bHalfSpectrum);
+    ThreadFftCache& cache = threadCache();
+
+    const Index iNCopy = std::min<Index>(matData.cols(), iNfft);
+    const Index iNFreqs = bHalfSpectrum ? iNfft / 2 + 1 : iNfft;
+
+    matSpectra.resize(matData.rows(), iNFreqs);
+    cache.vecReal.setZero(iNfft);
+    cache.vecComplex.resize(iNfft);
+
+    for(Index i = 0; i < matData.rows(); ++i) {
+        cache.vecReal.head(iNCopy) = matData.row(i).head(iNCopy).transpose();
+        fft.fwd(cache.vecComplex.data(), cache.vecReal.data(), iNfft);
+        matSpectra.row(i) = cache.vecComplex.head(iNFreqs).transpose();
+    }
+}
+
+//=============================================================================================================
+
+void FftPlanCache::invRows(MatrixXd& matData,
+                           const MatrixXcd& matSpectra,
+                           int iNfft,
+                           bool bUnscaled)
+{
+    FFT<double>& fft = get(true, bUnscaled);
+    ThreadFftCache& cache = threadCache();
+
+    const Index iNFreqs = iNfft / 2 + 1;
+
+    matData.resize(matSpectra.rows(), iNfft);
+    cache.vecReal.resize(iNfft);
+    cache.vecComplex.resize(iNfft);
+
+    for(Index i = 0; i < matSpectra.rows(); ++i) {
+        cache.vecComplex.head(iNFreqs) = matSpectra.row(i).head(iNFreqs).transpose();
+        fft.inv(cache.vecReal.data(), cache.vecComplex.data(), iNfft);
+        matData.row(i) = cache.vecReal.transpose();
+    }
+}
+
+//=============================================================================================================
+
+void FftPlanCache::clear()
+{
+    ThreadFftCache& cache = threadCache();
+
+    for(std::unique_ptr<FFT<double> >& pEngine : cache.engines) {
+        pEngine.reset();
+    }
+    cache.vecReal.resize(0);
+    cache.vecComplex.resize(0);
+}
@@ -0,0 +1,130 @@
+//=============================================================================================================
+/**
+ * @file     fft_plan_cache.h
+ * @author   Christoph Dinh <christoph.dinh@mne-cpp.org>
+ * @since    2.1.0
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, Christoph Dinh. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    FftPlanCache class declaration.
+ */
+
+#ifndef FFT_PLAN_CACHE_H
+#define FFT_PLAN_CACHE_H
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "math_global.h"
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+#include <unsupported/Eigen/FFT>
+
+//=============================================================================================================
+// DEFINE NAMESPACE UTILSLIB
+//=============================================================================================================
+
+namespace UTILSLIB
+{
+
+//=============================================================================================================
+/**
+ * Hands out per-thread Eigen::FFT engines that live as long as their thread. An engine keeps the plans and
+ * twiddle tables of every length and direction (real or complex, forward or inverse) it has seen, so
+ * repeated transforms of the same length skip the setup that a freshly constructed Eigen::FFT pays for.
+ * There is one engine per combination of the HalfSpectrum and Unscaled flags. Because every thread owns
+ * its engines no locking is needed.
+ *
+ * Callers must not change the flags of an engine they got from here.
+ *
+ * @brief Per-thread FFT plan cache.
+ */
+class MATHSHARED_EXPORT FftPlanCache
+{
+public:
+    //=========================================================================================================
+    /**
+     * deleted default constructor (static class).
+     */
+    FftPlanCache() = delete;
+
+    //=========================================================================================================
+    /**
+     * Returns the calling thread's FFT engine for the given flags.
+     *
+     * @param[in] bHalfSpectrum  Whether real forward transforms return (and real inverse transforms expect)
+     *                           only the nfft/2+1 non-negative frequencies.
+     * @param[in] bUnscaled      Whether inverse transforms skip the 1/nfft scaling.
+     *
+     * @return The cached engine.
+     */
+    static Eigen::FFT<double>& get(bool bHalfSpectrum = false,
+                                   bool bUnscaled = false);
+
+    //=========================================================================================================
+    /**
+     * Forward transforms every row of matData. Rows shorter than iNfft are zero-padded, longer rows are
+     * truncated. All rows share one plan and one work buffer.
+     *
+     * @param[out] matSpectra        The spectra, one row per input row (iNfft/2+1 or iNfft columns).
+     * @param[in] matData            The real time domain data (rows x samples).
+     * @param[in] iNfft              The FFT length.
+     * @param[in] bHalfSpectrum      Whether to return only the non-negative frequencies. Default is true.
+     */
+    static void fwdRows(Eigen::MatrixXcd& matSpectra,
+                        const Eigen::MatrixXd& matData,
+                        int iNfft,
+                        bool bHalfSpectrum = true);
+
+    //=========================================================================================================
+    /**
+     * Inverse transforms every row of matSpectra to real time domain data. Only the first iNfft/2+1 columns
+     * are used, the rest of the spectrum is assumed to be Hermitian.
+     *
+     * @param[out] matData           The real time domain data, one row of iNfft samples per spectrum.
+     * @param[in] matSpectra         The spectra (rows x iNfft/2+1 or rows x iNfft).
+     * @param[in] iNfft              The FFT length.
+     * @param[in] bUnscaled          Whether to skip the 1/iNfft scaling. Default is false.
+     */
+    static void invRows(Eigen::MatrixXd& matData,
+                        const Eigen::MatrixXcd& matSpectra,
+                        int iNfft,
+                        bool bUnscaled = false);
+
+    //=========================================================================================================
+    /**
+     * Releases the plans and work buffers held by the calling thread.
+     */
+    static void clear();
+};
+
+} // NAMESPACE UTILSLIB
+
+#endif // FFT_PLAN_CACHE_H
@@ -42,6 +42,7 @@
 //=============================================================================================================
 
 #include "spectral.h"
+#include "fft_plan_cache.h"
 #include "math.h"
 
 //=============================================================================================================
@@ -74,23 +75,16 @@ MatrixXcd Spectral::computeTaperedSpectraRow(const RowVectorXd &vecData,
                                              int iNfft)
 {
     //qDebug() << "Spectral::computeTaperedSpectra Matrixwise";
-    FFT<double> fft;
-    fft.SetFlag(fft.HalfSpectrum);
 
     //Check inputs
     if (vecData.cols() != matTaper.cols() || iNfft < vecData.cols()) {
         return MatrixXcd();
     }
 
-    //FFT for freq domain returning the half spectrum
-    RowVectorXd vecInputFFT;
-    RowVectorXcd vecTmpFreq;
-    MatrixXcd matTapSpectrum(matTaper.rows(), int(floor(iNfft / 2.0)) + 1);
-    for (int i=0; i < matTaper.rows(); i++) {
-        vecInputFFT = vecData.cwiseProduct(matTaper.row(i));
-        fft.fwd(vecTmpFreq, vecInputFFT, iNfft);
-        matTapSpectrum.row(i) = vecTmpFreq;
-    }
+    //FFT for freq domain returning the half spectrum, all tapers share one plan
+    MatrixXd matTapered = matTaper.array().rowwise() * vecData.array();
+    MatrixXcd matTapSpectrum;
+    FftPlanCache::fwdRows(matTapSpectrum, matTapered, iNfft, true);
 
     return matTapSpectrum;
 }
@@ -115,8 +109,7 @@ QVector<MatrixXcd> Spectral::computeTaperedSpectraMatrix(const MatrixXd &matData
 //        int iTimeAll = 0;
 //        timer.start();
 
-        FFT<double> fft;
-        fft.SetFlag(fft.HalfSpectrum);
+        FFT<double>& fft = FftPlanCache::get(true);
 
         RowVectorXd vecInputFFT, rowData;
         RowVectorXcd vecTmpFreq;
@@ -455,6 +455,7 @@ public:
      * @param[in] decim     Decimation factor (1 = no decimation).
      * @param[in] from      First sample to save (-1 = from start of raw data).
      * @param[in] to        Last sample to save (-1 = to end of raw data).
+     * @param[in] data_type Output sample format: FIFFT_FLOAT (default), FIFFT_INT or FIFFT_SHORT.
      *
      * @return true on success.
      */
@@ -463,9 +464,10 @@ public:
                                 const Eigen::RowVectorXi &picks = Eigen::RowVectorXi(),
                                 int decim = 1,
                                 int from = -1,
-                                int to = -1)
+                                int to = -1,
+                                FIFFLIB::fiff_int_t data_type = FIFFT_FLOAT)
     {
-        return raw.save(p_IODevice, picks, decim, from, to);
+        return raw.save(p_IODevice, picks, decim, from, to, data_type);
     }
 
     static void setup_compensators(FIFFLIB::FiffRawData& raw,
@@ -156,6 +156,7 @@ struct MNESHARED_EXPORT ProcessingSettings {
     QStringList saveFiles;              /**< Destination(s) for saving filtered raw data. */
     bool omitSubjectInfo   = false;     /**< Omit subject info from output. */
     int  decimation        = 1;         /**< Decimation factor. */
+    int  dataType          = FIFFT_FLOAT; /**< Output sample format (FIFFT_FLOAT, FIFFT_INT or FIFFT_SHORT). */
     long splitSize         = -1;        /**< Split output into chunks of this many bytes (-1=no split). */
 
     // Averaging
@@ -170,6 +171,10 @@ struct MNESHARED_EXPORT ProcessingSettings {
 
     // Misc
     bool saveHere          = false;     /**< Save auto-generated files in CWD instead of raw data dir. */
+    bool fused             = false;     /**< Run all steps in a single pass over each raw file. */
+    int  jobs              = 1;         /**< Raw files processed concurrently (0 = one per core). */
+    qint64 jobMemory       = -1;        /**< Budget for the raw files processed at once, in bytes (-1 = no limit). */
+    int  workers           = 0;         /**< Pipeline worker threads per raw file (0 = one per core). */
 };
 
 } // namespace MNELIB
@@ -39,6 +39,12 @@
 
 #include <mne/mne_process_description.h>
 
+#include <fiff/fiff_raw_data.h>
+#include <fiff/fiff_evoked_set.h>
+#include <fiff/fiff_cov.h>
+#include <fiff/fiff_proj.h>
+#include <fiff/fiff_stream.h>
+
 //=============================================================================================================
 // QT INCLUDES
 //=============================================================================================================
@@ -47,6 +53,7 @@
 #include <QCoreApplication>
 #include <QTemporaryDir>
 #include <QFile>
+#include <QDir>
 
 //=============================================================================================================
 // USED NAMESPACES
@@ -54,6 +61,8 @@
 
 using namespace MNEPROCESSRAWAPP;
 using namespace MNELIB;
+using namespace FIFFLIB;
+using namespace Eigen;
 
 //=============================================================================================================
 /**
@@ -83,11 +92,17 @@ private slots:
     void testRunNoRawFiles();
     void testRunWithSampleData();
     void testRunSaveFilteredData();
+    void testRunFusedMatchesSequential();
+    void testRunConcurrentJobs();
 
     void cleanupTestCase();
 
 private:
+    QList<FiffProj> readProjectors(const QString &fileName);
+
     QString m_sResourcePath;
+    QString m_sAveDescPath;
+    QString m_sCovDescPath;
     QTemporaryDir m_tempDir;
 };
 
@@ -98,6 +113,34 @@ void TestBatchProcessor::initTestCase()
     QString binDir = QCoreApplication::applicationDirPath();
     m_sResourcePath = binDir + "/../resources/data/mne-cpp-test-data/";
     QVERIFY(m_tempDir.isValid());
+
+    // Description files for the averaging and covariance runs
+    m_sAveDescPath = m_tempDir.path() + "/test.ave";
+    QFile aveDescFile(m_sAveDescPath);
+    QVERIFY(aveDescFile.open(QIODevice::WriteOnly | QIODevice::Text));
+    aveDescFile.write("average {\n"
+                      "    category {\n"
+                      "        name \"Auditory left\"\n"
+                      "        event 1\n"
+                      "        tmin -0.1\n"
+                      "        tmax 0.3\n"
+                      "        bmin -0.1\n"
+                      "        bmax 0.0\n"
+                      "    }\n"
+                      "}\n");
+    aveDescFile.close();
+
+    m_sCovDescPath = m_tempDir.path() + "/test.cov";
+    QFile covDescFile(m_sCovDescPath);
+    QVERIFY(covDescFile.open(QIODevice::WriteOnly | QIODevice::Text));
+    covDescFile.write("cov {\n"
+                      "    def {\n"
+                      "        event 1\n"
+                      "        tmin -0.2\n"
+                      "        tmax 0.0\n"
+                      "    }\n"
+                      "}\n");
+    covDescFile.close();
 }
 
 //=============================================================================================================
@@ -253,6 +296,200 @@ void TestBatchProcessor::testRunSaveFilteredData()
     QVERIFY(fi.size() > 0);
 }
 
+void TestBatchProcessor::testRunFusedMatchesSequential()
+{
+    QString rawPath = m_sResourcePath + "MEG/sample/sample_audvis_trunc_raw.fif";
+    if (!QFile::exists(rawPath))
+        QSKIP("Sample raw data not available");
+
+    ProcessingSettings settings;
+    settings.rawFiles << rawPath;
+    settings.digTriggerMask = 0xFF;
+    settings.decimation = 3;
+    settings.aveFiles << m_sAveDescPath;
+    settings.covFiles << m_sCovDescPath;
+    settings.makeProj = true;
+    settings.projEvent = 1;
+    settings.projTmin = -0.2f;
+    settings.projTmax = 0.0f;
+    settings.projNGrad = 2;
+    settings.projNMag = 2;
+
+    // The tagged outputs go to the working directory
+    settings.saveHere = true;
+    QString cwd = QDir::currentPath();
+    QVERIFY(QDir::setCurrent(m_tempDir.path()));
+
+    // Sequential steps
+    QString seqEvents = m_tempDir.path() + "/sequential.eve";
+    QString seqRaw = m_tempDir.path() + "/sequential_raw.fif";
+    settings.eventsOutFiles = QStringList() << seqEvents;
+    settings.saveFiles = QStringList() << seqRaw;
+    settings.saveAveTag = "_seq-ave";
+    settings.saveCovTag = "_seq-cov";
+    settings.saveProjTag = "_seq-proj";
+    int seqResult = BatchProcessor::run(settings);
+
+    // Single pass
+    QString fusedEvents = m_tempDir.path() + "/fused.eve";
+    QString fusedRaw = m_tempDir.path() + "/fused_raw.fif";
+    settings.eventsOutFiles = QStringList() << fusedEvents;
+    settings.saveFiles = QStringList() << fusedRaw;
+    settings.saveAveTag = "_fused-ave";
+    settings.saveCovTag = "_fused-cov";
+    settings.saveProjTag = "_fused-proj";
+    settings.fused = true;
+    int fusedResult = BatchProcessor::run(settings);
+
+    QDir::setCurrent(cwd);
+    QCOMPARE(seqResult, 0);
+    QCOMPARE(fusedResult, 0);
+
+    // Same events
+    QFile seqEventFile(seqEvents);
+    QFile fusedEventFile(fusedEvents);
+    QVERIFY(seqEventFile.open(QIODevice::ReadOnly));
+    QVERIFY(fusedEventFile.open(QIODevice::ReadOnly));
+    QCOMPARE(fusedEventFile.readAll(), seqEventFile.readAll());
+
+    // Same decimated data
+    QFile seqRawFile(seqRaw);
+    QFile fusedRawFile(fusedRaw);
+    FiffRawData seqData(seqRawFile);
+    FiffRawData fusedData(fusedRawFile);
+    QCOMPARE(fusedData.info.sfreq, seqData.info.sfreq);
+    QCOMPARE(fusedData.last_samp - fusedData.first_samp, seqData.last_samp - seqData.first_samp);
+
+    MatrixXd seqMat, fusedMat, times;
+    QVERIFY(seqData.read_raw_segment(seqMat, times));
+    QVERIFY(fusedData.read_raw_segment(fusedMat, times));
+    QCOMPARE(fusedMat.cols(), seqMat.cols());
+    QVERIFY((fusedMat - seqMat).cwiseAbs().maxCoeff() == 0.0);
+
+    // Same averages
+    QFile seqAveFile(m_tempDir.path() + "/sample_audvis_trunc_seq-ave.fif");
+    QFile fusedAveFile(m_tempDir.path() + "/sample_audvis_trunc_fused-ave.fif");
+    FiffEvokedSet seqAve(seqAveFile);
+    FiffEvokedSet fusedAve(fusedAveFile);
+    QCOMPARE(seqAve.evoked.size(), 1);
+    QCOMPARE(fusedAve.evoked.size(), seqAve.evoked.size());
+    QCOMPARE(fusedAve.evoked[0].nave, seqAve.evoked[0].nave);
+    QCOMPARE(fusedAve.evoked[0].data.cols(), seqAve.evoked[0].data.cols());
+    double aveScale = seqAve.evoked[0].data.cwiseAbs().maxCoeff();
+    QVERIFY(aveScale > 0.0);
+    QVERIFY((fusedAve.evoked[0].data - seqAve.evoked[0].data).cwiseAbs().maxCoeff() <= 1e-6 * aveScale);
+
+    // Same covariance
+    QFile seqCovFile(m_tempDir.path() + "/sample_audvis_trunc_seq-cov.fif");
+    QFile fusedCovFile(m_tempDir.path() + "/sample_audvis_trunc_fused-cov.fif");
+    FiffCov seqCov(seqCovFile);
+    FiffCov fusedCov(fusedCovFile);
+    QVERIFY(seqCov.dim > 0);
+    QCOMPARE(fusedCov.dim, seqCov.dim);
+    QCOMPARE(fusedCov.nfree, seqCov.nfree);
+    double covScale = seqCov.data.cwiseAbs().maxCoeff();
+    QVERIFY((fusedCov.data - seqCov.data).cwiseAbs().maxCoeff() <= 1e-6 * covScale);
+
+    // Same projectors, up to the sign of each vector
+    QList<FiffProj> seqProjs = readProjectors(m_tempDir.path() + "/sample_audvis_trunc_seq-proj.fif");
+    QList<FiffProj> fusedProjs = readProjectors(m_tempDir.path() + "/sample_audvis_trunc_fused-proj.fif");
+    QVERIFY(!seqProjs.isEmpty());
+    QCOMPARE(fusedProjs.size(), seqProjs.size());
+    for (int k = 0; k < seqProjs.size(); ++k) {
+        const MatrixXd &seqVec = seqProjs[k].data->data;
+        const MatrixXd &fusedVec = fusedProjs[k].data->data;
+        QCOMPARE(fusedVec.rows(), seqVec.rows());
+        QCOMPARE(fusedVec.cols(), seqVec.cols());
+        for (int r = 0; r < seqVec.rows(); ++r) {
+            double diff = std::min((fusedVec.row(r) - seqVec.row(r)).cwiseAbs().maxCoeff(),
+                                   (fusedVec.row(r) + seqVec.row(r)).cwiseAbs().maxCoeff());
+            QVERIFY(diff <= 1e-6);
+        }
+    }
+}
+
+//=============================================================================================================
+
+QList<FiffProj> TestBatchProcessor::readProjectors(const QString &fileName)
+{
+    QFile file(fileName);
+    FiffStream::SPtr stream(new FiffStream(&file));
+    if (!stream->open())
+        return QList<FiffProj>();
+
+    QList<FiffProj> projs = stream->read_proj(stream->dirtree());
+    stream->close();
+    return projs;
+}
+
+void TestBatchProcessor::testRunConcurrentJobs()
+{
+    QString rawPath = m_sResourcePath + "MEG/sample/sample_audvis_trunc_raw.fif";
+    if (!QFile::exists(rawPath))
+        QSKIP("Sample raw data not available");
+
+    ProcessingSettings settings;
+    settings.rawFiles << rawPath << rawPath << rawPath;
+    settings.digTriggerMask = 0xFF;
+    settings.aveFiles << m_sAveDescPath;
+    settings.covFiles << m_sCovDescPath;
+    settings.jobs = 3;
+    for (int f = 0; f < settings.rawFiles.size(); ++f)
+        settings.eventsOutFiles << m_tempDir.path() + QString("/concurrent_%1.eve").arg(f);
+
+    for (bool fused : {false, true}) {
+        settings.fused = fused;
+
+        // Concurrent jobs
+        settings.jobs = 3;
+        settings.grandAveFile = m_tempDir.path() + "/concurrent-ave.fif";
+        settings.grandCovFile = m_tempDir.path() + "/concurrent-cov.fif";
+        QCOMPARE(BatchProcessor::run(settings), 0);
+
+        // Every file wrote its own, identical events
+        QFile firstFile(settings.eventsOutFiles[0]);
+        QVERIFY(firstFile.open(QIODevice::ReadOnly));
+        QByteArray first = firstFile.readAll();
+        QVERIFY(!first.isEmpty());
+        for (int f = 1; f < settings.eventsOutFiles.size(); ++f) {
+            QFile file(settings.eventsOutFiles[f]);
+            QVERIFY(file.open(QIODevice::ReadOnly));
+            QCOMPARE(file.readAll(), first);
+        }
+
+        // One file after the other
+        settings.jobs = 1;
+        settings.grandAveFile = m_tempDir.path() + "/single-ave.fif";
+        settings.grandCovFile = m_tempDir.path() + "/single-cov.fif";
+        QCOMPARE(BatchProcessor::run(settings), 0);
+
+        // Same grand average and covariance, as the files are merged in order
+        QFile concurrentAveFile(m_tempDir.path() + "/concurrent-ave.fif");
+        QFile singleAveFile(m_tempDir.path() + "/single-ave.fif");
+        FiffEvokedSet concurrentAve(concurrentAveFile);
+        FiffEvokedSet singleAve(singleAveFile);
+        QCOMPARE(singleAve.evoked.size(), 1);
+        QCOMPARE(concurrentAve.evoked.size(), singleAve.evoked.size());
+        QCOMPARE(concurrentAve.evoked[0].nave, singleAve.evoked[0].nave);
+        QCOMPARE(concurrentAve.evoked[0].data.cols(), singleAve.evoked[0].data.cols());
+        QVERIFY((concurrentAve.evoked[0].data - singleAve.evoked[0].data).cwiseAbs().maxCoeff() == 0.0);
+
+        QFile concurrentCovFile(m_tempDir.path() + "/concurrent-cov.fif");
+        QFile singleCovFile(m_tempDir.path() + "/single-cov.fif");
+        FiffCov concurrentCov(concurrentCovFile);
+        FiffCov singleCov(singleCovFile);
+        QVERIFY(singleCov.dim > 0);
+        QCOMPARE(concurrentCov.dim, singleCov.dim);
+        QCOMPARE(concurrentCov.nfree, singleCov.nfree);
+        QVERIFY((concurrentCov.data - singleCov.data).cwiseAbs().maxCoeff() == 0.0);
+    }
+
+    // A budget below one file still processes them, one at a time
+    settings.jobs = 3;
+    settings.jobMemory = 1;
+    QCOMPARE(BatchProcessor::run(settings), 0);
+}
+
 //=============================================================================================================
 
 void TestBatchProcessor::cleanupTestCase()
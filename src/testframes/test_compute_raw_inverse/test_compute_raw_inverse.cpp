@@ -288,6 +288,9 @@ void TestComputeRawInverse::testInverseDSPM()
     // Verify result is not empty
     QVERIFY2(!m_stcDSPM.isEmpty(), "dSPM inverse returned empty result");
 
+    // The quiet per-block application gives the same solution
+    QVERIFY(minimumNorm.applyInverse(pickedEvoked.data, false).isApprox(m_stcDSPM.data));
+
     // Verify dimensions
     QVERIFY2(m_stcDSPM.data.rows() > 0, "No source vertices in result");
     QVERIFY2(m_stcDSPM.data.cols() > 0, "No time points in result");
@@ -38,6 +38,7 @@
 #include <conn/network/network.h>
 #include <conn/network/networknode.h>
 #include <conn/network/networkedge.h>
+#include <conn/network/networktensor.h>
 
 //=============================================================================================================
 // QT INCLUDES
@@ -111,6 +112,30 @@ private:
         return net;
     }
 
+    //=========================================================================================================
+    /**
+     * Build the diamond graph in compact form.
+     */
+    Network buildDiamondCompact()
+    {
+        Network net("TestCorrelation", 0.0);
+
+        net.append(QSharedPointer<NetworkNode>::create(0, RowVectorXf::Zero(3)));
+        net.append(QSharedPointer<NetworkNode>::create(1, (RowVectorXf(3) << 1,0,0).finished()));
+        net.append(QSharedPointer<NetworkNode>::create(2, (RowVectorXf(3) << 0,1,0).finished()));
+        net.append(QSharedPointer<NetworkNode>::create(3, (RowVectorXf(3) << 1,1,0).finished()));
+
+        NetworkTensor tensor(4, 1);
+        tensor.setEdgeWeights(0, 1, VectorXd::Constant(1, 0.8));
+        tensor.setEdgeWeights(0, 2, VectorXd::Constant(1, 0.5));
+        tensor.setEdgeWeights(1, 3, VectorXd::Constant(1, 0.3));
+        tensor.setEdgeWeights(3, 2, VectorXd::Constant(1, 0.6));
+
+        net.setTensor(tensor);
+
+        return net;
+    }
+
 private slots:
 
     //=========================================================================================================
@@ -698,6 +723,127 @@ private slots:
         QCOMPARE(C(1,0), 0.0);
         QVERIFY(qAbs(C(0,1) - 0.8) < 1e-10);
     }
+
+    //=========================================================================================================
+    // Compact storage tests
+    //=========================================================================================================
+
+    void testTensorEdgeIndex()
+    {
+        NetworkTensor tensor(5, 2);
+        QCOMPARE(int(tensor.getNumberEdges()), 10);
+
+        // Upper triangular order without the diagonal, independent of the node order
+        QCOMPARE(int(tensor.edgeIndex(0, 1)), 0);
+        QCOMPARE(int(tensor.edgeIndex(0, 4)), 3);
+        QCOMPARE(int(tensor.edgeIndex(1, 2)), 4);
+        QCOMPARE(int(tensor.edgeIndex(4, 3)), 9);
+        QCOMPARE(int(tensor.edgeIndex(2, 1)), int(tensor.edgeIndex(1, 2)));
+    }
+
+    void testTensorFrequencyBins()
+    {
+        NetworkTensor tensor(3, 4);
+        tensor.setNodeWeights(0, (MatrixXd(2,4) << 1,2,3,4, 5,6,7,8).finished());
+        tensor.setEdgeWeights(2, 1, (VectorXd(4) << 0,0,4,8).finished());
+
+        QVERIFY(qAbs(tensor.getWeight(0, 1) - 2.5) < 1e-10);
+        QVERIFY(qAbs(tensor.getWeight(1, 2) - 3.0) < 1e-10);
+
+        tensor.setFrequencyBins(QPair<int,int>(2, 3));
+        QVERIFY(qAbs(tensor.getWeight(0, 2) - 7.5) < 1e-10);
+        QVERIFY(qAbs(tensor.getWeight(2, 1) - 6.0) < 1e-10);
+
+        tensor.setThreshold(7.0);
+        QCOMPARE(int(tensor.getThresholdedEdges().nonZeros()), 1);
+        QVERIFY(tensor.getThresholdedDegrees() == (VectorXi(3) << 1,0,1).finished());
+    }
+
+    void testCompactMatchesEdgeList()
+    {
+        Network net = buildDiamond();
+        Network compact = buildDiamondCompact();
+
+        QVERIFY(compact.isCompact());
+        QVERIFY(!compact.isEmpty());
+        QVERIFY(compact.getFullConnectivityMatrix(true) == net.getFullConnectivityMatrix(true));
+        QVERIFY(compact.getFullConnectivityMatrix(false) == net.getFullConnectivityMatrix(false));
+
+        net.setThreshold(0.4);
+        compact.setThreshold(0.4);
+
+        QVERIFY(compact.getThresholdedConnectivityMatrix() == net.getThresholdedConnectivityMatrix());
+        QVERIFY(compact.getThresholdedDegrees() == net.getThresholdedDegrees());
+        QVERIFY(compact.getMinMaxThresholdedDegrees() == net.getMinMaxThresholdedDegrees());
+    }
+
+    void testCompactEdgeViews()
+    {
+        Network net = buildDiamondCompact();
+        net.setThreshold(0.4);
+
+        // All node pairs are stored, including the ones without a connection
+        QCOMPARE(net.getFullEdges().size(), 6);
+        QCOMPARE(net.getThresholdedEdges().size(), 3);
+        QVERIFY(qAbs(net.getEdgeAt(0)->getWeight() - 0.8) < 1e-10);
+        QCOMPARE(net.getNodeAt(0)->getThresholdedDegree(), qint16(2));
+
+        // Existing views follow later threshold changes
+        net.setThreshold(0.7);
+        QCOMPARE(net.getThresholdedEdges().size(), 1);
+        QVERIFY(!net.getEdgeAt(1)->isActive());
+    }
+
+    void testCompactCopiesDoNotShareEdges()
+    {
+        Network net = buildDiamondCompact();
+        Network netCopy = net;
+
+        // Both networks create their own views, the degrees must not add up. All other nodes are neighbors.
+        QCOMPARE(net.getNodes().at(0)->getFullDegree(), qint16(3));
+        QCOMPARE(netCopy.getNodeAt(0)->getFullDegree(), qint16(3));
+        QCOMPARE(net.getNodeAt(0)->getFullDegree(), qint16(3));
+        QVERIFY(net.getNodeAt(0) != netCopy.getNodeAt(0));
+        QCOMPARE(net.getNodes().at(3)->getId(), qint16(3));
+
+        // A threshold change of the copy leaves the views of the original alone
+        net.setThreshold(0.4);
+        netCopy.setThreshold(0.7);
+        QCOMPARE(net.getNodeAt(0)->getThresholdedDegree(), qint16(2));
+        QCOMPARE(netCopy.getNodeAt(0)->getThresholdedDegree(), qint16(1));
+    }
+
+    void testCompactNodesWithoutEdgeViews()
+    {
+        Network net = buildDiamond();
+        Network compact = buildDiamondCompact();
+        net.setThreshold(0.4);
+        compact.setThreshold(0.4);
+
+        // Positions and degrees come from the nodes and the tensor
+        QCOMPARE(compact.getNumberNodes(), 4);
+        QCOMPARE(int(compact.getNumberFullEdges()), 6);
+        QVERIFY(compact.getNodeVertices() == net.getNodeVertices());
+        QVERIFY(compact.getNodeVertices().row(3) == (RowVectorXf(3) << 1,1,0).finished());
+        QCOMPARE(compact.getThresholdedDistribution(), net.getThresholdedDistribution());
+        QCOMPARE(compact.getFullDistribution(), qint16(12));
+        QVERIFY(compact.getMinMaxFullDegrees() == QPair<int,int>(3,3));
+        QVERIFY(compact.getMinMaxFullIndegrees() == QPair<int,int>(0,3));
+        QVERIFY(compact.getMinMaxFullOutdegrees() == QPair<int,int>(0,3));
+        QVERIFY(compact.getMinMaxThresholdedIndegrees() == net.getMinMaxThresholdedIndegrees());
+        QVERIFY(compact.getMinMaxThresholdedOutdegrees() == net.getMinMaxThresholdedOutdegrees());
+        QVERIFY(compact.getTensor().getThresholdedIndegrees() == (VectorXi(4) << 0,1,1,1).finished());
+        QVERIFY(compact.getTensor().getThresholdedOutdegrees() == (VectorXi(4) << 2,0,1,0).finished());
+
+        // The edges of the nodes are created when one of them asks for its edges
+        const auto& nodes = compact.getNodes();
+        QCOMPARE(nodes.size(), 4);
+        QCOMPARE(nodes.at(2)->getId(), qint16(2));
+        QCOMPARE(nodes.at(2)->getThresholdedDegree(), qint16(2));
+        QCOMPARE(nodes.at(1)->getFullEdges().size(), 3);
+        QCOMPARE(compact.getThresholdedEdges().size(), 3);
+        QVERIFY(compact.getNodes().at(1) == nodes.at(1));
+    }
 };
 
 QTEST_GUILESS_MAIN(TestConnNetwork)
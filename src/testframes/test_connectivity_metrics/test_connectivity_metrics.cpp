@@ -4,6 +4,15 @@
 #include <conn/connectivitysettings.h>
 #include <conn/network/network.h>
 #include <conn/metrics/correlation.h>
+#include <conn/metrics/coherence.h>
+#include <conn/metrics/imagcoherence.h>
+#include <conn/metrics/phaselagindex.h>
+#include <conn/metrics/weightedphaselagindex.h>
+#include <conn/metrics/unbiasedsquaredphaselagindex.h>
+#include <conn/metrics/debiasedsquaredweightedphaselagindex.h>
+#include <conn/metrics/phaselockingvalue.h>
+#include <conn/metrics/multimetric.h>
+#include <conn/metrics/slidingwindowmetric.h>
 
 using namespace CONNLIB;
 using namespace Eigen;
@@ -325,6 +334,118 @@ private slots:
         QList<Network> networks = Connectivity::calculate(settings);
         QCOMPARE(networks.size(), 3);
     }
+
+    void testMultiMetricMatchesSeparateMetrics()
+    {
+        AbstractMetric::m_iNumberBinStart = -1;
+        AbstractMetric::m_iNumberBinAmount = -1;
+
+        ConnectivitySettings settings;
+        for(int i = 0; i < 5; ++i) {
+            settings.append(MatrixXd::Random(4, 200));
+        }
+        settings.setSamplingFrequency(1000);
+        settings.setFFTSize(128);
+        settings.setWindowType("hanning");
+
+        MatrixX3f nodePos(4, 3);
+        nodePos << 0,0,0, 1,0,0, 0,1,0, 0,0,1;
+        settings.setNodePositions(nodePos);
+
+        QStringList methods = MultiMetric::supportedMethods();
+        QList<Network> shared = MultiMetric::calculate(settings, methods);
+        QCOMPARE(shared.size(), methods.size());
+
+        for(int i = 0; i < methods.size(); ++i) {
+            settings.clearIntermediateData();
+
+            Network separate;
+            if(methods.at(i) == "COH") {
+                separate = Coherence::calculate(settings);
+            } else if(methods.at(i) == "IMAGCOH") {
+                separate = ImagCoherence::calculate(settings);
+            } else if(methods.at(i) == "PLI") {
+                separate = PhaseLagIndex::calculate(settings);
+            } else if(methods.at(i) == "WPLI") {
+                separate = WeightedPhaseLagIndex::calculate(settings);
+            } else if(methods.at(i) == "USPLI") {
+                separate = UnbiasedSquaredPhaseLagIndex::calculate(settings);
+            } else if(methods.at(i) == "DSWPLI") {
+                separate = DebiasedSquaredWeightedPhaseLagIndex::calculate(settings);
+            } else if(methods.at(i) == "PLV") {
+                separate = PhaseLockingValue::calculate(settings);
+            }
+
+            QCOMPARE(shared.at(i).getConnectivityMethod(), methods.at(i));
+            QCOMPARE(shared.at(i).getFullEdges().size(), separate.getFullEdges().size());
+
+            MatrixXd matShared = shared.at(i).getFullConnectivityMatrix();
+            MatrixXd matSeparate = separate.getFullConnectivityMatrix();
+            QCOMPARE(matShared.rows(), matSeparate.rows());
+            QVERIFY((matShared - matSeparate).cwiseAbs().maxCoeff() < 1e-10);
+        }
+
+        AbstractMetric::m_iNumberBinStart = -1;
+        AbstractMetric::m_iNumberBinAmount = -1;
+    }
+
+    void testSlidingWindowMatchesMultiMetric()
+    {
+        AbstractMetric::m_iNumberBinStart = -1;
+        AbstractMetric::m_iNumberBinAmount = -1;
+
+        ConnectivitySettings settings;
+        settings.setSamplingFrequency(1000);
+        settings.setFFTSize(128);
+        settings.setWindowType("hanning");
+
+        MatrixX3f nodePos(4, 3);
+        nodePos << 0,0,0, 1,0,0, 0,1,0, 0,0,1;
+        settings.setNodePositions(nodePos);
+
+        QList<MatrixXd> lTrials;
+        for(int i = 0; i < 9; ++i) {
+            lTrials.append(MatrixXd::Random(4, 200));
+        }
+
+        QVERIFY(SlidingWindowMetric::supports(MultiMetric::supportedMethods()));
+        QVERIFY(!SlidingWindowMetric::supports(QStringList() << "COR"));
+
+        // Append all trials, so that the first four get evicted
+        SlidingWindowMetric slidingWindow(5);
+        for(const MatrixXd& matTrial : lTrials) {
+            slidingWindow.append(matTrial, settings);
+        }
+        QCOMPARE(slidingWindow.size(), 5);
+
+        ConnectivitySettings lastTrials = settings;
+        lastTrials.clearAllData();
+        for(int i = lTrials.size() - 5; i < lTrials.size(); ++i) {
+            lastTrials.append(lTrials.at(i));
+        }
+
+        QStringList methods = MultiMetric::supportedMethods();
+        QList<Network> incremental = slidingWindow.getNetworks(settings, methods);
+        QList<Network> reference = MultiMetric::calculate(lastTrials, methods);
+        QCOMPARE(incremental.size(), methods.size());
+        QCOMPARE(reference.size(), methods.size());
+
+        for(int i = 0; i < methods.size(); ++i) {
+            QCOMPARE(incremental.at(i).getConnectivityMethod(), methods.at(i));
+
+            MatrixXd matIncremental = incremental.at(i).getFullConnectivityMatrix();
+            MatrixXd matReference = reference.at(i).getFullConnectivityMatrix();
+            QCOMPARE(matIncremental.rows(), matReference.rows());
+            QVERIFY((matIncremental - matReference).cwiseAbs().maxCoeff() < 1e-8);
+        }
+
+        // A trial with a different number of channels restarts the window
+        slidingWindow.append(MatrixXd::Random(3, 200), settings);
+        QCOMPARE(slidingWindow.size(), 1);
+
+        AbstractMetric::m_iNumberBinStart = -1;
+        AbstractMetric::m_iNumberBinAmount = -1;
+    }
 };
 
 QTEST_GUILESS_MAIN(TestConnectivityMetrics)
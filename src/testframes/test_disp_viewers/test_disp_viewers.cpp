@@ -73,6 +73,7 @@
 
 #include <QtTest>
 #include <QApplication>
+#include <QCheckBox>
 #include <QStringList>
 #include <QMap>
 
@@ -262,7 +263,13 @@ void TestDispViewers::scalingView_constructAndGetSet()
     view.setGuiMode(AbstractView::GuiMode::Clinical);
     view.setGuiMode(AbstractView::GuiMode::Research);
     view.setProcessingMode(AbstractView::ProcessingMode::RealTime);
+
+    // The low latency option only applies to streamed data
+    QCheckBox* pLowLatency = view.findChild<QCheckBox*>("m_pCheckBoxLowLatency");
+    QVERIFY(pLowLatency);
+    QVERIFY(!pLowLatency->isHidden());
     view.setProcessingMode(AbstractView::ProcessingMode::Offline);
+    QVERIFY(pLowLatency->isHidden());
     view.saveSettings();
     view.loadSettings();
     view.clearView();
@@ -1048,6 +1048,9 @@ void TestDispViewers2::rtFiffRawViewModel_extended()
     // Safe setters that don't require FiffInfo
     model.setFilterActive(true);
     model.setFilterActive(false);
+    model.setFilterLowLatency(true);
+    QCOMPARE(model.getCurrentOverlapAddDelay(), 0);
+    model.setFilterLowLatency(false);
 
     model.setBackgroundColor(Qt::white);
     model.setBackgroundColor(Qt::black);
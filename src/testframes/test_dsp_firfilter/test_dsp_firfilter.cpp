@@ -37,6 +37,9 @@
 
 #include <dsp/firfilter.h>
 #include <dsp/filterkernel.h>
+#include <dsp/rt/rt_fir_engine.h>
+#include <dsp/rt/rt_streaming_fir.h>
+#include <dsp/rt/rt_filter.h>
 
 //=============================================================================================================
 // EIGEN INCLUDES
@@ -55,6 +58,7 @@
 //=============================================================================================================
 
 using namespace UTILSLIB;
+using namespace RTPROCESSINGLIB;
 using namespace Eigen;
 
 //=============================================================================================================
@@ -147,6 +151,18 @@ private slots:
     //=========================================================================================================
     /** ParksMcClellan design method produces a valid kernel. */
     void design_parksMcClellan_producesValidKernel();
+
+    //=========================================================================================================
+    /** FirFilterEngine::filterBlock() matches FilterKernel::applyFftFilter() per channel and only touches picks. */
+    void firEngine_matchesPerChannelFftFilter();
+
+    //=========================================================================================================
+    /** StreamingFirFilter fed with blocks of any size, then flushed, matches the one-shot zero-phase result. */
+    void streamingFir_arbitraryBlocks_matchOneShot();
+
+    //=========================================================================================================
+    /** FilterOverlapAdd::calculate() fed block by block matches filterData() on the whole data. */
+    void overlapAdd_blocks_matchFilterData();
 };
 
 //=============================================================================================================
@@ -336,5 +352,111 @@ void TestDspFirFilter::design_parksMcClellan_producesValidKernel()
 
 //=============================================================================================================
 
+void TestDspFirFilter::firEngine_matchesPerChannelFftFilter()
+{
+    const int nCh = 70, nSamp = 1000;
+    FilterKernel k = FirFilter::design(128, FirFilter::BandPass, 1.0, 40.0, 1000.0, 5.0, FirFilter::Cosine);
+
+    MatrixXd data = MatrixXd::Random(nCh, nSamp);
+    RowVectorXi picks(nCh - 1);
+    for (int i = 0; i < picks.size(); ++i)
+        picks(i) = i + 1;
+
+    FirFilterEngine engine(QList<FilterKernel>() << k);
+    engine.setBatchSize(4);
+    MatrixXd out;
+    engine.filterBlock(data, picks, out);
+
+    const int iOrder = k.getCoefficients().cols();
+    QCOMPARE(engine.getFilterOrder(), iOrder);
+    QCOMPARE(out.rows(), nCh);
+    QCOMPARE(out.cols(), nSamp + iOrder);
+
+    for (int ch = 1; ch < nCh; ++ch) {
+        RowVectorXd ref = data.row(ch);
+        k.applyFftFilter(ref, true);
+        QVERIFY((out.row(ch) - ref).norm() < 1e-10 * ref.norm());
+    }
+
+    // The unpicked row is only delayed
+    QVERIFY((out.row(0).segment(iOrder / 2, nSamp) - data.row(0)).norm() < 1e-14);
+}
+
+//=============================================================================================================
+
+void TestDspFirFilter::streamingFir_arbitraryBlocks_matchOneShot()
+{
+    const int nCh = 5, nSamp = 3000;
+    FilterKernel k = FirFilter::design(256, FirFilter::LowPass, 40.0, 0.0, 1000.0, 5.0, FirFilter::Cosine);
+
+    MatrixXd data = MatrixXd::Random(nCh, nSamp);
+    RowVectorXi picks(nCh - 1);
+    for (int i = 0; i < picks.size(); ++i)
+        picks(i) = i;
+
+    StreamingFirFilter filter(k, picks);
+    const int iDelay = filter.getGroupDelay();
+    QCOMPARE(iDelay, k.getCoefficients().cols() / 2);
+
+    // Block sizes below and above the filter order
+    MatrixXd streamed(nCh, nSamp + iDelay);
+    MatrixXd block;
+    int iPos = 0;
+    const int blockSizes[] = {1, 17, 100, 513, 1000};
+    for (int b = 0; iPos < nSamp; ++b) {
+        const int n = std::min(blockSizes[b % 5], nSamp - iPos);
+        filter.process(data.middleCols(iPos, n), block);
+        QCOMPARE(block.cols(), n);
+        streamed.middleCols(iPos, n) = block;
+        iPos += n;
+    }
+    filter.flush(block);
+    QCOMPARE(block.cols(), iDelay);
+    streamed.rightCols(iDelay) = block;
+
+    for (int ch = 0; ch < nCh - 1; ++ch) {
+        RowVectorXd ref = data.row(ch);
+        k.applyFftFilter(ref);
+        QVERIFY((streamed.row(ch).tail(nSamp) - ref).norm() < 1e-10 * ref.norm());
+    }
+
+    // The unpicked channel is delayed by the same amount
+    QVERIFY((streamed.row(nCh - 1).tail(nSamp) - data.row(nCh - 1)).norm() < 1e-14);
+}
+
+//=============================================================================================================
+
+void TestDspFirFilter::overlapAdd_blocks_matchFilterData()
+{
+    const int nCh = 6, nSamp = 4000;
+    FilterKernel k = FirFilter::design(128, FirFilter::BandPass, 1.0, 40.0, 1000.0, 5.0, FirFilter::Cosine);
+    const int iOrder = k.getFilterOrder();
+
+    MatrixXd data = MatrixXd::Random(nCh, nSamp);
+    RowVectorXi picks(nCh - 1);
+    for (int i = 0; i < picks.size(); ++i)
+        picks(i) = i;
+
+    const MatrixXd ref = filterData(data, k, picks, false, true);
+    QCOMPARE(ref.cols(), nSamp + iOrder);
+
+    // Blocks filtered in one piece and blocks split into slices, the tail of each block added to the next
+    FilterOverlapAdd filter;
+    MatrixXd streamed(nCh, nSamp);
+    int iPos = 0;
+    const int blockSizes[] = {200, 1000, 300, 700};
+    for (int b = 0; iPos < nSamp; ++b) {
+        const int n = std::min(blockSizes[b % 4], nSamp - iPos);
+        MatrixXd block = filter.calculate(data.middleCols(iPos, n), k, picks, true, false, false);
+        QCOMPARE(block.cols(), n);
+        streamed.middleCols(iPos, n) = block;
+        iPos += n;
+    }
+
+    QVERIFY((streamed - ref.leftCols(nSamp)).norm() < 1e-10 * ref.norm());
+}
+
+//=============================================================================================================
+
 QTEST_MAIN(TestDspFirFilter)
 #include "test_dsp_firfilter.moc"
@@ -37,8 +37,11 @@
 #include <cmath>
 
 #include <dsp/iirfilter.h>
+#include <dsp/firfilter.h>
+#include <dsp/rt/rt_streaming_iir.h>
 
 using namespace UTILSLIB;
+using namespace RTPROCESSINGLIB;
 using namespace Eigen;
 
 //=============================================================================================================
@@ -237,6 +240,102 @@ private slots:
         auto sos = IirFilter::designButterworth(0, IirFilter::LowPass, 40.0, 0.0, 1000.0);
         QVERIFY(sos.isEmpty());
     }
+
+    //=========================================================================
+    // Streaming: blocks of any size match one causal pass per channel
+    //=========================================================================
+    void streaming_blocksMatchApplySos()
+    {
+        auto sos = IirFilter::designButterworth(4, IirFilter::BandPass, 1.0, 40.0, 1000.0);
+
+        // 19 channels: two full lane groups and a remainder
+        const int nChannels = 19;
+        const int N = 1500;
+        MatrixXd data = MatrixXd::Random(nChannels, N);
+
+        MatrixXd expected(nChannels, N);
+        for (int c = 0; c < nChannels; ++c) {
+            expected.row(c) = IirFilter::applySos(data.row(c), sos);
+        }
+
+        StreamingIirFilter filter(sos);
+        MatrixXd result(nChannels, N);
+        MatrixXd block;
+        int pos = 0;
+        for (int n : {1, 3, 64, 250, 7, 1000, 175}) {
+            filter.process(data.middleCols(pos, n), block);
+            result.middleCols(pos, n) = block;
+            pos += n;
+        }
+        QCOMPARE(pos, N);
+        QVERIFY2((result - expected).cwiseAbs().maxCoeff() < 1e-12,
+                 qPrintable(QString("max diff %1").arg((result - expected).cwiseAbs().maxCoeff())));
+    }
+
+    void streaming_picksKeepOtherChannels()
+    {
+        auto sos = IirFilter::designButterworth(3, IirFilter::HighPass, 5.0, 0.0, 500.0);
+        MatrixXd data = MatrixXd::Random(6, 400);
+
+        RowVectorXi picks(3);
+        picks << 4, 0, 2;
+        StreamingIirFilter filter(sos, picks);
+        MatrixXd first = filter.process(data.leftCols(150));
+        MatrixXd second = filter.process(data.rightCols(250));
+
+        for (int c = 0; c < data.rows(); ++c) {
+            RowVectorXd row(400);
+            row << first.row(c), second.row(c);
+            if (c == 0 || c == 2 || c == 4) {
+                QVERIFY((row - IirFilter::applySos(data.row(c), sos)).cwiseAbs().maxCoeff() < 1e-12);
+            } else {
+                QVERIFY(row == data.row(c));
+            }
+        }
+    }
+
+    void streaming_inPlaceAndReset()
+    {
+        auto sos = IirFilter::designButterworth(2, IirFilter::LowPass, 30.0, 0.0, 1000.0);
+        MatrixXd data = MatrixXd::Random(9, 300);
+
+        StreamingIirFilter filter(sos);
+        MatrixXd inPlace = data;
+        filter.process(inPlace, inPlace);
+
+        // After reset, the same block gives the same result again
+        filter.reset();
+        MatrixXd again = filter.process(data);
+        QVERIFY((inPlace - again).cwiseAbs().maxCoeff() == 0.0);
+
+        // Without reset the delay lines carry on, so the result differs
+        MatrixXd carried = filter.process(data);
+        QVERIFY((carried - again).cwiseAbs().maxCoeff() > 0.0);
+
+        // Setting the same sections keeps the state, setting none passes the data through
+        filter.setSections(sos);
+        QCOMPARE(filter.getSections().size(), sos.size());
+        filter.setSections(QVector<IirBiquad>());
+        QVERIFY(filter.process(data) == data);
+    }
+
+    void streaming_designFromKernel()
+    {
+        FilterKernel bp = FirFilter::design(128, FirFilter::BandPass, 1.0, 40.0, 500.0);
+        auto fromKernel = StreamingIirFilter::designFromKernel(bp, 4);
+        auto direct = IirFilter::designButterworth(4, IirFilter::BandPass, 1.0, 40.0, 500.0);
+
+        QCOMPARE(fromKernel.size(), direct.size());
+        for (int i = 0; i < direct.size(); ++i) {
+            QVERIFY(std::abs(fromKernel[i].b0 - direct[i].b0) < 1e-9);
+            QVERIFY(std::abs(fromKernel[i].a1 - direct[i].a1) < 1e-9);
+            QVERIFY(std::abs(fromKernel[i].a2 - direct[i].a2) < 1e-9);
+        }
+
+        FilterKernel lp = FirFilter::design(128, FirFilter::LowPass, 40.0, 0.0, 500.0);
+        QCOMPARE(StreamingIirFilter::designFromKernels(QList<FilterKernel>() << lp << bp, 4).size(),
+                 IirFilter::designButterworth(4, IirFilter::LowPass, 40.0, 0.0, 500.0).size() + direct.size());
+    }
 };
 
 QTEST_MAIN(TestDspIirFilter)
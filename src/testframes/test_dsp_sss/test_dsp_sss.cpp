@@ -33,6 +33,7 @@
  */
 
 #include <QtTest/QtTest>
+#include <QTemporaryFile>
 #include <Eigen/Dense>
 #include <cmath>
 
@@ -40,6 +41,8 @@
 #include <fiff/fiff_info.h>
 #include <fiff/fiff_ch_info.h>
 #include <fiff/fiff_constants.h>
+#include <fiff/fiff_raw_data.h>
+#include <fiff/fiff_stream.h>
 
 using namespace UTILSLIB;
 using namespace FIFFLIB;
@@ -248,6 +251,93 @@ private slots:
         QCOMPARE(out.rows(), data.rows());
         QCOMPARE(out.cols(), data.cols());
     }
+
+    void applyTemporal_matchesDirectProjection()
+    {
+        FiffInfo info = makeSyntheticMegInfo(102);
+        SSS::Basis basis = SSS::computeBasis(info, SSS::Params());
+
+        // Random data plus a strong artefact seen by both the internal and the external expansion
+        const int nSamp = 1300, bufLen = 500;
+        MatrixXd data = MatrixXd::Random(102, nSamp);
+        RowVectorXd artefact = RowVectorXd::Random(nSamp) * 50.0;
+        data += (basis.matSout.col(1) + 0.5 * basis.matSin.col(2)) * artefact;
+
+        // Reference: SVD of the external coefficients and explicit winLen x winLen projector
+        MatrixXd cIn  = basis.matPinvAll.topRows(basis.iNin) * data;
+        MatrixXd cOut = basis.matPinvAll.bottomRows(basis.iNout) * data;
+        for (int offset = 0; offset < nSamp; offset += bufLen) {
+            int winLen = std::min(bufLen, nSamp - offset);
+            JacobiSVD<MatrixXd> svd(cOut.middleCols(offset, winLen), ComputeThinV);
+            const VectorXd& sv = svd.singularValues();
+            int nRemove = 0;
+            while (nRemove < sv.size() && sv(nRemove) / sv(0) > 0.9) {
+                ++nRemove;
+            }
+            QVERIFY(nRemove > 0);
+            MatrixXd Vr = svd.matrixV().leftCols(nRemove);
+            MatrixXd cInWin = cIn.middleCols(offset, winLen);
+            cIn.middleCols(offset, winLen) = cInWin - cInWin * (Vr * Vr.transpose());
+        }
+        MatrixXd expected = basis.matSin * cIn;
+
+        MatrixXd serial   = SSS::applyTemporal(data, basis, bufLen, 0.9, false);
+        MatrixXd threaded = SSS::applyTemporal(data, basis, bufLen, 0.9, true);
+
+        QVERIFY((serial - expected).norm() / expected.norm() < 1e-8);
+        QVERIFY((threaded - serial).norm() == 0.0);
+    }
+
+    void applyTemporalFile_matchesInMemory()
+    {
+        FiffInfo info = makeSyntheticMegInfo(102);
+        SSS::Basis basis = SSS::computeBasis(info, SSS::Params());
+
+        const int nSamp = 2300, bufLen = 500;
+        MatrixXd data = MatrixXd::Random(102, nSamp);
+        RowVectorXd artefact = RowVectorXd::Random(nSamp) * 50.0;
+        data += (basis.matSout.col(1) + 0.5 * basis.matSin.col(2)) * artefact;
+
+        // Write the input raw file
+        QTemporaryFile inFile;
+        QVERIFY(inFile.open());
+        RowVectorXd cals;
+        FiffStream::SPtr pStream = FiffStream::start_writing_raw(inFile, info, cals);
+        QVERIFY(pStream);
+        for (int col = 0; col < nSamp; col += 1000) {
+            QVERIFY(pStream->write_raw_buffer(data.middleCols(col, std::min(1000, nSamp - col)), cals));
+        }
+        pStream->finish_writing_raw();
+        inFile.close();
+
+        QFile inRaw(inFile.fileName());
+        FiffRawData raw(inRaw);
+        QVERIFY(!raw.isEmpty());
+
+        MatrixXd input, times;
+        QVERIFY(raw.read_raw_segment(input, times, raw.first_samp, raw.last_samp));
+        QCOMPARE(input.cols(), static_cast<Index>(nSamp));
+        MatrixXd expected = SSS::applyTemporal(input, basis, bufLen, 0.9);
+
+        // Windowed from file with several workers
+        QTemporaryFile outFile;
+        QVERIFY(outFile.open());
+        QVERIFY(SSS::applyTemporalFile(outFile, raw, basis, bufLen, 0.9, 3));
+        outFile.close();
+
+        QFile outRaw(outFile.fileName());
+        FiffRawData rawOut(outRaw);
+        MatrixXd output;
+        QVERIFY(rawOut.read_raw_segment(output, times, rawOut.first_samp, rawOut.last_samp));
+        QCOMPARE(output.rows(), expected.rows());
+        QCOMPARE(output.cols(), expected.cols());
+
+        // Data are stored as floats
+        for (Index r = 0; r < expected.rows(); ++r) {
+            double dScale = std::max(expected.row(r).cwiseAbs().maxCoeff(), 1e-30);
+            QVERIFY((output.row(r) - expected.row(r)).cwiseAbs().maxCoeff() / dScale < 1e-5);
+        }
+    }
 };
 
 QTEST_MAIN(TestDspSss)
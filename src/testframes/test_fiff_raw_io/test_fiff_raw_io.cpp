@@ -18,6 +18,7 @@
 #include <QDir>
 #include <QBuffer>
 #include <QTemporaryFile>
+#include <QElapsedTimer>
 #include <Eigen/Dense>
 
 #include <utils/generics/mne_logger.h>
@@ -220,6 +221,131 @@ private slots:
         QVERIFY(nChunks > 1);
     }
 
+    void fiffRawData_mappedMatchesStream()
+    {
+        if (!hasData()) QSKIP("No test data");
+
+        QFile file(m_sDataPath + "/MEG/sample/sample_audvis_trunc_raw.fif");
+        FiffRawData raw(file);
+
+        QFile fileMapped(m_sDataPath + "/MEG/sample/sample_audvis_trunc_raw.fif");
+        FiffRawData rawMapped;
+        QVERIFY(FiffStream::setup_read_raw(fileMapped, rawMapped, true, false, true));
+        QVERIFY(rawMapped.isMapped());
+
+        // Segment spanning several buffers and starting inside one
+        fiff_int_t from = raw.first_samp + 37;
+        fiff_int_t to = qMin(from + (fiff_int_t)(raw.info.sfreq * 1.5), raw.last_samp);
+
+        MatrixXd data, times, dataMapped, timesMapped;
+        QVERIFY(raw.read_raw_segment(data, times, from, to));
+        QVERIFY(rawMapped.read_raw_segment(dataMapped, timesMapped, from, to));
+        QCOMPARE(dataMapped.rows(), data.rows());
+        QCOMPARE(dataMapped.cols(), data.cols());
+        QVERIFY(dataMapped.isApprox(data));
+        QVERIFY(timesMapped.isApprox(times));
+
+        // Channel selection
+        RowVectorXi picks = raw.info.pick_types(true, true, true);
+        QVERIFY(raw.read_raw_segment(data, times, from, to, picks));
+        QVERIFY(rawMapped.read_raw_segment(dataMapped, timesMapped, from, to, picks));
+        QVERIFY(dataMapped.isApprox(data));
+
+        // Projection
+        RowVectorXi megPicks = raw.info.pick_types(true, false, false);
+        raw.proj = MatrixXd::Identity(raw.info.nchan, raw.info.nchan);
+        rawMapped.proj = raw.proj;
+        SparseMatrix<double> mult, multMapped;
+        QVERIFY(raw.read_raw_segment(data, times, mult, from, to, megPicks));
+        QVERIFY(rawMapped.read_raw_segment(dataMapped, timesMapped, multMapped, from, to, megPicks));
+        QVERIFY(dataMapped.isApprox(data));
+        QVERIFY(MatrixXd(multMapped).isApprox(MatrixXd(mult)));
+
+        // A buffer tag shorter than its samples is rejected instead of read into the next tag
+        FiffDirEntry::SPtr pEnt = rawMapped.rawdir.first().ent;
+        QVERIFY(pEnt);
+        const fiff_int_t iSize = pEnt->size;
+        pEnt->size = iSize / 2;
+        QVERIFY(!rawMapped.read_raw_segment(dataMapped, timesMapped, rawMapped.first_samp, rawMapped.first_samp + 10));
+        pEnt->size = iSize;
+        QVERIFY(rawMapped.read_raw_segment(dataMapped, timesMapped, rawMapped.first_samp, rawMapped.first_samp + 10));
+
+        rawMapped.unmapFile();
+        QVERIFY(!rawMapped.isMapped());
+    }
+
+    void fiffRawData_operatorCacheTracksProj()
+    {
+        if (!hasData()) QSKIP("No test data");
+
+        QFile file(m_sDataPath + "/MEG/sample/sample_audvis_trunc_raw.fif");
+        FiffRawData raw(file);
+
+        fiff_int_t from = raw.first_samp;
+        fiff_int_t to = qMin(raw.first_samp + (fiff_int_t)(raw.info.sfreq), raw.last_samp);
+
+        MatrixXd dataRef, times;
+        QVERIFY(raw.read_raw_segment(dataRef, times, from, to));
+
+        // Identity projection must give the same data, repeated reads must hit the cached operator
+        raw.proj = MatrixXd::Identity(raw.info.nchan, raw.info.nchan);
+        MatrixXd data;
+        for (int i = 0; i < 3; ++i) {
+            QVERIFY(raw.read_raw_segment(data, times, from, to));
+            QVERIFY(data.isApprox(dataRef));
+        }
+
+        // Changing the projector in place must invalidate the cached operator
+        raw.proj(0, 0) = 0.0;
+        QVERIFY(raw.read_raw_segment(data, times, from, to));
+        QVERIFY(data.row(0).isZero());
+        QVERIFY(data.bottomRows(data.rows() - 1).isApprox(dataRef.bottomRows(dataRef.rows() - 1)));
+
+        // So must changing the calibration
+        raw.proj = MatrixXd();
+        raw.cals *= 2.0;
+        QVERIFY(raw.read_raw_segment(data, times, from, to));
+        QVERIFY(data.isApprox(2.0 * dataRef));
+    }
+
+    void fiffRawData_benchmarkMappedRead()
+    {
+        if (!hasData()) QSKIP("No test data");
+
+        QFile file(m_sDataPath + "/MEG/sample/sample_audvis_trunc_raw.fif");
+        FiffRawData raw(file);
+        FiffRawData rawMapped(raw);
+        QVERIFY(rawMapped.mapFile());
+
+        // Read the whole file in 1 s windows, as the browsers and batch tools do
+        fiff_int_t quantum = (fiff_int_t)raw.info.sfreq;
+        auto readAll = [&](const FiffRawData& r) {
+            MatrixXd data, times;
+            for (fiff_int_t from = r.first_samp; from <= r.last_samp; from += quantum) {
+                r.read_raw_segment(data, times, from, qMin(from + quantum - 1, r.last_samp));
+            }
+        };
+
+        double dMBytes = 0.0;
+        for (const FiffRawDir& dir : raw.rawdir) {
+            if (dir.ent) {
+                dMBytes += dir.ent->size / (1024.0 * 1024.0);
+            }
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        readAll(raw);
+        double dStreamSec = qMax(timer.nsecsElapsed() * 1e-9, 1e-9);
+
+        timer.restart();
+        readAll(rawMapped);
+        double dMappedSec = qMax(timer.nsecsElapsed() * 1e-9, 1e-9);
+
+        qInfo("read_raw_segment: stream %.1f MB/s, memory-mapped %.1f MB/s (%.1f MB)",
+              dMBytes / dStreamSec, dMBytes / dMappedSec, dMBytes);
+    }
+
     void fiffRawData_infoDetails()
     {
         if (!hasData()) QSKIP("No test data");
@@ -307,6 +433,52 @@ private slots:
         QCOMPARE(data2.rows(), data.rows());
     }
 
+    void fiffRawData_writeBehindRoundTrip()
+    {
+        if (!hasData()) QSKIP("No test data");
+
+        QFile file(m_sDataPath + "/MEG/sample/sample_audvis_trunc_raw.fif");
+        FiffRawData raw(file);
+
+        MatrixXd data, times;
+        fiff_int_t from = raw.first_samp;
+        fiff_int_t to = qMin(raw.first_samp + 4 * (fiff_int_t)raw.info.sfreq, raw.last_samp);
+        QVERIFY(raw.read_raw_segment(data, times, from, to));
+
+        // Write in 1 s buffers through the background writer with a short queue
+        QTemporaryFile tmpFile;
+        QVERIFY(tmpFile.open());
+
+        RowVectorXd cals;
+        FiffStream::SPtr outStream = FiffStream::start_writing_raw(tmpFile, raw.info, cals);
+        QVERIFY(outStream->start_write_behind(2));
+        QVERIFY(outStream->is_write_behind());
+
+        fiff_int_t quantum = (fiff_int_t)raw.info.sfreq;
+        for (Index col = 0; col < data.cols(); col += quantum) {
+            Index ncols = qMin((Index)quantum, data.cols() - col);
+            QVERIFY(outStream->write_raw_buffer(data.middleCols(col, ncols), cals));
+        }
+        outStream->finish_writing_raw();
+        QVERIFY(!outStream->is_write_behind());
+        tmpFile.close();
+
+        QFile tmpIn(tmpFile.fileName());
+        FiffRawData raw2(tmpIn);
+        QVERIFY(raw2.rawdir.size() == (data.cols() + quantum - 1) / quantum);
+
+        MatrixXd data2, times2;
+        QVERIFY(raw2.read_raw_segment(data2, times2, raw2.first_samp, raw2.last_samp));
+        QCOMPARE(data2.rows(), data.rows());
+        QCOMPARE(data2.cols(), data.cols());
+
+        // Data are stored as floats
+        for (Index r = 0; r < data.rows(); ++r) {
+            double dScale = qMax(data.row(r).cwiseAbs().maxCoeff(), 1e-30);
+            QVERIFY((data2.row(r) - data.row(r)).cwiseAbs().maxCoeff() / dScale < 1e-6);
+        }
+    }
+
     //=========================================================================
     // FiffEvokedSet: read averaged data
     //=========================================================================
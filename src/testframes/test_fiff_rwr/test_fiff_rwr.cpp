@@ -41,6 +41,7 @@
 #include <utils/generics/mne_logger.h>
 
 #include <fiff/fiff.h>
+#include <fiff/fiff_raw_pipeline.h>
 
 #include <iostream>
 
@@ -76,6 +77,8 @@ private slots:
     void compareData();
     void compareTimes();
     void compareInfo();
+    void compareCompactFormats();
+    void comparePipeline();
     void cleanupTestCase();
 
 private:
@@ -308,6 +311,90 @@ void TestFiffRWR::compareInfo()
 
 //=============================================================================================================
 
+void TestFiffRWR::compareCompactFormats()
+{
+    QString sFileOut = QCoreApplication::applicationDirPath() + "/../resources/data/mne-cpp-test-data/MEG/sample/sample_audvis_trunc_raw_test_rwr_compact_out.fif";
+
+    fiff_int_t from = rawFirstInRaw.first_samp;
+    fiff_int_t to = qMin(rawFirstInRaw.last_samp, from + 2 * static_cast<fiff_int_t>(ceil(rawFirstInRaw.info.sfreq)));
+
+    MatrixXd mOrigData, mOrigTimes;
+    QVERIFY(rawFirstInRaw.read_raw_segment(mOrigData, mOrigTimes, from, to));
+
+    QList<fiff_int_t> dataTypes;
+    dataTypes << FIFFT_INT << FIFFT_SHORT;
+
+    for(fiff_int_t dataType : dataTypes) {
+        std::cout << "Data type " << dataType << std::endl;
+
+        QFile t_fileOut(sFileOut);
+        QVERIFY(rawFirstInRaw.save(t_fileOut, RowVectorXi(), 1, from, to, dataType));
+
+        QFile t_fileIn(sFileOut);
+        FiffRawData rawCompact(t_fileIn);
+        QVERIFY(rawCompact.info.nchan == rawFirstInRaw.info.nchan);
+
+        MatrixXd mCompactData, mCompactTimes;
+        QVERIFY(rawCompact.read_raw_segment(mCompactData, mCompactTimes, from, to));
+        QVERIFY(mCompactData.rows() == mOrigData.rows());
+        QVERIFY(mCompactData.cols() == mOrigData.cols());
+
+        //
+        //   Rounding to the integer grid must not move any sample by more than half a step
+        //
+        for(Index k = 0; k < mOrigData.rows(); ++k) {
+            double dMaxErr = (mCompactData.row(k) - mOrigData.row(k)).cwiseAbs().maxCoeff();
+            double dBound = 0.5 * std::fabs(rawCompact.cals[k]) * (1.0 + dEpsilon) + 1e-30;
+            QVERIFY2(dMaxErr <= dBound, qPrintable(QString("Channel %1: error %2 exceeds %3").arg(k).arg(dMaxErr).arg(dBound)));
+        }
+
+        t_fileIn.remove();
+    }
+}
+
+//=============================================================================================================
+
+void TestFiffRWR::comparePipeline()
+{
+    fiff_int_t from = rawFirstInRaw.first_samp;
+    fiff_int_t to = qMin(rawFirstInRaw.last_samp, from + 2 * static_cast<fiff_int_t>(ceil(rawFirstInRaw.info.sfreq)));
+
+    MatrixXd mOrigData, mOrigTimes;
+    QVERIFY(rawFirstInRaw.read_raw_segment(mOrigData, mOrigTimes, from, to));
+
+    //
+    //   Several workers finish out of order, the writer must still see the blocks in file order
+    //
+    FiffRawPipeline pipeline(rawFirstInRaw, 333);
+    pipeline.setRange(from, to);
+    pipeline.setNumWorkers(3);
+    pipeline.setQueueLength(2);
+
+    MatrixXd mPipeData(mOrigData.rows(), mOrigData.cols());
+    int iNextIndex = 0;
+    Index iCol = 0;
+
+    bool bOk = pipeline.run([](FiffRawBlock& block) {
+                                block.matData *= 2.0;
+                                return true;
+                            },
+                            [&](const FiffRawBlock& block) {
+                                if(block.iIndex != iNextIndex++ || block.first != from + iCol) {
+                                    return false;
+                                }
+                                mPipeData.middleCols(iCol, block.matData.cols()) = block.matData;
+                                iCol += block.matData.cols();
+                                return true;
+                            });
+
+    QVERIFY(bOk);
+    QCOMPARE(iCol, mOrigData.cols());
+    QCOMPARE(pipeline.getStats().iBlocks, iNextIndex);
+    QVERIFY((mPipeData - 2.0 * mOrigData).cwiseAbs().maxCoeff() <= 2.0 * mOrigData.cwiseAbs().maxCoeff() * dEpsilon);
+}
+
+//=============================================================================================================
+
 void TestFiffRWR::cleanupTestCase()
 {
 }
@@ -18,6 +18,7 @@
 #include <QtTest/QtTest>
 #include <QFile>
 #include <QDir>
+#include <QElapsedTimer>
 #include <Eigen/Dense>
 
 #include <utils/generics/mne_logger.h>
@@ -58,6 +59,23 @@ private:
 
     bool hasData() const { return !m_sDataPath.isEmpty(); }
 
+    static double relDiff(const MatrixXf& a, const MatrixXf& b)
+    {
+        return (a - b).cast<double>().norm() / b.cast<double>().norm();
+    }
+
+    // Compute the solution of model and return its relative difference to the one of reference
+    static double computedSolutionDiff(FwdBemModel& model, const FwdBemModel& reference)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        if (model.fwd_bem_compute_solution(FWD_BEM_LINEAR_COLL) != 0 || model.nsol != reference.nsol)
+            return -1.0;
+        qInfo("Linear collocation solution (%d x %d) computed in %lld ms",
+              model.nsol, model.nsol, timer.elapsed());
+        return relDiff(model.solution, reference.solution);
+    }
+
 private slots:
 
     //=========================================================================
@@ -150,6 +168,110 @@ private slots:
         QVERIFY(result == 0 || result == 1);  // 0=ok, 1=recomputed
     }
 
+    //=========================================================================
+    // FwdBemModel: computed homogeneous solution agrees with the stored one
+    //=========================================================================
+    void bemModel_computeSolutionMatchesFile()
+    {
+        if (!hasData()) QSKIP("No test data");
+
+        QString bemPath = m_sDataPath + "/subjects/sample/bem/sample-5120-bem.fif";
+        QString solPath = m_sDataPath + "/subjects/sample/bem/sample-5120-bem-sol.fif";
+        if (!QFile::exists(bemPath) || !QFile::exists(solPath)) QSKIP("BEM files not found");
+
+        auto model = FwdBemModel::fwd_bem_load_homog_surface(bemPath);
+        auto reference = FwdBemModel::fwd_bem_load_homog_surface(bemPath);
+        QVERIFY(model != nullptr && reference != nullptr);
+        if (reference->fwd_bem_load_solution(solPath, FWD_BEM_LINEAR_COLL) != 1)
+            QSKIP("No linear collocation solution in the file");
+
+        double diff = computedSolutionDiff(*model, *reference);
+        qInfo("Relative difference to the stored solution: %g", diff);
+        QVERIFY(diff >= 0.0 && diff < 1e-3);
+    }
+
+    //=========================================================================
+    // FwdBemModel: computed three-layer (IP approach) solution agrees with the stored one
+    //=========================================================================
+    void bemModel_computeThreeLayerSolutionMatchesFile()
+    {
+        if (!hasData()) QSKIP("No test data");
+
+        QString bemPath = m_sDataPath + "/subjects/sample/bem/sample-1280-1280-1280-bem.fif";
+        QString solPath = m_sDataPath + "/subjects/sample/bem/sample-1280-1280-1280-bem-sol.fif";
+        if (!QFile::exists(bemPath) || !QFile::exists(solPath)) QSKIP("3-layer BEM files not found");
+
+        auto model = FwdBemModel::fwd_bem_load_three_layer_surfaces(bemPath);
+        auto reference = FwdBemModel::fwd_bem_load_three_layer_surfaces(bemPath);
+        QVERIFY(model != nullptr && reference != nullptr);
+        if (reference->fwd_bem_load_solution(solPath, FWD_BEM_LINEAR_COLL) != 1)
+            QSKIP("No linear collocation solution in the file");
+
+        double diff = computedSolutionDiff(*model, *reference);
+        qInfo("Relative difference to the stored solution: %g", diff);
+        QVERIFY(diff >= 0.0 && diff < 1e-3);
+    }
+
+    //=========================================================================
+    // FwdBemModel: blocked LU solution agrees with the explicit inverse
+    //=========================================================================
+    void bemModel_multiSolutionMatchesInverse()
+    {
+        const int n = 700;                      // Not a multiple of the block sizes
+        VectorXi ntri(2);
+        ntri << 300, 400;
+        MatrixXf gamma(2, 2);
+        gamma << 1.0f, 0.5f, 0.25f, 1.0f;
+
+        srand(42);
+        MatrixXf solids = MatrixXf::Random(n, n);
+        /*
+         * The same deflation and diagonal as in fwd_bem_multi_solution
+         */
+        MatrixXf ref(n, n);
+        float pi2 = 1.0/(2*M_PI);
+        for (int j = 0; j < n; ++j)
+            for (int k = 0; k < n; ++k)
+                ref(j, k) = 1.0f/n - solids(j, k)*pi2*gamma(j < 300 ? 0 : 1, k < 300 ? 0 : 1);
+        ref.diagonal().array() += 1.0f;
+        MatrixXd refInv = ref.cast<double>().inverse();
+
+        MatrixXf result = FwdBemModel::fwd_bem_multi_solution(solids, &gamma, 2, ntri);
+        QCOMPARE(static_cast<int>(result.rows()), n);
+        QCOMPARE(static_cast<int>(result.cols()), n);
+        QVERIFY(relDiff(result, refInv.cast<float>()) < 1e-4);
+    }
+
+    //=========================================================================
+    // FwdBemModel: IP modification as a matrix product agrees with the row-wise form
+    //=========================================================================
+    void bemModel_ipModifySolution()
+    {
+        VectorXi ntri(3);
+        ntri << 150, 120, 100;
+        const int n = ntri.sum();
+        const int koff = 270;
+        const float ipMult = 0.02f;
+        const float mult = (1.0f + ipMult)/ipMult;
+
+        srand(7);
+        MatrixXf solution = MatrixXf::Random(n, n);
+        MatrixXf ipSolution = MatrixXf::Random(100, 100);
+
+        MatrixXf ref = solution;
+        for (int j = 0; j < n; ++j) {
+            RowVectorXf row(100);
+            for (int k = 0; k < 100; ++k)
+                row[k] = ref.row(j).segment(koff, 100).dot(ipSolution.col(k));
+            ref.row(j).segment(koff, 100) -= 2.0f*row;
+        }
+        ref.block(koff, koff, 100, 100) += mult*ipSolution;
+        ref *= ipMult;
+
+        FwdBemModel::fwd_bem_ip_modify_solution(solution, ipSolution, ipMult, 3, ntri);
+        QVERIFY(relDiff(solution, ref) < 1e-5);
+    }
+
     //=========================================================================
     // Forward solution: read and verify structure
     //=========================================================================
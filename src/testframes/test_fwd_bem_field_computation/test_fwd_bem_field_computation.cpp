@@ -32,6 +32,8 @@
 #include <QTest>
 #include <QDebug>
 #include <QDir>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
 
 #include <Eigen/Core>
 
@@ -89,6 +91,8 @@ private:
         return testDataPath() + "/MEG/sample/all-trans.fif";
     }
 
+    QTemporaryDir m_bemSolCacheDir;     // Keeps the solutions computed by the tests out of the user cache
+
 private slots:
 
     void initTestCase()
@@ -101,6 +105,8 @@ private slots:
                  qPrintable(QString("Source space not found: %1").arg(srcPath())));
         QVERIFY2(QFile::exists(coilDefPath()),
                  qPrintable(QString("Coil definitions not found: %1").arg(coilDefPath())));
+        QVERIFY(m_bemSolCacheDir.isValid());
+        FwdBemModel::fwd_bem_set_solution_cache_dir(m_bemSolCacheDir.path());
     }
 
     // ---- FwdBemModel: BEM Solution Computation ----
@@ -133,6 +139,39 @@ private slots:
         QVERIFY(model->nsol > 0);
     }
 
+    void testBemSolutionCache()
+    {
+        // A computed solution is cached under the model hash and reused by the next model
+        // with the same geometry; different conductivities give a different hash.
+
+        QTemporaryDir cacheDir;
+        QVERIFY(cacheDir.isValid());
+        FwdBemModel::fwd_bem_set_solution_cache_dir(cacheDir.path());
+
+        auto model = FwdBemModel::fwd_bem_load_homog_surface(bemPath());
+        QVERIFY(model != nullptr);
+        QString cacheName = QDir(cacheDir.path()).filePath(model->fwd_bem_solution_hash(FWD_BEM_CONSTANT_COLL) + "-bem-sol.fif");
+        QVERIFY(!QFile::exists(cacheName));
+
+        QVERIFY(model->fwd_bem_compute_cached_solution(FWD_BEM_CONSTANT_COLL) == 0);
+        QVERIFY(QFile::exists(cacheName));
+
+        auto cached = FwdBemModel::fwd_bem_load_homog_surface(bemPath());
+        QVERIFY(cached != nullptr);
+        QVERIFY(cached->fwd_bem_compute_cached_solution(FWD_BEM_CONSTANT_COLL) == 0);
+        QCOMPARE(cached->sol_name, cacheName);
+        QCOMPARE(cached->bem_method, FWD_BEM_CONSTANT_COLL);
+        QCOMPARE(cached->nsol, model->nsol);
+        QVERIFY(cached->solution == model->solution);
+
+        QVERIFY(model->fwd_bem_solution_hash(FWD_BEM_LINEAR_COLL) != model->fwd_bem_solution_hash(FWD_BEM_CONSTANT_COLL));
+        QString hash = cached->fwd_bem_solution_hash(FWD_BEM_CONSTANT_COLL);
+        cached->sigma[0] *= 2.0f;
+        QVERIFY(cached->fwd_bem_solution_hash(FWD_BEM_CONSTANT_COLL) != hash);
+
+        FwdBemModel::fwd_bem_set_solution_cache_dir(m_bemSolCacheDir.path());
+    }
+
     // ---- FwdBemModel: Coil/Electrode Specification ----
 
     void testBemSpecifyCoils()
@@ -624,6 +663,74 @@ private slots:
         }
     }
 
+    // ---- FwdBemModel: Batched Field Kernels ----
+
+    void testBatchKernelsMatchPerDipole()
+    {
+        // The batched kernels must agree with the per-dipole callbacks.
+        // Also reports the throughput of both (fields of one dipole at all sensors per second).
+
+        auto model = FwdBemModel::fwd_bem_load_homog_surface(bemPath());
+        QVERIFY(model != nullptr);
+        model->fwd_bem_load_recompute_solution(bemSolPath(), FWD_BEM_LINEAR_COLL, 0);
+
+        auto coilDefs = FwdCoilSet::read_coil_defs(coilDefPath());
+        QFile rawFile(rawPath());
+        FiffRawData raw(rawFile);
+        QList<FiffChInfo> megChs;
+        QList<FiffChInfo> eegChs;
+        for (int i = 0; i < raw.info.nchan; ++i) {
+            if (raw.info.chs[i].kind == FIFFV_MEG_CH)
+                megChs.append(raw.info.chs[i]);
+            else if (raw.info.chs[i].kind == FIFFV_EEG_CH)
+                eegChs.append(raw.info.chs[i]);
+        }
+        auto coils = coilDefs->create_meg_coils(megChs, megChs.size(), FWD_COIL_ACCURACY_NORMAL, raw.info.dev_head_t);
+        auto sphereCoils = coilDefs->create_meg_coils(megChs, megChs.size(), FWD_COIL_ACCURACY_NORMAL);
+        auto eegEls = FwdCoilSet::create_eeg_els(eegChs, eegChs.size());
+        FiffCoordTrans head_mri_t = FiffCoordTrans::readMriTransform(transPath());
+        model->fwd_bem_set_head_mri_t(head_mri_t);
+        QVERIFY(model->fwd_bem_specify_coils(coils.get()) == 0);
+        QVERIFY(model->fwd_bem_specify_els(eegEls.get()) == 0);
+
+        // Dipoles in a 3 cm cube around a point well inside the head
+        const int ndip = 960;
+        const int nbatch = 96;
+        MatrixX3f rd = (MatrixX3f::Random(ndip, 3) * 0.03f).rowwise() + RowVector3f(0.0f, 0.0f, 0.05f);
+        MatrixX3f Q = MatrixX3f::Random(ndip, 3) * 1e-8f;
+        float r0[3] = {0.0f, 0.0f, 0.04f};
+
+        auto compare = [&](const char* name, FwdCoilSet& set, const fwdFieldFunc& one, const fwdFieldBatchFunc& batch, void* client) {
+            MatrixXf Bone = MatrixXf::Zero(set.ncoil(), ndip);
+            MatrixXf Bbatch = MatrixXf::Zero(set.ncoil(), ndip);
+            QElapsedTimer timer;
+
+            timer.start();
+            for (int k = 0; k < ndip; ++k)
+                QVERIFY(one(rd.row(k).transpose(), Q.row(k).transpose(), set, Bone.col(k), client) == 0);
+            double tOne = timer.nsecsElapsed() * 1e-9;
+
+            timer.restart();
+            for (int k = 0; k < ndip; k += nbatch)
+                QVERIFY(batch(rd.middleRows(k, nbatch), Q.middleRows(k, nbatch), set, Bbatch.middleCols(k, nbatch), client) == 0);
+            double tBatch = timer.nsecsElapsed() * 1e-9;
+
+            qInfo("%-20s per dipole %10.0f fields/s, batched %10.0f fields/s (%.1fx)",
+                  name, ndip / tOne, ndip / tBatch, tOne / tBatch);
+            QVERIFY(Bone.norm() > 0);
+            QVERIFY2((Bbatch - Bone).norm() <= 1e-4f * Bone.norm(),
+                     qPrintable(QString("%1: batched result differs from the per-dipole one").arg(name)));
+        };
+
+        compare("fwd_bem_field", *coils, FwdBemModel::fwd_bem_field, FwdBemModel::fwd_bem_field_batch, model.get());
+        if (QTest::currentTestFailed())
+            return;
+        compare("fwd_bem_pot_els", *eegEls, FwdBemModel::fwd_bem_pot_els, FwdBemModel::fwd_bem_pot_els_batch, model.get());
+        if (QTest::currentTestFailed())
+            return;
+        compare("fwd_sphere_field", *sphereCoils, FwdBemModel::fwd_sphere_field, FwdBemModel::fwd_sphere_field_batch, r0);
+    }
+
     // ---- FwdCompData ----
 
     void testFwdCompDataMembers()
@@ -633,6 +740,7 @@ private slots:
         QVERIFY(compData.set == nullptr);
         QVERIFY(compData.comp_coils == nullptr);
         QVERIFY(compData.client == nullptr);
+        QVERIFY(compData.field_batch == nullptr);
     }
 
     // ---- FwdThreadArg ----
@@ -645,6 +753,9 @@ private slots:
         QVERIFY(arg.res_grad == nullptr);
         QVERIFY(arg.coils_els == nullptr);
         QVERIFY(arg.s == nullptr);
+        QVERIFY(arg.vert_from == 0);
+        QVERIFY(arg.vert_to == -1);
+        QVERIFY(arg.field_pot_batch == nullptr);
         QVERIFY(arg.fixed_ori == false);
         QVERIFY(arg.comp == -1);
     }
@@ -693,6 +804,43 @@ private slots:
         // Clean up temp file
         QFile::remove(pSettings->solname);
     }
+
+    void testComputeFwdThreadCountInvariant()
+    {
+        // The chunked computation must give the same result as the serial one,
+        // independent of the number of threads.
+        QFile rawFile(rawPath());
+        FiffRawData raw(rawFile);
+
+        auto computeWithThreads = [&](int nthreads) {
+            auto pSettings = std::make_shared<ComputeFwdSettings>();
+            pSettings->include_meg = true;
+            pSettings->include_eeg = true;
+            pSettings->srcname = srcPath();
+            pSettings->measname = rawPath();
+            pSettings->mriname = transPath();
+            pSettings->transname.clear();
+            pSettings->bemname = bem3Path();
+            pSettings->mindist = 5.0f / 1000.0f;
+            pSettings->solname = QDir::tempPath() + "/test_fwd_threads_output.fif";
+            pSettings->use_threads = nthreads > 1;
+            pSettings->nthreads = nthreads;
+            pSettings->pFiffInfo = QSharedPointer<FiffInfo>(new FiffInfo(raw.info));
+            pSettings->checkIntegrity();
+
+            ComputeFwd computer(pSettings);
+            return computer.calculateFwd();
+        };
+
+        auto pFwdSerial = computeWithThreads(1);
+        auto pFwdThreaded = computeWithThreads(7);
+
+        QVERIFY(pFwdSerial != nullptr);
+        QVERIFY(pFwdThreaded != nullptr);
+        QCOMPARE(pFwdThreaded->sol->data.rows(), pFwdSerial->sol->data.rows());
+        QCOMPARE(pFwdThreaded->sol->data.cols(), pFwdSerial->sol->data.cols());
+        QVERIFY(pFwdThreaded->sol->data == pFwdSerial->sol->data);
+    }
 };
 
 //=============================================================================================================
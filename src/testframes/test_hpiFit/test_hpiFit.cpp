@@ -47,6 +47,7 @@
 #include <fiff/fiff_dig_point_set.h>
 
 #include <inv/hpi/inv_hpi_fit.h>
+#include <inv/hpi/inv_hpi_batch_fit.h>
 #include <inv/hpi/inv_hpi_data_updater.h>
 #include <inv/hpi/inv_sensor_set.h>
 
@@ -64,6 +65,7 @@
 #include <QFile>
 #include <QCommandLineParser>
 #include <QDebug>
+#include <QTemporaryDir>
 #include <QtTest>
 
 //=============================================================================================================
@@ -100,11 +102,14 @@ private slots:
     void testFit_advanced_gof();  // compare gof to specified value
     void testFit_basic_error();  // compare error to specified value
     void testFit_advanced_error();  // compare error to specified value
+    void testFit_levenbergMarquardt_error();  // compare error to specified value
+    void testBatchFit();  // fit the whole file and write the head positions
     void testCheckForUpdate();
     void testFindOrder();  // test with all possible frequency oders
     void cleanupTestCase();  // clean-up at the end
 
 private:
+    QString m_sRawFile;
     FiffRawData m_raw;
     QSharedPointer<FiffInfo>  m_pFiffInfo;
     MatrixXd m_matData;
@@ -132,7 +137,8 @@ void TestHpiFit::initTestCase()
 {
     qInstallMessageHandler(MNELogger::customLogWriter);
 
-    QFile t_fileIn(QCoreApplication::applicationDirPath() + "/../resources/data/mne-cpp-test-data/MEG/sample/test_hpiFit_raw.fif");
+    m_sRawFile = QCoreApplication::applicationDirPath() + "/../resources/data/mne-cpp-test-data/MEG/sample/test_hpiFit_raw.fif";
+    QFile t_fileIn(m_sRawFile);
 
     // Make sure test folder exists
     QFileInfo t_fileInInfo(t_fileIn);
@@ -433,6 +439,99 @@ void TestHpiFit::testFit_advanced_error()
 
 //=============================================================================================================
 
+void TestHpiFit::testFit_levenbergMarquardt_error()
+{
+    /// prepare
+    int iSampleFreq = m_pFiffInfo->sfreq;
+    int iLineFreq = m_pFiffInfo->linefreq;
+    QVector<int> vecHpiFreqs = {166, 154, 161, 158};
+    bool bBasic = true;
+    InvHpiModelParameters hpiModelParameters(vecHpiFreqs,
+                                          iSampleFreq,
+                                          iLineFreq,
+                                          bBasic);
+
+    InvHpiDataUpdater hpiDataUpdater = InvHpiDataUpdater(m_pFiffInfo);
+    InvHpiFit HPI = InvHpiFit(hpiDataUpdater.getSensors());
+    HPI.setDipoleSolver(HpiDipoleSolver::LevenbergMarquardt);
+    QVERIFY(HPI.getDipoleSolver() == HpiDipoleSolver::LevenbergMarquardt);
+    hpiDataUpdater.prepareDataAndProjectors(m_matData,m_matProjectors);
+    const auto& matProjectedData = hpiDataUpdater.getProjectedData();
+    const auto& matPreparedProjectors = hpiDataUpdater.getProjectors();
+    const auto& matCoilsHead = hpiDataUpdater.getHpiDigitizer();
+
+    HpiFitResult hpiFitResult;
+
+    /// act: the second fit is seeded from the first
+    HPI.fit(matProjectedData,
+            matPreparedProjectors,
+            hpiModelParameters,
+            matCoilsHead,
+            hpiFitResult);
+    HPI.fit(matProjectedData,
+            matPreparedProjectors,
+            hpiModelParameters,
+            matCoilsHead,
+            hpiFitResult);
+
+    QVector<double> vecError = hpiFitResult.errorDistances;
+
+    /// assert
+    double dLocalizationErrorMean = 1000.0 * std::accumulate(vecError.begin(), vecError.end(), .0) / vecError.size();
+    QVERIFY(dLocalizationErrorMean < dLocalizationErrorTol);
+    QVERIFY(hpiFitResult.GoF.mean() > dGofTol);
+}
+
+//=============================================================================================================
+
+void TestHpiFit::testBatchFit()
+{
+    /// prepare
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QString sPosFile = tempDir.filePath("test_hpiFit.pos");
+
+    InvHpiBatchFit batchFit(m_sRawFile, {166, 154, 161, 158});
+    batchFit.setWindowLength(0.2);
+    batchFit.setStep(1.0);
+
+    /// act
+    QVERIFY(batchFit.run());
+    QVERIFY(batchFit.writeHeadPositions(sPosFile));
+
+    /// assert
+    const HpiBatchStats stats = batchFit.getStats();
+    const QVector<HpiBatchWindow>& vecWindows = batchFit.getWindows();
+    QCOMPARE(static_cast<int>(vecWindows.size()), stats.iWindows);
+    QVERIFY(stats.iWindows > 0);
+    QVERIFY(stats.iRejected < stats.iWindows);
+    QVERIFY(stats.dWindowsPerSec > 0.0);
+    QVERIFY(1000.0 * stats.dMeanError < dLocalizationErrorTol);
+    QVERIFY(stats.dMedianError <= stats.dMaxError);
+
+    // Windows are in time order, one step apart
+    for(int k = 1; k < vecWindows.size(); ++k) {
+        QCOMPARE(vecWindows.at(k).first - vecWindows.at(k - 1).first, batchFit.getStepSamples());
+    }
+
+    // One line per window after the header, time stamps and unit quaternions
+    const MatrixXd matPositions = batchFit.getHeadPositions();
+    QCOMPARE(static_cast<int>(matPositions.rows()), stats.iWindows);
+    QCOMPARE(static_cast<int>(matPositions.cols()), 10);
+    for(int k = 0; k < matPositions.rows(); ++k) {
+        // Time stamps count from the start of the acquisition, first_samp included
+        QVERIFY(qAbs(matPositions(k, 0) - vecWindows.at(k).first / m_pFiffInfo->sfreq) < 1e-3);
+        QVERIFY(matPositions.row(k).segment(1, 3).norm() <= 1.0 + 1e-6);
+    }
+
+    QFile filePos(sPosFile);
+    QVERIFY(filePos.open(QIODevice::ReadOnly | QIODevice::Text));
+    const QStringList lLines = QString(filePos.readAll()).split("\n", Qt::SkipEmptyParts);
+    QCOMPARE(static_cast<int>(lLines.size()), stats.iWindows + 1);
+}
+
+//=============================================================================================================
+
 void TestHpiFit::testCheckForUpdate()
 {
     /// prepare
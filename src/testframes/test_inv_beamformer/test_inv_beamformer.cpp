@@ -176,6 +176,14 @@ private slots:
      */
     void beamformerCompute_freeOrient();
 
+    //=========================================================================================================
+    /**
+     * Verifies that the blocked, parallel InvBeamformerCompute::computeBeamformer matches a direct per-source
+     * evaluation of the unit-noise-gain filter, for all orientations and for max-power orientations, on a
+     * source count spanning several blocks.
+     */
+    void beamformerCompute_matchesPerSource();
+
     //=========================================================================================================
     /**
      * Verifies the full LCMV pipeline: builds spatial filters with InvLCMV::makeLCMV and
@@ -405,6 +413,79 @@ void TestInvBeamformer::beamformerCompute_freeOrient()
 
 //=============================================================================================================
 
+void TestInvBeamformer::beamformerCompute_matchesPerSource()
+{
+    const int nChan   = 40;
+    const int nSrc    = 600;
+    const int nOrient = 3;
+    const double reg  = 0.05;
+    std::srand(42);
+    MatrixXd G = MatrixXd::Random(nChan, nSrc * nOrient);
+    MatrixXd A = MatrixXd::Random(nChan, 2 * nChan);
+    MatrixXd Cm = A * A.transpose() / nChan;
+    MatrixX3d nn = MatrixX3d::Random(nSrc, 3);
+
+    // Regularized inverse of the full-rank covariance
+    SelfAdjointEigenSolver<MatrixXd> eig(Cm);
+    const double loading = reg * eig.eigenvalues().sum() / nChan;
+    const MatrixXd CmInv = eig.eigenvectors()
+                           * (eig.eigenvalues().array() + loading).inverse().matrix().asDiagonal()
+                           * eig.eigenvectors().transpose();
+
+    MatrixXd  W, WMaxPower;
+    MatrixX3d mpOri, mpOriMaxPower;
+    QVERIFY(InvBeamformerCompute::computeBeamformer(
+        G, Cm, reg, nOrient,
+        BeamformerWeightNorm::UnitNoiseGain,
+        BeamformerPickOri::None,
+        false,
+        BeamformerInversion::Matrix,
+        nn, W, mpOri));
+    QVERIFY(InvBeamformerCompute::computeBeamformer(
+        G, Cm, reg, nOrient,
+        BeamformerWeightNorm::UnitNoiseGain,
+        BeamformerPickOri::MaxPower,
+        false,
+        BeamformerInversion::Matrix,
+        nn, WMaxPower, mpOriMaxPower));
+    QCOMPARE(W.rows(), (Index)(nSrc * nOrient));
+    QCOMPARE(WMaxPower.rows(), (Index)nSrc);
+
+    for (int s = 0; s < nSrc; ++s) {
+        const MatrixXd Gk = G.middleCols(s * nOrient, nOrient);
+
+        // All orientations: W_ug = (Gk^T Cm^-1 Gk)^-1 Gk^T Cm^-1, rows scaled to unit norm
+        MatrixXd Wk = (Gk.transpose() * CmInv * Gk).inverse() * Gk.transpose() * CmInv;
+        Wk.rowwise().normalize();
+        QVERIFY((Wk - W.middleRows(s * nOrient, nOrient)).norm() < 1e-8 * Wk.norm());
+
+        // Max power: eigenvector of (Gk^T Cm^-2 Gk)^-1 (Gk^T Cm^-1 Gk) with the largest eigenvalue
+        const MatrixXd oriPick = (Gk.transpose() * CmInv * CmInv * Gk).inverse() * (Gk.transpose() * CmInv * Gk);
+        EigenSolver<MatrixXd> eigOri(oriPick);
+        Index iMax;
+        eigOri.eigenvalues().cwiseAbs().maxCoeff(&iMax);
+        Vector3d ori = eigOri.eigenvectors().col(iMax).real().normalized();
+        if (ori.dot(nn.row(s).transpose()) < 0.0) {
+            ori = -ori;
+        }
+        QVERIFY((ori.transpose() - mpOriMaxPower.row(s)).norm() < 1e-8);
+
+        const VectorXd g = Gk * ori;
+        RowVectorXd w = (g.transpose() * CmInv) / (g.transpose() * CmInv * g).value();
+        w.normalize();
+        QVERIFY((w - WMaxPower.row(s)).norm() < 1e-8);
+    }
+
+    // Power of the max-power filters: w Cm w^T per source
+    VectorXd power = InvBeamformerCompute::computePower(Cm, WMaxPower, 1);
+    for (int s = 0; s < nSrc; ++s) {
+        const double ref = (WMaxPower.row(s) * Cm * WMaxPower.row(s).transpose()).value();
+        QVERIFY(qAbs(power(s) - ref) < 1e-10 * qAbs(ref));
+    }
+}
+
+//=============================================================================================================
+
 void TestInvBeamformer::lcmv_makeAndApply()
 {
     if (!hasData()) QSKIP("Required data not loaded");
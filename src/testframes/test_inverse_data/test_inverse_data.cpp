@@ -34,6 +34,7 @@
 #include <mne/mne.h>
 #include <mne/mne_inverse_operator.h>
 #include <inv/inv_source_estimate.h>
+#include <inv/inv_stc_file.h>
 #include <mne/mne_source_spaces.h>
 #include <mne/mne_forward_solution.h>
 
@@ -582,6 +583,109 @@ private slots:
         }
     }
 
+    //=========================================================================
+    // Memory-mapped STC access matches the full read
+    //=========================================================================
+    void stcFile_randomAccess()
+    {
+        // Synthetic data, so that the test does not depend on the sample data
+        const int nVert = 37;
+        const int nTimes = 53;
+        VectorXi vertices(nVert);
+        for (int i = 0; i < nVert; ++i) vertices(i) = 3 * i + 1;
+        MatrixXd data = MatrixXd::Random(nVert, nTimes).cast<float>().cast<double>();
+        InvSourceEstimate stc(data, vertices, -0.1f, 0.004f);
+
+        QTemporaryDir tmpDir;
+        QVERIFY(tmpDir.isValid());
+        QString path = tmpDir.path() + "/test-lh.stc";
+        QFile outFile(path);
+        QVERIFY(stc.write(outFile));
+
+        // The bulk read returns exactly what was written
+        QFile inFile(path);
+        InvSourceEstimate stcRead;
+        QVERIFY(InvSourceEstimate::read(inFile, stcRead));
+        QVERIFY(stcRead.vertices == vertices);
+        QVERIFY(stcRead.data == data);
+
+        InvStcFile stcFile;
+        QVERIFY(stcFile.open(path));
+        QCOMPARE(stcFile.nVertices(), nVert);
+        QCOMPARE(stcFile.nTimes(), nTimes);
+        QVERIFY(stcFile.vertices() == vertices);
+        QCOMPARE(stcFile.tmin(), -0.1f);
+        QCOMPARE(stcFile.tstep(), 0.004f);
+
+        QVERIFY(stcFile.readTimes(10, 7) == data.middleCols(10, 7));
+        QVERIFY(stcFile.readTime(nTimes - 1) == data.col(nTimes - 1));
+
+        VectorXi rows(3);
+        rows << 0, 20, nVert - 1;
+        MatrixXd subset = stcFile.readVertices(rows, 5, 11);
+        QCOMPARE(static_cast<int>(subset.rows()), 3);
+        QCOMPARE(static_cast<int>(subset.cols()), 11);
+        for (int r = 0; r < rows.size(); ++r) {
+            QVERIFY(subset.row(r) == data.row(rows(r)).segment(5, 11));
+        }
+        QCOMPARE(static_cast<int>(stcFile.readVertices(rows).cols()), nTimes);
+
+        // Out of range requests return empty matrices
+        QCOMPARE(static_cast<int>(stcFile.readTimes(nTimes - 2, 3).size()), 0);
+        QCOMPARE(static_cast<int>(stcFile.readTime(-1).size()), 0);
+
+        InvSourceEstimate stcMapped;
+        QVERIFY(stcFile.read(stcMapped));
+        QVERIFY(stcMapped.data == data);
+        QCOMPARE(static_cast<int>(stcMapped.times.size()), nTimes);
+    }
+
+    //=========================================================================
+    // Appending to a memory-mapped STC keeps a valid file
+    //=========================================================================
+    void stcFile_append()
+    {
+        const int nVert = 19;
+        VectorXi vertices = VectorXi::LinSpaced(nVert, 0, 2 * (nVert - 1));
+        MatrixXd data = MatrixXd::Random(nVert, 40).cast<float>().cast<double>();
+
+        QTemporaryDir tmpDir;
+        QVERIFY(tmpDir.isValid());
+        QString path = tmpDir.path() + "/append-rh.stc";
+
+        InvStcFile writer;
+        QVERIFY(writer.create(path, 0.5f, 0.001f, vertices));
+        QCOMPARE(writer.nTimes(), 0);
+
+        int written = 0;
+        for (int n : {1, 12, 27}) {
+            QVERIFY(writer.append(data.middleCols(written, n)));
+            written += n;
+            QCOMPARE(writer.nTimes(), written);
+
+            // The header is updated with every append, so another reader sees a complete file
+            QFile inFile(path);
+            InvSourceEstimate stc;
+            QVERIFY(InvSourceEstimate::read(inFile, stc));
+            QVERIFY(stc.data == data.leftCols(written));
+        }
+        QVERIFY(writer.readTimes(0, written) == data);
+
+        // Wrong number of rows is rejected and leaves the file untouched
+        QVERIFY(!writer.append(MatrixXd::Zero(nVert + 1, 2)));
+        QCOMPARE(writer.nTimes(), written);
+        writer.close();
+
+        // The space reserved for further appends is cut off on close
+        QCOMPARE(QFileInfo(path).size(), qint64(16 + 4 * nVert + 4 * nVert * written));
+
+        // A read-only file cannot be extended
+        InvStcFile reader;
+        QVERIFY(reader.open(path));
+        QCOMPARE(reader.nTimes(), written);
+        QVERIFY(!reader.append(data.leftCols(1)));
+    }
+
     //=========================================================================
     // InvRapMusic with forward solution
     //=========================================================================
@@ -87,6 +87,7 @@ using namespace UTILSLIB;
  *  5. testHelp           – --help flag returns exit code 0
  *  6. testMissingArgs    – missing --in/--inv returns non-zero exit code
  *  7. testMatchesMnePython – compare dSPM output against mne-python STCs
+ *  8. testRawStreaming   – block-wise raw processing matches the whole-file run
  */
 class TestMneComputeRawInverse : public QObject
 {
@@ -104,6 +105,7 @@ private slots:
     void testHelp();
     void testMissingArgs();
     void testMatchesMnePython();
+    void testRawStreaming();
     void cleanupTestCase();
 
 private:
@@ -762,6 +764,68 @@ void TestMneComputeRawInverse::testMatchesMnePython()
 
 //=============================================================================================================
 
+void TestMneComputeRawInverse::testRawStreaming()
+{
+    if (!m_bDataAvailable || !m_bExeAvailable) QSKIP("Prerequisites missing");
+
+    QString rawFile = m_sDataPath + "/MEG/sample/sample_audvis_trunc_raw.fif";
+    if (!QFile::exists(rawFile)) QSKIP("sample_audvis_trunc_raw.fif not found");
+
+    printf(">>>>>>>>>>>>>>>>>>>>>>>>> Test Raw Streaming (application) >>>>>>>>>>>>>>>>>>>>>>>>>\n");
+
+    QTemporaryDir tmpDir;
+    QVERIFY2(tmpDir.isValid(), "Failed to create temp dir");
+
+    // Whole file at once and an odd block size which leaves a partial last block
+    const QStringList blockSizes = QStringList() << "0" << "333";
+    QList<InvSourceEstimate> results;
+    for (const QString &blockSize : blockSizes) {
+        QString outBase = tmpDir.path() + "/raw_" + blockSize;
+        QStringList args;
+        args << "--in" << rawFile
+             << "--inv" << m_sInvFile
+             << "--snr" << "1"
+             << "--spm"
+             << "--blocksize" << blockSize
+             << "--out" << outBase;
+
+        QString output;
+        int exitCode = runApp(args, output);
+        printf("  Block size %s: exit code %d\n", blockSize.toUtf8().constData(), exitCode);
+        QCOMPARE(exitCode, 0);
+
+        InvSourceEstimate stcLh, stcRh;
+        QVERIFY2(readStc(outBase + "-lh.stc", stcLh), "Failed to read LH STC");
+        QVERIFY2(readStc(outBase + "-rh.stc", stcRh), "Failed to read RH STC");
+        QCOMPARE((int)stcLh.data.rows(), 3732);
+        QCOMPARE((int)stcRh.data.rows(), 3766);
+        QCOMPARE(stcLh.data.cols(), stcRh.data.cols());
+
+        MatrixXd data(stcLh.data.rows() + stcRh.data.rows(), stcLh.data.cols());
+        data << stcLh.data, stcRh.data;
+        VectorXi vertices(stcLh.vertices.size() + stcRh.vertices.size());
+        vertices << stcLh.vertices, stcRh.vertices;
+        results.append(InvSourceEstimate(data, vertices, stcLh.tmin, stcLh.tstep));
+    }
+
+    const InvSourceEstimate &whole = results[0];
+    const InvSourceEstimate &streamed = results[1];
+    printf("  %d sources, %d time points\n", (int)whole.data.rows(), (int)whole.data.cols());
+
+    QCOMPARE(streamed.data.cols(), whole.data.cols());
+    QVERIFY(streamed.vertices == whole.vertices);
+    QVERIFY(std::fabs(streamed.tmin - whole.tmin) < 1e-6f);
+    QVERIFY(std::fabs(streamed.tstep - whole.tstep) < 1e-9f);
+
+    double relDiff = (streamed.data - whole.data).norm() / whole.data.norm();
+    printf("  Relative difference: %g\n", relDiff);
+    QVERIFY2(relDiff < 1e-6, "Streamed result differs from the whole-file result");
+
+    printf("<<<<<<<<<<<<<<<<<<<<<<<<< Test Raw Streaming Finished <<<<<<<<<<<<<<<<<<<<<<<<<\n");
+}
+
+//=============================================================================================================
+
 void TestMneComputeRawInverse::cleanupTestCase()
 {
     printf("<<<<<<<<<<<<<<<<<<<<<<<<< mne_compute_raw_inverse Integration Test Cleanup <<<<<<<<<<<<<<<<<<<<<<<<<\n");
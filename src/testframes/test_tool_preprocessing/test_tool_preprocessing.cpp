@@ -32,6 +32,13 @@
  *           mne_process_raw, mne_compensate_data, mne_mark_bad_channels, etc.
  */
 
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <fiff/fiff_raw_data.h>
+#include <dsp/sss.h>
+
 //=============================================================================================================
 // QT INCLUDES
 //=============================================================================================================
@@ -40,6 +47,21 @@
 #include <QProcess>
 #include <QCoreApplication>
 #include <QDir>
+#include <QTemporaryDir>
+
+//=============================================================================================================
+// C++ INCLUDES
+//=============================================================================================================
+
+#include <cmath>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace UTILSLIB;
+using namespace Eigen;
 
 //=============================================================================================================
 // TEST CLASS
@@ -67,6 +89,32 @@ private:
         return proc.readAllStandardOutput() + proc.readAllStandardError();
     }
 
+    bool readRaw(const QString& fileName, FiffInfo& info, MatrixXd& matData)
+    {
+        QFile file(fileName);
+        FiffRawData raw(file);
+        MatrixXd matTimes;
+        info = raw.info;
+        return !raw.isEmpty() && raw.read_raw_segment(matData, matTimes);
+    }
+
+    FiffInfo infoInHead(const FiffInfo& info)
+    {
+        // mne_sss sets the basis up in head coordinates
+        FiffInfo infoHead = info;
+        const Matrix4f matDevHead = info.dev_head_t.trans;
+        for (FiffChInfo& ch : infoHead.chs) {
+            if (ch.kind != FIFFV_MEG_CH && ch.kind != FIFFV_REF_MEG_CH) {
+                continue;
+            }
+            ch.chpos.r0 = matDevHead.block<3,3>(0,0) * ch.chpos.r0 + matDevHead.block<3,1>(0,3);
+            ch.chpos.ex = matDevHead.block<3,3>(0,0) * ch.chpos.ex;
+            ch.chpos.ey = matDevHead.block<3,3>(0,0) * ch.chpos.ey;
+            ch.chpos.ez = matDevHead.block<3,3>(0,0) * ch.chpos.ez;
+        }
+        return infoHead;
+    }
+
     bool toolExists(const QString& toolName)
     {
         QString path = m_sBinDir + "/" + toolName;
@@ -240,6 +288,94 @@ private slots:
                 output.contains("smooth", Qt::CaseInsensitive));
     }
 
+    //=========================================================================================================
+    // mne_sss
+    //=========================================================================================================
+
+    void testSssHelp()
+    {
+        if (!toolExists("mne_sss")) QSKIP("mne_sss not found");
+        QString output = runTool("mne_sss", {"--help"});
+        QVERIFY(output.contains("help", Qt::CaseInsensitive) ||
+                output.contains("sss", Qt::CaseInsensitive));
+    }
+
+    void testSssRun()
+    {
+        if (!toolExists("mne_sss")) QSKIP("mne_sss not found");
+        QString rawFile = m_sResourcePath + "MEG/sample/sample_audvis_trunc_raw.fif";
+        if (!QFile::exists(rawFile)) QSKIP("Raw file not available");
+
+        QTemporaryDir tempDir;
+        QVERIFY(tempDir.isValid());
+        QString outFile = tempDir.filePath("test_mne_sss_raw.fif");
+        QString output = runTool("mne_sss", {"--in", rawFile, "--out", outFile, "--st", "--st-buflen", "4", "--jobs", "2"}, 120000);
+        QVERIFY(output.contains("tSSS"));
+
+        // Same result as tSSS of the whole recording in memory, up to the float precision of the file
+        FiffInfo info;
+        MatrixXd matData;
+        QVERIFY(readRaw(rawFile, info, matData));
+        const SSS::Basis basis = SSS::computeBasis(infoInHead(info), SSS::Params());
+        const MatrixXd matExpected = SSS::applyTemporal(matData, basis, static_cast<int>(std::lround(4.0 * info.sfreq)), 0.98, false);
+
+        FiffInfo infoOut;
+        MatrixXd matOut;
+        QVERIFY(readRaw(outFile, infoOut, matOut));
+        QCOMPARE(matOut.rows(), matExpected.rows());
+        QCOMPARE(matOut.cols(), matExpected.cols());
+        for (int i : basis.megChannelIdx) {
+            QVERIFY((matOut.row(i) - matExpected.row(i)).norm() <= 1e-4 * matExpected.row(i).norm() + 1e-20);
+        }
+    }
+
+    void testSssMoveComp()
+    {
+        if (!toolExists("mne_sss")) QSKIP("mne_sss not found");
+        QString rawFile = m_sResourcePath + "MEG/sample/test_hpiFit_raw.fif";
+        if (!QFile::exists(rawFile)) QSKIP("Raw file not available");
+
+        QTemporaryDir tempDir;
+        QVERIFY(tempDir.isValid());
+        QString outFile = tempDir.filePath("test_mne_sss_mc_raw.fif");
+        QString posFile = tempDir.filePath("test_mne_sss.pos");
+        QString output = runTool("mne_sss", {"--in", rawFile, "--out", outFile, "--pos", posFile, "--movecomp",
+                                             "--hpi-freqs", "166,154,161,158", "--hpi-step", "1000"}, 300000);
+        QVERIFY(output.contains("movement compensation"));
+
+        FiffInfo info;
+        MatrixXd matData;
+        QVERIFY(readRaw(rawFile, info, matData));
+        FiffInfo infoOut;
+        MatrixXd matOut;
+        QVERIFY(readRaw(outFile, infoOut, matOut));
+        QCOMPARE(matOut.rows(), matData.rows());
+        QCOMPARE(matOut.cols(), matData.cols());
+        QVERIFY(matOut.allFinite());
+
+        // Only the MEG channels are processed
+        for (int i = 0; i < info.chs.size(); ++i) {
+            if (info.chs.at(i).kind != FIFFV_MEG_CH) {
+                QVERIFY((matOut.row(i) - matData.row(i)).norm() <= 1e-5 * matData.row(i).norm() + 1e-20);
+            }
+        }
+
+        // One head position per second after the header, time stamped from the start of the acquisition
+        QFile filePos(posFile);
+        QVERIFY(filePos.open(QIODevice::ReadOnly | QIODevice::Text));
+        const QStringList lLines = QString(filePos.readAll()).split("\n", Qt::SkipEmptyParts);
+        const int iStep = static_cast<int>(std::lround(info.sfreq));
+        QCOMPARE(static_cast<int>(lLines.size()), static_cast<int>(matData.cols() - 1) / iStep + 2);
+
+        QFile fileRaw(rawFile);
+        FiffRawData raw(fileRaw);
+        for (int k = 1; k < lLines.size(); ++k) {
+            const QStringList lValues = lLines.at(k).split(" ", Qt::SkipEmptyParts);
+            QCOMPARE(static_cast<int>(lValues.size()), 10);
+            QVERIFY(qAbs(lValues.at(0).toDouble() - (raw.first_samp + (k - 1) * iStep) / info.sfreq) < 1e-3);
+        }
+    }
+
     //=========================================================================================================
     // mne_make_eeg_layout
     //=========================================================================================================
@@ -0,0 +1,252 @@
+//=============================================================================================================
+/**
+ * @file     test_utils_fft_plan_cache.cpp
+ * @author   Christoph Dinh <christoph.dinh@mne-cpp.org>
+ * @since    2.1.0
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, Christoph Dinh. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    Unit tests and micro-benchmark for FftPlanCache.
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <math/fft_plan_cache.h>
+
+#include <thread>
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+#include <unsupported/Eigen/FFT>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QElapsedTimer>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace Eigen;
+
+//=============================================================================================================
+// TEST CLASS
+//=============================================================================================================
+
+class TestFftPlanCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    // Engine handling
+    void testSameEnginePerThread();
+    void testEnginePerFlagCombination();
+    void testSeparateEnginePerThread();
+
+    // Transforms
+    void testCachedMatchesFresh();
+    void testFwdRowsMatchesSingleRows();
+    void testFwdRowsZeroPads();
+    void testInvRowsRoundTrip();
+
+    // Performance
+    void benchmarkTransformsPerSecond();
+};
+
+//=============================================================================================================
+
+void TestFftPlanCache::testSameEnginePerThread()
+{
+    QVERIFY(&FftPlanCache::get(true) == &FftPlanCache::get(true));
+    QVERIFY(&FftPlanCache::get() == &FftPlanCache::get(false, false));
+}
+
+//=============================================================================================================
+
+void TestFftPlanCache::testEnginePerFlagCombination()
+{
+    FFT<double>& fftFull = FftPlanCache::get(false, false);
+    FFT<double>& fftHalf = FftPlanCache::get(true, false);
+    FFT<double>& fftUnscaled = FftPlanCache::get(false, true);
+
+    QVERIFY(&fftFull != &fftHalf);
+    QVERIFY(&fftFull != &fftUnscaled);
+    QVERIFY(!fftFull.HasFlag(FFT<double>::HalfSpectrum));
+    QVERIFY(fftHalf.HasFlag(FFT<double>::HalfSpectrum));
+    QVERIFY(fftUnscaled.HasFlag(FFT<double>::Unscaled));
+}
+
+//=============================================================================================================
+
+void TestFftPlanCache::testSeparateEnginePerThread()
+{
+    const FFT<double>* pMain = &FftPlanCache::get(true);
+    const FFT<double>* pOther = nullptr;
+
+    std::thread worker([&pOther]() { pOther = &FftPlanCache::get(true); });
+    worker.join();
+
+    QVERIFY(pOther != nullptr);
+    QVERIFY(pOther != pMain);
+}
+
+//=============================================================================================================
+
+void TestFftPlanCache::testCachedMatchesFresh()
+{
+    const int iNfft = 512;
+    VectorXd vecData = VectorXd::Random(iNfft);
+
+    FFT<double> fftFresh;
+    fftFresh.SetFlag(fftFresh.HalfSpectrum);
+    VectorXcd vecExpected;
+    fftFresh.fwd(vecExpected, vecData);
+
+    // Run twice so that the second call hits the cached plan
+    for(int i = 0; i < 2; ++i) {
+        VectorXcd vecSpec;
+        FftPlanCache::get(true).fwd(vecSpec, vecData);
+        QCOMPARE(vecSpec.size(), vecExpected.size());
+        QVERIFY((vecSpec - vecExpected).cwiseAbs().maxCoeff() < 1e-12);
+    }
+}
+
+//=============================================================================================================
+
+void TestFftPlanCache::testFwdRowsMatchesSingleRows()
+{
+    const int iNfft = 256;
+    MatrixXd matData = MatrixXd::Random(6, iNfft);
+
+    MatrixXcd matSpectra;
+    FftPlanCache::fwdRows(matSpectra, matData, iNfft);
+    QCOMPARE(matSpectra.rows(), matData.rows());
+    QCOMPARE(matSpectra.cols(), static_cast<Index>(iNfft / 2 + 1));
+
+    FFT<double> fft;
+    fft.SetFlag(fft.HalfSpectrum);
+    for(Index i = 0; i < matData.rows(); ++i) {
+        VectorXd vecRow = matData.row(i).transpose();
+        VectorXcd vecSpec;
+        fft.fwd(vecSpec, vecRow);
+        QVERIFY((matSpectra.row(i).transpose() - vecSpec).cwiseAbs().maxCoeff() < 1e-12);
+    }
+
+    MatrixXcd matFull;
+    FftPlanCache::fwdRows(matFull, matData, iNfft, false);
+    QCOMPARE(matFull.cols(), static_cast<Index>(iNfft));
+    QVERIFY((matFull.leftCols(iNfft / 2 + 1) - matSpectra).cwiseAbs().maxCoeff() < 1e-12);
+}
+
+//=============================================================================================================
+
+void TestFftPlanCache::testFwdRowsZeroPads()
+{
+    const int iNfft = 128;
+    MatrixXd matData = MatrixXd::Random(3, 100);
+    MatrixXd matPadded = MatrixXd::Zero(3, iNfft);
+    matPadded.leftCols(100) = matData;
+
+    MatrixXcd matSpectra, matExpected;
+    FftPlanCache::fwdRows(matSpectra, matData, iNfft);
+    FftPlanCache::fwdRows(matExpected, matPadded, iNfft);
+
+    QVERIFY((matSpectra - matExpected).cwiseAbs().maxCoeff() < 1e-12);
+}
+
+//=============================================================================================================
+
+void TestFftPlanCache::testInvRowsRoundTrip()
+{
+    QList<int> lengths;
+    lengths << 64 << 100 << 1000;
+
+    for(int iNfft : lengths) {
+        MatrixXd matData = MatrixXd::Random(4, iNfft);
+
+        MatrixXcd matSpectra;
+        MatrixXd matBack;
+        FftPlanCache::fwdRows(matSpectra, matData, iNfft);
+        FftPlanCache::invRows(matBack, matSpectra, iNfft);
+
+        QCOMPARE(matBack.rows(), matData.rows());
+        QCOMPARE(matBack.cols(), matData.cols());
+        QVERIFY((matBack - matData).cwiseAbs().maxCoeff() < 1e-10);
+    }
+}
+
+//=============================================================================================================
+
+void TestFftPlanCache::benchmarkTransformsPerSecond()
+{
+    QList<int> lengths;
+    lengths << 256 << 1024 << 4096 << 16384 << 65536;
+
+    for(int iNfft : lengths) {
+        const int iReps = qMax(16, (1 << 22) / iNfft);
+        VectorXd vecData = VectorXd::Random(iNfft);
+        VectorXcd vecSpec;
+        QElapsedTimer timer;
+
+        // A new engine per transform, as the call sites did before
+        timer.start();
+        for(int i = 0; i < iReps; ++i) {
+            FFT<double> fft;
+            fft.SetFlag(fft.HalfSpectrum);
+            fft.fwd(vecSpec, vecData);
+        }
+        const double dFreshSec = qMax<qint64>(timer.nsecsElapsed(), 1) * 1e-9;
+
+        // The cached engine
+        FftPlanCache::get(true).fwd(vecSpec, vecData);
+        timer.restart();
+        for(int i = 0; i < iReps; ++i) {
+            FftPlanCache::get(true).fwd(vecSpec, vecData);
+        }
+        const double dCachedSec = qMax<qint64>(timer.nsecsElapsed(), 1) * 1e-9;
+
+        qInfo("nfft %6d: fresh %10.0f transforms/s, cached %10.0f transforms/s (x%.2f)",
+              iNfft,
+              iReps / dFreshSec,
+              iReps / dCachedSec,
+              dFreshSec / dCachedSec);
+    }
+
+    FftPlanCache::clear();
+}
+
+//=============================================================================================================
+
+QTEST_GUILESS_MAIN(TestFftPlanCache)
+#include "test_utils_fft_plan_cache.moc"
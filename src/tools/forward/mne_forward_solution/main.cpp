@@ -38,6 +38,7 @@
 
 #include <fwd/compute_fwd/compute_fwd_settings.h>
 #include <fwd/compute_fwd/compute_fwd.h>
+#include <fwd/fwd_bem_model.h>
 #include <mne/mne_forward_solution.h>
 
 #include <memory>
@@ -51,6 +52,7 @@
 #include <QApplication>
 #include <QCommandLineParser>
 #include <QFile>
+#include <QElapsedTimer>
 
 //=============================================================================================================
 // USED NAMESPACES
@@ -129,11 +131,17 @@ int main(int argc, char *argv[])
     QCommandLineOption mindistoutOpt("mindistout", "Output file for omitted source space points.", "file");
     QCommandLineOption includeallOpt("includeall", "Omit all source space checks.");
 
+    // Performance
+    QCommandLineOption threadsOpt("threads", "Number of threads for the field computation (default: all cores, 1 = no threads).", "n");
+    QCommandLineOption bemcacheOpt("bemcache", "Directory of the cache of computed BEM solutions (default: $MNE_BEM_SOL_CACHE or the user cache location).", "dir");
+    QCommandLineOption nobemcacheOpt("nobemcache", "Do not use the cache of computed BEM solutions.");
+
     parser.addOptions({srcOpt, measOpt, fwdOpt,
                        mriOpt, transOpt, notransOpt,
                        bemOpt, originOpt, eegscalpOpt, eegmodelsOpt, eegmodelOpt, eegradOpt,
                        megOpt, eegOpt, gradOpt, fixedOpt, accurateOpt, mricoordOpt, allOpt,
-                       labelOpt, mindistOpt, mindistoutOpt, includeallOpt});
+                       labelOpt, mindistOpt, mindistoutOpt, includeallOpt,
+                       threadsOpt, bemcacheOpt, nobemcacheOpt});
 
     parser.process(app);
 
@@ -242,15 +250,36 @@ int main(int argc, char *argv[])
     if (parser.isSet(includeallOpt))
         settings->filter_spaces = false;
 
+    // Performance
+    if (parser.isSet(threadsOpt)) {
+        bool ok;
+        int nthreads = parser.value(threadsOpt).toInt(&ok);
+        if (!ok || nthreads < 1) {
+            qCritical("The number of threads must be a positive integer.");
+            return 1;
+        }
+        settings->nthreads = nthreads;
+        settings->use_threads = nthreads > 1;
+    }
+    if (parser.isSet(nobemcacheOpt))
+        FwdBemModel::fwd_bem_set_solution_cache_dir(QString());
+    else if (parser.isSet(bemcacheOpt))
+        FwdBemModel::fwd_bem_set_solution_cache_dir(parser.value(bemcacheOpt));
+
     //=========================================================================================================
     // Run forward computation
     //=========================================================================================================
 
     settings->checkIntegrity();
 
+    QElapsedTimer timer;
+    timer.start();
+
     ComputeFwd computer(settings);
     auto fwdSolution = computer.calculateFwd();
 
+    qInfo("Forward computation took %.2f s.", timer.elapsed() / 1000.0);
+
     QFile fwdFile(settings->solname);
     fwdSolution->write(fwdFile);
 
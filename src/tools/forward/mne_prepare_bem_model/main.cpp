@@ -140,7 +140,7 @@ int main(int argc, char *argv[])
 
     // Compute the BEM solution
     printf("\nComputing BEM solution...\n");
-    if (bemModel->fwd_bem_compute_solution(bemMethod) != 0) {
+    if (bemModel->fwd_bem_compute_cached_solution(bemMethod) != 0) {
         qCritical("BEM solution computation failed.");
         return 1;
     }
@@ -677,7 +677,7 @@ bool SetupForwardModel::prepareBemSolution(const QString& bemFile,
 
     printf("Computing the linear collocation solution...\n");
 
-    int result = bemModel->fwd_bem_compute_solution(FWD_BEM_LINEAR_COLL);
+    int result = bemModel->fwd_bem_compute_cached_solution(FWD_BEM_LINEAR_COLL);
     if (result != 0) {
         qCritical() << "BEM solution computation failed.";
         return false;
@@ -52,6 +52,7 @@
 #include <mne/mne.h>
 #include <mne/mne_inverse_operator.h>
 #include <inv/inv_source_estimate.h>
+#include <inv/inv_stc_file.h>
 #include <mne/mne_source_spaces.h>
 
 #include <inv/minimum_norm/inv_minimum_norm.h>
@@ -73,6 +74,8 @@
 #include <QDirIterator>
 #include <QDebug>
 #include <QRegularExpression>
+#include <QThread>
+#include <QtConcurrent>
 
 //=============================================================================================================
 // EIGEN INCLUDES
@@ -81,6 +84,15 @@
 #include <Eigen/Core>
 #include <Eigen/SparseCore>
 
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <vector>
+
 //=============================================================================================================
 // USED NAMESPACES
 //=============================================================================================================
@@ -343,6 +355,280 @@ static InvSourceEstimate processLabelDir(const QString &labelDir,
     return InvSourceEstimate(avgData, avgVertices, fullStc.tmin, fullStc.tstep);
 }
 
+//=============================================================================================================
+// HELPER: method tag used in output file names
+//=============================================================================================================
+
+static QString methodTag(const QString &method)
+{
+    if (method == "dSPM") return "spm";
+    if (method == "sLORETA") return "sloreta";
+    return "mne";
+}
+
+//=============================================================================================================
+// HELPER: one STC output of the streaming mode
+//=============================================================================================================
+
+struct StreamOutput
+{
+    VectorXi vertices;              /**< Vertex numbers written to the STC header. */
+    SparseMatrix<double> select;    /**< Picks or averages the rows of the full source estimate. */
+    InvStcFile file;                /**< The STC file, extended block by block. */
+};
+
+//=============================================================================================================
+// Streaming mode: apply the inverse to the raw data block by block
+//=============================================================================================================
+
+/**
+ * Reads the raw data in blocks of blockSize samples, applies the inverse to each block on a worker pool and
+ * appends the results to the STC outputs in time order. At most one block per thread is in flight, so the
+ * memory needed depends on the block size and the number of threads only, not on the length of the recording.
+ * The outputs are the same as those of the in-memory mode: one average waveform per label with labelDir,
+ * one STC per label with labelFiles, and the lh/rh full source space estimates otherwise.
+ */
+static int streamRawInverse(const FiffRawData &raw,
+                            const RowVectorXi &picks,
+                            const MNEInverseOperator &invOp,
+                            float lambda2,
+                            const QString &method,
+                            bool pickNormal,
+                            int nave,
+                            const QString &labelDir,
+                            const QStringList &labelFiles,
+                            const QString &labelListName,
+                            const QString &inName,
+                            const QString &outName,
+                            int blockSize)
+{
+    float tstep = 1.0f / raw.info.sfreq;
+    float tmin = static_cast<float>(raw.first_samp) * tstep;
+
+    // The label modes use one average, as the in-memory mode does
+    bool labelMode = !labelDir.isEmpty() || !labelFiles.isEmpty();
+    InvMinimumNorm minimumNorm(invOp, lambda2, method);
+    minimumNorm.doInverseSetup(labelMode ? 1 : nave, pickNormal);
+
+    // Layout of the full source estimate
+    VectorXi vertices(invOp.src[0].vertno.size() + invOp.src[1].vertno.size());
+    vertices << invOp.src[0].vertno, invOp.src[1].vertno;
+    int nSrc = vertices.size();
+    InvSourceEstimate layout(MatrixXd::Zero(nSrc, 0), vertices, tmin, tstep);
+
+    std::vector<std::unique_ptr<StreamOutput>> outputs;
+    QStringList labelNames;
+
+    auto addOutput = [&](const QString &fileName, const VectorXi &outVertices,
+                         const std::vector<Triplet<double>> &triplets) -> bool {
+        auto output = std::make_unique<StreamOutput>();
+        output->vertices = outVertices;
+        output->select.resize(outVertices.size(), nSrc);
+        output->select.setFromTriplets(triplets.begin(), triplets.end());
+        if (!output->file.create(fileName, tmin, tstep, outVertices)) {
+            fprintf(stderr, "Error: Failed to write STC file: %s\n", fileName.toUtf8().constData());
+            return false;
+        }
+        outputs.push_back(std::move(output));
+        return true;
+    };
+
+    if (!labelDir.isEmpty()) {
+        //-----------------------------------------------------------------------------------------------------
+        // FsLabel directory mode: average waveform for each label
+        //-----------------------------------------------------------------------------------------------------
+        QStringList dirLabels = findLabelsInDir(labelDir);
+        std::vector<Triplet<double>> triplets;
+        std::vector<int> avgVertices;
+
+        printf("Found %lld label files in %s\n", (long long)dirLabels.size(), labelDir.toUtf8().constData());
+        for (const QString &labelFile : dirLabels) {
+            FsLabel label;
+            int hemi = labelHemisphere(labelFile);
+            if (!FsLabel::read(labelFile, label) || hemi < 0) {
+                qWarning() << "  Skipping label:" << labelFile;
+                continue;
+            }
+            label.hemi = hemi;
+
+            VectorXi labelIndices = layout.getIndicesByLabel(QList<FsLabel>() << label, false);
+            if (labelIndices.size() == 0) {
+                qWarning() << "  No source vertices found in label:" << labelFile;
+                continue;
+            }
+            for (int j = 0; j < labelIndices.size(); ++j) {
+                triplets.emplace_back(static_cast<int>(avgVertices.size()), labelIndices(j),
+                                      1.0 / labelIndices.size());
+            }
+            avgVertices.push_back(vertices(labelIndices(0)));
+            labelNames.append(QFileInfo(labelFile).fileName());
+        }
+        if (avgVertices.empty()) {
+            fprintf(stderr, "Error: FsLabel directory processing failed.\n");
+            return 1;
+        }
+
+        QString stcOut = outName;
+        if (!stcOut.endsWith(".stc") && !stcOut.endsWith(".fif")) {
+            stcOut += "-lh.stc";
+        }
+        if (!addOutput(stcOut, Map<VectorXi>(avgVertices.data(), avgVertices.size()), triplets)) {
+            return 1;
+        }
+    } else if (!labelFiles.isEmpty()) {
+        //-----------------------------------------------------------------------------------------------------
+        // Individual label mode: the label vertices of the full estimate
+        //-----------------------------------------------------------------------------------------------------
+        for (const QString &labelFile : labelFiles) {
+            FsLabel label;
+            int hemi = labelHemisphere(labelFile);
+            if (!FsLabel::read(labelFile, label) || hemi < 0) {
+                fprintf(stderr, "Warning: Skipping label %s (no result).\n", labelFile.toUtf8().constData());
+                continue;
+            }
+            label.hemi = hemi;
+
+            VectorXi labelIndices = layout.getIndicesByLabel(QList<FsLabel>() << label, false);
+            if (labelIndices.size() == 0) {
+                fprintf(stderr, "Warning: Skipping label %s (no result).\n", labelFile.toUtf8().constData());
+                continue;
+            }
+            std::vector<Triplet<double>> triplets;
+            VectorXi labelVertices(labelIndices.size());
+            for (int j = 0; j < labelIndices.size(); ++j) {
+                triplets.emplace_back(j, labelIndices(j), 1.0);
+                labelVertices(j) = vertices(labelIndices(j));
+            }
+
+            QString stcOut;
+            if (!outName.isEmpty() && labelFiles.size() == 1) {
+                stcOut = outName;
+            } else {
+                QFileInfo fi(labelFile);
+                stcOut = fi.path() + "/" + fi.completeBaseName() + "-" + methodTag(method)
+                         + (hemi == 0 ? "-lh.stc" : "-rh.stc");
+            }
+            if (!addOutput(stcOut, labelVertices, triplets)) {
+                return 1;
+            }
+        }
+    } else {
+        //-----------------------------------------------------------------------------------------------------
+        // Full source space mode: lh and rh estimates
+        //-----------------------------------------------------------------------------------------------------
+        QString stcOut;
+        if (!outName.isEmpty()) {
+            stcOut = outName;
+            if (stcOut.endsWith("-lh.stc") || stcOut.endsWith("-rh.stc")) stcOut.chop(7);
+        } else {
+            QFileInfo fi(inName);
+            stcOut = fi.path() + "/" + fi.completeBaseName() + "-" + methodTag(method);
+        }
+
+        int nSrcLh = invOp.src[0].nuse;
+        int nSrcRh = invOp.src[1].nuse;
+        int from = 0;
+        for (int hemi = 0; hemi < 2; ++hemi) {
+            int n = (hemi == 0) ? nSrcLh : nSrcRh;
+            if (n == 0) {
+                continue;
+            }
+            std::vector<Triplet<double>> triplets;
+            for (int j = 0; j < n; ++j) {
+                triplets.emplace_back(j, from + j, 1.0);
+            }
+            if (!addOutput(stcOut + (hemi == 0 ? "-lh.stc" : "-rh.stc"), vertices.segment(from, n), triplets)) {
+                return 1;
+            }
+            from += n;
+        }
+    }
+    if (outputs.empty()) {
+        fprintf(stderr, "Error: Nothing to compute.\n");
+        return 1;
+    }
+
+    //---------------------------------------------------------------------------------------------------------
+    // Read, compute and write block by block
+    //---------------------------------------------------------------------------------------------------------
+    int nThreads = std::max(1, QThread::idealThreadCount());
+    int nBlocks = (raw.last_samp - raw.first_samp) / blockSize + 1;
+    std::deque<QFuture<std::vector<MatrixXd>>> pending;
+    bool ok = true;
+
+    printf("\nStreaming %d blocks of up to %d samples on %d threads...\n", nBlocks, blockSize, nThreads);
+
+    auto writeNext = [&]() {
+        std::vector<MatrixXd> results = pending.front().result();
+        pending.pop_front();
+        if (results.size() != outputs.size()) {
+            ok = false;
+            return;
+        }
+        for (size_t i = 0; i < outputs.size(); ++i) {
+            ok = ok && outputs[i]->file.append(results[i]);
+        }
+    };
+
+    for (int from = raw.first_samp; ok && from <= raw.last_samp; from += blockSize) {
+        int to = std::min(from + blockSize - 1, static_cast<int>(raw.last_samp));
+        MatrixXd block;
+        MatrixXd times;
+        if (!raw.read_raw_segment(block, times, from, to, picks)) {
+            fprintf(stderr, "Error: Failed to read raw data segment %d ... %d.\n", from, to);
+            ok = false;
+            break;
+        }
+        pending.push_back(QtConcurrent::run([&minimumNorm, &outputs, pickNormal,
+                                             block = std::move(block)]() {
+            // The inverse is set up once, the blocks are applied without the per call messages
+            std::vector<MatrixXd> results;
+            MatrixXd sol = minimumNorm.applyInverse(block, pickNormal);
+            if (sol.size() > 0) {
+                for (const auto &output : outputs) {
+                    results.push_back(output->select * sol);
+                }
+            }
+            return results;
+        }));
+        if (static_cast<int>(pending.size()) >= nThreads) {
+            writeNext();
+        }
+    }
+    while (!pending.empty()) {
+        if (ok) {
+            writeNext();
+        } else {
+            pending.front().waitForFinished();
+            pending.pop_front();
+        }
+    }
+
+    for (const auto &output : outputs) {
+        printf("  Wrote %s (%d sources, %d time points)\n",
+               output->file.fileName().toUtf8().constData(), (int)output->vertices.size(),
+               output->file.nTimes());
+        output->file.close();
+    }
+    if (!ok) {
+        fprintf(stderr, "Error: Streaming inverse computation failed.\n");
+        return 1;
+    }
+
+    if (!labelListName.isEmpty() && !labelNames.isEmpty()) {
+        QFile labelListFile(labelListName);
+        if (labelListFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            QTextStream out(&labelListFile);
+            for (const QString &name : labelNames) {
+                out << name << "\n";
+            }
+            labelListFile.close();
+            printf("FsLabel names output to %s\n", labelListName.toUtf8().constData());
+        }
+    }
+    return 0;
+}
+
 //=============================================================================================================
 // MAIN
 //=============================================================================================================
@@ -464,6 +750,12 @@ int main(int argc, char *argv[])
         "Output the names of labels used from --labeldir to this file.", "file");
     parser.addOption(labelListOpt);
 
+    // --blocksize: Streaming block size for raw data
+    QCommandLineOption blockSizeOpt(QStringList() << "blocksize",
+        "Process raw data in blocks of this many samples on all cores and write the results "
+        "incrementally (default: 2000, 0 = read the whole file at once).", "samples", "2000");
+    parser.addOption(blockSizeOpt);
+
     parser.process(app);
 
     //=========================================================================================================
@@ -525,6 +817,12 @@ int main(int argc, char *argv[])
     bool pickNormal = parser.isSet(pickNormalOpt);
     int nave = parser.isSet(naveOpt) ? parser.value(naveOpt).toInt() : -1;
 
+    int blockSize = parser.value(blockSizeOpt).toInt();
+    if (blockSize < 0) {
+        fprintf(stderr, "Error: Block size must not be negative.\n");
+        return 1;
+    }
+
     // With --labeldir, always pick normal component
     if (!labelDir.isEmpty()) {
         pickNormal = true;
@@ -547,6 +845,9 @@ int main(int argc, char *argv[])
     if (pickNormal) {
         printf("Picking normal component to cortex\n");
     }
+    if (blockSize > 0) {
+        printf("Raw data block size    : %d samples\n", blockSize);
+    }
 
     if (!labelFiles.isEmpty()) {
         printf("FsLabel files to process :\n");
@@ -647,8 +948,7 @@ int main(int argc, char *argv[])
             }
 
             // Compose output file name
-            QString tag = (method == "dSPM") ? "spm" : "mne";
-            if (method == "sLORETA") tag = "sloreta";
+            QString tag = methodTag(method);
             QString stcOut;
             if (!curOutName.isEmpty() && labelFiles.size() == 1) {
                 stcOut = curOutName;
@@ -698,8 +998,7 @@ int main(int argc, char *argv[])
             else if (stcOut.endsWith("-rh.stc")) stcOut.chop(7);
         } else {
             QFileInfo fi(inName);
-            QString tag = (method == "dSPM") ? "spm" : "mne";
-            if (method == "sLORETA") tag = "sloreta";
+            QString tag = methodTag(method);
             stcOut = fi.path() + "/" + fi.completeBaseName() + "-" + tag;
         }
 
@@ -794,6 +1093,16 @@ int main(int argc, char *argv[])
             raw.info.projs[k].active = true;
         }
 
+        if (blockSize > 0) {
+            // Stream the data through the inverse block by block
+            raw.mapFile();
+            int result = streamRawInverse(raw, picks, inverseOperator, lambda2, method, pickNormal, nave,
+                                          labelDir, labelFiles, labelListName, inName, outName, blockSize);
+            if (result != 0) return result;
+            printf("\nFinished.\n");
+            return 0;
+        }
+
         // Read the full raw segment
         MatrixXd inputData;
         MatrixXd times;
@@ -887,8 +1196,7 @@ int main(int argc, char *argv[])
                 setOutName = outName + "-" + commentTag;
             } else {
                 QFileInfo fi(inName);
-                QString tag = (method == "dSPM") ? "spm" : "mne";
-                if (method == "sLORETA") tag = "sloreta";
+                QString tag = methodTag(method);
                 setOutName = fi.path() + "/" + fi.completeBaseName() + "-" + tag + "-" + commentTag;
             }
 
@@ -39,6 +39,7 @@
 #include <fiff/fiff_info.h>
 #include <fiff/fiff_ctf_comp.h>
 #include <fiff/fiff_stream.h>
+#include <fiff/fiff_raw_pipeline.h>
 #include <utils/generics/mne_logger.h>
 
 //=============================================================================================================
@@ -131,41 +132,45 @@ int main(int argc, char *argv[])
     }
     printf("Compensation matrix created (%d -> %d)\n", currentComp, grade);
 
-    // Read all data
-    MatrixXd data;
-    MatrixXd times;
-
-    if (!raw.read_raw_segment(data, times)) {
-        qCritical("Cannot read raw data segment");
-        return 1;
-    }
-    printf("Read %d channels x %d samples\n", (int)data.rows(), (int)data.cols());
-
-    // Apply compensation
-    data = comp.data->data.cast<double>() * data;
-    printf("Compensation applied.\n");
-
     // Update compensation info
-    raw.info.set_current_comp(grade);
+    FiffInfo infoOut = raw.info;
+    infoOut.set_current_comp(grade);
 
     // Write output
     QFile fileOut(outFile);
     Eigen::RowVectorXd cals;
-    FiffStream::SPtr outStream = FiffStream::start_writing_raw(fileOut, raw.info, cals);
+    FiffStream::SPtr outStream = FiffStream::start_writing_raw(fileOut, infoOut, cals);
     if (!outStream) {
         qCritical("Cannot open output file: %s", qPrintable(outFile));
         return 1;
     }
 
-    // Write data in chunks
-    int chunkSize = 10000;
-    for (int start = 0; start < data.cols(); start += chunkSize) {
-        int end = std::min(start + chunkSize, (int)data.cols());
-        MatrixXd chunk = data.block(0, start, data.rows(), end - start);
-        outStream->write_raw_buffer(chunk);
+    fiff_int_t firstSamp = raw.first_samp;
+    if (firstSamp > 0) {
+        outStream->write_int(FIFF_FIRST_SAMPLE, &firstSamp);
     }
+    outStream->start_write_behind();
+
+    // Read, compensate and write in overlapping stages. The compensation is stateless, so blocks can be
+    // processed by several workers at once.
+    const MatrixXd matComp = comp.data->data.cast<double>();
+    FiffRawPipeline pipeline(raw, 10000);
+    pipeline.setNumWorkers(0);
+
+    bool ok = pipeline.run([&matComp](FiffRawBlock& block) {
+                               block.matData = matComp * block.matData;
+                               return true;
+                           },
+                           outStream,
+                           cals);
 
     outStream->finish_writing_raw();
+
+    if (!ok) {
+        qCritical("Cannot compensate raw data");
+        return 1;
+    }
+    printf("Compensated %d channels x %d samples.\n", pipeline.getStats().iChannels, (int)pipeline.getStats().iSamples);
     printf("Written compensated data to: %s\n", qPrintable(outFile));
 
     return 0;
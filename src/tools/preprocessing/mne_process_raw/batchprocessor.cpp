@@ -38,6 +38,7 @@
 //=============================================================================================================
 
 #include "batchprocessor.h"
+#include "fusedprocessor.h"
 
 #include <mne/mne_description_parser.h>
 
@@ -45,6 +46,7 @@
 #include <fiff/fiff_events.h>
 #include <fiff/fiff_stream.h>
 #include <fiff/fiff_file.h>
+#include <fiff/fiff_proj.h>
 
 #include <mne/mne.h>
 
@@ -53,6 +55,12 @@
 #include <QDir>
 #include <QTextStream>
 
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 //=============================================================================================================
 // USED NAMESPACES
 //=============================================================================================================
@@ -62,6 +70,36 @@ using namespace FIFFLIB;
 using namespace MNELIB;
 using namespace Eigen;
 
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace
+{
+
+/** A message logged while processing one raw file concurrently with others. */
+struct BufferedMessage
+{
+    QtMsgType type;
+    QString msg;
+};
+
+thread_local QList<BufferedMessage>* t_pMessageBuffer = nullptr;    /**< Buffer of the file this thread works on. */
+std::mutex g_messageMutex;                                          /**< Guards the buffers, which the pipeline threads of a file share. */
+QtMessageHandler g_previousMessageHandler = nullptr;
+
+void bufferMessage(QtMsgType type, const QMessageLogContext &context, const QString &msg)
+{
+    if (t_pMessageBuffer && type != QtFatalMsg) {
+        std::lock_guard<std::mutex> lock(g_messageMutex);
+        t_pMessageBuffer->append({type, msg});
+        return;
+    }
+    g_previousMessageHandler(type, context, msg);
+}
+
+} // namespace
+
 //=============================================================================================================
 // DEFINE MEMBER METHODS
 //=============================================================================================================
@@ -123,295 +161,628 @@ bool BatchProcessor::writeLog(const QString &logFile, const QString &log)
 
 //=============================================================================================================
 
-int BatchProcessor::run(const ProcessingSettings &settings)
+QString BatchProcessor::fileForRaw(const QStringList &files, int f, bool reuseLast)
 {
-    if (settings.rawFiles.isEmpty()) {
-        qCritical() << "Raw data file not specified.";
-        return 1;
+    if (f < files.size())
+        return files[f];
+    if (reuseLast && !files.isEmpty())
+        return files.last();
+    return QString();
+}
+
+//=============================================================================================================
+
+void BatchProcessor::readEvents(const QString &eventFile, FiffEvents &events)
+{
+    if (eventFile.isEmpty())
+        return;
+
+    qInfo() << "Loading events from" << eventFile;
+    QFile evtFile(eventFile);
+    if (eventFile.endsWith(".fif", Qt::CaseInsensitive)) {
+        FiffEvents::read_from_fif(evtFile, events);
+    } else {
+        FiffEvents::read_from_ascii(evtFile, events);
+    }
+}
+
+//=============================================================================================================
+
+void BatchProcessor::writeEvents(const QString &eventFile, const FiffEvents &events, float sfreq)
+{
+    if (eventFile.isEmpty())
+        return;
+
+    qInfo() << "\n--- Saving events to" << eventFile << "---\n";
+    QFile evtOutFile(eventFile);
+    if (eventFile.endsWith(".fif", Qt::CaseInsensitive)) {
+        events.write_to_fif(evtOutFile);
+    } else {
+        events.write_to_ascii(evtOutFile, sfreq);
     }
+}
 
-    qInfo() << "\n--- mne_process_raw batch processing ---\n";
+//=============================================================================================================
 
-    // Storage for grand average computation
-    QList<FiffEvokedSet> allAverages;
-    QList<FiffCov> allCovariances;
+QList<FiffProj> BatchProcessor::readProjections(const QStringList &projFiles)
+{
+    QList<FiffProj> loadedProjs;
+    for (const QString &projFile : projFiles) {
+        QFile pFile(projFile);
+        FiffStream::SPtr pStream(new FiffStream(&pFile));
+        if (pStream->open()) {
+            QList<FiffDirNode::SPtr> projNodes = pStream->dirtree()->dir_tree_find(FIFFB_PROJ);
+            if (!projNodes.isEmpty()) {
+                QList<FiffProj> fileProjs = pStream->read_proj(projNodes[0]);
+                loadedProjs.append(fileProjs);
+            }
+            pStream->close();
+        }
+    }
+    return loadedProjs;
+}
 
-    // Process each raw file
-    for (int f = 0; f < settings.rawFiles.size(); ++f) {
-        const QString &rawName = settings.rawFiles[f];
+//=============================================================================================================
+
+void BatchProcessor::saveProjections(const ProcessingSettings &settings,
+                                     const QString &rawName,
+                                     const QList<FiffProj> &projs)
+{
+    if (settings.saveProjTag.isEmpty())
+        return;
+
+    QString projSaveName, projLogName;
+    composeSaveNames(rawName, settings.saveProjTag, settings.saveHere,
+                     projSaveName, projLogName);
+    QFile projOutFile(projSaveName);
+    FiffStream::SPtr pProjStream = FiffStream::start_file(projOutFile);
+    if (pProjStream) {
+        pProjStream->write_proj(projs);
+        pProjStream->end_file();
+    }
+}
+
+//=============================================================================================================
 
-        qInfo() << "\n--- Opening" << rawName << "---\n";
+void BatchProcessor::activateProjections(const ProcessingSettings &settings, FiffInfo &info)
+{
+    // Activate/deactivate projections
+    if (settings.projOn >= 0) {
+        for (int k = 0; k < info.projs.size(); ++k) {
+            info.projs[k].active = (settings.projOn > 0);
+        }
+        qInfo() << "Projections turned" << (settings.projOn ? "on." : "off.");
+    }
+
+    // Report projection status
+    if (!info.projs.isEmpty()) {
+        qInfo() << "\n--- Projection status ---";
+        for (int k = 0; k < info.projs.size(); ++k) {
+            qInfo() << "  " << info.projs[k].desc
+                    << (info.projs[k].active ? "[active]" : "[off]");
+        }
+    }
+}
+
+//=============================================================================================================
+
+void BatchProcessor::finishAverages(const ProcessingSettings &settings,
+                                    const QString &rawName,
+                                    const AverageDescription &aveDesc,
+                                    const FiffEvokedSet &evokedSet,
+                                    const QString &aveLog,
+                                    QList<FiffEvokedSet> &allAverages)
+{
+    // Report results
+    for (int j = 0; j < evokedSet.evoked.size(); ++j) {
+        qInfo() << "  " << evokedSet.evoked[j].comment
+                << ":" << evokedSet.evoked[j].nave << "averages";
+    }
+
+    // Compose save name
+    QString aveSaveName, aveLogName;
+    if (!settings.saveAveTag.isEmpty()) {
+        composeSaveNames(rawName, settings.saveAveTag, settings.saveHere,
+                         aveSaveName, aveLogName);
+    } else if (!aveDesc.filename.isEmpty()) {
+        aveSaveName = aveDesc.filename;
+    }
+
+    if (!aveSaveName.isEmpty()) {
+        evokedSet.save(aveSaveName);
+    }
+    writeLog(aveLogName, aveLog);
+
+    allAverages.append(evokedSet);
+}
+
+//=============================================================================================================
+
+void BatchProcessor::finishCovariance(const ProcessingSettings &settings,
+                                      const QString &rawName,
+                                      const CovDescription &covDesc,
+                                      const QList<FiffCov> &defCovs,
+                                      QList<FiffCov> &allCovariances)
+{
+    QList<FiffCov> validCovs;
+    QString covLog;
+    covLog += QString("Computing covariance matrix\n");
+
+    for (int d = 0; d < defCovs.size(); ++d) {
+        if (defCovs[d].dim > 0) {
+            validCovs.append(defCovs[d]);
+            covLog += QString("  Definition %1: %2 degrees of freedom\n")
+                .arg(d + 1).arg(defCovs[d].nfree);
+        }
+    }
 
-        // Open raw data file
-        QFile rawFile(rawName);
-        FiffRawData raw(rawFile);
+    // Combine all definitions into a single covariance
+    FiffCov cov;
+    if (validCovs.size() == 1) {
+        cov = validCovs[0];
+    } else if (validCovs.size() > 1) {
+        cov = FiffCov::computeGrandAverage(validCovs);
+    }
+
+    if (cov.dim > 0) {
+        // Compose save name
+        QString covSaveName, covLogName;
+        if (!settings.saveCovTag.isEmpty()) {
+            composeSaveNames(rawName, settings.saveCovTag, settings.saveHere,
+                             covSaveName, covLogName);
+        } else if (!covDesc.filename.isEmpty()) {
+            covSaveName = covDesc.filename;
+        }
+
+        if (!covSaveName.isEmpty()) {
+            cov.save(covSaveName);
+        }
+        writeLog(covLogName, covLog);
+
+        allCovariances.append(cov);
+    }
+}
+
+//=============================================================================================================
+
+int BatchProcessor::processFused(const ProcessingSettings &settings,
+                                 int f,
+                                 FiffRawData &raw,
+                                 QList<FiffEvokedSet> &allAverages,
+                                 QList<FiffCov> &allCovariances)
+{
+    const QString &rawName = settings.rawFiles[f];
+
+    //---------------------------------------------------------------------
+    // Everything that does not depend on the data is set up before the pass
+    //---------------------------------------------------------------------
+    FiffEvents fiffEvents;
+    readEvents(fileForRaw(settings.eventFiles, f), fiffEvents);
+
+    const bool doProj = !settings.projFiles.isEmpty() || settings.makeProj;
+    if (doProj && !settings.makeProj) {
+        QList<FiffProj> loadedProjs = readProjections(settings.projFiles);
+        if (!loadedProjs.isEmpty()) {
+            raw.info.projs = loadedProjs;
+        }
+        activateProjections(settings, raw.info);
+    }
 
-        if (raw.info.nchan == 0) {
-            qCritical() << "Failed to open raw data file:" << rawName;
+    const QString aveDescFile = fileForRaw(settings.aveFiles, f, true);
+    AverageDescription aveDesc;
+    if (!aveDescFile.isEmpty()) {
+        if (!MNEDescriptionParser::parseAverageFile(aveDescFile, aveDesc) || aveDesc.categories.isEmpty()) {
+            qCritical() << "Failed to parse averaging description file:" << aveDescFile;
             return 1;
         }
+    }
 
-        qInfo() << "Opened:" << rawName
-                << "(" << raw.info.nchan << "channels,"
-                << "sfreq =" << raw.info.sfreq << "Hz )";
-
-        //---------------------------------------------------------------------
-        // Step 1: Event detection / loading
-        //---------------------------------------------------------------------
-        FiffEvents fiffEvents;
-
-        // Try loading events from an event file first
-        QString eventInFile;
-        if (f < settings.eventFiles.size())
-            eventInFile = settings.eventFiles[f];
-
-        if (!eventInFile.isEmpty()) {
-            qInfo() << "Loading events from" << eventInFile;
-            if (eventInFile.endsWith(".fif", Qt::CaseInsensitive)) {
-                QFile evtFile(eventInFile);
-                FiffEvents::read_from_fif(evtFile, fiffEvents);
-            } else {
-                QFile evtFile(eventInFile);
-                FiffEvents::read_from_ascii(evtFile, fiffEvents);
-            }
+    const QString covDescFile = fileForRaw(settings.covFiles, f, true);
+    CovDescription covDesc;
+    if (!covDescFile.isEmpty()) {
+        if (!MNEDescriptionParser::parseCovarianceFile(covDescFile, covDesc) || covDesc.defs.isEmpty()) {
+            qCritical() << "Failed to parse covariance description file:" << covDescFile;
+            return 1;
         }
+    }
 
-        if (fiffEvents.is_empty()) {
-            // Detect from trigger channel
-            qInfo() << "Detecting events from trigger channel" << settings.digTrigger;
-            FiffEvents::detect_from_raw(raw,
-                                     fiffEvents,
-                                     settings.digTrigger,
-                                     settings.digTriggerMask,
-                                     true);
+    // The data can only be written during the pass if its header is complete beforehand, i.e., no new
+    // projectors go into it and integer output does not need the peak of the whole file
+    const QString saveFile = fileForRaw(settings.saveFiles, f);
+    const bool saveInPass = !saveFile.isEmpty() && !settings.makeProj && settings.dataType == FIFFT_FLOAT;
+    const bool saveAfterPass = !saveFile.isEmpty() && !saveInPass;
+
+    //---------------------------------------------------------------------
+    // Single pass: events, averages, covariance, SSP epochs, peak scan, save
+    //---------------------------------------------------------------------
+    // The pipeline threads log into the buffer of this file, if any
+    QList<BufferedMessage>* pMessageBuffer = t_pMessageBuffer;
+    auto routeMessages = [pMessageBuffer]() { t_pMessageBuffer = pMessageBuffer; };
+
+    FusedProcessor processor(raw);
+    processor.setThreads(settings.workers, routeMessages);
+
+    if (fiffEvents.is_empty()) {
+        qInfo() << "Detecting events from trigger channel" << settings.digTrigger;
+        processor.setTriggerDetection(settings.digTrigger, settings.digTriggerMask);
+    } else {
+        processor.setEvents(fiffEvents.events);
+    }
+
+    if (!aveDescFile.isEmpty())
+        processor.setAverageDescription(aveDesc);
+    if (!covDescFile.isEmpty())
+        processor.setCovDescription(covDesc);
+
+    if (settings.makeProj) {
+        QMap<QString,double> projReject;
+        projReject["grad"] = settings.projGradReject;
+        projReject["mag"]  = settings.projMagReject;
+        projReject["eeg"]  = settings.projEegReject;
+        processor.setProjEpochs(settings.projEvent, settings.projTmin, settings.projTmax, projReject);
+    }
+
+    processor.setPeakScan(saveAfterPass && settings.dataType != FIFFT_FLOAT);
+
+    QFile rawOutFile(saveFile);
+    if (saveInPass) {
+        qInfo() << "\n--- Saving data to" << saveFile << "(decim =" << settings.decimation << ") ---\n";
+        processor.setSave(&rawOutFile, settings.decimation, settings.dataType);
+    }
+
+    qInfo() << "\n--- Processing" << rawName << "in a single pass ---\n";
+    if (!processor.run()) {
+        qCritical() << "Failed to process raw data file:" << rawName;
+        return 1;
+    }
+
+    fiffEvents.events = processor.events();
+    qInfo() << fiffEvents.num_events() << "events found.";
+
+    writeEvents(fileForRaw(settings.eventsOutFiles, f), fiffEvents, raw.info.sfreq);
+
+    //---------------------------------------------------------------------
+    // SSP operators from the collected epochs
+    //---------------------------------------------------------------------
+    if (settings.makeProj) {
+        qInfo() << "\n--- Creating new projection operator ---\n";
+
+        QList<MatrixXd> projEpochs = processor.projEpochs();
+        qInfo() << projEpochs.size() << "epochs collected for event" << settings.projEvent;
+
+        QList<FiffProj> newProjs = FiffProj::compute_from_epochs(raw.info, projEpochs,
+                                                                 settings.projNGrad,
+                                                                 settings.projNMag,
+                                                                 settings.projNEeg);
+        if (!newProjs.isEmpty()) {
+            raw.info.projs = newProjs;
+            saveProjections(settings, rawName, newProjs);
         }
+        activateProjections(settings, raw.info);
+    }
 
-        qInfo() << fiffEvents.num_events() << "events found.";
-
-        //---------------------------------------------------------------------
-        // Step 2: Save events if requested
-        //---------------------------------------------------------------------
-        QString eventOutFile;
-        if (f < settings.eventsOutFiles.size())
-            eventOutFile = settings.eventsOutFiles[f];
-
-        if (!eventOutFile.isEmpty()) {
-            qInfo() << "\n--- Saving events to" << eventOutFile << "---\n";
-            if (eventOutFile.endsWith(".fif", Qt::CaseInsensitive)) {
-                QFile evtOutFile(eventOutFile);
-                fiffEvents.write_to_fif(evtOutFile);
-            } else {
-                QFile evtOutFile(eventOutFile);
-                fiffEvents.write_to_ascii(evtOutFile, raw.info.sfreq);
-            }
+    //---------------------------------------------------------------------
+    // Second pass, only when the output header needed the first one
+    //---------------------------------------------------------------------
+    if (saveAfterPass) {
+        qInfo() << "\n--- Saving data to" << saveFile << "(decim =" << settings.decimation << ") ---\n";
+        FusedProcessor saver(raw);
+        saver.setThreads(settings.workers, routeMessages);
+        saver.setSave(&rawOutFile, settings.decimation, settings.dataType, processor.maxAbs());
+        if (!saver.run()) {
+            qCritical() << "Failed to save raw data.";
+            return 1;
         }
+    }
 
-        //---------------------------------------------------------------------
-        // Step 3: Load/Create SSP projections
-        //---------------------------------------------------------------------
-        if (!settings.projFiles.isEmpty() || settings.makeProj) {
-            if (settings.makeProj) {
-                qInfo() << "\n--- Creating new projection operator ---\n";
-
-                QMap<QString,double> projReject;
-                projReject["grad"] = settings.projGradReject;
-                projReject["mag"]  = settings.projMagReject;
-                projReject["eeg"]  = settings.projEegReject;
-
-                QList<FiffProj> newProjs = MNE::compute_proj(
-                    raw, fiffEvents.events,
-                    settings.projEvent,
-                    settings.projTmin, settings.projTmax,
-                    settings.projNGrad, settings.projNMag, settings.projNEeg,
-                    projReject);
-
-                if (!newProjs.isEmpty()) {
-                    // Replace projections in the raw info
-                    raw.info.projs = newProjs;
-
-                    // Save if requested
-                    if (!settings.saveProjTag.isEmpty()) {
-                        QString projSaveName, projLogName;
-                        composeSaveNames(rawName, settings.saveProjTag, settings.saveHere,
-                                         projSaveName, projLogName);
-                        QFile projOutFile(projSaveName);
-                        FiffStream::SPtr pProjStream = FiffStream::start_file(projOutFile);
-                        if (pProjStream) {
-                            pProjStream->write_proj(newProjs);
-                            pProjStream->end_file();
-                        }
-                    }
-                }
-            } else {
-                // Load projections from files
-                QList<FiffProj> loadedProjs;
-                for (const QString &projFile : settings.projFiles) {
-                    QFile pFile(projFile);
-                    FiffStream::SPtr pStream(new FiffStream(&pFile));
-                    if (pStream->open()) {
-                        QList<FiffDirNode::SPtr> projNodes = pStream->dirtree()->dir_tree_find(FIFFB_PROJ);
-                        if (!projNodes.isEmpty()) {
-                            QList<FiffProj> fileProjs = pStream->read_proj(projNodes[0]);
-                            loadedProjs.append(fileProjs);
-                        }
-                        pStream->close();
-                    }
-                }
-                if (!loadedProjs.isEmpty()) {
-                    raw.info.projs = loadedProjs;
-                }
-            }
+    //---------------------------------------------------------------------
+    // Averages and covariance from the accumulated sums
+    //---------------------------------------------------------------------
+    if (!aveDescFile.isEmpty()) {
+        qInfo() << "\n--- Averaging according to" << aveDescFile << "---\n";
+        QString aveLog;
+        FiffEvokedSet evokedSet = processor.averages(raw.info, aveLog);
+        finishAverages(settings, rawName, aveDesc, evokedSet, aveLog, allAverages);
+    }
 
-            // Activate/deactivate projections
-            if (settings.projOn >= 0) {
-                for (int k = 0; k < raw.info.projs.size(); ++k) {
-                    raw.info.projs[k].active = (settings.projOn > 0);
-                }
-                qInfo() << "Projections turned" << (settings.projOn ? "on." : "off.");
-            }
+    if (!covDescFile.isEmpty()) {
+        qInfo() << "\n--- Computing covariance matrix according to" << covDescFile << "---\n";
+        finishCovariance(settings, rawName, covDesc, processor.covariances(raw.info), allCovariances);
+    }
+
+    return 0;
+}
+
+//=============================================================================================================
+
+int BatchProcessor::runConcurrently(const ProcessingSettings &settings,
+                                    int nJobs,
+                                    QList<FiffEvokedSet> &allAverages,
+                                    QList<FiffCov> &allCovariances)
+{
+    struct FileResult {
+        int status = -1;                        // -1 while not processed
+        QList<FiffEvokedSet> averages;
+        QList<FiffCov> covariances;
+        QList<BufferedMessage> messages;
+    };
+
+    const int nFiles = settings.rawFiles.size();
+    std::vector<FileResult> results(nFiles);
+
+    // Each running file is charged its size against the memory budget
+    std::vector<qint64> cost(nFiles, 0);
+    if (settings.jobMemory > 0) {
+        for (int f = 0; f < nFiles; ++f)
+            cost[f] = QFileInfo(settings.rawFiles[f]).size();
+    }
 
-            // Report projection status
-            if (!raw.info.projs.isEmpty()) {
-                qInfo() << "\n--- Projection status ---";
-                for (int k = 0; k < raw.info.projs.size(); ++k) {
-                    qInfo() << "  " << raw.info.projs[k].desc
-                            << (raw.info.projs[k].active ? "[active]" : "[off]");
-                }
+    qInfo() << "Processing" << nFiles << "raw files with" << nJobs << "jobs.";
+
+    // The jobs share the cores between their pipelines
+    ProcessingSettings jobSettings = settings;
+    jobSettings.workers = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) / nJobs);
+
+    std::mutex mutex;
+    std::condition_variable cvChanged;
+    int iNext = 0;
+    qint64 iMemoryInUse = 0;
+    bool bFailed = false;
+
+    g_previousMessageHandler = qInstallMessageHandler(bufferMessage);
+
+    // Workers start the files in order. A file waits until it fits the budget, unless nothing else runs.
+    auto worker = [&]() {
+        while (true) {
+            int f;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cvChanged.wait(lock, [&]() {
+                    return bFailed || iNext >= nFiles || settings.jobMemory <= 0 || iMemoryInUse == 0
+                           || iMemoryInUse + cost[iNext] <= settings.jobMemory;
+                });
+                if (bFailed || iNext >= nFiles)
+                    return;
+                f = iNext++;
+                iMemoryInUse += cost[f];
             }
+
+            FileResult &result = results[f];
+            t_pMessageBuffer = &result.messages;
+            int status = processFile(jobSettings, f, result.averages, result.covariances);
+            t_pMessageBuffer = nullptr;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            result.status = status;
+            iMemoryInUse -= cost[f];
+            if (status != 0)
+                bFailed = true;
+            cvChanged.notify_all();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int j = 0; j < nJobs; ++j)
+        workers.emplace_back(worker);
+
+    // Print the log of each file in one piece and in file order, as soon as it is done
+    for (int f = 0; f < nFiles; ++f) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cvChanged.wait(lock, [&]() { return results[f].status >= 0 || (bFailed && f >= iNext); });
+            if (results[f].status < 0)
+                break;
         }
+        for (const BufferedMessage &message : results[f].messages)
+            g_previousMessageHandler(message.type, QMessageLogContext(), message.msg);
+    }
 
-        //---------------------------------------------------------------------
-        // Step 4: Save filtered/decimated raw data
-        //---------------------------------------------------------------------
-        QString saveFile;
-        if (f < settings.saveFiles.size())
-            saveFile = settings.saveFiles[f];
-
-        if (!saveFile.isEmpty()) {
-            qInfo() << "\n--- Saving data to" << saveFile << "(decim =" << settings.decimation << ") ---\n";
-            QFile rawOutFile(saveFile);
-            if (!MNE::save_raw(raw, rawOutFile, RowVectorXi(), settings.decimation)) {
-                qCritical() << "Failed to save raw data.";
-                return 1;
+    for (std::thread &thread : workers)
+        thread.join();
+
+    qInstallMessageHandler(g_previousMessageHandler);
+
+    if (bFailed)
+        return 1;
+
+    // Merge in file order, so that the grand averages do not depend on the scheduling
+    for (int f = 0; f < nFiles; ++f) {
+        allAverages.append(results[f].averages);
+        allCovariances.append(results[f].covariances);
+    }
+
+    return 0;
+}
+
+//=============================================================================================================
+
+int BatchProcessor::processFile(const ProcessingSettings &settings,
+                                int f,
+                                QList<FiffEvokedSet> &allAverages,
+                                QList<FiffCov> &allCovariances)
+{
+    const QString &rawName = settings.rawFiles[f];
+
+    qInfo() << "\n--- Opening" << rawName << "---\n";
+
+    // Open raw data file
+    QFile rawFile(rawName);
+    FiffRawData raw(rawFile);
+
+    if (raw.info.nchan == 0) {
+        qCritical() << "Failed to open raw data file:" << rawName;
+        return 1;
+    }
+
+    qInfo() << "Opened:" << rawName
+            << "(" << raw.info.nchan << "channels,"
+            << "sfreq =" << raw.info.sfreq << "Hz )";
+
+    if (settings.fused)
+        return processFused(settings, f, raw, allAverages, allCovariances);
+
+    //---------------------------------------------------------------------
+    // Step 1: Event detection / loading
+    //---------------------------------------------------------------------
+    FiffEvents fiffEvents;
+
+    // Try loading events from an event file first
+    readEvents(fileForRaw(settings.eventFiles, f), fiffEvents);
+
+    if (fiffEvents.is_empty()) {
+        // Detect from trigger channel
+        qInfo() << "Detecting events from trigger channel" << settings.digTrigger;
+        FiffEvents::detect_from_raw(raw,
+                                 fiffEvents,
+                                 settings.digTrigger,
+                                 settings.digTriggerMask,
+                                 true);
+    }
+
+    qInfo() << fiffEvents.num_events() << "events found.";
+
+    //---------------------------------------------------------------------
+    // Step 2: Save events if requested
+    //---------------------------------------------------------------------
+    writeEvents(fileForRaw(settings.eventsOutFiles, f), fiffEvents, raw.info.sfreq);
+
+    //---------------------------------------------------------------------
+    // Step 3: Load/Create SSP projections
+    //---------------------------------------------------------------------
+    if (!settings.projFiles.isEmpty() || settings.makeProj) {
+        if (settings.makeProj) {
+            qInfo() << "\n--- Creating new projection operator ---\n";
+
+            QMap<QString,double> projReject;
+            projReject["grad"] = settings.projGradReject;
+            projReject["mag"]  = settings.projMagReject;
+            projReject["eeg"]  = settings.projEegReject;
+
+            QList<FiffProj> newProjs = MNE::compute_proj(
+                raw, fiffEvents.events,
+                settings.projEvent,
+                settings.projTmin, settings.projTmax,
+                settings.projNGrad, settings.projNMag, settings.projNEeg,
+                projReject);
+
+            if (!newProjs.isEmpty()) {
+                // Replace projections in the raw info
+                raw.info.projs = newProjs;
+
+                // Save if requested
+                saveProjections(settings, rawName, newProjs);
+            }
+        } else {
+            // Load projections from files
+            QList<FiffProj> loadedProjs = readProjections(settings.projFiles);
+            if (!loadedProjs.isEmpty()) {
+                raw.info.projs = loadedProjs;
             }
         }
 
-        //---------------------------------------------------------------------
-        // Step 5: Compute averages
-        //---------------------------------------------------------------------
-        QString aveDescFile;
-        if (f < settings.aveFiles.size())
-            aveDescFile = settings.aveFiles[f];
-        else if (!settings.aveFiles.isEmpty())
-            aveDescFile = settings.aveFiles.last();
-
-        if (!aveDescFile.isEmpty()) {
-            qInfo() << "\n--- Averaging according to" << aveDescFile << "---\n";
-
-            AverageDescription aveDesc;
-            if (!MNEDescriptionParser::parseAverageFile(aveDescFile, aveDesc) || aveDesc.categories.isEmpty()) {
-                qCritical() << "Failed to parse averaging description file:" << aveDescFile;
-                return 1;
-            }
+        activateProjections(settings, raw.info);
+    }
 
-            QString aveLog;
-            FiffEvokedSet evokedSet = FiffEvokedSet::computeAverages(raw, aveDesc, fiffEvents.events, aveLog);
+    //---------------------------------------------------------------------
+    // Step 4: Save filtered/decimated raw data
+    //---------------------------------------------------------------------
+    QString saveFile = fileForRaw(settings.saveFiles, f);
 
-            // Report results
-            for (int j = 0; j < evokedSet.evoked.size(); ++j) {
-                qInfo() << "  " << evokedSet.evoked[j].comment
-                        << ":" << evokedSet.evoked[j].nave << "averages";
-            }
+    if (!saveFile.isEmpty()) {
+        qInfo() << "\n--- Saving data to" << saveFile << "(decim =" << settings.decimation << ") ---\n";
+        QFile rawOutFile(saveFile);
+        if (!MNE::save_raw(raw, rawOutFile, RowVectorXi(), settings.decimation, -1, -1, settings.dataType)) {
+            qCritical() << "Failed to save raw data.";
+            return 1;
+        }
+    }
 
-            // Compose save name
-            QString aveSaveName, aveLogName;
-            if (!settings.saveAveTag.isEmpty()) {
-                composeSaveNames(rawName, settings.saveAveTag, settings.saveHere,
-                                 aveSaveName, aveLogName);
-            } else if (!aveDesc.filename.isEmpty()) {
-                aveSaveName = aveDesc.filename;
-            }
+    //---------------------------------------------------------------------
+    // Step 5: Compute averages
+    //---------------------------------------------------------------------
+    QString aveDescFile = fileForRaw(settings.aveFiles, f, true);
 
-            if (!aveSaveName.isEmpty()) {
-                evokedSet.save(aveSaveName);
-            }
-            writeLog(aveLogName, aveLog);
+    if (!aveDescFile.isEmpty()) {
+        qInfo() << "\n--- Averaging according to" << aveDescFile << "---\n";
 
-            allAverages.append(evokedSet);
+        AverageDescription aveDesc;
+        if (!MNEDescriptionParser::parseAverageFile(aveDescFile, aveDesc) || aveDesc.categories.isEmpty()) {
+            qCritical() << "Failed to parse averaging description file:" << aveDescFile;
+            return 1;
         }
 
-        //---------------------------------------------------------------------
-        // Step 6: Compute covariance matrices
-        //---------------------------------------------------------------------
-        QString covDescFile;
-        if (f < settings.covFiles.size())
-            covDescFile = settings.covFiles[f];
-        else if (!settings.covFiles.isEmpty())
-            covDescFile = settings.covFiles.last();
-
-        if (!covDescFile.isEmpty()) {
-            qInfo() << "\n--- Computing covariance matrix according to" << covDescFile << "---\n";
-
-            CovDescription covDesc;
-            if (!MNEDescriptionParser::parseCovarianceFile(covDescFile, covDesc) || covDesc.defs.isEmpty()) {
-                qCritical() << "Failed to parse covariance description file:" << covDescFile;
-                return 1;
-            }
+        QString aveLog;
+        FiffEvokedSet evokedSet = FiffEvokedSet::computeAverages(raw, aveDesc, fiffEvents.events, aveLog);
 
-            // Compute covariance per definition, then combine
-            QList<FiffCov> defCovs;
-            QString covLog;
-            covLog += QString("Computing covariance matrix\n");
-
-            for (int d = 0; d < covDesc.defs.size(); ++d) {
-                const CovDefinition &def = covDesc.defs[d];
-
-                // Convert event codes from unsigned to int
-                QList<int> eventCodes;
-                for (int ec = 0; ec < def.events.size(); ++ec)
-                    eventCodes.append(static_cast<int>(def.events[ec]));
-
-                FiffCov defCov = FiffCov::compute_from_epochs(
-                    raw, fiffEvents.events, eventCodes,
-                    def.tmin, def.tmax,
-                    def.bmin, def.bmax,
-                    def.doBaseline,
-                    covDesc.removeSampleMean,
-                    def.ignore,
-                    def.delay);
-
-                if (defCov.dim > 0) {
-                    defCovs.append(defCov);
-                    covLog += QString("  Definition %1: %2 degrees of freedom\n")
-                        .arg(d + 1).arg(defCov.nfree);
-                }
-            }
+        finishAverages(settings, rawName, aveDesc, evokedSet, aveLog, allAverages);
+    }
 
-            // Combine all definitions into a single covariance
-            FiffCov cov;
-            if (defCovs.size() == 1) {
-                cov = defCovs[0];
-            } else if (defCovs.size() > 1) {
-                cov = FiffCov::computeGrandAverage(defCovs);
-            }
+    //---------------------------------------------------------------------
+    // Step 6: Compute covariance matrices
+    //---------------------------------------------------------------------
+    QString covDescFile = fileForRaw(settings.covFiles, f, true);
 
-            if (cov.dim > 0) {
-                // Compose save name
-                QString covSaveName, covLogName;
-                if (!settings.saveCovTag.isEmpty()) {
-                    composeSaveNames(rawName, settings.saveCovTag, settings.saveHere,
-                                     covSaveName, covLogName);
-                } else if (!covDesc.filename.isEmpty()) {
-                    covSaveName = covDesc.filename;
-                }
-
-                if (!covSaveName.isEmpty()) {
-                    cov.save(covSaveName);
-                }
-                writeLog(covLogName, covLog);
-
-                allCovariances.append(cov);
-            }
+    if (!covDescFile.isEmpty()) {
+        qInfo() << "\n--- Computing covariance matrix according to" << covDescFile << "---\n";
+
+        CovDescription covDesc;
+        if (!MNEDescriptionParser::parseCovarianceFile(covDescFile, covDesc) || covDesc.defs.isEmpty()) {
+            qCritical() << "Failed to parse covariance description file:" << covDescFile;
+            return 1;
+        }
+
+        // Compute covariance per definition, then combine
+        QList<FiffCov> defCovs;
+        for (int d = 0; d < covDesc.defs.size(); ++d) {
+            const CovDefinition &def = covDesc.defs[d];
+
+            // Convert event codes from unsigned to int
+            QList<int> eventCodes;
+            for (int ec = 0; ec < def.events.size(); ++ec)
+                eventCodes.append(static_cast<int>(def.events[ec]));
+
+            defCovs.append(FiffCov::compute_from_epochs(
+                raw, fiffEvents.events, eventCodes,
+                def.tmin, def.tmax,
+                def.bmin, def.bmax,
+                def.doBaseline,
+                covDesc.removeSampleMean,
+                def.ignore,
+                def.delay));
+        }
+
+        finishCovariance(settings, rawName, covDesc, defCovs, allCovariances);
+    }
+
+    return 0;
+}
+
+//=============================================================================================================
+
+int BatchProcessor::run(const ProcessingSettings &settings)
+{
+    if (settings.rawFiles.isEmpty()) {
+        qCritical() << "Raw data file not specified.";
+        return 1;
+    }
+
+    qInfo() << "\n--- mne_process_raw batch processing ---\n";
+
+    // Storage for grand average computation
+    QList<FiffEvokedSet> allAverages;
+    QList<FiffCov> allCovariances;
+
+    int nJobs = settings.jobs > 0 ? settings.jobs : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    nJobs = std::min(nJobs, static_cast<int>(settings.rawFiles.size()));
+
+    // Process each raw file
+    if (nJobs > 1) {
+        if (runConcurrently(settings, nJobs, allAverages, allCovariances) != 0)
+            return 1;
+    } else {
+        for (int f = 0; f < settings.rawFiles.size(); ++f) {
+            if (processFile(settings, f, allAverages, allCovariances) != 0)
+                return 1;
         }
     }
 
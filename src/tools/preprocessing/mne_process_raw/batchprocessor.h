@@ -42,6 +42,13 @@
 
 #include <mne/mne_process_description.h>
 
+#include <fiff/fiff_raw_data.h>
+#include <fiff/fiff_events.h>
+#include <fiff/fiff_evoked_set.h>
+#include <fiff/fiff_cov.h>
+#include <fiff/fiff_proj.h>
+
+#include <QList>
 #include <QString>
 #include <QStringList>
 
@@ -93,6 +100,105 @@ public:
      * Write a log string to a log file.
      */
     static bool writeLog(const QString &logFile, const QString &log);
+
+private:
+    /**
+     * Run all steps for one raw file.
+     *
+     * @param[in] settings          All processing settings.
+     * @param[in] f                 Index of the raw file in settings.rawFiles.
+     * @param[in, out] allAverages  Averages for the grand average.
+     * @param[in, out] allCovariances   Covariances for the grand average.
+     * @return 0 on success, non-zero on failure.
+     */
+    static int processFile(const ProcessingSettings &settings,
+                           int f,
+                           QList<FIFFLIB::FiffEvokedSet> &allAverages,
+                           QList<FIFFLIB::FiffCov> &allCovariances);
+
+    /**
+     * Process the raw files on nJobs threads, each file with its own FiffRawData. The log of each file is
+     * held back and printed in one piece in file order; messages of helper threads the steps start
+     * themselves are printed directly. Averages and covariances are merged in file order.
+     *
+     * @param[in] settings          All processing settings.
+     * @param[in] nJobs             Number of files processed at the same time.
+     * @param[in, out] allAverages  Averages for the grand average.
+     * @param[in, out] allCovariances   Covariances for the grand average.
+     * @return 0 on success, non-zero if a file failed.
+     */
+    static int runConcurrently(const ProcessingSettings &settings,
+                               int nJobs,
+                               QList<FIFFLIB::FiffEvokedSet> &allAverages,
+                               QList<FIFFLIB::FiffCov> &allCovariances);
+
+    /**
+     * Run all steps for one raw file in a single pass over the data. A second pass is made only to save
+     * data whose header depends on the first one: new SSP operators or integer output.
+     *
+     * @param[in] settings          All processing settings.
+     * @param[in] f                 Index of the raw file in settings.rawFiles.
+     * @param[in, out] raw          The opened raw data. Its projectors are updated.
+     * @param[in, out] allAverages  Averages for the grand average.
+     * @param[in, out] allCovariances   Covariances for the grand average.
+     * @return 0 on success, non-zero on failure.
+     */
+    static int processFused(const ProcessingSettings &settings,
+                            int f,
+                            FIFFLIB::FiffRawData &raw,
+                            QList<FIFFLIB::FiffEvokedSet> &allAverages,
+                            QList<FIFFLIB::FiffCov> &allCovariances);
+
+    /**
+     * The file given for raw file f, or the last one given if reuseLast is set.
+     */
+    static QString fileForRaw(const QStringList &files, int f, bool reuseLast = false);
+
+    /**
+     * Read events from a fif or ascii event file. Does nothing if eventFile is empty.
+     */
+    static void readEvents(const QString &eventFile, FIFFLIB::FiffEvents &events);
+
+    /**
+     * Write events to a fif or ascii event file. Does nothing if eventFile is empty.
+     */
+    static void writeEvents(const QString &eventFile, const FIFFLIB::FiffEvents &events, float sfreq);
+
+    /**
+     * Read the SSP operators of all projFiles.
+     */
+    static QList<FIFFLIB::FiffProj> readProjections(const QStringList &projFiles);
+
+    /**
+     * Save new SSP operators if a projection tag is set.
+     */
+    static void saveProjections(const ProcessingSettings &settings,
+                                const QString &rawName,
+                                const QList<FIFFLIB::FiffProj> &projs);
+
+    /**
+     * Apply --projon/--projoff and report the projection status.
+     */
+    static void activateProjections(const ProcessingSettings &settings, FIFFLIB::FiffInfo &info);
+
+    /**
+     * Report, save and collect the averages of one raw file.
+     */
+    static void finishAverages(const ProcessingSettings &settings,
+                               const QString &rawName,
+                               const AverageDescription &aveDesc,
+                               const FIFFLIB::FiffEvokedSet &evokedSet,
+                               const QString &aveLog,
+                               QList<FIFFLIB::FiffEvokedSet> &allAverages);
+
+    /**
+     * Combine the covariances of all definitions of one raw file, then save and collect the result.
+     */
+    static void finishCovariance(const ProcessingSettings &settings,
+                                 const QString &rawName,
+                                 const CovDescription &covDesc,
+                                 const QList<FIFFLIB::FiffCov> &defCovs,
+                                 QList<FIFFLIB::FiffCov> &allCovariances);
 };
 
 } // namespace
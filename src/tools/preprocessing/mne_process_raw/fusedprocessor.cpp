@@ -0,0 +1,696 @@
+//=============================================================================================================
+/**
+ * @file     fusedprocessor.cpp
+ * @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>
+ * @since    2.1.0
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, Christoph Dinh. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    FusedProcessor class implementation.
+ *
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fusedprocessor.h"
+
+#include <fiff/fiff_events.h>
+#include <fiff/fiff_file.h>
+#include <fiff/fiff_proj.h>
+#include <fiff/fiff_raw_pipeline.h>
+
+#include <QDebug>
+
+#include <algorithm>
+#include <cmath>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace MNEPROCESSRAWAPP;
+using namespace FIFFLIB;
+using namespace MNELIB;
+using namespace Eigen;
+
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace
+{
+enum EventMatch { NoMatch, Match, Undecided };
+}
+
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+FusedProcessor::FusedProcessor(const FiffRawData &raw)
+: m_raw(raw)
+{
+}
+
+//=============================================================================================================
+
+void FusedProcessor::setEvents(const MatrixXi &events)
+{
+    m_givenEvents = events;
+    m_bEventsGiven = true;
+}
+
+//=============================================================================================================
+
+void FusedProcessor::setTriggerDetection(const QString &triggerCh, unsigned int triggerMask)
+{
+    QString stimCh = triggerCh.isEmpty() ? QString("STI 014") : triggerCh;
+
+    m_iTriggerCh = m_raw.info.ch_names.indexOf(stimCh);
+    m_iTriggerMask = triggerMask;
+
+    if (m_iTriggerCh < 0) {
+        qWarning() << "[FusedProcessor::setTriggerDetection] Trigger channel" << stimCh << "not found.";
+    }
+}
+
+//=============================================================================================================
+
+void FusedProcessor::setAverageDescription(const AverageDescription &desc)
+{
+    m_aveDesc = desc;
+}
+
+//=============================================================================================================
+
+void FusedProcessor::setCovDescription(const CovDescription &desc)
+{
+    m_covDesc = desc;
+}
+
+//=============================================================================================================
+
+void FusedProcessor::setProjEpochs(int eventCode, float tmin, float tmax, const QMap<QString,double> &mapReject)
+{
+    m_bProjEpochs = true;
+    m_iProjEvent = eventCode;
+    m_fProjTmin = tmin;
+    m_fProjTmax = tmax;
+    m_mapProjReject = mapReject;
+}
+
+//=============================================================================================================
+
+void FusedProcessor::setPeakScan(bool bPeakScan)
+{
+    m_bPeakScan = bPeakScan;
+}
+
+//=============================================================================================================
+
+void FusedProcessor::setSave(QIODevice *pDevice, int decim, int dataType, const RowVectorXd &maxAbs)
+{
+    m_pSaveDevice = pDevice;
+    m_iDecim = decim < 1 ? 1 : decim;
+    m_iDataType = dataType;
+    m_vecSaveMaxAbs = maxAbs;
+}
+
+//=============================================================================================================
+
+void FusedProcessor::setThreads(int numWorkers, const std::function<void()> &threadInit)
+{
+    m_iNumWorkers = numWorkers < 0 ? 1 : numWorkers;
+    m_threadInit = threadInit;
+}
+
+//=============================================================================================================
+
+bool FusedProcessor::run()
+{
+    float sfreq = m_raw.info.sfreq;
+    int nchan   = m_raw.info.nchan;
+
+    // Epoch consumers
+    m_sinks.clear();
+    if (m_bProjEpochs) {
+        EpochSink sink;
+        sink.kind = ProjectionSink;
+        sink.index = 0;
+        sink.minSamp = static_cast<int>(std::round(m_fProjTmin * sfreq));
+        sink.maxSamp = static_cast<int>(std::round(m_fProjTmax * sfreq));
+        sink.delaySamp = 0;
+        sink.bminSamp = sink.bmaxSamp = 0;
+
+        if (sink.maxSamp - sink.minSamp + 1 <= 0) {
+            qWarning() << "[FusedProcessor::run] Invalid time window for the projection epochs.";
+        } else {
+            m_sinks.append(sink);
+        }
+    }
+
+    m_aveSums.clear();
+    for (int j = 0; j < m_aveDesc.categories.size(); ++j) {
+        const AverageCategory &cat = m_aveDesc.categories[j];
+
+        EpochSink sink;
+        sink.kind = AverageSink;
+        sink.index = j;
+        sink.minSamp = static_cast<int>(std::round(cat.tmin * sfreq));
+        sink.maxSamp = static_cast<int>(std::round(cat.tmax * sfreq));
+        sink.delaySamp = static_cast<int>(std::round(cat.delay * sfreq));
+        sink.bminSamp = sink.bmaxSamp = 0;
+        if (cat.doBaseline) {
+            sink.bminSamp = static_cast<int>(std::round(cat.bmin * sfreq)) - sink.minSamp;
+            sink.bmaxSamp = static_cast<int>(std::round(cat.bmax * sfreq)) - sink.minSamp;
+        }
+        m_sinks.append(sink);
+
+        int ns = sink.maxSamp - sink.minSamp + 1;
+        AverageSum sum;
+        sum.sumData = MatrixXd::Zero(nchan, ns);
+        sum.log += QString("\n  Category: %1\n").arg(cat.comment);
+        sum.log += QString("    t = %1 ... %2 ms\n").arg(1000.0 * cat.tmin, 0, 'f', 1).arg(1000.0 * cat.tmax, 0, 'f', 1);
+        m_aveSums.append(sum);
+    }
+
+    m_covSums.clear();
+    for (int d = 0; d < m_covDesc.defs.size(); ++d) {
+        const CovDefinition &def = m_covDesc.defs[d];
+
+        EpochSink sink;
+        sink.kind = CovarianceSink;
+        sink.index = d;
+        sink.minSamp = static_cast<int>(std::round(def.tmin * sfreq));
+        sink.maxSamp = static_cast<int>(std::round(def.tmax * sfreq));
+        sink.delaySamp = static_cast<int>(std::round(def.delay * sfreq));
+        sink.bminSamp = sink.bmaxSamp = 0;
+        if (def.doBaseline) {
+            sink.bminSamp = static_cast<int>(std::round(def.bmin * sfreq)) - sink.minSamp;
+            sink.bmaxSamp = static_cast<int>(std::round(def.bmax * sfreq)) - sink.minSamp;
+        }
+
+        CovSum sum;
+        sum.covAccum = MatrixXd::Zero(nchan, nchan);
+        sum.meanAccum = VectorXd::Zero(nchan);
+        m_covSums.append(sum);
+
+        if (sink.maxSamp - sink.minSamp + 1 <= 0) {
+            qWarning() << "[FusedProcessor::run] Invalid time window in covariance definition" << d + 1;
+            continue;
+        }
+        m_sinks.append(sink);
+    }
+
+    // The stream must hold back enough samples for epochs that start before their event
+    m_iLookback = 0;
+    for (const EpochSink &sink : m_sinks) {
+        m_iLookback = std::max(m_iLookback, -(sink.delaySamp + sink.minSamp));
+    }
+    m_matHistory.resize(nchan, 0);
+    m_iHistoryFirst = m_raw.first_samp;
+
+    // Events
+    m_events.clear();
+    m_givenOrder.clear();
+    m_iNextGiven = 0;
+    m_bTriggerStarted = false;
+    m_bEventsComplete = m_bEventsGiven;
+    if (m_bEventsGiven) {
+        for (int k = 0; k < m_givenEvents.rows(); ++k) {
+            m_events.push_back(Vector3i(m_givenEvents(k, 0), m_givenEvents(k, 1), m_givenEvents(k, 2)));
+            m_givenOrder.push_back(k);
+        }
+        std::stable_sort(m_givenOrder.begin(), m_givenOrder.end(), [this](int a, int b) {
+            return m_events[a](0) < m_events[b](0);
+        });
+    }
+
+    m_pending.clear();
+    m_projEpochs.clear();
+    m_vecMaxAbs.resize(0);
+
+    // Output
+    if (m_pSaveDevice) {
+        FiffInfo outInfo = m_raw.info;
+        if (m_iDecim > 1) {
+            outInfo.sfreq = m_raw.info.sfreq / static_cast<float>(m_iDecim);
+        }
+
+        m_pSaveStream = FiffStream::start_writing_raw(*m_pSaveDevice, outInfo, m_vecSaveCals, RowVectorXi(), true,
+                                                      m_iDataType, m_vecSaveMaxAbs);
+        if (!m_pSaveStream) {
+            qWarning() << "[FusedProcessor::run] Cannot start writing raw file.";
+            return false;
+        }
+        m_pSaveStream->start_write_behind();
+    }
+
+    // One pass over the file. The accumulators run in the in-order stage of the pipeline.
+    FiffRawPipeline pipeline(m_raw, 2000 * m_iDecim);
+    pipeline.setNumWorkers(m_iNumWorkers);
+    pipeline.setThreadInit(m_threadInit);
+    bool bOk = pipeline.run(FiffRawPipeline::Transform(), [this](const FiffRawBlock &block) {
+        consume(block.matData, block.first);
+        return true;
+    });
+
+    // Epochs still waiting for a following event will not get one anymore
+    m_bEventsComplete = true;
+    finishPending();
+
+    if (m_pSaveStream) {
+        m_pSaveStream->finish_writing_raw();
+        m_pSaveStream.clear();
+    }
+
+    return bOk;
+}
+
+//=============================================================================================================
+
+MatrixXi FusedProcessor::events() const
+{
+    MatrixXi events(static_cast<int>(m_events.size()), 3);
+    for (int k = 0; k < events.rows(); ++k) {
+        events.row(k) = m_events[k].transpose();
+    }
+    return events;
+}
+
+//=============================================================================================================
+
+FiffEvokedSet FusedProcessor::averages(const FiffInfo &info, QString &log) const
+{
+    FiffEvokedSet evokedSet;
+    evokedSet.info = info;
+
+    float sfreq = info.sfreq;
+
+    log.clear();
+    log += QString("Averaging: %1\n").arg(m_aveDesc.comment);
+
+    for (int j = 0; j < m_aveDesc.categories.size() && j < m_aveSums.size(); ++j) {
+        const AverageCategory &cat = m_aveDesc.categories[j];
+        const AverageSum &sum = m_aveSums[j];
+
+        int minSamp = static_cast<int>(std::round(cat.tmin * sfreq));
+        int maxSamp = static_cast<int>(std::round(cat.tmax * sfreq));
+        int ns      = maxSamp - minSamp + 1;
+
+        FiffEvoked evoked;
+        evoked.comment = cat.comment;
+        evoked.first   = minSamp;
+        evoked.last    = maxSamp;
+        evoked.nave    = sum.nave;
+
+        RowVectorXf times(ns);
+        for (int s = 0; s < ns; ++s)
+            times(s) = static_cast<float>(minSamp + s) / sfreq;
+        evoked.times = times;
+
+        if (sum.nave > 0) {
+            evoked.data = sum.sumData / static_cast<double>(sum.nave);
+        } else {
+            evoked.data = MatrixXd::Zero(info.nchan, ns);
+        }
+
+        evoked.info = info;
+
+        evokedSet.evoked.append(evoked);
+        log += sum.log;
+        log += QString("    nave = %1\n").arg(sum.nave);
+    }
+
+    return evokedSet;
+}
+
+//=============================================================================================================
+
+QList<FiffCov> FusedProcessor::covariances(const FiffInfo &info) const
+{
+    QList<FiffCov> covs;
+
+    for (int d = 0; d < m_covSums.size(); ++d) {
+        const CovSum &sum = m_covSums[d];
+
+        FiffCov cov = FiffCov::compute_from_sums(info, sum.covAccum, sum.meanAccum, sum.totalSamples,
+                                                 m_covDesc.removeSampleMean);
+        if (cov.dim > 0) {
+            qInfo() << "[FusedProcessor::covariances] Computed:" << info.nchan << "channels,"
+                    << sum.nAccepted << "epochs," << sum.totalSamples << "total samples.";
+        }
+        covs.append(cov);
+    }
+
+    return covs;
+}
+
+//=============================================================================================================
+
+QList<MatrixXd> FusedProcessor::projEpochs() const
+{
+    return m_projEpochs;
+}
+
+//=============================================================================================================
+
+RowVectorXd FusedProcessor::maxAbs() const
+{
+    return m_vecMaxAbs;
+}
+
+//=============================================================================================================
+
+void FusedProcessor::consume(const MatrixXd &block, int first)
+{
+    const int last = first + static_cast<int>(block.cols()) - 1;
+
+    // Continue the epochs started in earlier blocks
+    for (PendingEpoch &epoch : m_pending) {
+        fill(epoch, block, first);
+    }
+
+    // Start the epochs of the events in this block
+    QList<int> newEvents;
+    if (m_bEventsGiven) {
+        while (m_iNextGiven < static_cast<int>(m_givenOrder.size())
+               && m_events[m_givenOrder[m_iNextGiven]](0) <= last) {
+            newEvents.append(m_givenOrder[m_iNextGiven++]);
+        }
+    } else if (m_iTriggerCh >= 0) {
+        detectEvents(block, first, newEvents);
+    }
+
+    for (int iEvent : newEvents) {
+        const int evSample = m_events[iEvent](0);
+
+        for (int i = 0; i < m_sinks.size(); ++i) {
+            const EpochSink &sink = m_sinks[i];
+
+            int match = matchEvent(sink, iEvent);
+            if (match == NoMatch)
+                continue;
+
+            PendingEpoch epoch;
+            epoch.iSink = i;
+            epoch.iEvent = iEvent;
+            epoch.start = evSample + sink.delaySamp + sink.minSamp;
+            epoch.end = evSample + sink.delaySamp + sink.maxSamp;
+            epoch.next = epoch.start;
+            epoch.bDecided = (match == Match);
+
+            if (epoch.start < m_raw.first_samp || epoch.end > m_raw.last_samp)
+                continue;
+
+            epoch.data.resize(block.rows(), epoch.end - epoch.start + 1);
+            fill(epoch, m_matHistory, m_iHistoryFirst);
+            fill(epoch, block, first);
+            m_pending.push_back(std::move(epoch));
+        }
+    }
+
+    finishPending();
+
+    // Keep the tail of the stream for the next block
+    if (m_iLookback > 0) {
+        if (block.cols() >= m_iLookback) {
+            m_matHistory = block.rightCols(m_iLookback);
+        } else {
+            const int nKeep = std::min<int>(m_iLookback - block.cols(), m_matHistory.cols());
+            MatrixXd history(block.rows(), nKeep + block.cols());
+            history.leftCols(nKeep) = m_matHistory.rightCols(nKeep);
+            history.rightCols(block.cols()) = block;
+            m_matHistory = history;
+        }
+        m_iHistoryFirst = last - static_cast<int>(m_matHistory.cols()) + 1;
+    }
+
+    if (m_bPeakScan) {
+        RowVectorXd blockMax = block.cwiseAbs().rowwise().maxCoeff().transpose();
+        m_vecMaxAbs = (m_vecMaxAbs.size() == 0) ? blockMax : RowVectorXd(m_vecMaxAbs.cwiseMax(blockMax));
+    }
+
+    if (m_pSaveStream) {
+        writeBlock(block, first);
+    }
+}
+
+//=============================================================================================================
+
+void FusedProcessor::detectEvents(const MatrixXd &block, int first, QList<int> &newEvents)
+{
+    // Leading edges, as FiffEvents::detect_from_raw with the level carried across blocks
+    int s = 0;
+    if (!m_bTriggerStarted) {
+        if (block.cols() == 0)
+            return;
+        m_iTriggerPrev = static_cast<int>(block(m_iTriggerCh, 0)) & m_iTriggerMask;
+        m_bTriggerStarted = true;
+        s = 1;
+    }
+
+    for (; s < block.cols(); ++s) {
+        int curVal = static_cast<int>(block(m_iTriggerCh, s)) & m_iTriggerMask;
+        if (curVal != m_iTriggerPrev && m_iTriggerPrev == 0 && curVal != 0) {
+            m_events.push_back(Vector3i(first + s, m_iTriggerPrev, curVal));
+            newEvents.append(static_cast<int>(m_events.size()) - 1);
+        }
+        m_iTriggerPrev = curVal;
+    }
+}
+
+//=============================================================================================================
+
+int FusedProcessor::matchEvent(const EpochSink &sink, int iEvent) const
+{
+    const Vector3i &ev = m_events[iEvent];
+
+    switch (sink.kind) {
+    case AverageSink: {
+        // FiffEvents::matchEvent, except that the following event may not be known yet
+        const AverageCategory &cat = m_aveDesc.categories[sink.index];
+
+        bool match = false;
+        for (int k = 0; k < cat.events.size(); ++k) {
+            if ((ev(1) & ~cat.ignore) == 0 &&
+                (ev(2) & ~cat.ignore) == cat.events[k]) {
+                match = true;
+                break;
+            }
+        }
+        if (!match)
+            return NoMatch;
+
+        if (cat.prevEvent != 0) {
+            bool found = false;
+            for (int j = iEvent - 1; j >= 0; --j) {
+                if ((m_events[j](1) & ~cat.prevIgnore) == 0) {
+                    found = true;
+                    match = (m_events[j](2) & ~cat.prevIgnore) == cat.prevEvent;
+                    break;
+                }
+            }
+            if (!found || !match)
+                return NoMatch;
+        }
+
+        return matchNextEvent(cat, iEvent);
+    }
+    case CovarianceSink: {
+        const CovDefinition &def = m_covDesc.defs[sink.index];
+        int evFrom = ev(1) & ~static_cast<int>(def.ignore);
+        int evTo   = ev(2) & ~static_cast<int>(def.ignore);
+
+        for (int k = 0; k < def.events.size(); ++k) {
+            if (evFrom == 0 && evTo == static_cast<int>(def.events[k]))
+                return Match;
+        }
+        return NoMatch;
+    }
+    case ProjectionSink:
+        return (ev(1) == 0 && ev(2) == m_iProjEvent) ? Match : NoMatch;
+    }
+
+    return NoMatch;
+}
+
+//=============================================================================================================
+
+int FusedProcessor::matchNextEvent(const AverageCategory &cat, int iEvent) const
+{
+    if (cat.nextEvent == 0)
+        return Match;
+
+    for (int j = iEvent + 1; j < static_cast<int>(m_events.size()); ++j) {
+        if ((m_events[j](1) & ~cat.nextIgnore) == 0) {
+            return ((m_events[j](2) & ~cat.nextIgnore) == cat.nextEvent) ? Match : NoMatch;
+        }
+    }
+
+    return m_bEventsComplete ? NoMatch : Undecided;
+}
+
+//=============================================================================================================
+
+void FusedProcessor::fill(PendingEpoch &epoch, const MatrixXd &data, int first) const
+{
+    const int from = std::max(epoch.next, first);
+    const int to = std::min(epoch.end, first + static_cast<int>(data.cols()) - 1);
+
+    if (from > to)
+        return;
+
+    epoch.data.middleCols(from - epoch.start, to - from + 1) = data.middleCols(from - first, to - from + 1);
+    epoch.next = to + 1;
+}
+
+//=============================================================================================================
+
+void FusedProcessor::finishPending()
+{
+    // In start order, so that each consumer sees its epochs in event order
+    for (auto it = m_pending.begin(); it != m_pending.end(); ) {
+        if (!it->bDecided) {
+            int match = matchNextEvent(m_aveDesc.categories[m_sinks[it->iSink].index], it->iEvent);
+            if (match == NoMatch) {
+                it = m_pending.erase(it);
+                continue;
+            }
+            it->bDecided = (match == Match);
+        }
+
+        if (it->bDecided && it->next > it->end) {
+            finishEpoch(*it);
+            it = m_pending.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+//=============================================================================================================
+
+void FusedProcessor::finishEpoch(PendingEpoch &epoch)
+{
+    const EpochSink &sink = m_sinks[epoch.iSink];
+    MatrixXd &epochData = epoch.data;
+
+    switch (sink.kind) {
+    case AverageSink: {
+        // As FiffEvokedSet::computeAverages
+        const AverageCategory &cat = m_aveDesc.categories[sink.index];
+        AverageSum &sum = m_aveSums[sink.index];
+        const Vector3i &ev = m_events[epoch.iEvent];
+        float sfreq = m_raw.info.sfreq;
+
+        QString rejReason;
+        if (!FiffEvokedSet::checkArtifacts(epochData, m_raw.info, m_raw.info.bads, m_aveDesc.rej, rejReason)) {
+            sum.log += QString("    %1 %2 %3 %4 [%5] %6 [omit]\n")
+                .arg(ev(0), 7)
+                .arg(static_cast<float>(ev(0)) / sfreq, -10, 'f', 3)
+                .arg(ev(1), 3)
+                .arg(ev(2), 3)
+                .arg(cat.comment)
+                .arg(rejReason);
+            return;
+        }
+
+        if (cat.doBaseline) {
+            FiffEvokedSet::subtractBaseline(epochData, sink.bminSamp, sink.bmaxSamp);
+        }
+
+        if (cat.doAbs) {
+            epochData = epochData.cwiseAbs();
+        }
+
+        sum.sumData += epochData;
+        sum.nave++;
+
+        sum.log += QString("    %1 %2 %3 %4 [%5]\n")
+            .arg(ev(0), 7)
+            .arg(static_cast<float>(ev(0)) / sfreq, -10, 'f', 3)
+            .arg(ev(1), 3)
+            .arg(ev(2), 3)
+            .arg(cat.comment);
+        break;
+    }
+    case CovarianceSink: {
+        // As FiffCov::compute_from_epochs
+        CovSum &sum = m_covSums[sink.index];
+        const int ns = static_cast<int>(epochData.cols());
+
+        if (m_covDesc.defs[sink.index].doBaseline) {
+            int bminIdx = std::max(0, sink.bminSamp);
+            int bmaxIdx = std::min(ns - 1, sink.bmaxSamp);
+            if (bmaxIdx > bminIdx) {
+                int nBase = bmaxIdx - bminIdx;
+                for (int c = 0; c < epochData.rows(); ++c) {
+                    double baseVal = epochData.row(c).segment(bminIdx, nBase).mean();
+                    epochData.row(c).array() -= baseVal;
+                }
+            }
+        }
+
+        if (m_covDesc.removeSampleMean) {
+            VectorXd epochMean = epochData.rowwise().mean();
+            sum.meanAccum += epochMean * static_cast<double>(ns);
+        }
+        sum.covAccum += epochData * epochData.transpose();
+        sum.totalSamples += ns;
+        sum.nAccepted++;
+        break;
+    }
+    case ProjectionSink:
+        if (FiffProj::check_epoch(m_raw.info, epochData, m_mapProjReject)) {
+            m_projEpochs.append(epochData);
+        }
+        break;
+    }
+}
+
+//=============================================================================================================
+
+void FusedProcessor::writeBlock(const MatrixXd &block, int first)
+{
+    if (m_iDecim == 1) {
+        m_pSaveStream->write_raw_buffer(block, m_vecSaveCals);
+        return;
+    }
+
+    // Keep the samples at first_samp + k * decim, as FiffRawData::save
+    const int offset = (m_iDecim - (first - m_raw.first_samp) % m_iDecim) % m_iDecim;
+    const int nOut = offset < block.cols() ? (static_cast<int>(block.cols()) - offset + m_iDecim - 1) / m_iDecim : 0;
+    if (nOut == 0)
+        return;
+
+    MatrixXd decimData(block.rows(), nOut);
+    for (int idx = 0; idx < nOut; ++idx) {
+        decimData.col(idx) = block.col(offset + idx * m_iDecim);
+    }
+
+    m_pSaveStream->write_raw_buffer(decimData, m_vecSaveCals);
+}
@@ -0,0 +1,265 @@
+//=============================================================================================================
+/**
+ * @file     fusedprocessor.h
+ * @author   Christoph Dinh <chdinh@nmr.mgh.harvard.edu>
+ * @since    2.1.0
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, Christoph Dinh. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    Single-pass accumulation of events, averages, covariance and SSP epochs for mne_process_raw.
+ *
+ */
+
+#ifndef MNE_PROCESS_RAW_FUSEDPROCESSOR_H
+#define MNE_PROCESS_RAW_FUSEDPROCESSOR_H
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <mne/mne_process_description.h>
+
+#include <fiff/fiff_raw_data.h>
+#include <fiff/fiff_evoked_set.h>
+#include <fiff/fiff_cov.h>
+#include <fiff/fiff_stream.h>
+#include <fiff/fiff_file.h>
+
+#include <QIODevice>
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+
+#include <Eigen/Core>
+
+#include <functional>
+#include <vector>
+
+//=============================================================================================================
+// DEFINE NAMESPACE
+//=============================================================================================================
+
+namespace MNEPROCESSRAWAPP
+{
+
+using namespace MNELIB;
+
+//=============================================================================================================
+/**
+ * Streams a raw file once and feeds every block to all enabled accumulators: trigger detection, epoch
+ * averaging per category, noise covariance sums per definition, SSP epoch collection, the per-channel
+ * peak scan for integer output, and optionally writing the data.
+ *
+ * Events are handled as soon as the block holding them arrives. Epochs are cut from the stream with a
+ * lookback of the largest negative epoch start, so no block is read twice. The per-epoch processing
+ * matches FiffEvokedSet::computeAverages, FiffCov::compute_from_epochs and FiffProj::compute_from_raw.
+ */
+class FusedProcessor
+{
+public:
+    /**
+     * @param[in] raw       The raw data. Its info is used as is, so set projectors before calling run().
+     */
+    explicit FusedProcessor(const FIFFLIB::FiffRawData &raw);
+
+    /**
+     * Use a known event list instead of detecting events.
+     */
+    void setEvents(const Eigen::MatrixXi &events);
+
+    /**
+     * Detect events on the rising edges of a trigger channel while streaming.
+     */
+    void setTriggerDetection(const QString &triggerCh, unsigned int triggerMask);
+
+    /**
+     * Average the categories of desc.
+     */
+    void setAverageDescription(const FIFFLIB::AverageDescription &desc);
+
+    /**
+     * Accumulate the covariance definitions of desc.
+     */
+    void setCovDescription(const CovDescription &desc);
+
+    /**
+     * Collect the epochs for SSP creation.
+     */
+    void setProjEpochs(int eventCode, float tmin, float tmax, const QMap<QString,double> &mapReject);
+
+    /**
+     * Track the per-channel absolute peak, as needed for integer output.
+     */
+    void setPeakScan(bool bPeakScan);
+
+    /**
+     * Write the data to pDevice while streaming, like FiffRawData::save.
+     *
+     * @param[in] pDevice   The output device.
+     * @param[in] decim     Decimation factor.
+     * @param[in] dataType  Output sample format.
+     * @param[in] maxAbs    Per-channel peak, required for integer formats.
+     */
+    void setSave(QIODevice *pDevice, int decim, int dataType, const Eigen::RowVectorXd &maxAbs = Eigen::RowVectorXd());
+
+    /**
+     * Set the worker threads of the pipeline and a function each of its threads calls first.
+     *
+     * @param[in] numWorkers    Number of workers, 0 for one per core.
+     * @param[in] threadInit    Called on every pipeline thread before its first block. May be empty.
+     */
+    void setThreads(int numWorkers, const std::function<void()> &threadInit = std::function<void()>());
+
+    /**
+     * Streams the file once through all enabled accumulators.
+     *
+     * @return true on success.
+     */
+    bool run();
+
+    /**
+     * The events that were given or detected.
+     */
+    Eigen::MatrixXi events() const;
+
+    /**
+     * Finishes the averages, tagged with info.
+     */
+    FIFFLIB::FiffEvokedSet averages(const FIFFLIB::FiffInfo &info, QString &log) const;
+
+    /**
+     * Finishes one covariance per definition, tagged with info. Definitions without data give an empty FiffCov.
+     */
+    QList<FIFFLIB::FiffCov> covariances(const FIFFLIB::FiffInfo &info) const;
+
+    /**
+     * The accepted SSP epochs.
+     */
+    QList<Eigen::MatrixXd> projEpochs() const;
+
+    /**
+     * The per-channel absolute peak of the streamed data.
+     */
+    Eigen::RowVectorXd maxAbs() const;
+
+private:
+    enum SinkKind { AverageSink, CovarianceSink, ProjectionSink };
+
+    /** One consumer of epochs. */
+    struct EpochSink {
+        SinkKind kind;
+        int index;          /**< Category, definition, or 0 for the projection. */
+        int minSamp;        /**< Epoch start relative to the event. */
+        int maxSamp;        /**< Epoch end relative to the event. */
+        int delaySamp;      /**< Delay applied to the event. */
+        int bminSamp;       /**< Baseline start relative to the epoch start. */
+        int bmaxSamp;       /**< Baseline end relative to the epoch start. */
+    };
+
+    /** An epoch still being filled from the stream. */
+    struct PendingEpoch {
+        int iSink;
+        int iEvent;
+        int start;
+        int end;
+        int next;           /**< Next sample to fill. */
+        bool bDecided;      /**< False while the category waits for the following event. */
+        Eigen::MatrixXd data;
+    };
+
+    /** Sums of one average category. */
+    struct AverageSum {
+        Eigen::MatrixXd sumData;
+        int nave = 0;
+        QString log;
+    };
+
+    /** Sums of one covariance definition. */
+    struct CovSum {
+        Eigen::MatrixXd covAccum;
+        Eigen::VectorXd meanAccum;
+        int totalSamples = 0;
+        int nAccepted = 0;
+    };
+
+    void consume(const Eigen::MatrixXd &block, int first);
+    void detectEvents(const Eigen::MatrixXd &block, int first, QList<int> &newEvents);
+    int matchEvent(const EpochSink &sink, int iEvent) const;
+    int matchNextEvent(const FIFFLIB::AverageCategory &cat, int iEvent) const;
+    void fill(PendingEpoch &epoch, const Eigen::MatrixXd &data, int first) const;
+    void finishPending();
+    void finishEpoch(PendingEpoch &epoch);
+    void writeBlock(const Eigen::MatrixXd &block, int first);
+
+    const FIFFLIB::FiffRawData &m_raw;
+
+    std::vector<Eigen::Vector3i> m_events;      /**< Events in stream order: sample, before, after. */
+    std::vector<int> m_givenOrder;              /**< Given events sorted by sample. */
+    Eigen::MatrixXi m_givenEvents;              /**< The given event list. */
+    bool m_bEventsGiven = false;
+    bool m_bEventsComplete = false;             /**< No further events will be added. */
+    int m_iNextGiven = 0;
+
+    int m_iTriggerCh = -1;
+    unsigned int m_iTriggerMask = 0;
+    int m_iTriggerPrev = 0;
+    bool m_bTriggerStarted = false;
+
+    FIFFLIB::AverageDescription m_aveDesc;
+    CovDescription m_covDesc;
+    bool m_bProjEpochs = false;
+    int m_iProjEvent = 0;
+    float m_fProjTmin = 0.0f;
+    float m_fProjTmax = 0.0f;
+    QMap<QString,double> m_mapProjReject;
+
+    QList<EpochSink> m_sinks;
+    std::vector<PendingEpoch> m_pending;
+    QList<AverageSum> m_aveSums;
+    QList<CovSum> m_covSums;
+    QList<Eigen::MatrixXd> m_projEpochs;
+
+    Eigen::MatrixXd m_matHistory;               /**< The last samples before the current block. */
+    int m_iHistoryFirst = 0;                    /**< First sample of m_matHistory. */
+    int m_iLookback = 0;                        /**< Samples kept in m_matHistory. */
+
+    bool m_bPeakScan = false;
+    Eigen::RowVectorXd m_vecMaxAbs;
+
+    QIODevice *m_pSaveDevice = nullptr;
+    int m_iDecim = 1;
+    int m_iDataType = FIFFT_FLOAT;
+    Eigen::RowVectorXd m_vecSaveMaxAbs;
+    FIFFLIB::FiffStream::SPtr m_pSaveStream;
+    Eigen::RowVectorXd m_vecSaveCals;
+
+    int m_iNumWorkers = 1;
+    std::function<void()> m_threadInit;
+};
+
+} // namespace
+
+#endif // MNE_PROCESS_RAW_FUSEDPROCESSOR_H
@@ -95,6 +95,13 @@ static void printHelp()
         << "  --help                    Print this help and exit.\n"
         << "  --version                 Print version information and exit.\n"
         << "  --cd <dir>                Change working directory before processing.\n"
+        << "  --fused                   Detect events, average, compute covariance,\n"
+        << "                            collect SSP epochs and save in a single pass\n"
+        << "                            over each raw file.\n"
+        << "  --jobs <n>                Process up to n raw files concurrently\n"
+        << "                            (0 = one per core, default: 1).\n"
+        << "  --jobmem <MB>             Start another raw file only while the sizes\n"
+        << "                            of the files in progress fit in this budget.\n"
         << "\n"
         << "Input:\n"
         << "  --raw <file>              Raw data file to process.  May be given\n"
@@ -138,6 +145,8 @@ static void printHelp()
         << "Output / Decimation:\n"
         << "  --save <file>             Save processed raw data to file.\n"
         << "  --decim <factor>          Decimation factor (default: 1).\n"
+        << "  --format <type>           Output sample format: float, int or short\n"
+        << "                            (default: float).\n"
         << "  --split <MB>              Split output at this file size (MB).\n"
         << "  --anon                    Omit subject information from output.\n"
         << "  --savehere                Write output to current dir instead of\n"
@@ -176,6 +185,10 @@ static void printHelp()
         << "    mne_process_raw --raw data.fif --proj ssp.fif --projon \\\n"
         << "                    --decim 4 --save decimated.fif\n"
         << "\n"
+        << "  Average several runs on four cores:\n"
+        << "    mne_process_raw --raw run1.fif --raw run2.fif --raw run3.fif \\\n"
+        << "                    --ave paradigm.ave --gave grand_avg.fif --jobs 4\n"
+        << "\n"
         << "  Create SSP operators from empty-room data:\n"
         << "    mne_process_raw --raw empty_room.fif --makeproj \\\n"
         << "                    --projngrad 3 --projnmag 3\n"
@@ -316,6 +329,9 @@ int main(int argc, char *argv[])
     QCommandLineOption splitOpt("split", "Split output files at this size (MB).", "size");
     parser.addOption(splitOpt);
 
+    QCommandLineOption formatOpt("format", "Output sample format: float, int or short (default=float).", "type", "float");
+    parser.addOption(formatOpt);
+
     // --- Averaging ---
     QCommandLineOption aveOpt("ave", "Average description file (may be specified multiple times).", "file");
     parser.addOption(aveOpt);
@@ -337,6 +353,15 @@ int main(int argc, char *argv[])
     parser.addOption(gcovOpt);
 
     // --- Save location ---
+    QCommandLineOption fusedOpt("fused", "Run all processing steps in a single pass over each raw file.");
+    parser.addOption(fusedOpt);
+
+    QCommandLineOption jobsOpt("jobs", "Number of raw files processed concurrently (0 = one per core).", "n", "1");
+    parser.addOption(jobsOpt);
+
+    QCommandLineOption jobMemOpt("jobmem", "Memory budget for the raw files processed at once (MB).", "size");
+    parser.addOption(jobMemOpt);
+
     QCommandLineOption saveHereOpt("savehere", "Save output files in current directory instead of raw data directory.");
     parser.addOption(saveHereOpt);
 
@@ -442,6 +467,17 @@ int main(int argc, char *argv[])
     settings.decimation = parser.value(decimOpt).toInt();
     if (parser.isSet(splitOpt))
         settings.splitSize = static_cast<qint64>(parser.value(splitOpt).toFloat() * 1024 * 1024);
+    const QString format = parser.value(formatOpt).toLower();
+    if (format == "float") {
+        settings.dataType = FIFFT_FLOAT;
+    } else if (format == "int") {
+        settings.dataType = FIFFT_INT;
+    } else if (format == "short") {
+        settings.dataType = FIFFT_SHORT;
+    } else {
+        qCritical() << "Unknown output format" << format << "(expected float, int or short).";
+        return 1;
+    }
 
     // Averaging settings
     settings.aveFiles   = parser.values(aveOpt);
@@ -455,6 +491,10 @@ int main(int argc, char *argv[])
 
     // Other settings
     settings.saveHere = parser.isSet(saveHereOpt);
+    settings.fused    = parser.isSet(fusedOpt);
+    settings.jobs     = parser.value(jobsOpt).toInt();
+    if (parser.isSet(jobMemOpt))
+        settings.jobMemory = static_cast<qint64>(parser.value(jobMemOpt).toFloat() * 1024 * 1024);
 
     //=========================================================================
     // Validate required options
@@ -0,0 +1,403 @@
+//=============================================================================================================
+/**
+ * @file     main.cpp
+ * @author   Christoph Dinh <christoph.dinh@mne-cpp.org>
+ * @since    2.0.0
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, Christoph Dinh. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * @brief    Apply SSS/tSSS with head-movement compensation from continuous HPI to raw data.
+ *
+ *           The tool works in three passes over the file:
+ *           - The head position is fitted for every HPI step. The file is split into as many contiguous
+ *             parts as there are threads; within a part every fit starts from the previous one.
+ *           - Head positions within the tolerance of an earlier one share its SSS basis, the remaining
+ *             bases are computed in parallel.
+ *           - The raw data are read, processed and written block by block, one block per tSSS window, with
+ *             the blocks processed in parallel. Every sample is decomposed with the basis of its head position
+ *             and reconstructed with the internal basis of the initial head position.
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <fiff/fiff.h>
+#include <fiff/fiff_raw_data.h>
+#include <fiff/fiff_info.h>
+#include <fiff/fiff_stream.h>
+#include <fiff/fiff_raw_pipeline.h>
+#include <dsp/sss.h>
+#include <inv/hpi/inv_hpi_fit.h>
+#include <inv/hpi/inv_hpi_batch_fit.h>
+#include <utils/generics/mne_logger.h>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QCommandLineOption>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <QDebug>
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+//=============================================================================================================
+// C++ INCLUDES
+//=============================================================================================================
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace INVLIB;
+using namespace UTILSLIB;
+using namespace Eigen;
+
+//=============================================================================================================
+// STATIC DEFINITIONS
+//=============================================================================================================
+
+#define PROGRAM_VERSION MNE_CPP_VERSION
+
+//=============================================================================================================
+// HELPERS
+//=============================================================================================================
+
+namespace {
+
+typedef Eigen::Matrix<float, 4, 4, Eigen::DontAlign> TransMatrix;  /**< Unaligned 4x4 transformation, storable in Qt containers. */
+
+//=============================================================================================================
+/**
+ * Returns a copy of the measurement info with the MEG sensor positions and orientations moved into head
+ * coordinates with the given device to head transformation.
+ */
+FiffInfo infoInHead(const FiffInfo& info, const Matrix4f& matDevHead)
+{
+    FiffInfo infoHead = info;
+    const Matrix3f matRot = matDevHead.block<3,3>(0,0);
+    const Vector3f vecMove = matDevHead.block<3,1>(0,3);
+
+    for (FiffChInfo& ch : infoHead.chs) {
+        if (ch.kind != FIFFV_MEG_CH && ch.kind != FIFFV_REF_MEG_CH) {
+            continue;
+        }
+        ch.chpos.r0 = matRot * ch.chpos.r0 + vecMove;
+        ch.chpos.ex = matRot * ch.chpos.ex;
+        ch.chpos.ey = matRot * ch.chpos.ey;
+        ch.chpos.ez = matRot * ch.chpos.ez;
+    }
+
+    return infoHead;
+}
+
+} // anonymous namespace
+
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+int main(int argc, char *argv[])
+{
+    qInstallMessageHandler(MNELogger::customLogWriter);
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("mne_sss");
+    QCoreApplication::setApplicationVersion(PROGRAM_VERSION);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Apply Signal Space Separation (SSS) or temporal SSS (tSSS) to raw FIFF data.\n\n"
+                                     "Optionally fits the head position from continuous HPI and compensates head movements.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    QCommandLineOption inOpt("in", "Input raw FIFF file.", "file");
+    QCommandLineOption outOpt("out", "Output raw FIFF file.", "file");
+    QCommandLineOption posOpt("pos", "Write the fitted head positions to this file (MaxFilter .pos format).", "file");
+    QCommandLineOption orderInOpt("order-in", "Internal expansion order (default 8).", "value", "8");
+    QCommandLineOption orderOutOpt("order-out", "External expansion order (default 3).", "value", "3");
+    QCommandLineOption originOpt("origin", "Expansion origin in head coordinates in mm (default 0,0,40).", "x,y,z", "0,0,40");
+    QCommandLineOption regOpt("reg", "Regularisation of the basis pseudoinverse (default 1e-5).", "value", "1e-5");
+    QCommandLineOption stOpt("st", "Apply temporal SSS.");
+    QCommandLineOption stBufOpt("st-buflen", "tSSS window length in s (default 10).", "s", "10");
+    QCommandLineOption stCorrOpt("st-corr", "tSSS correlation limit (default 0.98).", "value", "0.98");
+    QCommandLineOption moveOpt("movecomp", "Compensate head movements using continuous HPI.");
+    QCommandLineOption freqsOpt("hpi-freqs", "HPI coil frequencies in Hz, e.g. 154,158,161,166.", "list");
+    QCommandLineOption hpiWinOpt("hpi-window", "HPI fit window in ms (default 200).", "ms", "200");
+    QCommandLineOption hpiStepOpt("hpi-step", "Time between HPI fits in ms (default 200).", "ms", "200");
+    QCommandLineOption hpiErrOpt("hpi-maxerr", "Largest accepted mean coil error in mm; worse fits keep the previous position (default 5).", "mm", "5");
+    QCommandLineOption tolTransOpt("tol-trans", "Head positions closer than this share an SSS basis, in mm (default 1).", "mm", "1");
+    QCommandLineOption tolRotOpt("tol-rot", "Head rotations smaller than this share an SSS basis, in degrees (default 1).", "deg", "1");
+    QCommandLineOption jobsOpt("jobs", "Number of threads, 0 for one per core (default 0).", "n", "0");
+
+    parser.addOptions({inOpt, outOpt, posOpt, orderInOpt, orderOutOpt, originOpt, regOpt, stOpt, stBufOpt, stCorrOpt,
+                       moveOpt, freqsOpt, hpiWinOpt, hpiStepOpt, hpiErrOpt, tolTransOpt, tolRotOpt, jobsOpt});
+
+    parser.process(app);
+
+    QString inFile = parser.value(inOpt);
+    QString outFile = parser.value(outOpt);
+    QString posFile = parser.value(posOpt);
+    bool bTemporal = parser.isSet(stOpt);
+    bool bMoveComp = parser.isSet(moveOpt);
+    bool bFitHpi = bMoveComp || !posFile.isEmpty();
+    double dCorrLimit = parser.value(stCorrOpt).toDouble();
+    int iJobs = parser.value(jobsOpt).toInt();
+
+    if (inFile.isEmpty()) { qCritical("--in is required."); return 1; }
+    if (outFile.isEmpty() && posFile.isEmpty()) { qCritical("--out or --pos is required."); return 1; }
+    if (bFitHpi && !parser.isSet(freqsOpt)) { qCritical("--hpi-freqs is required for --movecomp and --pos."); return 1; }
+
+    if (iJobs > 0) {
+        QThreadPool::globalInstance()->setMaxThreadCount(iJobs);
+    }
+    const int iThreads = QThreadPool::globalInstance()->maxThreadCount();
+
+    SSS::Params params;
+    params.iOrderIn = parser.value(orderInOpt).toInt();
+    params.iOrderOut = parser.value(orderOutOpt).toInt();
+    params.dRegIn = parser.value(regOpt).toDouble();
+    QStringList lOrigin = parser.value(originOpt).split(",");
+    if (lOrigin.size() != 3) { qCritical("--origin needs three values."); return 1; }
+    for (int i = 0; i < 3; ++i) {
+        params.origin(i) = lOrigin[i].toDouble() / 1000.0;
+    }
+
+    // Open input file
+    QFile fileIn(inFile);
+    FiffRawData raw(fileIn);
+    if (raw.info.isEmpty()) {
+        qCritical("Cannot read raw data from: %s", qPrintable(inFile));
+        return 1;
+    }
+
+    const double dSFreq = raw.info.sfreq;
+    const Matrix4f matRefTrans = raw.info.dev_head_t.isEmpty() ? Matrix4f::Identity()
+                                                               : Matrix4f(raw.info.dev_head_t.trans);
+    if (raw.info.dev_head_t.isEmpty()) {
+        qWarning("No device to head transformation in the file, using the device coordinates.");
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    //=========================================================================================================
+    // Head positions
+    //=========================================================================================================
+
+    QVector<HpiBatchWindow> vecPositions;
+    fiff_int_t iStep = std::max<fiff_int_t>(1, std::lround(parser.value(hpiStepOpt).toDouble() / 1000.0 * dSFreq));
+
+    if (bFitHpi) {
+        QVector<int> vecFreqs;
+        for (const QString& sFreq : parser.value(freqsOpt).split(",")) {
+            vecFreqs.append(sFreq.toInt());
+        }
+
+        InvHpiBatchFit batchFit(inFile, vecFreqs);
+        batchFit.setWindowLength(parser.value(hpiWinOpt).toDouble() / 1000.0);
+        batchFit.setStep(parser.value(hpiStepOpt).toDouble() / 1000.0);
+        batchFit.setMaxError(parser.value(hpiErrOpt).toDouble() / 1000.0);
+        batchFit.setNumThreads(iThreads);
+
+        if (!batchFit.run()) {
+            qCritical("Cannot fit the head positions of: %s", qPrintable(inFile));
+            return 1;
+        }
+        vecPositions = batchFit.getWindows();
+        iStep = batchFit.getStepSamples();
+
+        const HpiBatchStats hpiStats = batchFit.getStats();
+        printf("Fitted %d head positions in %.1f s (%.1f windows/s, %d above the error limit).\n",
+               hpiStats.iWindows, hpiStats.dWallTime, hpiStats.dWindowsPerSec, hpiStats.iRejected);
+        printf("Coil error: mean %.2f mm, median %.2f mm, max %.2f mm; mean GoF %.4f.\n",
+               hpiStats.dMeanError * 1000.0, hpiStats.dMedianError * 1000.0, hpiStats.dMaxError * 1000.0,
+               hpiStats.dMeanGoF);
+
+        if (!posFile.isEmpty()) {
+            if (!batchFit.writeHeadPositions(posFile)) {
+                qCritical("Cannot write head positions to: %s", qPrintable(posFile));
+                return 1;
+            }
+            printf("Written head positions to: %s\n", qPrintable(posFile));
+        }
+    }
+
+    if (outFile.isEmpty()) {
+        return 0;
+    }
+
+    //=========================================================================================================
+    // SSS bases
+    //=========================================================================================================
+
+    const SSS::Basis refBasis = SSS::computeBasis(infoInHead(raw.info, matRefTrans), params);
+    if (refBasis.megChannelIdx.isEmpty()) {
+        qCritical("No MEG channels in: %s", qPrintable(inFile));
+        return 1;
+    }
+
+    // Head positions within the tolerance of an earlier basis use that basis
+    QVector<TransMatrix> vecBasisTrans;
+    QVector<int> vecPositionBasis;
+    if (bMoveComp) {
+        const float fTolTrans = parser.value(tolTransOpt).toFloat() / 1000.0f;
+        const float fTolRot = parser.value(tolRotOpt).toFloat();
+
+        vecPositionBasis.resize(vecPositions.size());
+        int iLast = -1;
+        for (int k = 0; k < vecPositions.size(); ++k) {
+            const Matrix4f matTrans = vecPositions.at(k).matDevHead;
+            int iBasis = -1;
+            if (iLast >= 0 && !InvHpiFit::compareTransformation(vecBasisTrans[iLast], matTrans, fTolRot, fTolTrans)) {
+                iBasis = iLast;
+            }
+            for (int j = 0; iBasis < 0 && j < vecBasisTrans.size(); ++j) {
+                if (!InvHpiFit::compareTransformation(vecBasisTrans[j], matTrans, fTolRot, fTolTrans)) {
+                    iBasis = j;
+                }
+            }
+            if (iBasis < 0) {
+                iBasis = vecBasisTrans.size();
+                vecBasisTrans.append(matTrans);
+            }
+            vecPositionBasis[k] = iBasis;
+            iLast = iBasis;
+        }
+    }
+
+    // Only the decomposition is needed per head position, the reconstruction uses the reference basis
+    QVector<MatrixXd> vecPinv(vecBasisTrans.size());
+    QVector<int> vecBasisIdx(vecBasisTrans.size());
+    std::iota(vecBasisIdx.begin(), vecBasisIdx.end(), 0);
+    QtConcurrent::blockingMap(vecBasisIdx, [&](int j) {
+        vecPinv[j] = SSS::computeBasis(infoInHead(raw.info, vecBasisTrans.at(j)), params).matPinvAll;
+    });
+
+    if (bMoveComp) {
+        printf("Computed %d SSS bases for %d head positions.\n",
+               static_cast<int>(vecPinv.size()), static_cast<int>(vecPositions.size()));
+    }
+
+    //=========================================================================================================
+    // Processing
+    //=========================================================================================================
+
+    QFile fileOut(outFile);
+    Eigen::RowVectorXd cals;
+    FiffStream::SPtr outStream = FiffStream::start_writing_raw(fileOut, raw.info, cals);
+    if (!outStream) {
+        qCritical("Cannot open output file: %s", qPrintable(outFile));
+        return 1;
+    }
+
+    fiff_int_t firstSamp = raw.first_samp;
+    if (firstSamp > 0) {
+        outStream->write_int(FIFF_FIRST_SAMPLE, &firstSamp);
+    }
+    outStream->start_write_behind();
+
+    // One block is one tSSS window. The blocks are independent and are processed by several workers.
+    const fiff_int_t iBlockSize = std::max<fiff_int_t>(1, std::lround(parser.value(stBufOpt).toDouble() * dSFreq));
+    FiffRawPipeline pipeline(raw, iBlockSize);
+    pipeline.setNumWorkers(iJobs);
+
+    const int nMeg = refBasis.megChannelIdx.size();
+    const int nIn = refBasis.iNin;
+    const int nOut = refBasis.iNout;
+
+    FiffRawPipeline::Transform sssBlock = [&](FiffRawBlock& block) {
+        const int nSamp = static_cast<int>(block.matData.cols());
+
+        MatrixXd megData(nMeg, nSamp);
+        for (int i = 0; i < nMeg; ++i) {
+            megData.row(i) = block.matData.row(refBasis.megChannelIdx[i]);
+        }
+
+        MatrixXd cIn(nIn, nSamp);
+        MatrixXd cOut(nOut, nSamp);
+        if (bMoveComp) {
+            // Decompose every HPI step with the basis of its head position
+            int col = 0;
+            while (col < nSamp) {
+                const int k = std::min<int>((block.first + col - raw.first_samp) / iStep, vecPositions.size() - 1);
+                const int iEnd = (k == vecPositions.size() - 1) ? nSamp
+                                                                : std::min<int>(nSamp, vecPositions.at(k + 1).first - block.first);
+                const MatrixXd& matPinv = vecPinv.at(vecPositionBasis.at(k));
+                cIn.middleCols(col, iEnd - col).noalias() = matPinv.topRows(nIn) * megData.middleCols(col, iEnd - col);
+                cOut.middleCols(col, iEnd - col).noalias() = matPinv.bottomRows(nOut) * megData.middleCols(col, iEnd - col);
+                col = iEnd;
+            }
+        } else {
+            cIn.noalias() = refBasis.matPinvAll.topRows(nIn) * megData;
+            if (bTemporal) {
+                cOut.noalias() = refBasis.matPinvAll.bottomRows(nOut) * megData;
+            }
+        }
+
+        if (bTemporal) {
+            SSS::temporalProject(cIn, cOut, dCorrLimit);
+        }
+
+        // Reconstruct at the initial head position
+        megData.noalias() = refBasis.matSin * cIn;
+        for (int i = 0; i < nMeg; ++i) {
+            block.matData.row(refBasis.megChannelIdx[i]) = megData.row(i);
+        }
+        return true;
+    };
+
+    bool ok = pipeline.run(sssBlock, outStream, cals);
+
+    outStream->finish_writing_raw();
+
+    if (!ok) {
+        qCritical("Cannot process raw data");
+        return 1;
+    }
+
+    const FiffRawPipelineStats stats = pipeline.getStats();
+    printf("Processed %d channels x %d samples with %s%s in %.1f s.\n",
+           stats.iChannels, static_cast<int>(stats.iSamples),
+           bTemporal ? "tSSS" : "SSS",
+           bMoveComp ? " and movement compensation" : "",
+           timer.elapsed() / 1000.0);
+    printf("Written processed data to: %s\n", qPrintable(outFile));
+
+    return 0;
+}